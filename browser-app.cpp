@@ -306,12 +306,16 @@ bool BrowserApp::OnProcessMessageReceived(CefRefPtr<CefBrowser> browser,
 
 		CefRefPtr<CefV8Value> globalObj = context->GetGlobal();
 		
-		Json::object json;
+		/* Validate the payload without building a Json tree */
+		std::string jsonString = "{";
 		if (args->GetSize() > 1) {
 			std::string err;
-			json["detail"] = Json::parse(args->GetString(1).ToString(), err);
+			jsonString += "\"detail\":";
+			if (!Json::minify(args->GetString(1).ToString(),
+					  jsonString, err))
+				jsonString += "null";
 		}
-		std::string jsonString = Json(json).dump();
+		jsonString += "}";
 
 		jsonString = StringReplaceAll(jsonString, "'", "\\u0027");
 		jsonString = StringReplaceAll(jsonString, "\\", "\\\\");
@@ -626,44 +630,56 @@ void MessageObject::ExecuteTask(MessageTask task)
 	task();
 }
 
+MessageObject::MessageObject()
+	: pump({
+		  /* post */
+		  [this](int ms) {
+			  QMetaObject::invokeMethod(this, "DoCefMessageLoop",
+						    Qt::QueuedConnection,
+						    Q_ARG(int, ms));
+		  },
+		  /* startTimer */
+		  [this](int ms) { StartPumpTimer(ms); },
+		  /* stopTimer */
+		  [this]() { pumpTimer.stop(); },
+		  /* doWork */
+		  []() { CefDoMessageLoopWork(); },
+		  /* now */
+		  []() { return os_gettime_ns(); },
+	  })
+{
+}
+
 void MessageObject::DoCefMessageLoop(int ms)
 {
-	if (ms)
-		QTimer::singleShot((int)ms + 2,
-				   []() { CefDoMessageLoopWork(); });
-	else
-		CefDoMessageLoopWork();
+	pump.DoCefMessageLoop(ms);
 }
 
-void MessageObject::Process()
+void MessageObject::OnPumpTimer()
 {
-	CefDoMessageLoopWork();
+	pump.OnPumpTimer();
 }
 
-void ProcessCef()
+void MessageObject::StartPumpTimer(int ms)
 {
-	QMetaObject::invokeMethod(&messageObject, "DoCefMessageLoop",
-				  Qt::QueuedConnection, Q_ARG(int, (int)0));
+	if (!pumpTimerConnected) {
+		pumpTimer.setSingleShot(true);
+		pumpTimer.setTimerType(Qt::PreciseTimer);
+		QObject::connect(&pumpTimer, &QTimer::timeout, this,
+				 &MessageObject::OnPumpTimer);
+		pumpTimerConnected = true;
+	}
+
+	pumpTimer.start(ms);
 }
 
-#define MAX_DELAY (1000 / 30)
+void ProcessCef()
+{
+	messageObject.SchedulePump(0);
+}
 
 void BrowserApp::OnScheduleMessagePumpWork(int64 delay_ms)
 {
-	if (delay_ms < 0)
-		delay_ms = 0;
-	else if (delay_ms > MAX_DELAY)
-		delay_ms = MAX_DELAY;
-
-	if (!frameTimer.isActive()) {
-		QObject::connect(&frameTimer, &QTimer::timeout, &messageObject,
-				 &MessageObject::Process);
-		frameTimer.setSingleShot(false);
-		frameTimer.start(33);
-	}
-
-	QMetaObject::invokeMethod(&messageObject, "DoCefMessageLoop",
-				  Qt::QueuedConnection,
-				  Q_ARG(int, (int)delay_ms));
+	messageObject.SchedulePump(delay_ms);
 }
 #endif
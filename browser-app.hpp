@@ -30,6 +30,7 @@ typedef std::function<void(CefRefPtr<CefBrowser>)> BrowserFunc;
 #include <QTimer>
 #include <mutex>
 #include <deque>
+#include "browser-message-pump.hpp"
 
 typedef std::function<void()> MessageTask;
 
@@ -53,11 +54,25 @@ class MessageObject : public QObject {
 	std::mutex browserTaskMutex;
 	std::deque<Task> browserTasks;
 
+	/* Main thread only */
+	QTimer pumpTimer;
+	bool pumpTimerConnected = false;
+
+	CefMessagePump pump;
+
+	void StartPumpTimer(int ms);
+
+public:
+	MessageObject();
+
+	void SchedulePump(int64_t delay_ms) { pump.SchedulePump(delay_ms); }
+	void StopPump() { pump.Stop(); }
+
 public slots:
 	bool ExecuteNextBrowserTask();
 	void ExecuteTask(MessageTask task);
 	void DoCefMessageLoop(int ms);
-	void Process();
+	void OnPumpTimer();
 };
 
 extern void QueueBrowserTask(CefRefPtr<CefBrowser> browser, BrowserFunc func);
@@ -123,7 +138,6 @@ public:
 
 #ifdef USE_QT_LOOP
 	virtual void OnScheduleMessagePumpWork(int64 delay_ms) override;
-	QTimer frameTimer;
 #endif
 
 #if !ENABLE_WASHIDDEN
@@ -17,6 +17,7 @@
  ******************************************************************************/
 
 #include "streamelements/StreamElementsMessageBus.hpp"
+#include "streamelements/StreamElementsTracer.hpp"
 #include "browser-client.hpp"
 #include "obs-browser-source.hpp"
 #include "base64/base64.hpp"
@@ -204,6 +205,8 @@ void BrowserClient::OnPaint(CefRefPtr<CefBrowser>, PaintElementType type,
 		return;
 	}
 
+	SE_TRACE_SCOPE("paint", "OnPaint upload");
+
 	if (source->width != width || source->height != height) {
 		obs_enter_graphics();
 		source->DestroyTextures();
@@ -322,16 +325,8 @@ void BrowserClient::OnAudioStreamStarted(CefRefPtr<CefBrowser> browser, int id,
 	}
 
 	AudioStream &stream = bs->audio_streams[id];
-	if (!stream.source) {
-		stream.source = obs_source_create_private("audio_line", nullptr,
-							  nullptr);
-		obs_source_release(stream.source);
-
-		obs_source_add_active_child(bs->source, stream.source);
-
-		std::lock_guard<std::mutex> lock(bs->audio_sources_mutex);
-		bs->audio_sources.push_back(stream.source);
-	}
+	if (!stream.source)
+		stream.source = bs->AcquireAudioSource();
 
 	stream.speakers = GetSpeakerLayout(channel_layout);
 	stream.channels = get_audio_channels(stream.speakers);
@@ -373,18 +368,7 @@ void BrowserClient::OnAudioStreamStopped(CefRefPtr<CefBrowser> browser, int id)
 		return;
 	}
 
-	AudioStream &stream = pair->second;
-	{
-		std::lock_guard<std::mutex> lock(bs->audio_sources_mutex);
-		for (size_t i = 0; i < bs->audio_sources.size(); i++) {
-			obs_source_t *source = bs->audio_sources[i];
-			if (source == stream.source) {
-				bs->audio_sources.erase(
-					bs->audio_sources.begin() + i);
-				break;
-			}
-		}
-	}
+	bs->ReleaseAudioSource(pair->second.source);
 	bs->audio_streams.erase(pair);
 }
 #endif
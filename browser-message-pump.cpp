@@ -0,0 +1,191 @@
+/******************************************************************************
+ Copyright (C) 2014 by John R. Bradley <jrb@turrettech.com>
+ Copyright (C) 2018 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "browser-message-pump.hpp"
+
+#include <util/base.h>
+
+/* While CEF requests no work, a fallback pump runs with a delay which starts
+ * at MIN_IDLE_DELAY and doubles up to MAX_IDLE_DELAY. Any CEF request resets
+ * the backoff. */
+#define MIN_IDLE_DELAY (1000 / 30)
+#define MAX_IDLE_DELAY 1000
+
+#define PUMP_STATS_INTERVAL_NS 60000000000ULL
+
+CefMessagePump::CefMessagePump(Callbacks callbacks) : cb(callbacks) {}
+
+void CefMessagePump::SchedulePump(int64_t delay_ms)
+{
+	++pumpRequestCount;
+
+	if (delay_ms <= 0) {
+		/* Coalesce immediate requests until the pump runs */
+		if (immediatePumpPending.exchange(true))
+			return;
+
+		immediatePumpRequestTime = cb.now();
+		delay_ms = 0;
+	}
+
+	cb.post((int)delay_ms);
+}
+
+void CefMessagePump::DoCefMessageLoop(int ms)
+{
+	uint64_t now = cb.now();
+
+	idleDelay = MIN_IDLE_DELAY;
+
+	if (ms <= 0) {
+		if (inPump) {
+			/* Reached from a nested event loop inside the pump:
+			 * keep the request pending and re-post it once the
+			 * running pump returns */
+			immediatePumpDeferred = true;
+			return;
+		}
+
+		uint64_t requestTime = immediatePumpRequestTime;
+
+		immediatePumpPending = false;
+
+		RunCefMessageLoopWork(requestTime ? requestTime : now);
+		return;
+	}
+
+	uint64_t dueTime = now + (uint64_t)ms * 1000000ULL;
+
+	if (!requestedDueTime || dueTime < requestedDueTime)
+		requestedDueTime = dueTime;
+
+	ArmPumpTimer(now);
+}
+
+void CefMessagePump::OnPumpTimer()
+{
+	if (requestedDueTime && cb.now() >= requestedDueTime)
+		RunCefMessageLoopWork(requestedDueTime);
+	else
+		RunCefMessageLoopWork(0);
+}
+
+void CefMessagePump::RunCefMessageLoopWork(uint64_t dueTime)
+{
+	/* CefDoMessageLoopWork() must not be re-entered */
+	if (inPump || pumpStopped)
+		return;
+
+	uint64_t startTime = cb.now();
+
+	if (!statsStartTime)
+		statsStartTime = startTime;
+
+	if (dueTime) {
+		uint64_t latency = startTime > dueTime ? startTime - dueTime
+						       : 0;
+
+		stats.pumpLatencyTotal += latency;
+		if (latency > stats.pumpLatencyMax)
+			stats.pumpLatencyMax = latency;
+
+		++stats.requestedPumpCount;
+	} else if (idleDelay < MAX_IDLE_DELAY) {
+		/* Nothing was requested: back off the fallback pump */
+		idleDelay = idleDelay * 2 < MAX_IDLE_DELAY ? idleDelay * 2
+							   : MAX_IDLE_DELAY;
+	}
+
+	/* This call satisfies any request which is already due */
+	if (requestedDueTime && requestedDueTime <= startTime)
+		requestedDueTime = 0;
+
+	uint64_t requestsBefore = pumpRequestCount;
+
+	inPump = true;
+	cb.doWork();
+	inPump = false;
+
+	if (immediatePumpDeferred) {
+		immediatePumpDeferred = false;
+
+		cb.post(0);
+	}
+
+	uint64_t endTime = cb.now();
+
+	++stats.pumpCount;
+	stats.pumpTimeTotal += endTime - startTime;
+	stats.pumpRequestsTotal += pumpRequestCount - requestsBefore;
+
+	if (endTime - statsStartTime >= PUMP_STATS_INTERVAL_NS)
+		LogPumpStats(endTime);
+
+	ArmPumpTimer(endTime);
+}
+
+void CefMessagePump::Stop()
+{
+	pumpStopped = true;
+	cb.stopTimer();
+}
+
+void CefMessagePump::ArmPumpTimer(uint64_t now)
+{
+	if (pumpStopped)
+		return;
+
+	if (!idleDelay)
+		idleDelay = MIN_IDLE_DELAY;
+
+	uint64_t dueTime = now + (uint64_t)idleDelay * 1000000ULL;
+
+	if (requestedDueTime && requestedDueTime < dueTime)
+		dueTime = requestedDueTime;
+
+	int ms = dueTime > now ? (int)((dueTime - now + 999999ULL) / 1000000ULL)
+			       : 0;
+
+	cb.startTimer(ms);
+}
+
+void CefMessagePump::LogPumpStats(uint64_t now)
+{
+	double seconds = (double)(now - statsStartTime) / 1000000000.0;
+
+	blog(LOG_DEBUG,
+	     "[obs-browser]: message pump: %llu calls in %.1f s (%llu requested), "
+	     "latency avg %.3f ms max %.3f ms, "
+	     "work time avg %.3f ms, %.2f work requests per call",
+	     (unsigned long long)stats.pumpCount, seconds,
+	     (unsigned long long)stats.requestedPumpCount,
+	     stats.requestedPumpCount ? (double)stats.pumpLatencyTotal /
+						(double)stats.requestedPumpCount /
+						1000000.0
+				      : 0.0,
+	     (double)stats.pumpLatencyMax / 1000000.0,
+	     stats.pumpCount ? (double)stats.pumpTimeTotal /
+				       (double)stats.pumpCount / 1000000.0
+			     : 0.0,
+	     stats.pumpCount ? (double)stats.pumpRequestsTotal /
+				       (double)stats.pumpCount
+			     : 0.0);
+
+	statsStartTime = now;
+	stats = Stats();
+}
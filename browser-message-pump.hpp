@@ -0,0 +1,92 @@
+/******************************************************************************
+ Copyright (C) 2014 by John R. Bradley <jrb@turrettech.com>
+ Copyright (C) 2018 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+/* Schedules CefDoMessageLoopWork() on the main thread from the delays CEF
+ * requests through OnScheduleMessagePumpWork().
+ *
+ * Zero-delay requests are coalesced into a single queued pump. Delayed
+ * requests arm a single-shot timer for the earliest due time. While CEF
+ * requests nothing, a fallback pump runs with a delay backing off from
+ * 33 ms to 1 s.
+ *
+ * The main loop, timer, clock and the pump work itself are supplied as
+ * callbacks, so this depends on neither Qt nor CEF.
+ */
+class CefMessagePump {
+public:
+	struct Callbacks {
+		/* Queues DoCefMessageLoop(ms) to the main thread */
+		std::function<void(int ms)> post;
+		/* (Re)starts the single-shot timer calling OnPumpTimer() */
+		std::function<void(int ms)> startTimer;
+		std::function<void()> stopTimer;
+		/* CefDoMessageLoopWork() */
+		std::function<void()> doWork;
+		/* Monotonic time in ns */
+		std::function<uint64_t()> now;
+	};
+
+	struct Stats {
+		uint64_t pumpCount = 0;
+		uint64_t requestedPumpCount = 0;
+		uint64_t pumpLatencyTotal = 0;
+		uint64_t pumpLatencyMax = 0;
+		uint64_t pumpTimeTotal = 0;
+		uint64_t pumpRequestsTotal = 0;
+	};
+
+	explicit CefMessagePump(Callbacks callbacks);
+
+	/* Any thread */
+	void SchedulePump(int64_t delay_ms);
+
+	/* Main thread */
+	void DoCefMessageLoop(int ms);
+	void OnPumpTimer();
+	void Stop();
+
+	/* Since the last stats log, main thread */
+	const Stats &GetStats() const { return stats; }
+
+private:
+	void RunCefMessageLoopWork(uint64_t dueTime);
+	void ArmPumpTimer(uint64_t now);
+	void LogPumpStats(uint64_t now);
+
+	Callbacks cb;
+
+	std::atomic<bool> immediatePumpPending = {false};
+	std::atomic<uint64_t> immediatePumpRequestTime = {0};
+	std::atomic<uint64_t> pumpRequestCount = {0};
+
+	/* Accessed on the main thread only */
+	bool inPump = false;
+	bool pumpStopped = false;
+	bool immediatePumpDeferred = false;
+	uint64_t requestedDueTime = 0;
+	int idleDelay = 0;
+
+	uint64_t statsStartTime = 0;
+	Stats stats;
+};
@@ -25,99 +25,323 @@ Ren
 
 */
 
+/*
+Altered source version: the byte-at-a-time codec was replaced with a
+table-driven scalar codec and an SSSE3 codec selected at runtime, and a
+validating decoder was added.
+*/
+
 #include "base64.hpp"
-#include <iostream>
 
-static const std::string base64_chars =
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+	defined(_M_IX86)
+#define BASE64_HAVE_SSSE3 1
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BASE64_TARGET_SSSE3
+#else
+#define BASE64_TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+static const char base64_chars[] =
 "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
 "abcdefghijklmnopqrstuvwxyz"
 "0123456789+/";
 
+// Decoded value of each input byte, or 0xFF if it is not a base64 char
+struct base64_decode_table {
+	uint8_t values[256];
+
+	base64_decode_table()
+	{
+		memset(values, 0xFF, sizeof(values));
+
+		for (int i = 0; i < 64; ++i)
+			values[(uint8_t)base64_chars[i]] = (uint8_t)i;
+	}
+};
+
+static const base64_decode_table decode_table;
 
-static inline bool is_base64(unsigned char c) {
-	return (isalnum(c) || (c == '+') || (c == '/'));
+#ifdef BASE64_HAVE_SSSE3
+static bool cpu_has_ssse3()
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3");
+#endif
 }
 
+static const bool use_ssse3 = cpu_has_ssse3();
+
+// Encodes 12 input bytes into 16 chars per iteration, reading 16 bytes.
+// Returns the number of input bytes consumed.
+BASE64_TARGET_SSSE3
+static size_t encode_ssse3(const uint8_t *in, size_t len, char *out)
+{
+	const uint8_t *start = in;
+
+	const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5,
+					     3, 4, 1, 2, 0, 1);
+	const __m128i lut = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4, -4,
+					  -4, -4, -4, -19, -16, 0, 0);
+
+	while (len >= 16) {
+		__m128i str = _mm_loadu_si128((const __m128i *)in);
+
+		// Split each 3 byte group into four 6 bit values
+		str = _mm_shuffle_epi8(str, shuffle);
+
+		const __m128i t0 =
+			_mm_and_si128(str, _mm_set1_epi32(0x0FC0FC00));
+		const __m128i t1 =
+			_mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+		const __m128i t2 =
+			_mm_and_si128(str, _mm_set1_epi32(0x003F03F0));
+		const __m128i t3 =
+			_mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+
+		str = _mm_or_si128(t1, t3);
+
+		// Translate 6 bit values to ASCII
+		__m128i indices = _mm_subs_epu8(str, _mm_set1_epi8(51));
+		const __m128i mask = _mm_cmpgt_epi8(str, _mm_set1_epi8(25));
+		indices = _mm_sub_epi8(indices, mask);
+
+		str = _mm_add_epi8(str, _mm_shuffle_epi8(lut, indices));
+
+		_mm_storeu_si128((__m128i *)out, str);
+
+		in += 12;
+		out += 16;
+		len -= 12;
+	}
+
+	return in - start;
+}
+
+// Decodes 16 input chars into 12 bytes per iteration, writing 16 bytes.
+// Stops at the first block containing a char which is not in the base64
+// alphabet (including '='). Returns the number of input chars consumed.
+BASE64_TARGET_SSSE3
+static size_t decode_ssse3(const uint8_t *in, size_t len, uint8_t *out)
+{
+	const uint8_t *start = in;
+
+	const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11,
+					     0x11, 0x11, 0x11, 0x11, 0x11,
+					     0x13, 0x1A, 0x1B, 0x1B, 0x1B,
+					     0x1A);
+	const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04,
+					     0x08, 0x04, 0x08, 0x10, 0x10,
+					     0x10, 0x10, 0x10, 0x10, 0x10,
+					     0x10);
+	const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71,
+					       -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i mask_2F = _mm_set1_epi8(0x2F);
+
+	while (len >= 16) {
+		__m128i str = _mm_loadu_si128((const __m128i *)in);
+
+		const __m128i hi_nibbles =
+			_mm_and_si128(_mm_srli_epi32(str, 4), mask_2F);
+		const __m128i lo_nibbles = _mm_and_si128(str, mask_2F);
+		const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+		const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+
+		// Leave blocks with invalid chars to the scalar decoder
+		if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+						     _mm_setzero_si128())))
+			break;
+
+		const __m128i eq_2F = _mm_cmpeq_epi8(str, mask_2F);
+		const __m128i roll = _mm_shuffle_epi8(
+			lut_roll, _mm_add_epi8(eq_2F, hi_nibbles));
+
+		str = _mm_add_epi8(str, roll);
+
+		// Pack four 6 bit values into 3 bytes
+		const __m128i merge_ab_and_bc = _mm_maddubs_epi16(
+			str, _mm_set1_epi32(0x01400140));
+		str = _mm_madd_epi16(merge_ab_and_bc,
+				     _mm_set1_epi32(0x00011000));
+		str = _mm_shuffle_epi8(str,
+				       _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9,
+						     8, 14, 13, 12, -1, -1, -1,
+						     -1));
+
+		_mm_storeu_si128((__m128i *)out, str);
+
+		in += 16;
+		out += 12;
+		len -= 16;
+	}
+
+	return in - start;
+}
+#endif
+
 std::string base64_encode(unsigned char const* bytes_to_encode, unsigned int in_len) {
+	const uint8_t *in = bytes_to_encode;
+	size_t len = in_len;
+
 	std::string ret;
-	int i = 0;
-	int j = 0;
-	unsigned char char_array_3[3];
-	unsigned char char_array_4[4];
-
-	while (in_len--) {
-		char_array_3[i++] = *(bytes_to_encode++);
-		if (i == 3) {
-			char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-			char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-			char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-			char_array_4[3] = char_array_3[2] & 0x3f;
-
-			for (i = 0; (i <4); i++)
-				ret += base64_chars[char_array_4[i]];
-			i = 0;
-		}
+	ret.resize((len + 2) / 3 * 4);
+
+	char *out = &ret[0];
+
+#ifdef BASE64_HAVE_SSSE3
+	if (use_ssse3) {
+		size_t consumed = encode_ssse3(in, len, out);
+
+		in += consumed;
+		len -= consumed;
+		out += consumed / 3 * 4;
 	}
+#endif
 
-	if (i)
-	{
-		for (j = i; j < 3; j++)
-			char_array_3[j] = '\0';
+	while (len >= 3) {
+		uint32_t triple = ((uint32_t)in[0] << 16) |
+				  ((uint32_t)in[1] << 8) | (uint32_t)in[2];
 
-		char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-		char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-		char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-		char_array_4[3] = char_array_3[2] & 0x3f;
+		out[0] = base64_chars[(triple >> 18) & 0x3F];
+		out[1] = base64_chars[(triple >> 12) & 0x3F];
+		out[2] = base64_chars[(triple >> 6) & 0x3F];
+		out[3] = base64_chars[triple & 0x3F];
+
+		in += 3;
+		len -= 3;
+		out += 4;
+	}
 
-		for (j = 0; (j < i + 1); j++)
-			ret += base64_chars[char_array_4[j]];
+	if (len) {
+		uint32_t triple = (uint32_t)in[0] << 16;
 
-		while ((i++ < 3))
-			ret += '=';
+		if (len == 2)
+			triple |= (uint32_t)in[1] << 8;
 
+		out[0] = base64_chars[(triple >> 18) & 0x3F];
+		out[1] = base64_chars[(triple >> 12) & 0x3F];
+		out[2] = len == 2 ? base64_chars[(triple >> 6) & 0x3F] : '=';
+		out[3] = '=';
 	}
 
 	return ret;
 
 }
 
-std::string base64_decode(std::string const& encoded_string) {
-	int in_len = (int)encoded_string.size();
-	int i = 0;
-	int j = 0;
-	int in_ = 0;
-	unsigned char char_array_4[4], char_array_3[3];
+// Decodes the longest prefix of in which consists of base64 alphabet chars.
+// Sets *consumed to the number of chars decoded, a partial trailing group of
+// 2 or 3 chars is decoded as 1 or 2 bytes.
+static std::string decode_prefix(const uint8_t *in, size_t len,
+				 size_t *consumed)
+{
+	// Slack for the 16 byte SIMD stores
 	std::string ret;
+	ret.resize(len / 4 * 3 + 16);
 
-	while (in_len-- && (encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
-		char_array_4[i++] = encoded_string[in_]; in_++;
-		if (i == 4) {
-			for (i = 0; i <4; i++)
-				char_array_4[i] = (unsigned char)base64_chars.find(char_array_4[i]);
+	const uint8_t *start = in;
+	uint8_t *out = (uint8_t *)&ret[0];
 
-			char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-			char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-			char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+#ifdef BASE64_HAVE_SSSE3
+	if (use_ssse3) {
+		size_t n = decode_ssse3(in, len, out);
 
-			for (i = 0; (i < 3); i++)
-				ret += char_array_3[i];
-			i = 0;
-		}
+		in += n;
+		len -= n;
+		out += n / 4 * 3;
 	}
+#endif
+
+	const uint8_t *table = decode_table.values;
+
+	while (len >= 4) {
+		uint8_t a = table[in[0]];
+		uint8_t b = table[in[1]];
+		uint8_t c = table[in[2]];
+		uint8_t d = table[in[3]];
+
+		if ((a | b | c | d) & 0x80)
+			break;
 
-	if (i) {
-		for (j = i; j <4; j++)
-			char_array_4[j] = 0;
+		uint32_t triple = ((uint32_t)a << 18) | ((uint32_t)b << 12) |
+				  ((uint32_t)c << 6) | (uint32_t)d;
 
-		for (j = 0; j <4; j++)
-			char_array_4[j] = (unsigned char)base64_chars.find(char_array_4[j]);
+		out[0] = (uint8_t)(triple >> 16);
+		out[1] = (uint8_t)(triple >> 8);
+		out[2] = (uint8_t)triple;
 
-		char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-		char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-		char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+		in += 4;
+		len -= 4;
+		out += 3;
+	}
+
+	// Trailing group: up to 3 valid chars
+	uint32_t triple = 0;
+	size_t valid = 0;
 
-		for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
+	while (valid < len && valid < 4 && !(table[in[valid]] & 0x80)) {
+		triple |= (uint32_t)table[in[valid]] << (18 - 6 * valid);
+		++valid;
 	}
 
+	if (valid >= 2)
+		*out++ = (uint8_t)(triple >> 16);
+	if (valid >= 3)
+		*out++ = (uint8_t)(triple >> 8);
+
+	in += valid;
+
+	ret.resize(out - (uint8_t *)&ret[0]);
+
+	*consumed = in - start;
+
 	return ret;
 }
+
+std::string base64_decode(std::string const& encoded_string) {
+	size_t consumed = 0;
+
+	// Decoding stops at padding or at the first invalid char
+	return decode_prefix((const uint8_t *)encoded_string.data(),
+			     encoded_string.size(), &consumed);
+}
+
+bool base64_decode(std::string const& encoded_string, std::string& output) {
+	size_t len = encoded_string.size();
+	const char *in = encoded_string.data();
+
+	size_t padding = 0;
+
+	if (len && len % 4 == 0) {
+		if (in[len - 1] == '=')
+			++padding;
+		if (padding && in[len - 2] == '=')
+			++padding;
+	}
+
+	size_t data_len = len - padding;
+
+	// A single char can not carry a complete byte
+	if (data_len % 4 == 1)
+		return false;
+
+	size_t consumed = 0;
+	std::string result =
+		decode_prefix((const uint8_t *)in, data_len, &consumed);
+
+	if (consumed != data_len)
+		return false;
+
+	output.swap(result);
+
+	return true;
+}
@@ -3,6 +3,10 @@
 std::string base64_encode(unsigned char const*, unsigned int len);
 std::string base64_decode(std::string const& s);
 
+// Strict decode: fails on chars outside the base64 alphabet, misplaced
+// padding or truncated input. Unpadded input is accepted.
+bool base64_decode(std::string const& s, std::string& output);
+
 static inline std::string base64_encode(const char *str, unsigned int len)
 {
 	return base64_encode((unsigned const char *)str, len);
@@ -727,6 +727,265 @@ struct JsonParser final {
         return fail("expected value, got " + esc(ch));
     }
 };
+
+/* JsonMinifier
+ *
+ * Validates a JSON document and appends it to an output string with
+ * insignificant whitespace and comments removed, without building a Json
+ * tree. Strings and numbers are copied from the input as they are.
+ */
+struct JsonMinifier final {
+
+    /* State
+     */
+    JsonParser parser;
+    string &out;
+
+    /* append_string()
+     *
+     * Validate a string starting after its opening quote and append it,
+     * escaping U+2028 and U+2029 the same way dump() does.
+     */
+    void append_string() {
+        const string &str = parser.str;
+        size_t &i = parser.i;
+        size_t start = i - 1;
+
+        while (true) {
+            if (i == str.size()) {
+                parser.fail("unexpected end of input in string");
+                return;
+            }
+
+            char ch = str[i++];
+
+            if (ch == '"')
+                break;
+
+            if (in_range(ch, 0, 0x1f)) {
+                parser.fail("unescaped " + esc(ch) + " in string");
+                return;
+            }
+
+            if (static_cast<uint8_t>(ch) == 0xe2 && i + 1 < str.size()
+                    && static_cast<uint8_t>(str[i]) == 0x80
+                    && (static_cast<uint8_t>(str[i + 1]) == 0xa8
+                        || static_cast<uint8_t>(str[i + 1]) == 0xa9)) {
+                out.append(str, start, i - 1 - start);
+                out += static_cast<uint8_t>(str[i + 1]) == 0xa8
+                    ? "\\u2028" : "\\u2029";
+                i += 2;
+                start = i;
+                continue;
+            }
+
+            if (ch != '\\')
+                continue;
+
+            if (i == str.size()) {
+                parser.fail("unexpected end of input in string");
+                return;
+            }
+
+            ch = str[i++];
+
+            if (ch == 'u') {
+                for (size_t j = 0; j < 4; j++, i++) {
+                    if (i == str.size() || (!in_range(str[i], 'a', 'f')
+                            && !in_range(str[i], 'A', 'F')
+                            && !in_range(str[i], '0', '9'))) {
+                        parser.fail("bad \\u escape");
+                        return;
+                    }
+                }
+            } else if (ch != 'b' && ch != 'f' && ch != 'n' && ch != 'r'
+                    && ch != 't' && ch != '"' && ch != '\\' && ch != '/') {
+                parser.fail("invalid escape character " + esc(ch));
+                return;
+            }
+        }
+
+        out.append(str, start, i - start);
+    }
+
+    /* append_number()
+     *
+     * Validate a number starting at the current position and append it.
+     */
+    void append_number() {
+        const string &str = parser.str;
+        size_t &i = parser.i;
+        size_t start_pos = i;
+
+        if (str[i] == '-')
+            i++;
+
+        // Integer part
+        if (str[i] == '0') {
+            i++;
+            if (in_range(str[i], '0', '9')) {
+                parser.fail("leading 0s not permitted in numbers");
+                return;
+            }
+        } else if (in_range(str[i], '1', '9')) {
+            i++;
+            while (in_range(str[i], '0', '9'))
+                i++;
+        } else {
+            parser.fail("invalid " + esc(str[i]) + " in number");
+            return;
+        }
+
+        // Decimal part
+        if (str[i] == '.') {
+            i++;
+            if (!in_range(str[i], '0', '9')) {
+                parser.fail("at least one digit required in fractional part");
+                return;
+            }
+
+            while (in_range(str[i], '0', '9'))
+                i++;
+        }
+
+        // Exponent part
+        if (str[i] == 'e' || str[i] == 'E') {
+            i++;
+
+            if (str[i] == '+' || str[i] == '-')
+                i++;
+
+            if (!in_range(str[i], '0', '9')) {
+                parser.fail("at least one digit required in exponent");
+                return;
+            }
+
+            while (in_range(str[i], '0', '9'))
+                i++;
+        }
+
+        out.append(str, start_pos, i - start_pos);
+    }
+
+    /* append_literal(expected)
+     *
+     * Expect that 'expected' starts at the character that was just read.
+     */
+    void append_literal(const char *expected) {
+        parser.expect(expected, Json());
+        if (!parser.failed)
+            out += expected;
+    }
+
+    /* append_json()
+     *
+     * Validate and append one JSON value.
+     */
+    void append_json(int depth) {
+        if (depth > max_depth) {
+            parser.fail("exceeded maximum nesting depth");
+            return;
+        }
+
+        char ch = parser.get_next_token();
+        if (parser.failed)
+            return;
+
+        if (ch == '-' || (ch >= '0' && ch <= '9')) {
+            parser.i--;
+            append_number();
+            return;
+        }
+
+        if (ch == 't')
+            return append_literal("true");
+
+        if (ch == 'f')
+            return append_literal("false");
+
+        if (ch == 'n')
+            return append_literal("null");
+
+        if (ch == '"')
+            return append_string();
+
+        if (ch == '{') {
+            out += '{';
+            ch = parser.get_next_token();
+            if (ch == '}') {
+                out += '}';
+                return;
+            }
+
+            while (1) {
+                if (ch != '"') {
+                    parser.fail("expected '\"' in object, got " + esc(ch));
+                    return;
+                }
+
+                append_string();
+                if (parser.failed)
+                    return;
+
+                ch = parser.get_next_token();
+                if (ch != ':') {
+                    parser.fail("expected ':' in object, got " + esc(ch));
+                    return;
+                }
+                out += ':';
+
+                append_json(depth + 1);
+                if (parser.failed)
+                    return;
+
+                ch = parser.get_next_token();
+                if (ch == '}')
+                    break;
+                if (ch != ',') {
+                    parser.fail("expected ',' in object, got " + esc(ch));
+                    return;
+                }
+                out += ',';
+
+                ch = parser.get_next_token();
+            }
+            out += '}';
+            return;
+        }
+
+        if (ch == '[') {
+            out += '[';
+            ch = parser.get_next_token();
+            if (ch == ']') {
+                out += ']';
+                return;
+            }
+
+            while (1) {
+                parser.i--;
+                append_json(depth + 1);
+                if (parser.failed)
+                    return;
+
+                ch = parser.get_next_token();
+                if (ch == ']')
+                    break;
+                if (ch != ',') {
+                    parser.fail("expected ',' in list, got " + esc(ch));
+                    return;
+                }
+                out += ',';
+
+                ch = parser.get_next_token();
+                (void)ch;
+            }
+            out += ']';
+            return;
+        }
+
+        parser.fail("expected value, got " + esc(ch));
+    }
+};
 }//namespace {
 
 Json Json::parse(const string &in, string &err, JsonParse strategy) {
@@ -743,6 +1002,25 @@ Json Json::parse(const string &in, string &err, JsonParse strategy) {
     return result;
 }
 
+bool Json::minify(const string &in, string &out, string &err, JsonParse strategy) {
+    size_t out_size = out.size();
+
+    JsonMinifier minifier { { in, 0, err, false, strategy }, out };
+    minifier.append_json(0);
+
+    // Check for any trailing garbage
+    minifier.parser.consume_garbage();
+    if (!minifier.parser.failed && minifier.parser.i != in.size())
+        minifier.parser.fail("unexpected trailing " + esc(in[minifier.parser.i]));
+
+    if (minifier.parser.failed) {
+        out.resize(out_size);
+        return false;
+    }
+
+    return true;
+}
+
 // Documented in json11.hpp
 vector<Json> Json::parse_multi(const string &in,
                                std::string::size_type &parser_stop_pos,
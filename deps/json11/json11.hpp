@@ -174,6 +174,15 @@ public:
             return nullptr;
         }
     }
+    // Validate in and append it to out with whitespace and comments removed, without
+    // building a Json tree. Object keys keep their order and strings and numbers are
+    // copied as written. If validation fails, return false, leave out unchanged and
+    // assign an error message to err.
+    static bool minify(const std::string & in,
+                       std::string & out,
+                       std::string & err,
+                       JsonParse strategy = JsonParse::STANDARD);
+
     // Parse multiple objects, concatenated or separated by whitespace
     static std::vector<Json> parse_multi(
         const std::string & in,
@@ -0,0 +1,135 @@
+/******************************************************************************
+ Copyright (C) 2014 by John R. Bradley <jrb@turrettech.com>
+ Copyright (C) 2018 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "obs-browser-cookie-flush.hpp"
+
+#include <util/base.h>
+#include <util/platform.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+struct cookie_flush_state {
+	std::mutex mutex;
+	std::condition_variable cv;
+	size_t pending = 0;
+	std::vector<uint64_t> end_times;
+	std::vector<bool> completed;
+
+	void finish(size_t index, bool success)
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+
+		end_times[index] = os_gettime_ns();
+		completed[index] = success;
+		--pending;
+
+		cv.notify_all();
+	}
+};
+
+class CookieFlushCallback : public CefCompletionCallback {
+public:
+	CookieFlushCallback(std::shared_ptr<cookie_flush_state> state,
+			    size_t index)
+		: m_state(state), m_index(index)
+	{
+	}
+
+	virtual void OnComplete() override { m_state->finish(m_index, true); }
+
+	IMPLEMENT_REFCOUNTING(CookieFlushCallback);
+
+private:
+	std::shared_ptr<cookie_flush_state> m_state;
+	size_t m_index;
+};
+
+cookie_flush_report
+flush_cookie_stores(const std::vector<CefRefPtr<CefCookieManager>> &cms,
+		    const char *reason, int timeout_ms)
+{
+	cookie_flush_report report;
+
+	if (cms.empty())
+		return report;
+
+	if (CefCurrentlyOn(TID_UI)) {
+		for (auto cm : cms)
+			cm->FlushStore(nullptr);
+
+		return report;
+	}
+
+	/* Shared-owned: callbacks may complete after the deadline */
+	auto state = std::make_shared<cookie_flush_state>();
+
+	state->pending = cms.size();
+	state->end_times.resize(cms.size(), 0);
+	state->completed.resize(cms.size(), false);
+
+	uint64_t start_time = os_gettime_ns();
+
+	for (size_t i = 0; i < cms.size(); ++i) {
+		if (!cms[i]->FlushStore(new CookieFlushCallback(state, i)))
+			state->finish(i, false);
+	}
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+
+	state->cv.wait_until(lock,
+			     std::chrono::steady_clock::now() +
+				     std::chrono::milliseconds(timeout_ms),
+			     [&]() { return state->pending == 0; });
+
+	for (size_t i = 0; i < cms.size(); ++i) {
+		if (!state->end_times[i]) {
+			++report.timed_out;
+
+			blog(LOG_WARNING,
+			     "obs-browser: %s: cookie store %d: flush did not complete within %d ms",
+			     reason, (int)i, timeout_ms);
+		} else if (!state->completed[i]) {
+			++report.failed;
+
+			blog(LOG_WARNING,
+			     "obs-browser: %s: cookie store %d: flush failed",
+			     reason, (int)i);
+		} else {
+			++report.completed;
+
+			blog(LOG_INFO,
+			     "obs-browser: %s: cookie store %d: flushed in %.1f ms",
+			     reason, (int)i,
+			     (double)(state->end_times[i] - start_time) /
+				     1000000.0);
+		}
+	}
+
+	report.elapsed_ms =
+		(double)(os_gettime_ns() - start_time) / 1000000.0;
+
+	blog(LOG_INFO,
+	     "obs-browser: %s: flushed %d of %d cookie stores in %.1f ms",
+	     reason, (int)report.completed, (int)cms.size(),
+	     report.elapsed_ms);
+
+	return report;
+}
@@ -0,0 +1,41 @@
+/******************************************************************************
+ Copyright (C) 2014 by John R. Bradley <jrb@turrettech.com>
+ Copyright (C) 2018 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#pragma once
+
+#include "cef-headers.hpp"
+
+#include <cstddef>
+#include <vector>
+
+struct cookie_flush_report {
+	size_t completed = 0;
+	size_t failed = 0;    /* did not start, or reported failure */
+	size_t timed_out = 0; /* still running at the deadline */
+	double elapsed_ms = 0.0;
+};
+
+/* Issues FlushStore() on every store at once and waits for all of them
+ * until a single deadline, timeout_ms from now. Each store's flush time and
+ * outcome is logged, prefixed with reason.
+ *
+ * Completion callbacks run on the CEF UI thread, so when called on it the
+ * flushes are only issued and the report is empty. */
+cookie_flush_report
+flush_cookie_stores(const std::vector<CefRefPtr<CefCookieManager>> &cms,
+		    const char *reason, int timeout_ms);
@@ -29,6 +29,7 @@
 #include <mutex>
 
 #include "obs-browser-source.hpp"
+#include "obs-browser-cookie-flush.hpp"
 #include "browser-scheme.hpp"
 #include "browser-app.hpp"
 #include "browser-version.h"
@@ -63,6 +64,9 @@ static thread manager_thread;
 static bool manager_initialized = false;
 os_event_t *cef_started_event = nullptr;
 
+static std::mutex cef_started_callbacks_mutex;
+static std::vector<std::function<void()>> cef_started_callbacks;
+
 static int adapterCount = 0;
 static std::wstring deviceId;
 
@@ -74,6 +78,7 @@ bool hwaccel = false;
 
 #include "streamelements/StreamElementsGlobalStateManager.hpp"
 #include "streamelements/StreamElementsUtils.hpp"
+#include "streamelements/StreamElementsTracer.hpp"
 
 static bool on_streamelements_url_modified(obs_properties_t *props,
 					   obs_property_t *,
@@ -176,10 +181,24 @@ public:
 		/* you have to put the tasks on the Qt event queue after this
 		 * call otherwise the CEF message pump may stop functioning
 		 * correctly, it's only supposed to take 10ms max */
+		MessageTask messageTask = task;
+
+		if (StreamElementsTracer::IsEnabled()) {
+			std::function<void()> inner = task;
+
+			messageTask = [inner]() {
+				SE_TRACE_SCOPE("cef", "QueueCEFTask");
+
+				inner();
+			};
+		}
+
 		QMetaObject::invokeMethod(&messageObject, "ExecuteTask",
 					  Qt::QueuedConnection,
-					  Q_ARG(MessageTask, task));
+					  Q_ARG(MessageTask, messageTask));
 #else
+		SE_TRACE_SCOPE("cef", "QueueCEFTask");
+
 		task();
 #endif
 	}
@@ -193,67 +212,49 @@ bool QueueCEFTask(std::function<void()> task)
 			   CefRefPtr<BrowserTask>(new BrowserTask(task)));
 }
 
+/* Runs callback on the thread which started CEF once it has started, or
+ * right away on the calling thread if it already has */
+void QueueCEFStartedCallback(std::function<void()> callback)
+{
+	{
+		std::lock_guard<std::mutex> lock(cef_started_callbacks_mutex);
+
+		if (os_event_try(cef_started_event) != 0) {
+			cef_started_callbacks.push_back(callback);
+			return;
+		}
+	}
+
+	callback();
+}
+
 /* ========================================================================= */
 
 static std::mutex cookie_managers_mutex;
 static std::vector<CefRefPtr<CefCookieManager>> cookie_managers;
 
+/* Shared deadline for all stores flushed together */
+#define COOKIE_FLUSH_TIMEOUT_MS 3000
+
 void flush_cookie_manager(CefRefPtr<CefCookieManager> cm)
 {
 	if (!cm)
 		return;
 
-	cm->FlushStore(nullptr);
-	return;
-
-	os_event_t *complete_event;
-
-	os_event_init(&complete_event, OS_EVENT_TYPE_AUTO);
-
-	class CompletionCallback : public CefCompletionCallback {
-	public:
-		CompletionCallback(os_event_t *complete_event)
-			: m_complete_event(complete_event)
-		{
-		}
-
-		virtual void OnComplete() override
-		{
-			os_event_signal(m_complete_event);
-		}
-
-		IMPLEMENT_REFCOUNTING(CompletionCallback);
-
-	private:
-		os_event_t *m_complete_event;
-	};
-
-	CefRefPtr<CefCompletionCallback> callback =
-		new CompletionCallback(complete_event);
-
-	auto task = [&]() {
-		if (!cm->FlushStore(callback)) {
-			blog(LOG_WARNING, "Failed flushing cookie store");
-
-			os_event_signal(complete_event);
-		} else {
-			blog(LOG_INFO, "Flushed cookie store");
-		}
-	};
-
-	CefPostTask(TID_IO, CefRefPtr<BrowserTask>(new BrowserTask(task)));
-
-	os_event_wait(complete_event);
-	os_event_destroy(complete_event);
+	flush_cookie_stores({cm}, "flush cookies", COOKIE_FLUSH_TIMEOUT_MS);
 }
 
 void flush_cookie_managers()
 {
-	std::lock_guard<std::mutex> guard(cookie_managers_mutex);
+	std::vector<CefRefPtr<CefCookieManager>> cms;
+
+	{
+		std::lock_guard<std::mutex> guard(cookie_managers_mutex);
 
-	for (auto cm : cookie_managers) {
-		flush_cookie_manager(cm);
+		cms = cookie_managers;
 	}
+
+	flush_cookie_stores(cms, "flush all cookies", COOKIE_FLUSH_TIMEOUT_MS);
 }
 
 void register_cookie_manager(CefRefPtr<CefCookieManager> cm)
@@ -271,17 +272,20 @@ void unregister_cookie_manager(CefRefPtr<CefCookieManager> cm)
 	if (!cm)
 		return;
 
-	std::lock_guard<std::mutex> guard(cookie_managers_mutex);
-
-	flush_cookie_manager(cm);
+	{
+		std::lock_guard<std::mutex> guard(cookie_managers_mutex);
 
-	for (auto it = cookie_managers.begin(); it != cookie_managers.end();
-	     ++it) {
-		if (it->get() == cm) {
-			cookie_managers.erase(it);
-			return;
+		for (auto it = cookie_managers.begin();
+		     it != cookie_managers.end(); ++it) {
+			if (it->get() == cm) {
+				cookie_managers.erase(it);
+				break;
+			}
 		}
 	}
+
+	flush_cookie_stores({cm}, "unregister cookies",
+			    COOKIE_FLUSH_TIMEOUT_MS);
 }
 
 /* ========================================================================= */
@@ -504,7 +508,16 @@ static void BrowserInit(void)
 
 	os_event_signal(s_BrowserManagerThreadInitializedEvent);
 
-	os_event_signal(cef_started_event);
+	std::vector<std::function<void()>> callbacks;
+	{
+		std::lock_guard<std::mutex> lock(cef_started_callbacks_mutex);
+
+		os_event_signal(cef_started_event);
+		callbacks.swap(cef_started_callbacks);
+	}
+
+	for (auto &callback : callbacks)
+		callback();
 }
 
 #ifdef USE_QT_LOOP
@@ -516,6 +529,7 @@ static void BrowserShutdown(void)
 #ifdef USE_QT_LOOP
 	while (messageObject.ExecuteNextBrowserTask())
 		;
+	messageObject.StopPump();
 	CefDoMessageLoopWork();
 #endif
 	CefShutdown();
@@ -0,0 +1,30 @@
+/******************************************************************************
+ Copyright (C) 2019 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#pragma once
+
+#include <obs.h>
+#include <cstdint>
+#include <vector>
+
+/* Mixes the audio of a browser source's streams into audio_output, aligned
+ * to the earliest stream timestamp, which is returned in ts_out. Streams
+ * with pending audio are skipped. Returns false when no stream has audio.
+ * Not thread safe: callers serialize access to audio_sources. */
+bool MixAudioStreams(const std::vector<obs_source_t *> &audio_sources,
+		     uint64_t *ts_out, struct audio_output_data *audio_output,
+		     size_t channels, size_t sample_rate);
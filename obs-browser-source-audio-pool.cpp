@@ -0,0 +1,51 @@
+/******************************************************************************
+ Copyright (C) 2019 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "obs-browser-source-audio-pool.hpp"
+
+OBSSource AudioSourcePool::Acquire()
+{
+	OBSSource audio_source;
+
+	if (!pool.empty()) {
+		audio_source = pool.back();
+		pool.pop_back();
+
+		reused++;
+	} else {
+		audio_source =
+			obs_source_create_private("audio_line", nullptr, nullptr);
+		obs_source_release(audio_source);
+
+		obs_source_add_active_child(parent, audio_source);
+
+		created++;
+	}
+
+	return audio_source;
+}
+
+void AudioSourcePool::Release(obs_source_t *audio_source)
+{
+	if (!audio_source)
+		return;
+
+	if (pool.size() < MAX_POOLED_AUDIO_SOURCES)
+		pool.push_back(audio_source);
+	else
+		obs_source_remove_active_child(parent, audio_source);
+}
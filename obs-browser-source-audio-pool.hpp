@@ -0,0 +1,45 @@
+/******************************************************************************
+ Copyright (C) 2019 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#pragma once
+
+#include <obs.hpp>
+#include <cstdint>
+#include <vector>
+
+#define MAX_POOLED_AUDIO_SOURCES 4
+
+/* audio_line sources backing a browser source's audio streams. Sources of
+ * stopped streams stay active children of the parent and are handed out
+ * again, so a page that keeps starting and stopping streams does not
+ * create a new source each time. Not thread safe: callers serialize. */
+class AudioSourcePool {
+public:
+	inline AudioSourcePool(obs_source_t *parent_) : parent(parent_) {}
+
+	OBSSource Acquire();
+	void Release(obs_source_t *audio_source);
+
+	inline uint64_t Created() const { return created; }
+	inline uint64_t Reused() const { return reused; }
+
+private:
+	obs_source_t *parent;
+	std::vector<OBSSource> pool;
+	uint64_t created = 0;
+	uint64_t reused = 0;
+};
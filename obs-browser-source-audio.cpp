@@ -16,73 +16,49 @@
  ******************************************************************************/
 
 #include "obs-browser-source.hpp"
+#include "obs-browser-source-audio-mix.hpp"
 
-void BrowserSource::EnumAudioStreams(obs_source_enum_proc_t cb, void *param)
+OBSSource BrowserSource::AcquireAudioSource()
 {
 	std::lock_guard<std::mutex> lock(audio_sources_mutex);
-	for (obs_source_t *audio_source : audio_sources) {
-		cb(source, audio_source, param);
-	}
-}
 
-static inline void mix_audio(float *__restrict p_out,
-			     const float *__restrict p_in, size_t pos,
-			     size_t count)
-{
-	float *__restrict out = p_out;
-	const float *__restrict in = p_in + pos;
-	const float *__restrict end = in + count;
+	OBSSource audio_source = audio_source_pool.Acquire();
+	audio_sources.push_back(audio_source);
 
-	while (in < end)
-		*out++ += *in++;
+	return audio_source;
 }
 
-bool BrowserSource::AudioMix(uint64_t *ts_out,
-			     struct audio_output_data *audio_output,
-			     size_t channels, size_t sample_rate)
+void BrowserSource::ReleaseAudioSource(obs_source_t *audio_source)
 {
-	uint64_t timestamp = 0;
-	struct obs_source_audio_mix child_audio;
+	if (!audio_source)
+		return;
 
 	std::lock_guard<std::mutex> lock(audio_sources_mutex);
-	for (obs_source_t *s : audio_sources) {
-		if (!obs_source_audio_pending(s)) {
-			uint64_t source_ts = obs_source_get_audio_timestamp(s);
 
-			if (source_ts && (!timestamp || source_ts < timestamp))
-				timestamp = source_ts;
+	for (size_t i = 0; i < audio_sources.size(); i++) {
+		if (audio_sources[i] == audio_source) {
+			audio_sources.erase(audio_sources.begin() + i);
+			break;
 		}
 	}
 
-	if (!timestamp)
-		return false;
-
-	for (obs_source_t *s : audio_sources) {
-		uint64_t source_ts;
-		size_t pos, count;
-
-		if (obs_source_audio_pending(s)) {
-			continue;
-		}
-
-		source_ts = obs_source_get_audio_timestamp(s);
-		if (!source_ts) {
-			continue;
-		}
-
-		pos = (size_t)ns_to_audio_frames(sample_rate,
-						 source_ts - timestamp);
-		count = AUDIO_OUTPUT_FRAMES - pos;
-
-		obs_source_get_audio_mix(s, &child_audio);
-		for (size_t ch = 0; ch < channels; ch++) {
-			float *out = audio_output->data[ch];
-			float *in = child_audio.output[0].data[ch];
+	audio_source_pool.Release(audio_source);
+}
 
-			mix_audio(out, in, pos, count);
-		}
+void BrowserSource::EnumAudioStreams(obs_source_enum_proc_t cb, void *param)
+{
+	std::lock_guard<std::mutex> lock(audio_sources_mutex);
+	for (obs_source_t *audio_source : audio_sources) {
+		cb(source, audio_source, param);
 	}
+}
+
+bool BrowserSource::AudioMix(uint64_t *ts_out,
+			     struct audio_output_data *audio_output,
+			     size_t channels, size_t sample_rate)
+{
+	std::lock_guard<std::mutex> lock(audio_sources_mutex);
 
-	*ts_out = timestamp;
-	return true;
+	return MixAudioStreams(audio_sources, ts_out, audio_output, channels,
+			       sample_rate);
 }
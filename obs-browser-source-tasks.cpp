@@ -0,0 +1,103 @@
+/******************************************************************************
+ Copyright (C) 2014 by John R. Bradley <jrb@turrettech.com>
+ Copyright (C) 2018 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#include "obs-browser-source-tasks.hpp"
+
+#include <util/base.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+void BrowserWaitStats::Record(uint64_t wait_ns)
+{
+	waits++;
+	total_ns += wait_ns;
+
+	uint64_t max_time = max_ns;
+	while (wait_ns > max_time &&
+	       !max_ns.compare_exchange_weak(max_time, wait_ns))
+		;
+}
+
+void BrowserWaitStats::Log() const
+{
+	uint64_t count = waits;
+	if (!count)
+		return;
+
+	blog(LOG_DEBUG,
+	     "obs-browser: %llu blocking browser waits, "
+	     "avg %.3f ms, max %.3f ms",
+	     (unsigned long long)count, double(total_ns) / double(count) / 1e6,
+	     double(max_ns) / 1e6);
+}
+
+bool RunBrowserTaskAndWait(const CefTaskQueueFunc &queue,
+			   std::function<void()> task, BrowserWaitStats &stats)
+{
+	os_event_t *finishedEvent;
+	os_event_init(&finishedEvent, OS_EVENT_TYPE_AUTO);
+
+	bool success = queue([&]() {
+		task();
+		os_event_signal(finishedEvent);
+	});
+
+	if (success) {
+		uint64_t start_time = os_gettime_ns();
+
+		os_event_wait(finishedEvent);
+
+		stats.Record(os_gettime_ns() - start_time);
+	}
+
+	os_event_destroy(finishedEvent);
+
+	return success;
+}
+
+void SendBrowserVisibility(CefRefPtr<CefBrowser> browser, bool isVisible)
+{
+	if (!browser)
+		return;
+
+#if ENABLE_WASHIDDEN
+	if (isVisible) {
+		browser->GetHost()->WasHidden(false);
+		browser->GetHost()->Invalidate(PET_VIEW);
+	} else {
+		browser->GetHost()->WasHidden(true);
+	}
+#endif
+
+	CefRefPtr<CefProcessMessage> msg =
+		CefProcessMessage::Create("Visibility");
+	CefRefPtr<CefListValue> args = msg->GetArgumentList();
+	args->SetBool(0, isVisible);
+	SendBrowserProcessMessage(browser, PID_RENDERER, msg);
+}
+
+void SendBrowserActive(CefRefPtr<CefBrowser> browser, bool isActive)
+{
+	if (!browser)
+		return;
+
+	CefRefPtr<CefProcessMessage> msg = CefProcessMessage::Create("Active");
+	CefRefPtr<CefListValue> args = msg->GetArgumentList();
+	args->SetBool(0, isActive);
+	SendBrowserProcessMessage(browser, PID_RENDERER, msg);
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+ Copyright (C) 2014 by John R. Bradley <jrb@turrettech.com>
+ Copyright (C) 2018 by Hugh Bailey ("Jim") <jim@obsproject.com>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ ******************************************************************************/
+
+#pragma once
+
+#include "cef-headers.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+/* Durations of callers blocked until a browser task ran */
+class BrowserWaitStats {
+public:
+	void Record(uint64_t wait_ns);
+
+	uint64_t Waits() const { return waits; }
+	uint64_t TotalNs() const { return total_ns; }
+	uint64_t MaxNs() const { return max_ns; }
+
+	/* Logs count, average and maximum at debug level, if any */
+	void Log() const;
+
+private:
+	std::atomic<uint64_t> waits{0};
+	std::atomic<uint64_t> total_ns{0};
+	std::atomic<uint64_t> max_ns{0};
+};
+
+/* Queues task to the CEF UI thread, returns false if it was not queued */
+typedef std::function<bool(std::function<void()>)> CefTaskQueueFunc;
+
+/* Runs task through queue and blocks until it ran, recording the wait in
+ * stats. Returns false if the task could not be queued. */
+bool RunBrowserTaskAndWait(const CefTaskQueueFunc &queue,
+			   std::function<void()> task, BrowserWaitStats &stats);
+
+/* Source state messages to the renderer, sent on the CEF UI thread */
+void SendBrowserVisibility(CefRefPtr<CefBrowser> browser, bool isVisible);
+void SendBrowserActive(CefRefPtr<CefBrowser> browser, bool isActive);
@@ -21,12 +21,16 @@
 #include "browser-scheme.hpp"
 #include "wide-string.hpp"
 #include "json11/json11.hpp"
+#include "streamelements/StreamElementsTracer.hpp"
+#include "streamelements/StreamElementsSnapshotList.hpp"
 #include <util/threading.h>
 #include <QApplication>
 #include <util/dstr.h>
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <memory>
+#include <algorithm>
 
 #ifdef __linux__
 #include "linux-keyboard-helpers.hpp"
@@ -42,35 +46,50 @@ using namespace json11;
 
 extern bool QueueCEFTask(std::function<void()> task);
 
-static mutex browser_list_mutex;
-static BrowserSource *first_browser = nullptr;
+struct BrowserListEntry {
+	BrowserSource *bs;
+	CefRefPtr<CefBrowser> browser;
+};
 
-static void SendBrowserVisibility(CefRefPtr<CefBrowser> browser, bool isVisible)
+typedef StreamElementsSnapshotList<BrowserListEntry>::list_t BrowserList;
+typedef StreamElementsSnapshotList<BrowserListEntry>::snapshot_t
+	BrowserListSnapshot;
+
+/* Live browsers: broadcasts walk a snapshot without holding the lock */
+static StreamElementsSnapshotList<BrowserListEntry>
+	browser_list("browser list");
+
+/* Lists browser for bs, or unlists bs when browser is null */
+static void SetListedBrowser(BrowserSource *bs, CefRefPtr<CefBrowser> browser)
 {
-	if (!browser)
-		return;
+	browser_list.Update([bs, browser](BrowserList &list) {
+		list.erase(remove_if(list.begin(), list.end(),
+				     [bs](const BrowserListEntry &entry) {
+					     return entry.bs == bs;
+				     }),
+			   list.end());
+
+		if (!!browser)
+			list.push_back({bs, browser});
+	});
+}
 
-#if ENABLE_WASHIDDEN
-	if (isVisible) {
-		browser->GetHost()->WasHidden(false);
-		browser->GetHost()->Invalidate(PET_VIEW);
-	} else {
-		browser->GetHost()->WasHidden(true);
-	}
+static void QueueBrowserFunc(CefRefPtr<CefBrowser> browser, BrowserFunc func)
+{
+#ifdef USE_QT_LOOP
+	QueueBrowserTask(browser, func);
+#else
+	QueueCEFTask([=]() { func(browser); });
 #endif
-
-	CefRefPtr<CefProcessMessage> msg =
-		CefProcessMessage::Create("Visibility");
-	CefRefPtr<CefListValue> args = msg->GetArgumentList();
-	args->SetBool(0, isVisible);
-	SendBrowserProcessMessage(browser, PID_RENDERER, msg);
 }
 
 void DispatchJSEvent(std::string eventName, std::string jsonString,
 		     BrowserSource *browser = nullptr);
 
+BrowserWaitStats BrowserSource::blocking_waits;
+
 BrowserSource::BrowserSource(obs_data_t *settings, obs_source_t *source_)
-	: source(source_)
+	: source(source_), audio_source_pool(source_)
 {
 	{
 		auto handler = obs_source_get_signal_handler(source_);
@@ -86,29 +105,42 @@ BrowserSource::BrowserSource(obs_data_t *settings, obs_source_t *source_)
 
 	/* defer update */
 	obs_source_update(source, nullptr);
-
-	lock_guard<mutex> lock(browser_list_mutex);
-	p_prev_next = &first_browser;
-	next = first_browser;
-	if (first_browser)
-		first_browser->p_prev_next = &next;
-	first_browser = this;
 }
 
 BrowserSource::~BrowserSource()
 {
-	lock_guard<mutex> lock(browser_list_mutex);
-	if (next)
-		next->p_prev_next = p_prev_next;
-	*p_prev_next = next;
+	SetListedBrowser(this, nullptr);
 
 	DestroyBrowser();
 	DestroyTextures();
+
+	if (audio_source_pool.Created())
+		blog(LOG_DEBUG,
+		     "obs-browser: audio streams: %llu audio sources created, "
+		     "%llu reused",
+		     (unsigned long long)audio_source_pool.Created(),
+		     (unsigned long long)audio_source_pool.Reused());
+
+	blocking_waits.Log();
+
+	browser_list.LogLockStats();
 }
 
 void BrowserSource::ExecuteOnBrowser(BrowserFunc func, bool async)
 {
+	if (StreamElementsTracer::IsEnabled()) {
+		BrowserFunc inner = func;
+
+		func = [inner](CefRefPtr<CefBrowser> browser) {
+			SE_TRACE_SCOPE("cef", "ExecuteOnBrowser");
+
+			inner(browser);
+		};
+	}
+
 	if (!async) {
+		SE_TRACE_SCOPE("cef", "ExecuteOnBrowser wait");
+
 #ifdef USE_QT_LOOP
 		if (QThread::currentThread() == qApp->thread()) {
 			if (!!cefBrowser)
@@ -116,26 +148,17 @@ void BrowserSource::ExecuteOnBrowser(BrowserFunc func, bool async)
 			return;
 		}
 #endif
-		os_event_t *finishedEvent;
-		os_event_init(&finishedEvent, OS_EVENT_TYPE_AUTO);
-		bool success = QueueCEFTask([&]() {
-			if (!!cefBrowser)
-				func(cefBrowser);
-			os_event_signal(finishedEvent);
-		});
-		if (success) {
-			os_event_wait(finishedEvent);
-		}
-		os_event_destroy(finishedEvent);
+		RunBrowserTaskAndWait(
+			QueueCEFTask,
+			[&]() {
+				if (!!cefBrowser)
+					func(cefBrowser);
+			},
+			blocking_waits);
 	} else {
 		CefRefPtr<CefBrowser> browser = cefBrowser;
-		if (!!browser) {
-#ifdef USE_QT_LOOP
-			QueueBrowserTask(browser, func);
-#else
-			QueueCEFTask([=]() { func(browser); });
-#endif
-		}
+		if (!!browser)
+			QueueBrowserFunc(browser, func);
 	}
 }
 
@@ -202,6 +225,7 @@ bool BrowserSource::CreateBrowser()
 		if (reroute_audio)
 			cefBrowser->GetHost()->SetAudioMuted(true);
 #endif
+		SetListedBrowser(this, cefBrowser);
 
 		SendBrowserVisibility(cefBrowser, is_showing);
 	});
@@ -212,6 +236,8 @@ void BrowserSource::DestroyBrowser(bool async)
 	if (!cefBrowser)
 		return;
 
+	SetListedBrowser(this, nullptr);
+
 	CefRefPtr<CefClient> client = cefBrowser->GetHost()->GetClient();
 	BrowserClient *bc = reinterpret_cast<BrowserClient *>(client.get());
 	if (bc) {
@@ -232,6 +258,8 @@ void BrowserSource::DestroyBrowser(bool async)
 void BrowserSource::ClearAudioStreams()
 {
 	QueueCEFTask([this]() {
+		for (auto &stream : audio_streams)
+			ReleaseAudioSource(stream.second.source);
 		audio_streams.clear();
 		std::lock_guard<std::mutex> lock(audio_sources_mutex);
 		audio_sources.clear();
@@ -363,15 +391,11 @@ void BrowserSource::SetShowing(bool showing)
 			DestroyBrowser(true);
 		}
 	} else {
+		/* Visibility message and WasHidden() are ordered with
+		 * every other task for this browser */
 		ExecuteOnBrowser(
 			[=](CefRefPtr<CefBrowser> cefBrowser) {
-				CefRefPtr<CefProcessMessage> msg =
-					CefProcessMessage::Create("Visibility");
-				CefRefPtr<CefListValue> args =
-					msg->GetArgumentList();
-				args->SetBool(0, showing);
-				SendBrowserProcessMessage(cefBrowser,
-							  PID_RENDERER, msg);
+				SendBrowserVisibility(cefBrowser, showing);
 			},
 			true);
 		Json json = Json::object{{"visible", showing}};
@@ -381,8 +405,6 @@ void BrowserSource::SetShowing(bool showing)
 			reset_frame = false;
 		}
 #endif
-
-		SendBrowserVisibility(cefBrowser, showing);
 	}
 }
 
@@ -390,12 +412,7 @@ void BrowserSource::SetActive(bool active)
 {
 	ExecuteOnBrowser(
 		[=](CefRefPtr<CefBrowser> cefBrowser) {
-			CefRefPtr<CefProcessMessage> msg =
-				CefProcessMessage::Create("Active");
-			CefRefPtr<CefListValue> args = msg->GetArgumentList();
-			args->SetBool(0, active);
-			SendBrowserProcessMessage(cefBrowser, PID_RENDERER,
-						  msg);
+			SendBrowserActive(cefBrowser, active);
 		},
 		true);
 	Json json = Json::object{{"active", active}};
@@ -574,25 +591,26 @@ void BrowserSource::Render()
 
 static void ExecuteOnBrowser(BrowserFunc func, BrowserSource *bs)
 {
-	lock_guard<mutex> lock(browser_list_mutex);
-
-	if (bs) {
-		BrowserSource *bsw = reinterpret_cast<BrowserSource *>(bs);
-		bsw->ExecuteOnBrowser(func, true);
-	}
+	if (bs)
+		bs->ExecuteOnBrowser(func, true);
 }
 
 static void ExecuteOnAllBrowsers(BrowserFunc func)
 {
-	lock_guard<mutex> lock(browser_list_mutex);
+	if (StreamElementsTracer::IsEnabled()) {
+		BrowserFunc inner = func;
 
-	BrowserSource *bs = first_browser;
-	while (bs) {
-		BrowserSource *bsw = reinterpret_cast<BrowserSource *>(bs);
-		bsw->ExecuteOnBrowser(func, true);
+		func = [inner](CefRefPtr<CefBrowser> browser) {
+			SE_TRACE_SCOPE("cef", "ExecuteOnBrowser");
 
-		bs = bs->next;
+			inner(browser);
+		};
 	}
+
+	BrowserListSnapshot list = browser_list.Snapshot();
+
+	for (const BrowserListEntry &entry : *list)
+		QueueBrowserFunc(entry.browser, func);
 }
 
 void ReloadAllBrowserSources()
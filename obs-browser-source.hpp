@@ -24,12 +24,15 @@
 #include "cef-headers.hpp"
 #include "browser-config.h"
 #include "browser-app.hpp"
+#include "obs-browser-source-audio-pool.hpp"
+#include "obs-browser-source-tasks.hpp"
 
 #include <unordered_map>
 #include <functional>
 #include <vector>
 #include <string>
 #include <mutex>
+#include <atomic>
 
 #if EXPERIMENTAL_SHARED_TEXTURE_SUPPORT_ENABLED
 extern bool hwaccel;
@@ -43,9 +46,6 @@ struct AudioStream {
 };
 
 struct BrowserSource {
-	BrowserSource **p_prev_next = nullptr;
-	BrowserSource *next = nullptr;
-
 	obs_source_t *source = nullptr;
 
 	bool tex_sharing_avail = false;
@@ -84,7 +84,11 @@ struct BrowserSource {
 	bool CreateBrowser();
 	void DestroyBrowser(bool async = false);
 	void ClearAudioStreams();
-	void ExecuteOnBrowser(BrowserFunc func, bool async = false);
+	OBSSource AcquireAudioSource();
+	void ReleaseAudioSource(obs_source_t *audio_source);
+	/* Tasks run in order on the CEF UI thread. Only async == false
+	 * blocks the caller, and that wait is recorded below. */
+	void ExecuteOnBrowser(BrowserFunc func, bool async = true);
 
 	/* ---------------------------- */
 
@@ -116,5 +120,11 @@ struct BrowserSource {
 	std::mutex audio_sources_mutex;
 	std::vector<obs_source_t *> audio_sources;
 
+	/* Guarded by audio_sources_mutex */
+	AudioSourcePool audio_source_pool;
+
+	/* Blocking ExecuteOnBrowser() waits across all browser sources */
+	static BrowserWaitStats blocking_waits;
+
 	std::unordered_map<int, AudioStream> audio_streams;
 };
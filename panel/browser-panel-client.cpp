@@ -5,6 +5,7 @@
 #include <QDesktopServices>
 
 #include <obs-module.h>
+#include <util/platform.h>
 #ifdef _WIN32
 #include <windows.h>
 #endif
@@ -189,7 +190,20 @@ bool QCefBrowserClient::OnBeforePopup(
 void QCefBrowserClient::OnLoadEnd(CefRefPtr<CefBrowser>,
 				  CefRefPtr<CefFrame> frame, int)
 {
-	if (frame->IsMain() && !script.empty())
+	if (!frame->IsMain())
+		return;
+
+	if (!firstLoadEnded) {
+		firstLoadEnded = true;
+
+		blog(LOG_DEBUG,
+		     "obs-browser: panel '%s' first load ended %.1f ms "
+		     "after creation",
+		     frame->GetURL().ToString().c_str(),
+		     (double)(os_gettime_ns() - createTime) / 1000000.0);
+	}
+
+	if (!script.empty())
 		frame->ExecuteJavaScript(script, CefString(), 0);
 }
 
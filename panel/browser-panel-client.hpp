@@ -15,10 +15,11 @@ class QCefBrowserClient : public CefClient,
 public:
 	inline QCefBrowserClient(QCefWidgetInternal *widget_,
 				 const std::string &script_,
-				 bool allowAllPopups_)
+				 bool allowAllPopups_, uint64_t createTime_)
 		: widget(widget_),
 		  script(script_),
-		  allowAllPopups(allowAllPopups_)
+		  allowAllPopups(allowAllPopups_),
+		  createTime(createTime_)
 	{
 	}
 
@@ -80,5 +81,9 @@ public:
 	std::string script;
 	bool allowAllPopups;
 
+	/* Widget creation time, for logging time to first load */
+	uint64_t createTime;
+	bool firstLoadEnded = false;
+
 	IMPLEMENT_REFCOUNTING(QCefBrowserClient);
 };
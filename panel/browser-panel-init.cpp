@@ -0,0 +1,61 @@
+#include "browser-panel-init.hpp"
+
+#include <util/base.h>
+
+BrowserPanelInit::BrowserPanelInit(const std::string &name_,
+				   Callbacks callbacks)
+	: name(name_), cb(callbacks), createTime(cb.now())
+{
+}
+
+void BrowserPanelInit::Init()
+{
+	if (queued || !cb.isVisible())
+		return;
+
+	if (!cb.cefStarted()) {
+		/* Retried on the main thread once CEF has started */
+		if (!waitingForCef) {
+			waitingForCef = true;
+
+			cb.whenCefStarted([this]() {
+				waitingForCef = false;
+				Init();
+			});
+		}
+		return;
+	}
+
+	/* May create the native window, which sends WinIdChange and
+	 * re-enters Init() */
+	cb.createNativeWindow();
+
+	if (queued)
+		return;
+
+	if (!cb.queueCreate()) {
+		blog(LOG_WARNING,
+		     "obs-browser: failed to queue panel browser creation%s",
+		     retryPending ? "" : ", retrying");
+
+		/* Retried once from the main thread: show and resize
+		 * events may never come again for a docked panel */
+		if (!retryPending) {
+			retryPending = true;
+
+			cb.post([this]() {
+				Init();
+				retryPending = false;
+			});
+		}
+		return;
+	}
+
+	queued = true;
+	queueLatency = cb.now() - createTime;
+
+	blog(LOG_DEBUG,
+	     "obs-browser: panel '%s' browser creation queued %.1f ms "
+	     "after creation",
+	     name.c_str(), (double)queueLatency / 1000000.0);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/* Decides when a browser panel queues creation of its browser.
+ *
+ * Init() is called from the widget's show, resize and native window
+ * creation events. It queues creation once the widget is visible and CEF
+ * has started, and otherwise waits for one of those events or for CEF to
+ * start; nothing polls. Widget and CEF access is supplied by the owner, so
+ * this depends on neither Qt nor CEF.
+ */
+class BrowserPanelInit {
+public:
+	struct Callbacks {
+		std::function<bool()> isVisible;
+		/* Starts CEF if needed; returns true once it has started */
+		std::function<bool()> cefStarted;
+		/* Runs task on the main thread once CEF has started, unless
+		 * the widget is gone by then */
+		std::function<void(std::function<void()>)> whenCefStarted;
+		/* Creates the native window; may re-enter Init() */
+		std::function<void()> createNativeWindow;
+		/* Queues creation of the browser; returns false on failure */
+		std::function<bool()> queueCreate;
+		/* Runs task on the main thread later, unless the widget is
+		 * gone by then */
+		std::function<void(std::function<void()>)> post;
+		std::function<uint64_t()> now;
+	};
+
+	BrowserPanelInit(const std::string &name, Callbacks callbacks);
+
+	void Init();
+
+	/* The browser was closed: the next Init() creates it again */
+	void Reset() { queued = false; }
+
+	bool IsQueued() const { return queued; }
+	uint64_t GetCreateTime() const { return createTime; }
+
+	/* Time from creation of the widget until creation of the browser
+	 * was queued, 0 until it is */
+	uint64_t GetQueueLatency() const { return queueLatency; }
+
+private:
+	std::string name;
+	Callbacks cb;
+
+	uint64_t createTime;
+	uint64_t queueLatency = 0;
+	bool queued = false;
+	bool waitingForCef = false;
+	bool retryPending = false;
+};
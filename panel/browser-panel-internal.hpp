@@ -1,8 +1,8 @@
 #pragma once
 
-#include <QTimer>
 #include <QPointer>
 #include "browser-panel.hpp"
+#include "browser-panel-init.hpp"
 #include "cef-headers.hpp"
 
 #include <vector>
@@ -54,9 +54,13 @@ public:
 	std::string url;
 	std::string script;
 	CefRefPtr<CefRequestContext> rqc;
-	QTimer timer;
 	bool allowAllPopups_ = false;
 
+	/* Init() runs on show, resize and native window creation until the
+	 * browser is queued for creation */
+	BrowserPanelInit panelInit;
+
+	virtual bool event(QEvent *event) override;
 	virtual void resizeEvent(QResizeEvent *event) override;
 	virtual void showEvent(QShowEvent *event) override;
 	virtual QPaintEngine *paintEngine() const override;
@@ -68,6 +72,10 @@ public:
 
 	void Resize();
 
+private:
+	BrowserPanelInit::Callbacks InitCallbacks();
+	bool QueueCreateBrowser();
+
 public slots:
 	void Init();
 };
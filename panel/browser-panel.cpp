@@ -19,6 +19,7 @@
 #include "streamelements/StreamElementsUtils.hpp"
 
 extern bool QueueCEFTask(std::function<void()> task);
+extern void QueueCEFStartedCallback(std::function<void()> callback);
 extern "C" void obs_browser_initialize(void);
 extern os_event_t *cef_started_event;
 
@@ -180,7 +181,10 @@ struct QCefCookieManagerInternal : QCefCookieManager {
 
 QCefWidgetInternal::QCefWidgetInternal(QWidget *parent, const std::string &url_,
 				       CefRefPtr<CefRequestContext> rqc_)
-	: QCefWidget(parent), url(url_), rqc(rqc_)
+	: QCefWidget(parent),
+	  url(url_),
+	  rqc(rqc_),
+	  panelInit(url_, InitCallbacks())
 {
 	setAttribute(Qt::WA_PaintOnScreen);
 	setAttribute(Qt::WA_StaticContents);
@@ -241,9 +245,50 @@ void QCefWidgetInternal::closeBrowser()
 		destroyBrowser(browser);
 		cefBrowser = nullptr;
 	}
+
+	panelInit.Reset();
 }
 
-void QCefWidgetInternal::Init()
+BrowserPanelInit::Callbacks QCefWidgetInternal::InitCallbacks()
+{
+	QPointer<QCefWidgetInternal> widget = this;
+
+	BrowserPanelInit::Callbacks callbacks;
+
+	callbacks.isVisible = [this]() { return isVisible(); };
+
+	callbacks.cefStarted = []() {
+		obs_browser_initialize();
+
+		return os_event_try(cef_started_event) == 0;
+	};
+
+	callbacks.whenCefStarted = [widget](std::function<void()> task) {
+		QueueCEFStartedCallback([widget, task]() {
+			QtPostTask([widget, task]() {
+				if (widget)
+					task();
+			});
+		});
+	};
+
+	callbacks.createNativeWindow = [this]() { winId(); };
+
+	callbacks.queueCreate = [this]() { return QueueCreateBrowser(); };
+
+	callbacks.post = [widget](std::function<void()> task) {
+		QtPostTask([widget, task]() {
+			if (widget)
+				task();
+		});
+	};
+
+	callbacks.now = []() { return os_gettime_ns(); };
+
+	return callbacks;
+}
+
+bool QCefWidgetInternal::QueueCreateBrowser()
 {
 	WId id = winId();
 
@@ -265,7 +310,8 @@ void QCefWidgetInternal::Init()
 #endif
 
 		CefRefPtr<QCefBrowserClient> browserClient =
-			new QCefBrowserClient(this, script, allowAllPopups_);
+			new QCefBrowserClient(this, script, allowAllPopups_,
+					      panelInit.GetCreateTime());
 
 		CefBrowserSettings cefBrowserSettings;
 		cefBrowser = CefBrowserHost::CreateBrowserSync(
@@ -279,13 +325,31 @@ void QCefWidgetInternal::Init()
 #endif
 	});
 
-	if (success)
-		timer.stop();
+	return success;
+}
+
+void QCefWidgetInternal::Init()
+{
+	panelInit.Init();
+}
+
+bool QCefWidgetInternal::event(QEvent *event)
+{
+	bool result = QCefWidget::event(event);
+
+	if (event->type() == QEvent::WinIdChange)
+		Init();
+
+	return result;
 }
 
 void QCefWidgetInternal::resizeEvent(QResizeEvent *event)
 {
 	QWidget::resizeEvent(event);
+
+	if (!panelInit.IsQueued())
+		Init();
+
 	Resize();
 }
 
@@ -310,12 +374,8 @@ void QCefWidgetInternal::showEvent(QShowEvent *event)
 {
 	QWidget::showEvent(event);
 
-	if (!cefBrowser) {
-		obs_browser_initialize();
-		connect(&timer, SIGNAL(timeout()), this, SLOT(Init()));
-		timer.start(500);
+	if (!cefBrowser)
 		Init();
-	}
 }
 
 QPaintEngine *QCefWidgetInternal::paintEngine() const
@@ -6,8 +6,32 @@
 #include <util/platform.h>
 #include <string>
 #include <codecvt>
+#include <chrono>
+#include <ctime>
+#include <map>
+#include <algorithm>
 
-StreamElementsAnalyticsEventsManager::StreamElementsAnalyticsEventsManager(size_t numWorkers)
+static const char *HEAP_TRACK_URL = "https://heapanalytics.com/api/track";
+
+static std::string GetUtcTimestampString()
+{
+	auto now = std::chrono::system_clock::now();
+	time_t time = std::chrono::system_clock::to_time_t(now);
+	int ms = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(
+			       now.time_since_epoch())
+			       .count() %
+		       1000);
+
+	char buf[32];
+	std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", std::gmtime(&time));
+
+	char result[48];
+	snprintf(result, sizeof(result), "%s.%03dZ", buf, ms);
+
+	return result;
+}
+
+StreamElementsAnalyticsEventsManager::StreamElementsAnalyticsEventsManager()
 {
 	uint64_t now = os_gettime_ns();
 	m_startTime = now;
@@ -16,37 +40,35 @@ StreamElementsAnalyticsEventsManager::StreamElementsAnalyticsEventsManager(size_
 	m_sessionId = CreateGloballyUniqueIdString();
 	m_identity = GetComputerSystemUniqueId();
 
-	m_taskConsumersKeepRunning = true;
-
-	for (size_t i = 0; i < numWorkers; ++i) {
-		m_taskConsumers.push_back(std::thread([this]() {
-			task_queue_item_t task;
-
-			while (m_taskConsumersKeepRunning || m_taskQueue.size_approx()) {
-				if (m_taskQueue.wait_dequeue_timed(task, std::chrono::milliseconds(100))) {
-					task();
-				}
-			}
-		}));
-	}
-}
-
-StreamElementsAnalyticsEventsManager::~StreamElementsAnalyticsEventsManager()
-{
-	m_taskConsumersKeepRunning = false;
+	std::string spoolPath;
 
-	for (size_t i = 0; i < m_taskConsumers.size(); ++i) {
-		if (m_taskConsumers[i].joinable()) {
-			m_taskConsumers[i].join();
-		}
+	char *spoolPathPtr = obs_module_config_path("analytics_spool");
+	if (spoolPathPtr) {
+		spoolPath = spoolPathPtr;
+		bfree(spoolPathPtr);
 	}
 
-	m_taskConsumers.clear();
+	m_queue = std::make_unique<StreamElementsAnalyticsEventsQueue>(
+		m_appId, spoolPath,
+		[](const std::multimap<std::string, std::string> &headers,
+		   const void *body, size_t body_len, int &status) -> bool {
+			return HttpPost(
+				HEAP_TRACK_URL, headers, (void *)body,
+				body_len,
+				[&](void *, size_t, void *, char *,
+				    int http_code) -> bool {
+					if (http_code)
+						status = http_code;
+
+					return true;
+				},
+				nullptr);
+		});
 }
 
-void StreamElementsAnalyticsEventsManager::Enqueue(task_queue_item_t task)
+StreamElementsAnalyticsEventsManager::~StreamElementsAnalyticsEventsManager()
 {
-	m_taskQueue.enqueue(task);
+	m_queue.reset();
 }
 
 void StreamElementsAnalyticsEventsManager::AddRawEvent(const char* eventName, json11::Json::object propertiesJson, bool synchronous)
@@ -71,44 +93,16 @@ void StreamElementsAnalyticsEventsManager::AddRawEvent(const char* eventName, js
 	props["obsVersion"] = obs_get_version_string();
 
 	json11::Json json = json11::Json::object{
-		{ "app_id", m_appId },
 		{ "event", eventName },
 		{ "identity", m_identity.c_str() },
+		{ "timestamp", GetUtcTimestampString() },
 		{ "properties", props }
 	};
 
-	std::string httpRequestBody = json.dump();
-
 	if (!synchronous) {
-		Enqueue([=]() {
-			http_client_headers_t headers;
-
-			headers.emplace(
-				std::make_pair<std::string, std::string>(
-					"Content-Type", "application/json"));
-
-			HttpPost(
-				"https://heapanalytics.com/api/track",
-				headers,
-				(void*)httpRequestBody.c_str(),
-				httpRequestBody.size(),
-				nullptr,
-				nullptr);
-		});
+		m_queue->Enqueue(json);
 	}
 	else {
-		http_client_headers_t headers;
-
-		headers.emplace(
-			std::make_pair<std::string, std::string>(
-				"Content-Type", "application/json"));
-
-		HttpPost(
-			"https://heapanalytics.com/api/track",
-			headers,
-			(void*)httpRequestBody.c_str(),
-			httpRequestBody.size(),
-			nullptr,
-			nullptr);
+		m_queue->SendNow(json);
 	}
 }
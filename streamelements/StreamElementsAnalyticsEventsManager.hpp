@@ -1,12 +1,11 @@
 #pragma once
 
 #include "StreamElementsUtils.hpp"
-#include "deps/moodycamel/concurrentqueue.h"
-#include "deps/moodycamel/blockingconcurrentqueue.h"
+#include "StreamElementsAnalyticsEventsQueue.hpp"
 #include "json11/json11.hpp"
 
+#include <memory>
 #include <vector>
-#include <thread>
 #include <string>
 
 #include <QDockWidget>
@@ -14,7 +13,7 @@
 class StreamElementsAnalyticsEventsManager
 {
 public:
-	StreamElementsAnalyticsEventsManager(size_t numWorkers = 4);
+	StreamElementsAnalyticsEventsManager();
 	~StreamElementsAnalyticsEventsManager();
 
 	void trackSynchronousEvent(const char* eventName, json11::Json::object props = json11::Json::object{}) {
@@ -52,9 +51,6 @@ public:
 	std::string sessionId() { return m_sessionId; }
 
 protected:
-	typedef std::function<void()> task_queue_item_t;
-
-	void Enqueue(task_queue_item_t task);
 	void AddRawEvent(const char* eventName, json11::Json::object propertiesJson = json11::Json::object{}, bool synchronous = false);
 
 private:
@@ -64,7 +60,6 @@ private:
 	std::string m_sessionId;
 	std::string m_identity;
 
-	moodycamel::BlockingConcurrentQueue<task_queue_item_t> m_taskQueue;
-	bool m_taskConsumersKeepRunning;
-	std::vector<std::thread> m_taskConsumers;
+	/* Batching, spooling and delivery */
+	std::unique_ptr<StreamElementsAnalyticsEventsQueue> m_queue;
 };
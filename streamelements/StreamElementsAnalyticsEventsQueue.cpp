@@ -0,0 +1,339 @@
+#include "StreamElementsAnalyticsEventsQueue.hpp"
+
+#include <util/base.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#define MINIZ_HEADER_FILE_ONLY
+#include "deps/zip/miniz.h"
+
+/* Batch is sent when either limit is reached */
+static const size_t MAX_BATCH_EVENTS = 500;
+static const size_t MAX_BATCH_BYTES = 256 * 1024;
+static const uint64_t MAX_BATCH_DELAY_NS = 5000000000ULL;
+
+/* Undelivered batches spooled to disk */
+static const size_t MAX_SPOOL_BYTES = 4 * 1024 * 1024;
+static const uint64_t MIN_RETRY_DELAY_NS = 5000000000ULL;
+static const uint64_t MAX_RETRY_DELAY_NS = 600000000000ULL;
+
+static bool CompressBuffer(const std::string &input, std::vector<char> &output)
+{
+	mz_ulong len = mz_compressBound((mz_ulong)input.size());
+
+	output.resize(len);
+
+	if (MZ_OK != mz_compress2((unsigned char *)output.data(), &len,
+				  (const unsigned char *)input.data(),
+				  (mz_ulong)input.size(), MZ_DEFAULT_LEVEL))
+		return false;
+
+	output.resize(len);
+
+	return true;
+}
+
+StreamElementsAnalyticsEventsQueue::StreamElementsAnalyticsEventsQueue(
+	std::string appId, std::string spoolPath, post_func_t post)
+	: m_appId(appId),
+	  m_spoolPath(spoolPath),
+	  m_post(post),
+	  m_compressionEnabled(true),
+	  m_spoolPending(true)
+{
+	if (m_spoolPath.size())
+		os_mkdirs(m_spoolPath.c_str());
+
+	m_taskConsumersKeepRunning = true;
+
+	m_taskConsumer = std::thread([this]() { ProcessEventQueue(); });
+}
+
+StreamElementsAnalyticsEventsQueue::~StreamElementsAnalyticsEventsQueue()
+{
+	m_taskConsumersKeepRunning = false;
+
+	if (m_taskConsumer.joinable()) {
+		m_taskConsumer.join();
+	}
+}
+
+void StreamElementsAnalyticsEventsQueue::Enqueue(json11::Json event)
+{
+	m_eventQueue.enqueue(std::move(event));
+}
+
+void StreamElementsAnalyticsEventsQueue::SendNow(json11::Json event)
+{
+	std::string httpRequestBody =
+		SerializeBatch(json11::Json::array{event});
+
+	if (SendBatch(httpRequestBody) == BatchFailed) {
+		SpoolBatch(httpRequestBody);
+	}
+}
+
+void StreamElementsAnalyticsEventsQueue::ProcessEventQueue()
+{
+	json11::Json::array batch;
+	size_t batchBytes = 0;
+	uint64_t batchStartTime = 0;
+
+	uint64_t retryDelay = MIN_RETRY_DELAY_NS;
+	uint64_t nextRetryTime = os_gettime_ns();
+
+	auto flush = [&]() {
+		if (batch.empty())
+			return;
+
+		std::string body = SerializeBatch(batch);
+
+		batch.clear();
+		batchBytes = 0;
+
+		if (SendBatch(body) == BatchFailed) {
+			SpoolBatch(body);
+
+			nextRetryTime = os_gettime_ns() + retryDelay;
+		}
+	};
+
+	json11::Json event;
+
+	while (m_taskConsumersKeepRunning || m_eventQueue.size_approx()) {
+		if (m_eventQueue.wait_dequeue_timed(
+			    event, std::chrono::milliseconds(100))) {
+			if (batch.empty())
+				batchStartTime = os_gettime_ns();
+
+			batchBytes += event.dump().size();
+			batch.push_back(event);
+		}
+
+		uint64_t now = os_gettime_ns();
+
+		if (batch.size() >= MAX_BATCH_EVENTS ||
+		    batchBytes >= MAX_BATCH_BYTES ||
+		    (batch.size() && now - batchStartTime >= MAX_BATCH_DELAY_NS))
+			flush();
+
+		if (m_taskConsumersKeepRunning && m_spoolPending &&
+		    now >= nextRetryTime) {
+			/* Cleared before the scan: a batch spooled meanwhile
+			 * sets it again */
+			m_spoolPending = false;
+
+			switch (SendNextSpooledBatch()) {
+			case BatchNone:
+				break;
+			case BatchFailed:
+				m_spoolPending = true;
+
+				retryDelay = std::min(retryDelay * 2,
+						      MAX_RETRY_DELAY_NS);
+				nextRetryTime = now + retryDelay;
+				break;
+			default:
+				m_spoolPending = true;
+
+				retryDelay = MIN_RETRY_DELAY_NS;
+				nextRetryTime = now;
+				break;
+			}
+		}
+	}
+
+	flush();
+}
+
+std::string StreamElementsAnalyticsEventsQueue::SerializeBatch(
+	const json11::Json::array &events)
+{
+	json11::Json json =
+		json11::Json::object{{"app_id", m_appId}, {"events", events}};
+
+	return json.dump();
+}
+
+/* Client errors other than timeouts and rate limiting will not go away by
+ * sending the same batch again */
+static bool IsPermanentHttpFailure(int status)
+{
+	return status >= 400 && status < 500 && status != 408 && status != 429;
+}
+
+StreamElementsAnalyticsEventsQueue::batch_result_t
+StreamElementsAnalyticsEventsQueue::SendBatch(
+	const std::string &httpRequestBody)
+{
+	std::multimap<std::string, std::string> headers;
+
+	headers.emplace(std::make_pair<std::string, std::string>(
+		"Content-Type", "application/json"));
+
+	std::vector<char> compressed;
+
+	bool compress = m_compressionEnabled &&
+			CompressBuffer(httpRequestBody, compressed);
+
+	int status = 0;
+
+	bool sent = false;
+
+	if (compress) {
+		auto compressedHeaders = headers;
+
+		compressedHeaders.emplace(
+			std::make_pair<std::string, std::string>(
+				"Content-Encoding", "deflate"));
+
+		sent = m_post(compressedHeaders, compressed.data(),
+			      compressed.size(), status);
+
+		if (!sent && (status == 400 || status == 415)) {
+			/* Endpoint rejected the encoding: stop compressing */
+			blog(LOG_WARNING,
+			     "obs-browser: analytics: compressed request rejected with HTTP status %d, falling back to uncompressed requests",
+			     status);
+
+			m_compressionEnabled = false;
+
+			compress = false;
+			status = 0;
+		}
+	}
+
+	if (!compress)
+		sent = m_post(headers, httpRequestBody.c_str(),
+			      httpRequestBody.size(), status);
+
+	if (sent)
+		return BatchSent;
+
+	if (!IsPermanentHttpFailure(status))
+		return BatchFailed;
+
+	blog(LOG_WARNING,
+	     "obs-browser: analytics: events batch rejected with HTTP status %d, dropping it",
+	     status);
+
+	return BatchRejected;
+}
+
+void StreamElementsAnalyticsEventsQueue::SpoolBatch(
+	const std::string &httpRequestBody)
+{
+	if (!m_spoolPath.size() || httpRequestBody.size() > MAX_SPOOL_BYTES)
+		return;
+
+	/* Ordered by name: oldest first */
+	std::map<std::string, size_t> files;
+	size_t totalBytes = 0;
+
+	os_dir_t *dir = os_opendir(m_spoolPath.c_str());
+
+	if (dir) {
+		struct os_dirent *entry;
+
+		while ((entry = os_readdir(dir)) != NULL) {
+			if (entry->directory || *entry->d_name == '.')
+				continue;
+
+			std::string path = m_spoolPath + "/" + entry->d_name;
+
+			size_t size = (size_t)os_get_file_size(path.c_str());
+
+			files[path] = size;
+			totalBytes += size;
+		}
+
+		os_closedir(dir);
+	}
+
+	for (auto it = files.begin();
+	     it != files.end() &&
+	     totalBytes + httpRequestBody.size() > MAX_SPOOL_BYTES;
+	     ++it) {
+		if (0 == os_unlink(it->first.c_str()))
+			totalBytes -= it->second;
+	}
+
+	static long s_spoolCounter = 0;
+
+	uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+			      std::chrono::system_clock::now()
+				      .time_since_epoch())
+			      .count();
+
+	char fileName[64];
+	snprintf(fileName, sizeof(fileName), "batch-%016llx-%04lx.json",
+		 (unsigned long long)ms,
+		 os_atomic_inc_long(&s_spoolCounter) & 0xFFFF);
+
+	std::string path = m_spoolPath + "/" + fileName;
+
+	if (!os_quick_write_utf8_file(path.c_str(), httpRequestBody.c_str(),
+				      httpRequestBody.size(), false)) {
+		blog(LOG_WARNING,
+		     "obs-browser: analytics: failed spooling undelivered events batch: %s",
+		     path.c_str());
+
+		return;
+	}
+
+	m_spoolPending = true;
+}
+
+StreamElementsAnalyticsEventsQueue::batch_result_t
+StreamElementsAnalyticsEventsQueue::SendNextSpooledBatch()
+{
+	if (!m_spoolPath.size())
+		return BatchNone;
+
+	std::string oldest;
+
+	os_dir_t *dir = os_opendir(m_spoolPath.c_str());
+
+	if (!dir)
+		return BatchNone;
+
+	struct os_dirent *entry;
+
+	while ((entry = os_readdir(dir)) != NULL) {
+		if (entry->directory || *entry->d_name == '.')
+			continue;
+
+		if (!oldest.size() || oldest > entry->d_name)
+			oldest = entry->d_name;
+	}
+
+	os_closedir(dir);
+
+	if (!oldest.size())
+		return BatchNone;
+
+	std::string path = m_spoolPath + "/" + oldest;
+
+	char *buffer = os_quick_read_utf8_file(path.c_str());
+
+	if (!buffer) {
+		/* Unreadable: drop it, or back off if it can't be removed */
+		return 0 == os_unlink(path.c_str()) ? BatchRejected
+						    : BatchFailed;
+	}
+
+	std::string body = buffer;
+	bfree(buffer);
+
+	batch_result_t result = SendBatch(body);
+
+	if (result == BatchFailed || 0 != os_unlink(path.c_str()))
+		return BatchFailed;
+
+	return result;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "deps/moodycamel/concurrentqueue.h"
+#include "deps/moodycamel/blockingconcurrentqueue.h"
+#include "json11/json11.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+
+/* Delivery of analytics events through Heap's bulk track API.
+ *
+ * Events are collected by a single worker thread into batches, sent as one
+ * deflate-compressed request. Batches which could not be delivered are
+ * spooled to disk and retried with exponential backoff. Batches the
+ * endpoint rejects outright are dropped.
+ *
+ * The HTTP transport is supplied by the owner, so this depends on neither
+ * Qt nor CEF.
+ */
+class StreamElementsAnalyticsEventsQueue
+{
+public:
+	/* POSTs body with headers to the track endpoint. Returns true if the
+	 * request succeeded; status is set to the HTTP status if one was
+	 * received. */
+	typedef std::function<bool(
+		const std::multimap<std::string, std::string> &headers,
+		const void *body, size_t body_len, int &status)>
+		post_func_t;
+
+	/* An empty spoolPath disables spooling */
+	StreamElementsAnalyticsEventsQueue(std::string appId,
+					   std::string spoolPath,
+					   post_func_t post);
+	~StreamElementsAnalyticsEventsQueue();
+
+	/* Queues event for the next batch */
+	void Enqueue(json11::Json event);
+
+	/* Sends event on the calling thread, spooling it on failure */
+	void SendNow(json11::Json event);
+
+private:
+	enum batch_result_t {
+		BatchSent = 0,
+		BatchNone = 1,     // nothing spooled
+		BatchFailed = 2,   // retry later
+		BatchRejected = 3  // dropped, not retried
+	};
+
+	void ProcessEventQueue();
+	batch_result_t SendBatch(const std::string &httpRequestBody);
+	void SpoolBatch(const std::string &httpRequestBody);
+	batch_result_t SendNextSpooledBatch();
+	std::string SerializeBatch(const json11::Json::array &events);
+
+private:
+	std::string m_appId;
+	std::string m_spoolPath;
+	post_func_t m_post;
+
+	std::atomic<bool> m_compressionEnabled;
+	/* Set when a batch is spooled, the spool is only scanned then */
+	std::atomic<bool> m_spoolPending;
+
+	moodycamel::BlockingConcurrentQueue<json11::Json> m_eventQueue;
+	std::atomic<bool> m_taskConsumersKeepRunning;
+	std::thread m_taskConsumer;
+};
@@ -0,0 +1,308 @@
+#include "StreamElementsApiMessageHandler.hpp"
+
+#include "../cef-headers.hpp"
+
+#include <include/cef_parser.h> // CefParseJSON, CefWriteJSON
+
+#include "Version.hpp"
+#include "StreamElementsQtTasks.hpp"
+#include "StreamElementsTracer.hpp"
+
+#include <util/base.h>
+
+/* Renderer process message dispatch. Kept apart from the API handler
+ * registry in StreamElementsApiMessageHandler.cpp, which pulls in the
+ * frontend API and every manager the handlers call into.
+ */
+
+/* Incoming messages from renderer process */
+const char *MSG_ON_CONTEXT_CREATED =
+	"CefRenderProcessHandler::OnContextCreated";
+const char *MSG_INCOMING_API_CALL =
+	"StreamElementsApiMessageHandler::OnIncomingApiCall";
+
+/* Outgoing messages to renderer process */
+const char *MSG_BIND_JAVASCRIPT_FUNCTIONS =
+	"CefRenderProcessHandler::BindJavaScriptFunctions";
+const char *MSG_BIND_JAVASCRIPT_PROPS =
+	"CefRenderProcessHandler::BindJavaScriptProperties";
+
+bool StreamElementsApiMessageHandler::OnProcessMessageReceived(
+	CefRefPtr<CefBrowser> browser,
+#if CHROME_VERSION_BUILD >= 3770
+	CefRefPtr<CefFrame> /*frame*/,
+#endif
+	CefProcessId /*source_process*/, CefRefPtr<CefProcessMessage> message,
+	const long cefClientId)
+{
+	const std::string &name = message->GetName();
+
+	if (name == MSG_ON_CONTEXT_CREATED) {
+		RegisterIncomingApiCallHandlersInternal(browser);
+		RegisterApiPropsInternal(browser);
+		DispatchHostReadyEventInternal(browser);
+
+		return true;
+	} else if (name == MSG_INCOMING_API_CALL) {
+		CefRefPtr<CefValue> result = CefValue::Create();
+		result->SetBool(false);
+
+		CefRefPtr<CefListValue> args = message->GetArgumentList();
+
+		const int headerSize = args->GetInt(0);
+		std::string id = args->GetString(2).ToString();
+
+		id = id.substr(id.find_last_of('.') +
+			       1); // window.host.XXX -> XXX
+
+		if (m_apiCallHandlers.count(id)) {
+			CefRefPtr<CefListValue> callArgs =
+				CefListValue::Create();
+
+			for (int i = headerSize; i < args->GetSize() - 1; ++i) {
+				CefRefPtr<CefValue> parsedValue = CefParseJSON(
+					args->GetString(i),
+					JSON_PARSER_ALLOW_TRAILING_COMMAS);
+
+				callArgs->SetValue(callArgs->GetSize(),
+						   parsedValue);
+			}
+
+			struct local_context {
+				StreamElementsApiMessageHandler *self;
+				std::string id;
+				CefRefPtr<CefBrowser> browser;
+				CefRefPtr<CefProcessMessage> message;
+				CefRefPtr<CefListValue> callArgs;
+				CefRefPtr<CefValue> result;
+				std::function<void()> complete;
+				int cef_app_callback_id;
+				long cefClientId;
+			};
+
+			local_context *context = new local_context();
+
+			// Round trip from the renderer request to the result
+			uint64_t traceId = StreamElementsTracer::NewAsyncId();
+			StreamElementsTracer::RecordAsyncBegin("api", id.c_str(),
+							       traceId);
+
+			context->self = this;
+			context->id = id;
+			context->browser = browser;
+			context->message = message;
+			context->callArgs = callArgs;
+			context->result = result;
+			context->cef_app_callback_id =
+				message->GetArgumentList()->GetInt(
+					message->GetArgumentList()->GetSize() -
+					1);
+			context->cefClientId = cefClientId;
+			// Handlers may complete after context was deleted:
+			// capture what completion needs by value
+			CefRefPtr<CefBrowser> completeBrowser = browser;
+			CefRefPtr<CefValue> completeResult = result;
+			const int callbackId = context->cef_app_callback_id;
+
+			context->complete = [completeBrowser, completeResult,
+					     callbackId, cefClientId, traceId,
+					     id]() {
+				blog(LOG_INFO,
+				     "obs-browser[%lu]: API: completed call to '%s', callback id %d",
+				     cefClientId, id.c_str(), callbackId);
+
+				StreamElementsTracer::RecordAsyncEnd(
+					"api", id.c_str(), traceId);
+
+				if (callbackId != -1) {
+					// Invoke result callback
+					CefRefPtr<CefProcessMessage> msg =
+						CefProcessMessage::Create(
+							"executeCallback");
+
+					CefRefPtr<CefListValue> callbackArgs =
+						msg->GetArgumentList();
+					callbackArgs->SetInt(0, callbackId);
+					callbackArgs->SetString(
+						1,
+						CefWriteJSON(
+							completeResult,
+							JSON_WRITER_DEFAULT));
+
+					SendBrowserProcessMessage(
+						completeBrowser, PID_RENDERER,
+						msg);
+				}
+			};
+
+			{
+				CefRefPtr<CefValue> callArgsValue =
+					CefValue::Create();
+				callArgsValue->SetList(context->callArgs);
+				blog(LOG_INFO,
+				     "obs-browser[%lu]: API: posting call to '%s', callback id %d, args: %s",
+				     context->cefClientId, context->id.c_str(),
+				     context->cef_app_callback_id,
+				     CefWriteJSON(callArgsValue,
+						  JSON_WRITER_DEFAULT)
+					     .ToString()
+					     .c_str());
+			}
+
+			QtPostTask(
+				[context]() {
+					blog(LOG_INFO,
+					     "obs-browser[%lu]: API: performing call to '%s', callback id %d",
+					     context->cefClientId,
+					     context->id.c_str(),
+					     context->cef_app_callback_id);
+
+					SE_TRACE_SCOPE("api", context->id);
+
+					context->self
+						->m_apiCallHandlers[context->id](
+							context->self,
+							context->message,
+							context->callArgs,
+							context->result,
+							context->browser,
+							context->cefClientId,
+							context->complete);
+
+					delete context;
+				});
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void StreamElementsApiMessageHandler::InvokeApiCallHandlerAsync(
+	CefRefPtr<CefProcessMessage> message, CefRefPtr<CefBrowser> browser,
+	std::string invokeId, CefRefPtr<CefListValue> invokeArgs,
+	std::function<void(CefRefPtr<CefValue>)> result_callback,
+	const long cefClientId,
+	const bool enable_logging)
+{
+	CefRefPtr<CefValue> result = CefValue::Create();
+	result->SetNull();
+
+	if (!m_apiCallHandlers.count(invokeId)) {
+		blog(LOG_ERROR, "obs-browser[%lu]: API: invalid API call to '%s'",
+		     cefClientId, invokeId.c_str());
+
+		result_callback(result);
+
+		return;
+	}
+
+	if (enable_logging) {
+		blog(LOG_INFO, "obs-browser[%lu]: API: performing call to '%s'",
+		     cefClientId, invokeId.c_str());
+	}
+
+	auto handler = m_apiCallHandlers[invokeId];
+
+	SE_TRACE_SCOPE("api", invokeId);
+
+	handler(this, message, invokeArgs, result, browser, cefClientId, [=]() {
+		if (enable_logging) {
+			blog(LOG_INFO,
+			     "obs-browser[%lu]: API: completed call to '%s'",
+			     cefClientId, invokeId.c_str());
+		}
+
+		result_callback(result);
+	});
+}
+
+void StreamElementsApiMessageHandler::RegisterIncomingApiCallHandlersInternal(
+	CefRefPtr<CefBrowser> browser)
+{
+	RegisterIncomingApiCallHandlers();
+
+	// Context created, request creation of window.host object
+	// with API methods
+	CefRefPtr<CefValue> root = CefValue::Create();
+
+	CefRefPtr<CefDictionaryValue> rootDictionary =
+		CefDictionaryValue::Create();
+	root->SetDictionary(rootDictionary);
+
+	for (auto apiCallHandler : m_apiCallHandlers) {
+		CefRefPtr<CefValue> val = CefValue::Create();
+
+		CefRefPtr<CefDictionaryValue> function =
+			CefDictionaryValue::Create();
+
+		function->SetString("message", MSG_INCOMING_API_CALL);
+
+		val->SetDictionary(function);
+
+		rootDictionary->SetValue(apiCallHandler.first, val);
+	}
+
+	// Convert data to JSON
+	CefString jsonString = CefWriteJSON(root, JSON_WRITER_DEFAULT);
+
+	// Send request to renderer process
+	CefRefPtr<CefProcessMessage> msg =
+		CefProcessMessage::Create(MSG_BIND_JAVASCRIPT_FUNCTIONS);
+	msg->GetArgumentList()->SetString(0, "host");
+	msg->GetArgumentList()->SetString(1, jsonString);
+	SendBrowserProcessMessage(browser, PID_RENDERER, msg);
+}
+
+void StreamElementsApiMessageHandler::RegisterApiPropsInternal(
+	CefRefPtr<CefBrowser> browser)
+{
+	// Context created, request creation of window.host object
+	// with API methods
+	CefRefPtr<CefValue> root = CefValue::Create();
+
+	CefRefPtr<CefDictionaryValue> rootDictionary =
+		CefDictionaryValue::Create();
+	root->SetDictionary(rootDictionary);
+
+	rootDictionary->SetBool("hostReady", true);
+	rootDictionary->SetBool("hostContainerHidden", m_initialHiddenState);
+	rootDictionary->SetInt("apiMajorVersion", HOST_API_VERSION_MAJOR);
+	rootDictionary->SetInt("apiMinorVersion", HOST_API_VERSION_MINOR);
+
+	// Convert data to JSON
+	CefString jsonString = CefWriteJSON(root, JSON_WRITER_DEFAULT);
+
+	// Send request to renderer process
+	CefRefPtr<CefProcessMessage> msg =
+		CefProcessMessage::Create(MSG_BIND_JAVASCRIPT_PROPS);
+	msg->GetArgumentList()->SetString(0, "host");
+	msg->GetArgumentList()->SetString(1, jsonString);
+	SendBrowserProcessMessage(browser, PID_RENDERER, msg);
+}
+
+void StreamElementsApiMessageHandler::DispatchHostReadyEventInternal(
+	CefRefPtr<CefBrowser> browser)
+{
+	DispatchEventInternal(browser, "hostReady", "null");
+}
+
+void StreamElementsApiMessageHandler::DispatchEventInternal(
+	CefRefPtr<CefBrowser> browser, std::string event,
+	std::string eventArgsJson)
+{
+	CefRefPtr<CefProcessMessage> msg =
+		CefProcessMessage::Create("DispatchJSEvent");
+	CefRefPtr<CefListValue> args = msg->GetArgumentList();
+
+	args->SetString(0, event);
+	args->SetString(1, eventArgsJson);
+	SendBrowserProcessMessage(browser, PID_RENDERER, msg);
+}
+
+void StreamElementsApiMessageHandler::RegisterIncomingApiCallHandler(
+	std::string id, incoming_call_handler_t handler)
+{
+	m_apiCallHandlers[id] = handler;
+}
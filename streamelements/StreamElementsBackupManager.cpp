@@ -1,7 +1,9 @@
 #include "StreamElementsBackupManager.hpp"
+#include "StreamElementsBackupPackage.hpp"
 #include "StreamElementsUtils.hpp"
 #include "StreamElementsNetworkDialog.hpp"
 #include "StreamElementsGlobalStateManager.hpp"
+#include "StreamElementsTracer.hpp"
 
 #include <obs.h>
 #include <obs-frontend-api.h>
@@ -19,40 +21,54 @@
 #include <map>
 #include <codecvt>
 #include <regex>
-
-static bool GetLocalPathFromURL(std::string url, std::string &path)
+#include <unordered_set>
+
+/* Resolves url to a local file: session signed paths are used as is, other
+ * URLs are downloaded by a network dialog on the Qt main thread. callback
+ * receives the result on the Qt main thread (inline for signed paths), so
+ * the calling CEF thread never waits for the dialog.
+ */
+static void
+GetLocalPathFromURLAsync(std::string url,
+			 std::function<void(bool, std::string)> callback)
 {
-	if (VerifySessionSignedAbsolutePathURL(url, path))
-		return true;
+	std::string path;
 
-	if (!GetTemporaryFilePath("obs-live-restore", path))
-		return false;
-
-	bool result = false;
+	if (VerifySessionSignedAbsolutePathURL(url, path)) {
+		callback(true, path);
+		return;
+	}
 
-	QtExecSync([&]() {
-		obs_frontend_push_ui_translation(obs_module_get_string);
+	if (!GetTemporaryFilePath("obs-live-restore", path)) {
+		callback(false, path);
+		return;
+	}
 
-		StreamElementsNetworkDialog netDialog(
-			StreamElementsGlobalStateManager::GetInstance()
-				->mainWindow());
+	QtExecAsync(
+		[url, path]() -> bool {
+			obs_frontend_push_ui_translation(obs_module_get_string);
 
-		obs_frontend_pop_ui_translation();
+			StreamElementsNetworkDialog netDialog(
+				StreamElementsGlobalStateManager::GetInstance()
+					->mainWindow());
 
-		result = netDialog.DownloadFile(
-			path.c_str(), url.c_str(), true,
-			obs_module_text(
-				"StreamElements.BackupRestore.Download.Message"));
-	});
+			obs_frontend_pop_ui_translation();
 
-	if (!result)
-		os_unlink(path.c_str());
-	else
-		StreamElementsGlobalStateManager::GetInstance()
-			->GetCleanupManager()
-			->AddPath(path);
+			return netDialog.DownloadFile(
+				path.c_str(), url.c_str(), true,
+				obs_module_text(
+					"StreamElements.BackupRestore.Download.Message"));
+		},
+		[path, callback](bool result) {
+			if (!result)
+				os_unlink(path.c_str());
+			else
+				StreamElementsGlobalStateManager::GetInstance()
+					->GetCleanupManager()
+					->AddPath(path);
 
-	return result;
+			callback(result, path);
+		});
 }
 
 static bool AddFileToZip(zip_t *zip, std::string localPath, std::string zipPath)
@@ -276,88 +292,31 @@ static bool ScanForFileReferencesMonikersToRestore(std::string srcBasePath,
 	return success;
 }
 
-static bool
-ScanForFileReferencesToBackup(zip_t *zip, CefRefPtr<CefValue> &node,
-			      std::map<std::string, std::string> &filesMap,
-			      std::string timestamp,
-			      CefRefPtr<CefValue> &result)
+static bool AddReferencedFilesToZip(zip_t *zip, std::string timestamp,
+				    CefRefPtr<CefValue> &content)
 {
-	result = node->Copy();
-
-	if (node->GetType() == VTYPE_STRING) {
-		std::string path = node->GetString().ToString();
+	SE_TRACE_SCOPE("backup", "AddReferencedFilesToZip");
 
-		if (os_file_exists(path.c_str())) {
-			if (!filesMap.count(path)) {
-				std::string fileName =
-					GetUniqueFileNameFromPath(path, 48);
-				std::string zipPath =
-					"obslive_restored_files/" + timestamp +
-					"/" + fileName;
-
-				if (!AddFileToZip(zip, path, zipPath))
-					return false;
-
-				filesMap[path] = zipPath;
-			}
-
-			std::string zipPath = filesMap[path];
-
-			std::string moniker =
-				MONIKER_START + zipPath + MONIKER_END;
-
-			result->SetString(moniker);
-		}
-	} else if (node->GetType() == VTYPE_LIST) {
-		CefRefPtr<CefListValue> list = node->GetList();
-		CefRefPtr<CefListValue> out = CefListValue::Create();
+	std::map<std::string, std::string> filesMap;
 
-		for (size_t index = 0; index < list->GetSize(); ++index) {
-			CefRefPtr<CefValue> value =
-				list->GetValue(index)->Copy();
+	return ScanForFileReferences(content, [&](const std::string &path,
+						  std::string &moniker) {
+		if (!filesMap.count(path)) {
+			std::string fileName =
+				GetUniqueFileNameFromPath(path, 48);
+			std::string zipPath = "obslive_restored_files/" +
+					      timestamp + "/" + fileName;
 
-			if (!ScanForFileReferencesToBackup(zip, value, filesMap,
-							   timestamp, value))
+			if (!AddFileToZip(zip, path, zipPath))
 				return false;
 
-			out->SetValue(index, value);
-		}
-
-		result->SetList(out);
-	} else if (node->GetType() == VTYPE_DICTIONARY) {
-		CefRefPtr<CefDictionaryValue> d = node->GetDictionary();
-		CefRefPtr<CefDictionaryValue> out =
-			CefDictionaryValue::Create();
-
-		CefDictionaryValue::KeyList keys;
-		if (d->GetKeys(keys)) {
-			for (auto key : keys) {
-				CefRefPtr<CefValue> value =
-					d->GetValue(key)->Copy();
-
-				if (!ScanForFileReferencesToBackup(
-					    zip, value, filesMap, timestamp,
-					    value))
-					return false;
-
-				out->SetValue(key, value);
-			}
+			filesMap[path] = zipPath;
 		}
 
-		result->SetDictionary(out);
-	}
-
-	return true;
-}
+		moniker = MONIKER_START + filesMap[path] + MONIKER_END;
 
-static bool AddReferencedFilesToZip(zip_t *zip, std::string timestamp,
-				    CefRefPtr<CefValue> &content,
-				    CefRefPtr<CefValue> &result)
-{
-	std::map<std::string, std::string> filesMap;
-
-	return ScanForFileReferencesToBackup(zip, content, filesMap, timestamp,
-					     result);
+		return true;
+	});
 }
 
 static bool AddCollectionToZip(zip_t *zip, std::string basePath,
@@ -365,6 +324,8 @@ static bool AddCollectionToZip(zip_t *zip, std::string basePath,
 			       bool includeReferencedFiles,
 			       std::string timestamp)
 {
+	SE_TRACE_SCOPE("backup", "AddCollectionToZip");
+
 	std::string relPath = "basic/scenes/" + collection + ".json";
 	std::string absPath = basePath + "/" + relPath;
 
@@ -383,14 +344,10 @@ static bool AddCollectionToZip(zip_t *zip, std::string basePath,
 	if (!content.get() || content->GetType() == VTYPE_NULL)
 		return false;
 
-	std::map<std::string, std::string> filesMap;
-	CefRefPtr<CefValue> resultContent = CefValue::Create();
-
-	if (!AddReferencedFilesToZip(zip, timestamp, content, resultContent))
+	if (!AddReferencedFilesToZip(zip, timestamp, content))
 		return false;
 
-	std::string json =
-		CefWriteJSON(resultContent, JSON_WRITER_PRETTY_PRINT);
+	std::string json = CefWriteJSON(content, JSON_WRITER_PRETTY_PRINT);
 
 	return AddBufferToZip(zip, json.c_str(), json.size(), relPath);
 }
@@ -398,6 +355,8 @@ static bool AddCollectionToZip(zip_t *zip, std::string basePath,
 static bool AddProfileToZip(zip_t *zip, std::string basePath,
 			    std::string profile)
 {
+	SE_TRACE_SCOPE("backup", "AddProfileToZip");
+
 	std::string relPath = "basic/profiles/" +
 			      std::regex_replace(profile, std::regex(" "), "_");
 	std::string absPath = basePath + "/" + relPath;
@@ -495,6 +454,8 @@ void StreamElementsBackupManager::CreateLocalBackupPackage(
 {
 	std::lock_guard<decltype(m_mutex)> guard(m_mutex);
 
+	SE_TRACE_SCOPE("backup", "CreateLocalBackupPackage");
+
 	output->SetNull();
 
 	if (input->GetType() != VTYPE_DICTIONARY)
@@ -579,7 +540,11 @@ void StreamElementsBackupManager::CreateLocalBackupPackage(
 		addedCollections->SetDictionary(addedCollections->GetSize(), d);
 	}
 
-	zip_close(zip);
+	{
+		SE_TRACE_SCOPE("backup", "zip_close");
+
+		zip_close(zip);
+	}
 
 	std::wstring_convert<std::codecvt_utf8<wchar_t>> myconv;
 
@@ -593,81 +558,27 @@ void StreamElementsBackupManager::CreateLocalBackupPackage(
 	output->SetDictionary(out);
 }
 
-void StreamElementsBackupManager::QueryBackupPackageContent(
-	CefRefPtr<CefValue> input, CefRefPtr<CefValue> &output)
+static void SerializeBackupPackageContent(std::string localPath,
+					  const backup_package_index &index,
+					  CefRefPtr<CefValue> &output)
 {
-	std::lock_guard<decltype(m_mutex)> guard(m_mutex);
-
-	output->SetNull();
-
-	if (input->GetType() != VTYPE_DICTIONARY)
-		return;
-
-	CefRefPtr<CefDictionaryValue> in = input->GetDictionary();
-
-	if (!in->HasKey("url") || in->GetType("url") != VTYPE_STRING)
-		return;
-
-	std::string url = in->GetString("url").ToString();
-
-	std::string localPath;
-
-	if (!GetLocalPathFromURL(url, localPath))
-		return;
-
-	zip_t *zip = zip_open(localPath.c_str(), 0, 'r');
-
-	if (!zip)
-		return;
-
-	std::map<std::string, std::string> profiles;
-	std::map<std::string, std::string> collections;
-
-	for (int index = 0; index < zip_total_entries(zip) &&
-			    0 == zip_entry_openbyindex(zip, index);
-	     ++index) {
-		const char *namePtr = zip_entry_name(zip);
-
-		if (namePtr) {
-			std::string name = namePtr;
-
-			std::smatch match;
-
-			if (std::regex_search(
-				    name, match,
-				    std::regex(
-					    "^basic/profiles/(.+?)/basic.ini$"))) {
-				profiles[match[1].str()] = name;
-			} else if (std::regex_search(
-					   name, match,
-					   std::regex(
-						   "^basic/scenes/(.+?)\\.json$"))) {
-				collections[match[1].str()] = name;
-			}
-		}
-
-		zip_entry_close(zip);
-	}
-
-	zip_close(zip);
-
 	CefRefPtr<CefListValue> profilesList = CefListValue::Create();
 	CefRefPtr<CefListValue> collectionsList = CefListValue::Create();
 
-	for (auto item : profiles) {
+	for (auto &id : index.profiles) {
 		CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
 
-		d->SetString("id", item.first);
-		d->SetString("name", item.first);
+		d->SetString("id", id);
+		d->SetString("name", id);
 
 		profilesList->SetDictionary(profilesList->GetSize(), d);
 	}
 
-	for (auto item : collections) {
+	for (auto &id : index.collections) {
 		CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
 
-		d->SetString("id", item.first);
-		d->SetString("name", item.first);
+		d->SetString("id", id);
+		d->SetString("name", id);
 
 		collectionsList->SetDictionary(collectionsList->GetSize(), d);
 	}
@@ -684,216 +595,64 @@ void StreamElementsBackupManager::QueryBackupPackageContent(
 	output->SetDictionary(result);
 }
 
-static bool IsQualifiedFileForRestore(
-	std::string zipPath,
-	std::unordered_map<std::string, bool> &requestProfiles,
-	std::unordered_map<std::string, bool> &requestCollections)
+void StreamElementsBackupManager::QueryBackupPackageContentAsync(
+	CefRefPtr<CefValue> input, CefRefPtr<CefValue> output,
+	std::function<void()> complete)
 {
-	std::smatch match;
-
-	if (std::regex_search(zipPath, match,
-			      std::regex("^basic/profiles/(.+?)/"))) {
-		if (!requestProfiles.empty()) {
-			std::string id = match[1].str();
-
-			if (requestProfiles.count(id))
-				return true;
-			else
-				return false;
-		} else
-			return true;
-	} else if (std::regex_search(
-			   zipPath, match,
-			   std::regex("^basic/scenes/(.+?)\\.json$"))) {
-		if (!requestCollections.empty()) {
-			std::string id = match[1].str();
-
-			if (requestCollections.count(id))
-				return true;
-			else
-				return false;
-		} else
-			return true;
-	} else {
-		return true;
-	}
-}
-
-struct zip_extract_context_t {
-	int handle;
-};
-
-static size_t HandleZipExtract(void *arg, unsigned long long offset,
-			       const void *data, size_t size)
-{
-	zip_extract_context_t *context = (zip_extract_context_t *)arg;
-
-	return write(context->handle, data, size);
-};
-
-void StreamElementsBackupManager::RestoreBackupPackageContent(
-	CefRefPtr<CefValue> input, CefRefPtr<CefValue> &output)
-{
-	std::lock_guard<decltype(m_mutex)> guard(m_mutex);
-
 	output->SetNull();
 
-	/* Never allow restore during streaming or recording */
-	if (obs_frontend_streaming_active() || obs_frontend_recording_active())
+	if (input->GetType() != VTYPE_DICTIONARY) {
+		complete();
 		return;
-
-	if (input->GetType() != VTYPE_DICTIONARY)
-		return;
-
-	CefRefPtr<CefDictionaryValue> in = input->GetDictionary();
-
-	std::unordered_map<std::string, bool> requestCollections;
-	std::unordered_map<std::string, bool> requestProfiles;
-
-	if (in->HasKey("sceneCollections") &&
-	    in->GetType("sceneCollections") == VTYPE_LIST) {
-		std::vector<std::string> ids;
-
-		ReadListOfIdsFromCefValue(in->GetValue("sceneCollections"),
-					  ids);
-
-		for (auto id : ids) {
-			requestCollections[id] = true;
-		}
 	}
 
-	if (in->HasKey("profiles") && in->GetType("profiles") == VTYPE_LIST) {
-		std::vector<std::string> ids;
-
-		ReadListOfIdsFromCefValue(in->GetValue("profiles"), ids);
-
-		for (auto id : ids) {
-			requestProfiles[id] = true;
-		}
-	}
+	CefRefPtr<CefDictionaryValue> in = input->GetDictionary();
 
-	if (!in->HasKey("url") || in->GetType("url") != VTYPE_STRING)
+	if (!in->HasKey("url") || in->GetType("url") != VTYPE_STRING) {
+		complete();
 		return;
+	}
 
 	std::string url = in->GetString("url").ToString();
 
-	std::string extractPath;
-
-	if (!GetTemporaryFilePath("obs-live-restore-content", extractPath))
-		return;
-
-	StreamElementsGlobalStateManager::GetInstance()
-		->GetCleanupManager()
-		->AddPath(extractPath);
-
-	std::string extractRootPath = extractPath + ".dir";
-
-	extractPath = extractRootPath + "\\obs-studio";
-
-	if (MKDIR_ERROR == os_mkdirs(extractPath.c_str()))
-		return;
-
-	std::string localPath;
-
-	if (!GetLocalPathFromURL(url, localPath))
-		return;
-
-	zip_t *zip = zip_open(localPath.c_str(), 0, 'r');
-
-	if (!zip)
-		return;
-
-	bool success = true;
-
-	for (int index = 0; index < zip_total_entries(zip) &&
-			    0 == zip_entry_openbyindex(zip, index) && success;
-	     ++index) {
-		const char *namePtr = zip_entry_name(zip);
-
-		if (namePtr) {
-			std::string name = namePtr;
-
-			if (IsQualifiedFileForRestore(name, requestProfiles,
-						      requestCollections)) {
-				std::string destFilePath =
-					extractPath + "/" + name;
-
-				std::string extractDirPath =
-					GetFolderPathFromFilePath(destFilePath);
-
-				/* Create output base directory & extract file */
-				if (MKDIR_ERROR ==
-				    os_mkdirs(extractDirPath.c_str())) {
-					/* Mkdir failed*/
-					success = false;
-				} else {
-#ifdef _WIN32
-					std::wstring_convert<
-						std::codecvt_utf8<wchar_t>>
-						myconv;
-#endif
-					zip_extract_context_t context;
-
-					std::transform(
-						destFilePath.begin(),
-						destFilePath.end(),
-						destFilePath.begin(),
-						[](char ch) {
-							if (ch == '/')
-								return '\\';
-							else
-								return ch;
-						});
-
-#ifdef _WIN32
-					context.handle = _wopen(
-						myconv.from_bytes(destFilePath)
-							.c_str(),
-						_O_WRONLY | _O_CREAT |
-							_O_BINARY,
-						_S_IREAD | _S_IWRITE);
-#else
-					context.handle = open(destFilePath.c_str(), O_WRONLY | O_CREAT | S_IRUSR | S_IWUSR);
-#endif
-					if (-1 == context.handle) {
-						success = false;
-					} else {
-						if (0 !=
-						    zip_entry_extract(
-							    zip,
-							    HandleZipExtract,
-							    &context)) {
-							success = false;
-						} else {
-							/* Success */
-						}
-
-						close(context.handle);
-					}
-				}
-			}
+	GetLocalPathFromURLAsync(url, [this, output, complete](
+					      bool success,
+					      std::string localPath) {
+		if (!success) {
+			complete();
+			return;
 		}
 
-		zip_entry_close(zip);
-	}
+		m_taskQueue.Enqueue([output, complete, localPath]() {
+			SE_TRACE_SCOPE("backup", "QueryBackupPackageContent");
 
-	zip_close(zip);
+			auto index = read_backup_package_index(localPath);
 
-	if (!success)
-		return;
+			QtPostTask([output, complete, localPath, index]() {
+				CefRefPtr<CefValue> result = output;
 
-	/* Replace file monikers for Scene Collections */
+				if (index)
+					SerializeBackupPackageContent(
+						localPath, *index, result);
 
-	char *basePathPtr = os_get_config_path_ptr("obs-studio");
-	std::string destBasePath = basePathPtr;
-	bfree(basePathPtr);
+				complete();
+			});
+		});
+	});
+}
 
-	if (ScanForFileReferencesMonikersToRestore(extractPath, destBasePath)) {
-		std::string scriptPath;
-		if (!GetTemporaryFilePath("obs-restore-script", scriptPath))
-			return;
+/* Spawns the script host which moves the restored files into place once
+ * OBS exited, then exits OBS. Runs on the Qt main thread.
+ */
+static bool SpawnRestoreScriptAndExit(std::string extractPath,
+				      std::string extractRootPath,
+				      std::string destBasePath)
+{
+	std::string scriptPath;
+	if (!GetTemporaryFilePath("obs-restore-script", scriptPath))
+		return false;
 
-		std::string script = R"(
+	std::string script = R"(
 			void main() {
 				wait_pid(${OBS_PID}, 0);
 
@@ -913,177 +672,306 @@ void StreamElementsBackupManager::RestoreBackupPackageContent(
 				filesystem_delete("${SCRIPT_PATH}");
 				filesystem_delete("${EXTRACT_ROOT_PATH}");
 			}
-		)";
+	)";
 #ifdef _WIN32
-		char obs_pid_buffer[32];
-		ltoa(GetCurrentProcessId(), obs_pid_buffer, 10);
+	char obs_pid_buffer[32];
+	ltoa(GetCurrentProcessId(), obs_pid_buffer, 10);
 #else
-		const char* obs_pid_buffer = std::to_string(getpid()).c_str();
+	const char* obs_pid_buffer = std::to_string(getpid()).c_str();
 #endif
-		std::string cwd;
-		cwd.resize(MAX_PATH);
+	std::string cwd;
+	cwd.resize(MAX_PATH);
 #ifdef _WIN32
-		wchar_t obs_path_utf16[MAX_PATH];
-		GetModuleFileNameW(NULL, obs_path_utf16, MAX_PATH);
+	wchar_t obs_path_utf16[MAX_PATH];
+	GetModuleFileNameW(NULL, obs_path_utf16, MAX_PATH);
 
-		std::string outputPath = destBasePath.substr(
-			0, destBasePath.size() -
-				   std::string("\\obs-studio").size());
+	std::string outputPath = destBasePath.substr(
+		0, destBasePath.size() -
+			   std::string("\\obs-studio").size());
 
 #ifdef _WIN32
-		std::wstring_convert<std::codecvt_utf8<wchar_t>> myconv;
+	std::wstring_convert<std::codecvt_utf8<wchar_t>> myconv;
 #endif
 
-		std::string obsArgs = "";
+	std::string obsArgs = "";
 
-		{
-			int argc;
+	{
+		int argc;
 #ifdef _WIN32
-			LPWSTR *wArgv =
-				CommandLineToArgvW(GetCommandLineW(), &argc);
+		LPWSTR *wArgv =
+			CommandLineToArgvW(GetCommandLineW(), &argc);
 #else
-			char **wArgv = CommandLineToArgv(GetCommandLine, &argc);
+		char **wArgv = CommandLineToArgv(GetCommandLine, &argc);
 #endif
 
-			for (int i = 1; i < argc; ++i) {
+		for (int i = 1; i < argc; ++i) {
 #ifdef _WIN32
-				std::string arg = myconv.to_bytes(wArgv[i]);
+			std::string arg = myconv.to_bytes(wArgv[i]);
 #else
-				std string arg = wArgv[i];
+			std string arg = wArgv[i];
 #endif
-				if (arg.size() && arg.find_first_of(' ') >= 0) {
-					if (arg.substr(0, 1) != "\"")
-						arg = "\"" + arg;
-					if (arg.substr(arg.size() - 1, 1) !=
-					    "\"")
-						arg += "\"";
-				}
-
-				if (obsArgs.size())
-					obsArgs += " ";
-
-				obsArgs += arg;
+			if (arg.size() && arg.find_first_of(' ') >= 0) {
+				if (arg.substr(0, 1) != "\"")
+					arg = "\"" + arg;
+				if (arg.substr(arg.size() - 1, 1) !=
+				    "\"")
+					arg += "\"";
 			}
 
-			LocalFree(wArgv);
+			if (obsArgs.size())
+				obsArgs += " ";
+
+			obsArgs += arg;
 		}
 
-		std::map<std::string, std::string> vars;
+		LocalFree(wArgv);
+	}
 
-		vars["OBS_PID"] = obs_pid_buffer;
-		vars["SRC_PATH"] = extractPath;
-		vars["DEST_PATH"] = outputPath;
-		vars["CONFIRM_STOP_MOVE_TEXT"] = obs_module_text(
-			"StreamElements.BackupRestore.MoveRestoredFilesAbortConfirmation.Text");
-		vars["CONFIRM_STOP_MOVE_TITLE"] = obs_module_text(
-			"StreamElements.BackupRestore.MoveRestoredFilesAbortConfirmation.Title");
+	std::map<std::string, std::string> vars;
+
+	vars["OBS_PID"] = obs_pid_buffer;
+	vars["SRC_PATH"] = extractPath;
+	vars["DEST_PATH"] = outputPath;
+	vars["CONFIRM_STOP_MOVE_TEXT"] = obs_module_text(
+		"StreamElements.BackupRestore.MoveRestoredFilesAbortConfirmation.Text");
+	vars["CONFIRM_STOP_MOVE_TITLE"] = obs_module_text(
+		"StreamElements.BackupRestore.MoveRestoredFilesAbortConfirmation.Title");
 #ifdef _WIN32
-		vars["OBS_EXE_PATH"] = myconv.to_bytes(obs_path_utf16);
+	vars["OBS_EXE_PATH"] = myconv.to_bytes(obs_path_utf16);
 #else
-		vars["OBS_EXE_PATH"] = obs_path_utf16;
+	vars["OBS_EXE_PATH"] = obs_path_utf16;
 #endif
-		vars["OBS_ARGS"] = obsArgs;
-		vars["OBS_EXE_FOLDER"] =
-			os_getcwd((char *)cwd.data(), cwd.size());
-		vars["SCRIPT_PATH"] = scriptPath;
-		vars["EXTRACT_ROOT_PATH"] = extractRootPath;
-
-		for (auto var : vars) {
-			std::string regex = "\\$\\{" + var.first + "\\}";
-
-			std::string val = "";
-
-			for (char ch : var.second) {
-				switch (ch) {
-				case '\"':
-				case '\'':
-				case '\\':
-					val.push_back('\\');
-					val.push_back(ch);
-					break;
-				case '\t':
-					val.push_back('\\');
-					val.push_back('t');
-					break;
-				case '\r':
-					val.push_back('\\');
-					val.push_back('r');
-					break;
-				case '\n':
-					val.push_back('\\');
-					val.push_back('n');
-					break;
-				default:
-					val.push_back(ch);
-				}
+	vars["OBS_ARGS"] = obsArgs;
+	vars["OBS_EXE_FOLDER"] =
+		os_getcwd((char *)cwd.data(), cwd.size());
+	vars["SCRIPT_PATH"] = scriptPath;
+	vars["EXTRACT_ROOT_PATH"] = extractRootPath;
+
+	for (auto var : vars) {
+		std::string regex = "\\$\\{" + var.first + "\\}";
+
+		std::string val = "";
+
+		for (char ch : var.second) {
+			switch (ch) {
+			case '\"':
+			case '\'':
+			case '\\':
+				val.push_back('\\');
+				val.push_back(ch);
+				break;
+			case '\t':
+				val.push_back('\\');
+				val.push_back('t');
+				break;
+			case '\r':
+				val.push_back('\\');
+				val.push_back('r');
+				break;
+			case '\n':
+				val.push_back('\\');
+				val.push_back('n');
+				break;
+			default:
+				val.push_back(ch);
 			}
-
-			script = std::regex_replace(script, std::regex(regex),
-						    val);
 		}
+
+		script = std::regex_replace(script, std::regex(regex),
+					    val);
+	}
 #endif
 
-		/* Spawn move backup to config process */
+	/* Spawn move backup to config process */
 
-		std::string scriptHostExePath =
-			obs_get_module_binary_path(obs_current_module());
-		scriptHostExePath = scriptHostExePath.substr(
-			0, scriptHostExePath.find_last_of('/') + 1);
+	std::string scriptHostExePath =
+		obs_get_module_binary_path(obs_current_module());
+	scriptHostExePath = scriptHostExePath.substr(
+		0, scriptHostExePath.find_last_of('/') + 1);
 #ifdef _WIN32
-		scriptHostExePath +=
-			"obs-browser-streamelements-restore-script-host.exe";
+	scriptHostExePath +=
+		"obs-browser-streamelements-restore-script-host.exe";
 
-		std::transform(scriptHostExePath.begin(),
-			       scriptHostExePath.end(),
-			       scriptHostExePath.begin(),
-			       [](char ch) { return ch == '/' ? '\\' : ch; });
+	std::transform(scriptHostExePath.begin(),
+		       scriptHostExePath.end(),
+		       scriptHostExePath.begin(),
+		       [](char ch) { return ch == '/' ? '\\' : ch; });
 #else
-		scriptHostExePath +=
-			"obs-browser-streamelements-restore-script-host";
+	scriptHostExePath +=
+		"obs-browser-streamelements-restore-script-host";
 #endif
 
-		if (!os_quick_write_utf8_file(scriptPath.c_str(),
-					      script.c_str(), script.size(),
-					      false))
-			return;
-
-		std::string command = "\"";
-		command += scriptHostExePath;
-		command += "\" \"";
-		command += scriptPath;
-		command += "\"";
+	if (!os_quick_write_utf8_file(scriptPath.c_str(),
+				      script.c_str(), script.size(),
+				      false))
+		return false;
 
-		QProcess proc;
-		if (proc.startDetached(QString(command.c_str()))) {
-			success = true;
+	std::string command = "\"";
+	command += scriptHostExePath;
+	command += "\" \"";
+	command += scriptPath;
+	command += "\"";
 
-			/* Cleanup temporary resources */
+	QProcess proc;
+	if (proc.startDetached(QString(command.c_str()))) {
+		/* Cleanup temporary resources */
 
-			StreamElementsGlobalStateManager::GetInstance()
-				->GetCleanupManager()
-				->Clean();
+		StreamElementsGlobalStateManager::GetInstance()
+			->GetCleanupManager()
+			->Clean();
 
-			/* Exit OBS */
+		/* Exit OBS */
 
 #ifdef _WIN32
-			/* This is not the nicest way to terminate our own process,
-			 * yet, given that we are not looking for a clean shutdown
-			 * but will rather overwrite settings files, this is
-			 * acceptable.
-			 *
-			 * It is also likely to overcome any shutdown issues OBS
-			 * might have, and which appear from time to time. We definitely
-			 * do NOT want those attributed to Cloud Restore.
-			 */
-			if (!TerminateProcess(GetCurrentProcess(), 0)) {
-				/* Backup shutdown sequence */
-				QApplication::quit();
-			}
-#else
+		/* This is not the nicest way to terminate our own process,
+		 * yet, given that we are not looking for a clean shutdown
+		 * but will rather overwrite settings files, this is
+		 * acceptable.
+		 *
+		 * It is also likely to overcome any shutdown issues OBS
+		 * might have, and which appear from time to time. We definitely
+		 * do NOT want those attributed to Cloud Restore.
+		 */
+		if (!TerminateProcess(GetCurrentProcess(), 0)) {
+			/* Backup shutdown sequence */
 			QApplication::quit();
-#endif
 		}
+#else
+		QApplication::quit();
+#endif
+	}
+
+	return true;
+}
+
+void StreamElementsBackupManager::RestoreBackupPackageContentAsync(
+	CefRefPtr<CefValue> input, CefRefPtr<CefValue> output,
+	std::function<void()> complete, progress_callback_t progress)
+{
+	output->SetNull();
+
+	/* Never allow restore during streaming or recording */
+	if (obs_frontend_streaming_active() ||
+	    obs_frontend_recording_active()) {
+		complete();
+		return;
+	}
+
+	if (input->GetType() != VTYPE_DICTIONARY) {
+		complete();
+		return;
 	}
 
-	output->SetBool(success);
+	CefRefPtr<CefDictionaryValue> in = input->GetDictionary();
+
+	std::unordered_set<std::string> requestCollections;
+	std::unordered_set<std::string> requestProfiles;
+
+	if (in->HasKey("sceneCollections") &&
+	    in->GetType("sceneCollections") == VTYPE_LIST) {
+		std::vector<std::string> ids;
+
+		ReadListOfIdsFromCefValue(in->GetValue("sceneCollections"),
+					  ids);
+
+		requestCollections.insert(ids.begin(), ids.end());
+	}
+
+	if (in->HasKey("profiles") && in->GetType("profiles") == VTYPE_LIST) {
+		std::vector<std::string> ids;
+
+		ReadListOfIdsFromCefValue(in->GetValue("profiles"), ids);
+
+		requestProfiles.insert(ids.begin(), ids.end());
+	}
+
+	if (!in->HasKey("url") || in->GetType("url") != VTYPE_STRING) {
+		complete();
+		return;
+	}
+
+	std::string url = in->GetString("url").ToString();
+
+	std::string extractPath;
+
+	if (!GetTemporaryFilePath("obs-live-restore-content", extractPath)) {
+		complete();
+		return;
+	}
+
+	StreamElementsGlobalStateManager::GetInstance()
+		->GetCleanupManager()
+		->AddPath(extractPath);
+
+	std::string extractRootPath = extractPath + ".dir";
+
+	extractPath = extractRootPath + "\\obs-studio";
+
+	char *basePathPtr = os_get_config_path_ptr("obs-studio");
+	std::string destBasePath = basePathPtr;
+	bfree(basePathPtr);
+
+	GetLocalPathFromURLAsync(url, [=](bool downloaded,
+					  std::string localPath) {
+		if (!downloaded) {
+			complete();
+			return;
+		}
+
+		/* Reading, extracting and rewriting the package runs on the
+		 * worker, while progress, the result and the final restart
+		 * step are delivered on the Qt main thread */
+		m_taskQueue.Enqueue([=]() {
+			SE_TRACE_SCOPE("backup",
+				       "RestoreBackupPackageContent");
+
+			bool success = MKDIR_ERROR !=
+				       os_mkdirs(extractPath.c_str());
+
+			std::shared_ptr<const backup_package_index> index;
+
+			if (success) {
+				index = read_backup_package_index(
+					localPath);
+				success = !!index;
+			}
+
+			if (success)
+				success = extract_backup_package(
+					*index, extractPath, requestProfiles,
+					requestCollections,
+					[progress](size_t completedEntries,
+						   size_t totalEntries,
+						   uint64_t completedBytes,
+						   uint64_t totalBytes) {
+						if (!progress)
+							return;
+
+						QtPostTask([=]() {
+							progress(
+								completedEntries,
+								totalEntries,
+								completedBytes,
+								totalBytes);
+						});
+					});
+
+			/* Replace file monikers for Scene Collections */
+			bool monikersReplaced =
+				success &&
+				ScanForFileReferencesMonikersToRestore(
+					extractPath, destBasePath);
+
+			QtPostTask([=]() {
+				if (success &&
+				    (!monikersReplaced ||
+				     SpawnRestoreScriptAndExit(
+					     extractPath, extractRootPath,
+					     destBasePath)))
+					output->SetBool(true);
+
+				complete();
+			});
+		});
+	});
 }
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "cef-headers.hpp"
+#include "StreamElementsAsyncTaskQueue.hpp"
 #include <mutex>
+#include <functional>
 
 class StreamElementsBackupManager
 {
@@ -9,16 +11,31 @@ public:
 	StreamElementsBackupManager();
 	~StreamElementsBackupManager();
 
+public:
+	typedef std::function<void(size_t completedEntries, size_t totalEntries,
+				   unsigned long long completedBytes,
+				   unsigned long long totalBytes)>
+		progress_callback_t;
+
 public:
 	void CreateLocalBackupPackage(CefRefPtr<CefValue> input,
 					 CefRefPtr<CefValue> &output);
 
-	void QueryBackupPackageContent(CefRefPtr<CefValue> input,
-				       CefRefPtr<CefValue> &output);
+	/* Query and restore read the package on a worker thread. output is
+	 * set and complete is called on the Qt main thread once done, and
+	 * restore progress is reported on the Qt main thread as well.
+	 */
+	void QueryBackupPackageContentAsync(CefRefPtr<CefValue> input,
+					    CefRefPtr<CefValue> output,
+					    std::function<void()> complete);
 
-	void RestoreBackupPackageContent(CefRefPtr<CefValue> input,
-					 CefRefPtr<CefValue> &output);
+	void RestoreBackupPackageContentAsync(
+		CefRefPtr<CefValue> input, CefRefPtr<CefValue> output,
+		std::function<void()> complete,
+		progress_callback_t progress = nullptr);
 
 private:
 	std::recursive_mutex m_mutex;
+	StreamElementsAsyncTaskQueue m_taskQueue = {
+		"StreamElementsBackupManager: package"};
 };
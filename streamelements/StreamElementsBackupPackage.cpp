@@ -0,0 +1,395 @@
+#include "StreamElementsBackupPackage.hpp"
+#include "StreamElementsTracer.hpp"
+
+#include "deps/zip/zip.h"
+
+#define MINIZ_HEADER_FILE_ONLY
+#include "deps/zip/miniz.h"
+
+#include <util/platform.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <codecvt>
+#include <locale>
+#else
+#include <unistd.h>
+#endif
+
+#define BACKUP_PACKAGE_MAX_WORKERS 4
+
+static const char PROFILES_PREFIX[] = "basic/profiles/";
+static const char COLLECTIONS_PREFIX[] = "basic/scenes/";
+static const char PROFILE_SUFFIX[] = "/basic.ini";
+static const char COLLECTION_SUFFIX[] = ".json";
+
+static bool starts_with(const std::string &str, const char *prefix,
+			size_t len)
+{
+	return str.size() >= len && 0 == str.compare(0, len, prefix);
+}
+
+static bool ends_with(const std::string &str, const char *suffix, size_t len)
+{
+	return str.size() >= len &&
+	       0 == str.compare(str.size() - len, len, suffix);
+}
+
+// basic/profiles/<id>/basic.ini
+static bool get_profile_id(const std::string &name, std::string &id)
+{
+	const size_t prefix_len = sizeof(PROFILES_PREFIX) - 1;
+	const size_t suffix_len = sizeof(PROFILE_SUFFIX) - 1;
+
+	if (name.size() <= prefix_len + suffix_len ||
+	    !starts_with(name, PROFILES_PREFIX, prefix_len) ||
+	    !ends_with(name, PROFILE_SUFFIX, suffix_len))
+		return false;
+
+	id = name.substr(prefix_len, name.size() - prefix_len - suffix_len);
+	return true;
+}
+
+// basic/scenes/<id>.json
+static bool get_collection_id(const std::string &name, std::string &id)
+{
+	const size_t prefix_len = sizeof(COLLECTIONS_PREFIX) - 1;
+	const size_t suffix_len = sizeof(COLLECTION_SUFFIX) - 1;
+
+	if (name.size() <= prefix_len + suffix_len ||
+	    !starts_with(name, COLLECTIONS_PREFIX, prefix_len) ||
+	    !ends_with(name, COLLECTION_SUFFIX, suffix_len))
+		return false;
+
+	id = name.substr(prefix_len, name.size() - prefix_len - suffix_len);
+	return true;
+}
+
+static std::mutex s_cache_mutex;
+static std::shared_ptr<const backup_package_index> s_cache;
+
+std::shared_ptr<const backup_package_index>
+read_backup_package_index(const std::string &path)
+{
+	struct stat st;
+
+	if (0 != os_stat(path.c_str(), &st))
+		return nullptr;
+
+	{
+		std::lock_guard<std::mutex> guard(s_cache_mutex);
+
+		if (s_cache && s_cache->path == path &&
+		    s_cache->file_size == (int64_t)st.st_size &&
+		    s_cache->mtime == (int64_t)st.st_mtime)
+			return s_cache;
+	}
+
+	SE_TRACE_SCOPE("backup", "read_backup_package_index");
+
+	mz_zip_archive archive;
+	memset(&archive, 0, sizeof(archive));
+
+	if (!mz_zip_reader_init_file(&archive, path.c_str(), 0))
+		return nullptr;
+
+	auto index = std::make_shared<backup_package_index>();
+
+	index->path = path;
+	index->file_size = (int64_t)st.st_size;
+	index->mtime = (int64_t)st.st_mtime;
+
+	mz_uint total = mz_zip_reader_get_num_files(&archive);
+	index->entries.reserve(total);
+
+	std::unordered_set<std::string> profiles;
+	std::unordered_set<std::string> collections;
+	std::string id;
+
+	for (mz_uint i = 0; i < total; ++i) {
+		mz_zip_archive_file_stat stat;
+
+		if (!mz_zip_reader_file_stat(&archive, i, &stat)) {
+			mz_zip_reader_end(&archive);
+			return nullptr;
+		}
+
+		backup_package_entry entry;
+
+		entry.index = (int)i;
+		entry.size = stat.m_uncomp_size;
+		entry.is_dir =
+			!!mz_zip_reader_is_file_a_directory(&archive, i);
+
+		// m_filename is truncated to MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE
+		entry.name.resize(
+			mz_zip_reader_get_filename(&archive, i, nullptr, 0));
+		if (!entry.name.empty()) {
+			mz_zip_reader_get_filename(
+				&archive, i, &entry.name[0],
+				(mz_uint)entry.name.size());
+			entry.name.pop_back();
+		}
+
+		std::replace(entry.name.begin(), entry.name.end(), '\\', '/');
+
+		if (get_profile_id(entry.name, id))
+			profiles.insert(id);
+		else if (get_collection_id(entry.name, id))
+			collections.insert(id);
+
+		index->entries.push_back(std::move(entry));
+	}
+
+	mz_zip_reader_end(&archive);
+
+	index->profiles.assign(profiles.begin(), profiles.end());
+	index->collections.assign(collections.begin(), collections.end());
+	std::sort(index->profiles.begin(), index->profiles.end());
+	std::sort(index->collections.begin(), index->collections.end());
+
+	std::lock_guard<std::mutex> guard(s_cache_mutex);
+	s_cache = index;
+
+	return index;
+}
+
+bool is_backup_entry_qualified_for_restore(
+	const std::string &name,
+	const std::unordered_set<std::string> &profiles,
+	const std::unordered_set<std::string> &collections)
+{
+	const size_t prefix_len = sizeof(PROFILES_PREFIX) - 1;
+
+	// basic/profiles/<id>/...
+	if (starts_with(name, PROFILES_PREFIX, prefix_len)) {
+		size_t end = name.find('/', prefix_len);
+
+		if (end != std::string::npos && end > prefix_len) {
+			if (profiles.empty())
+				return true;
+
+			return profiles.count(
+				name.substr(prefix_len, end - prefix_len));
+		}
+	}
+
+	std::string id;
+
+	if (get_collection_id(name, id))
+		return collections.empty() || collections.count(id);
+
+	return true;
+}
+
+struct restore_entry {
+	int index;
+	std::string dest_path;
+	uint64_t size;
+};
+
+static int open_file_for_restore(const std::string &path)
+{
+#ifdef _WIN32
+	std::wstring_convert<std::codecvt_utf8<wchar_t>> myconv;
+
+	return _wopen(myconv.from_bytes(path).c_str(),
+		      _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+		      _S_IREAD | _S_IWRITE);
+#else
+	return open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+		    S_IRUSR | S_IWUSR);
+#endif
+}
+
+static size_t write_extracted_data(void *arg, unsigned long long offset,
+				   const void *data, size_t size)
+{
+	(void)offset;
+
+	int fd = *(int *)arg;
+
+	return write(fd, data, (unsigned int)size);
+}
+
+// Extracts a single entry to a temporary file next to its destination and
+// renames it into place once it was written completely, so a failed or
+// interrupted restore never leaves a truncated file behind.
+static bool extract_entry(struct zip_t *zip, const restore_entry &entry)
+{
+	SE_TRACE_SCOPE("backup", "extract_entry");
+
+	if (0 != zip_entry_openbyindex(zip, entry.index))
+		return false;
+
+	std::string temp_path = entry.dest_path + ".restore-tmp";
+
+	bool success = false;
+
+	int fd = open_file_for_restore(temp_path);
+
+	if (-1 != fd) {
+		success = 0 == zip_entry_extract(zip, write_extracted_data,
+						 &fd);
+
+		close(fd);
+
+		if (success)
+			success = 0 == os_rename(temp_path.c_str(),
+						 entry.dest_path.c_str());
+
+		if (!success)
+			os_unlink(temp_path.c_str());
+	}
+
+	zip_entry_close(zip);
+
+	return success;
+}
+
+static bool extract_entries_parallel(const std::string &zip_path,
+				     const std::vector<restore_entry> &entries,
+				     backup_package_progress_t progress)
+{
+	if (entries.empty())
+		return true;
+
+	SE_TRACE_SCOPE("backup", "extract_entries_parallel");
+
+	uint64_t total_bytes = 0;
+	for (auto &entry : entries)
+		total_bytes += entry.size;
+
+	size_t worker_count = std::thread::hardware_concurrency();
+	if (worker_count < 1)
+		worker_count = 1;
+	if (worker_count > BACKUP_PACKAGE_MAX_WORKERS)
+		worker_count = BACKUP_PACKAGE_MAX_WORKERS;
+	if (worker_count > entries.size())
+		worker_count = entries.size();
+
+	std::atomic<size_t> next_entry(0);
+	std::atomic<size_t> completed_entries(0);
+	std::atomic<uint64_t> completed_bytes(0);
+	std::atomic<bool> success(true);
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	size_t active_workers = worker_count;
+
+	std::vector<std::thread> workers;
+
+	for (size_t i = 0; i < worker_count; ++i) {
+		workers.push_back(std::thread([&]() {
+			// miniz readers share a single file handle and seek
+			// position: each worker needs its own
+			struct zip_t *zip = zip_open(zip_path.c_str(), 0, 'r');
+
+			if (!zip)
+				success = false;
+
+			while (zip && success) {
+				size_t index = next_entry++;
+
+				if (index >= entries.size())
+					break;
+
+				if (!extract_entry(zip, entries[index])) {
+					success = false;
+					break;
+				}
+
+				completed_bytes += entries[index].size;
+				++completed_entries;
+			}
+
+			if (zip)
+				zip_close(zip);
+
+			std::lock_guard<std::mutex> guard(mutex);
+			--active_workers;
+			cv.notify_all();
+		}));
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (active_workers) {
+			cv.wait_for(lock, std::chrono::milliseconds(250));
+
+			if (progress && active_workers)
+				progress(completed_entries, entries.size(),
+					 completed_bytes, total_bytes);
+		}
+	}
+
+	for (auto &worker : workers)
+		worker.join();
+
+	if (progress)
+		progress(completed_entries, entries.size(), completed_bytes,
+			 total_bytes);
+
+	return success;
+}
+
+static std::string get_folder_path(const std::string &path)
+{
+	size_t pos = path.find_last_of("/\\");
+
+	return pos == std::string::npos ? std::string() : path.substr(0, pos);
+}
+
+bool extract_backup_package(const backup_package_index &index,
+			    const std::string &extract_path,
+			    const std::unordered_set<std::string> &profiles,
+			    const std::unordered_set<std::string> &collections,
+			    backup_package_progress_t progress)
+{
+	SE_TRACE_SCOPE("backup", "extract_backup_package");
+
+	// Collect qualified entries and create their output directories
+	// before extraction starts
+	std::vector<restore_entry> entries;
+	std::unordered_set<std::string> created_dirs;
+
+	for (auto &item : index.entries) {
+		if (item.is_dir ||
+		    !is_backup_entry_qualified_for_restore(item.name, profiles,
+							   collections))
+			continue;
+
+		restore_entry entry;
+
+		entry.index = item.index;
+		entry.size = item.size;
+		entry.dest_path = extract_path + "/" + item.name;
+
+#ifdef _WIN32
+		std::replace(entry.dest_path.begin(), entry.dest_path.end(),
+			     '/', '\\');
+#endif
+
+		std::string dir = get_folder_path(entry.dest_path);
+
+		if (created_dirs.insert(dir).second &&
+		    MKDIR_ERROR == os_mkdirs(dir.c_str()))
+			return false;
+
+		entries.push_back(std::move(entry));
+	}
+
+	return extract_entries_parallel(index.path, entries, progress);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Reading side of backup packages created by StreamElementsBackupManager.
+// Nothing here depends on CEF, Qt or the frontend API, so it is safe to run
+// on worker threads.
+
+struct backup_package_entry {
+	int index;
+	std::string name; // forward slashes, like zip_entry_name()
+	uint64_t size;
+	bool is_dir;
+};
+
+struct backup_package_index {
+	std::string path;
+	int64_t file_size;
+	int64_t mtime;
+
+	std::vector<backup_package_entry> entries;
+
+	// Profile and scene collection ids found in the package, sorted
+	std::vector<std::string> profiles;
+	std::vector<std::string> collections;
+};
+
+typedef std::function<void(size_t completed_entries, size_t total_entries,
+			   uint64_t completed_bytes, uint64_t total_bytes)>
+	backup_package_progress_t;
+
+// Reads the central directory of the package at path. The last index read
+// is cached by path, size and modification time: querying a package and
+// then restoring it reads its central directory once.
+//
+// Returns nullptr if the package could not be read.
+//
+std::shared_ptr<const backup_package_index>
+read_backup_package_index(const std::string &path);
+
+// Returns true if the entry belongs in a restore of the requested profiles
+// and scene collections. An empty set requests all of its kind. Entries
+// which are neither profiles nor scene collections are always restored.
+//
+bool is_backup_entry_qualified_for_restore(
+	const std::string &name,
+	const std::unordered_set<std::string> &profiles,
+	const std::unordered_set<std::string> &collections);
+
+// Extracts the qualified entries of the package under extract_path. Output
+// directories are created up front, then entries are extracted by a small
+// pool of workers, each to a temporary file which is renamed into place
+// once written completely. progress is called on the calling thread about
+// every 250 ms while extraction runs, and once more when it is done.
+//
+// Returns false if any entry could not be extracted.
+//
+bool extract_backup_package(const backup_package_index &index,
+			    const std::string &extract_path,
+			    const std::unordered_set<std::string> &profiles,
+			    const std::unordered_set<std::string> &collections,
+			    backup_package_progress_t progress);
@@ -1,15 +1,9 @@
 #include "StreamElementsBandwidthTestClient.hpp"
 
-#include <thread>
+#include <algorithm>
 
 StreamElementsBandwidthTestClient::StreamElementsBandwidthTestClient()
-	//: m_taskQueue("StreamElementsBandwidthTestClient task queue")
 {
-	os_event_init(&m_event_state_changed, OS_EVENT_TYPE_AUTO);
-	os_event_init(&m_event_async_done, OS_EVENT_TYPE_MANUAL);
-
-	// Initially done
-	os_event_signal(m_event_async_done);
 }
 
 
@@ -17,66 +11,58 @@ StreamElementsBandwidthTestClient::~StreamElementsBandwidthTestClient()
 {
 	CancelAll();
 
-	os_event_destroy(m_event_async_done);
-	os_event_destroy(m_event_state_changed);
+	std::lock_guard<std::mutex> guard(m_session_mutex);
+
+	if (m_session_thread.joinable()) {
+		m_session_thread.join();
+	}
 }
 
 void StreamElementsBandwidthTestClient::TestServerBitsPerSecond(
-	const char* serverUrl,
-	const char* streamKey,
+	const Server& server,
 	const int maxBitrateBitsPerSecond,
 	const char* bindToIP,
 	const int durationSeconds,
-	const bool useAuth,
-	const char* const authUsername,
-	const char* const authPassword,
+	obs_encoder_t* vencoder,
+	obs_encoder_t* aencoder,
 	StreamElementsBandwidthTestClient::Result* result)
 {
-	result->serverUrl = serverUrl;
-	result->streamKey = streamKey;
+	result->serverUrl = server.url;
+	result->streamKey = server.streamKey;
 
-	m_state = Running;
-	os_event_reset(m_event_state_changed);
+	if (m_cancelled) {
+		result->cancelled = true;
 
-	obs_encoder_t* vencoder = obs_video_encoder_create("obs_x264", "test_x264", nullptr, nullptr);
-	obs_encoder_t* aencoder = obs_audio_encoder_create("ffmpeg_aac", "test_aac", nullptr, 0, nullptr);
-	obs_service_t* service = obs_service_create("rtmp_custom", "test_service", nullptr, nullptr);
-
-	obs_data_t* service_settings = obs_data_create();
-
-	// Configure video encoder
-	obs_data_t* vencoder_settings = obs_data_create();
-
-	obs_data_set_int(vencoder_settings, "bitrate", (int)(maxBitrateBitsPerSecond / 1000L));
-	obs_data_set_string(vencoder_settings, "rate_control", "CBR");
-	obs_data_set_string(vencoder_settings, "preset", "veryfast");
-	obs_data_set_int(vencoder_settings, "keyint_sec", 2);
-
-	obs_encoder_update(vencoder, vencoder_settings);
+		return;
+	}
 
-	obs_encoder_set_video(vencoder, obs_get_video());
+	TestState test;
 
-	// Configure audio encoder
-	obs_data_t* aencoder_settings = obs_data_create();
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
 
-	obs_data_set_int(aencoder_settings, "bitrate", 128);
+		m_active_tests.push_back(&test);
+	}
 
-	obs_encoder_update(aencoder, aencoder_settings);
+	obs_service_t* service = obs_service_create("rtmp_custom", "test_service", nullptr, nullptr);
 
-	obs_encoder_set_audio(aencoder, obs_get_audio());
+	obs_data_t* service_settings = obs_data_create();
 
 	// Configure service
 
 	obs_data_set_string(service_settings, "service", "rtmp_custom");
-	obs_data_set_string(service_settings, "server", serverUrl);
-	obs_data_set_string(service_settings, "key", streamKey);
+	obs_data_set_string(service_settings, "server", server.url.c_str());
+	obs_data_set_string(service_settings, "key", server.streamKey.c_str());
 
-	obs_data_set_bool(service_settings, "use_auth", useAuth);
-	obs_data_set_string(service_settings, "username", authUsername ? authUsername : "");
-	obs_data_set_string(service_settings, "password", authPassword ? authPassword : "");
+	obs_data_set_bool(service_settings, "use_auth", server.useAuth);
+	obs_data_set_string(service_settings, "username", server.authUsername.c_str());
+	obs_data_set_string(service_settings, "password", server.authPassword.c_str());
 
 	obs_service_update(service, service_settings);
-	obs_service_apply_encoder_settings(service, vencoder_settings, aencoder_settings);
+
+	// Encoders are shared by all concurrent tests, and rtmp_custom does
+	// not alter encoder settings: obs_service_apply_encoder_settings()
+	// is not called here.
 
 	// Configure output
 
@@ -104,35 +90,35 @@ void StreamElementsBandwidthTestClient::TestServerBitsPerSecond(
 
 	auto on_started = [](void* data, calldata_t*)
 	{
-		StreamElementsBandwidthTestClient* self = (StreamElementsBandwidthTestClient*)data;
+		TestState* test = (TestState*)data;
 
-		self->set_state(Running);
+		test->set_state(Running);
 	};
 
 	auto on_stopped = [](void* data, calldata_t*)
 	{
-		StreamElementsBandwidthTestClient* self = (StreamElementsBandwidthTestClient*)data;
+		TestState* test = (TestState*)data;
 
-		self->set_state(Stopped);
+		test->set_state(Stopped);
 	};
 
 	signal_handler *output_signal_handler = obs_output_get_signal_handler(output);
-	signal_handler_connect(output_signal_handler, "start", on_started, this);
-	signal_handler_connect(output_signal_handler, "stop", on_stopped, this);
+	signal_handler_connect(output_signal_handler, "start", on_started, &test);
+	signal_handler_connect(output_signal_handler, "stop", on_stopped, &test);
 
 	// Start testing
 
 	if (obs_output_start(output))
 	{
-		wait_state_changed();
+		test.wait_state_changed();
 
-		if (m_state == Running)
+		if (test.state == Running && !m_cancelled)
 		{
 			// ignore first WARMUP_DURATION_MS due to possible buffering skewing
 			// the result
-			wait_state_changed(WARMUP_DURATION_MS);
+			test.wait_state_changed(WARMUP_DURATION_MS);
 
-			if (m_state == Running)
+			if (test.state == Running && !m_cancelled)
 			{
 				// Test bandwidth
 
@@ -140,16 +126,20 @@ void StreamElementsBandwidthTestClient::TestServerBitsPerSecond(
 				uint64_t start_bytes = obs_output_get_total_bytes(output);
 				uint64_t start_time_ns = os_gettime_ns();
 
-				wait_state_changed((unsigned long)durationSeconds * 1000L);
+				test.wait_state_changed((unsigned long)durationSeconds * 1000L);
 
-				if (m_state == Running)
+				if (test.state == Running && !m_cancelled)
 				{
 					// Still running
 					obs_output_stop(output);
 
 					// Wait for stopped
-					wait_state_changed();
+					while (test.state == Running && !m_cancelled)
+						test.wait_state_changed();
+				}
 
+				if (test.state == Stopped && !m_cancelled)
+				{
 					// Get end metrics
 					uint64_t end_bytes = obs_output_get_total_bytes(output);
 					uint64_t end_time_ns = os_gettime_ns();
@@ -159,10 +149,10 @@ void StreamElementsBandwidthTestClient::TestServerBitsPerSecond(
 					uint64_t total_time_ns = end_time_ns - start_time_ns;
 
 					uint64_t total_bits = total_bytes * 8L;
-					uint64_t total_time_seconds = total_time_ns / 1000000000L;
 
 					result->connectTimeMilliseconds = obs_output_get_connect_time_ms(output);
-					result->bitsPerSecond = total_bits / total_time_seconds;
+					result->bitsPerSecond = total_time_ns ?
+						(uint64_t)((double)total_bits * 1000000000.0 / (double)total_time_ns) : 0L;
 
 					if (obs_output_get_frames_dropped(output))
 					{
@@ -189,17 +179,25 @@ void StreamElementsBandwidthTestClient::TestServerBitsPerSecond(
 
 	if (!result->success)
 	{
-		if (m_state == Cancelled) {
+		if (m_cancelled) {
 			result->cancelled = true;
 
 			obs_output_force_stop(output);
 
-			wait_state_changed();
+			while (test.state == Running)
+				test.wait_state_changed();
 		}
 	}
 
-	signal_handler_disconnect(output_signal_handler, "start", on_started, this);
-	signal_handler_disconnect(output_signal_handler, "stop", on_stopped, this);
+	signal_handler_disconnect(output_signal_handler, "start", on_started, &test);
+	signal_handler_disconnect(output_signal_handler, "stop", on_stopped, &test);
+
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		m_active_tests.erase(std::remove(m_active_tests.begin(), m_active_tests.end(), &test),
+			m_active_tests.end());
+	}
 
 	///
 	// This part is copied as-is with minor modifications from
@@ -218,13 +216,125 @@ void StreamElementsBandwidthTestClient::TestServerBitsPerSecond(
 	//
 	//obs_output_release(output);
 	//obs_service_release(service);
-	//obs_encoder_release(vencoder);
-	//obs_encoder_release(aencoder);
 
 	obs_data_release(output_settings);
 	obs_data_release(service_settings);
-	obs_data_release(vencoder_settings);
-	obs_data_release(aencoder_settings);
+}
+
+void StreamElementsBandwidthTestClient::StartSession(
+	std::vector<Server> servers,
+	const int maxBitrateBitsPerSecond,
+	std::string bindToIP,
+	const int durationSeconds,
+	const int maxConcurrentTests,
+	progress_func_t progress,
+	done_func_t done)
+{
+	std::lock_guard<std::mutex> guard(m_session_mutex);
+
+	// Previous session has completed or was cancelled, but was not
+	// joined yet
+	if (m_session_thread.joinable()) {
+		m_session_thread.join();
+	}
+
+	m_cancelled = false;
+
+	m_session_thread = std::thread([=]() {
+		// Shared test-pattern encode, fanned out to all outputs
+		obs_encoder_t* vencoder = obs_video_encoder_create("obs_x264", "test_x264", nullptr, nullptr);
+		obs_encoder_t* aencoder = obs_audio_encoder_create("ffmpeg_aac", "test_aac", nullptr, 0, nullptr);
+
+		// Configure video encoder
+		obs_data_t* vencoder_settings = obs_data_create();
+
+		obs_data_set_int(vencoder_settings, "bitrate", (int)(maxBitrateBitsPerSecond / 1000L));
+		obs_data_set_string(vencoder_settings, "rate_control", "CBR");
+		obs_data_set_string(vencoder_settings, "preset", "veryfast");
+		obs_data_set_int(vencoder_settings, "keyint_sec", 2);
+
+		obs_encoder_update(vencoder, vencoder_settings);
+
+		obs_encoder_set_video(vencoder, obs_get_video());
+
+		// Configure audio encoder
+		obs_data_t* aencoder_settings = obs_data_create();
+
+		obs_data_set_int(aencoder_settings, "bitrate", 128);
+
+		obs_encoder_update(aencoder, aencoder_settings);
+
+		obs_encoder_set_audio(aencoder, obs_get_audio());
+
+		std::mutex results_mutex;
+		std::vector<Result> results(servers.size());
+		std::vector<bool> completed(servers.size(), false);
+		std::vector<Result> completed_results;
+		std::atomic<size_t> next_index(0);
+
+		auto test_proc = [&]() {
+			for (size_t index = next_index++;
+				index < servers.size() && !m_cancelled;
+				index = next_index++)
+			{
+				Result result;
+
+				TestServerBitsPerSecond(
+					servers[index],
+					maxBitrateBitsPerSecond,
+					bindToIP.empty() ? nullptr : bindToIP.c_str(),
+					durationSeconds,
+					vencoder,
+					aencoder,
+					&result);
+
+				if (result.cancelled)
+					break;
+
+				std::lock_guard<std::mutex> guard(results_mutex);
+
+				results[index] = result;
+				completed[index] = true;
+				completed_results.push_back(result);
+
+				if (progress) {
+					progress(completed_results);
+				}
+			}
+		};
+
+		size_t worker_count = std::min(
+			(size_t)std::max(maxConcurrentTests, 1), servers.size());
+
+		std::vector<std::thread> workers;
+
+		for (size_t i = 1; i < worker_count; ++i) {
+			workers.emplace_back(test_proc);
+		}
+
+		test_proc();
+
+		for (auto& worker : workers) {
+			worker.join();
+		}
+
+		std::vector<Result> ordered_results;
+
+		for (size_t i = 0; i < results.size(); ++i) {
+			if (completed[i]) {
+				ordered_results.push_back(results[i]);
+			}
+		}
+
+		// See the comment at the end of TestServerBitsPerSecond()
+		//obs_encoder_release(vencoder);
+		//obs_encoder_release(aencoder);
+
+		obs_data_release(vencoder_settings);
+		obs_data_release(aencoder_settings);
+
+		done(ordered_results);
+	});
 }
 
 void StreamElementsBandwidthTestClient::TestServerBitsPerSecondAsync(
@@ -239,81 +349,52 @@ void StreamElementsBandwidthTestClient::TestServerBitsPerSecondAsync(
 	const TestServerBitsPerSecondAsyncCallback callback,
 	void* const data)
 {
-	assert(!m_async_busy);
 	assert(serverUrl);
 	assert(streamKey);
 	assert(maxBitrateBitsPerSecond > 0);
 	assert(durationSeconds > 0);
 	assert(callback);
 
-	// Not done
-	os_event_reset(m_event_async_done);
-
-	struct local_context {
-		StreamElementsBandwidthTestClient* self;
-		std::string serverUrl;
-		std::string streamKey;
-		bool useAuth;
-		std::string authUsername;
-		std::string authPassword;
-		int maxBitrateBitsPerSecond;
-		std::string bindToIP;
-		int durationSeconds;
-		TestServerBitsPerSecondAsyncCallback callback;
-		void* data;
-	};
-
-	local_context* context = new local_context();
-
-	context->self = this;
-	context->serverUrl = serverUrl;
-	context->streamKey = streamKey;
-	context->useAuth = useAuth;
-	context->authUsername = authUsername != nullptr ? authUsername : "";
-	context->authPassword = authPassword != nullptr ? authPassword : "";
-	context->maxBitrateBitsPerSecond = maxBitrateBitsPerSecond;
-
-	if (bindToIP) {
-		context->bindToIP = bindToIP;
-	}
-
-	context->durationSeconds = durationSeconds;
-	context->callback = callback;
-	context->data = data;
-
-	context->self->m_async_busy = true;
-
-	std::thread thread([=]() {
-		Result result;
-
-		context->self->TestServerBitsPerSecond(
-			context->serverUrl.c_str(),
-			context->streamKey.c_str(),
-			context->maxBitrateBitsPerSecond,
-			context->bindToIP.empty() ? nullptr : context->bindToIP.c_str(),
-			context->durationSeconds,
-			context->useAuth,
-			context->authUsername.c_str(),
-			context->authPassword.c_str(),
-			&result);
-
-		context->callback(&result, context->data);
-
-		context->self->m_async_busy = false;
-
-		os_event_signal(context->self->m_event_async_done);
+	std::vector<Server> servers;
+	servers.push_back(Server(serverUrl, streamKey, useAuth, authUsername,
+		authPassword));
+
+	std::string serverUrlCopy = serverUrl;
+	std::string streamKeyCopy = streamKey;
+
+	StartSession(
+		servers,
+		maxBitrateBitsPerSecond,
+		bindToIP ? bindToIP : "",
+		durationSeconds,
+		1,
+		nullptr,
+		[callback, data, serverUrlCopy, streamKeyCopy](std::vector<Result>& results) {
+			Result result;
+
+			if (results.size()) {
+				result = results[0];
+			} else {
+				result.serverUrl = serverUrlCopy;
+				result.streamKey = streamKeyCopy;
+				result.cancelled = true;
+			}
 
-		delete context;
-	});
-	thread.detach();
+			callback(&result, data);
+		});
 }
 
 void StreamElementsBandwidthTestClient::CancelAll()
 {
-	set_state(Cancelled);
+	// Only signal: the session thread winds down on its own and is
+	// joined by the next StartSession() or by the destructor, so the
+	// caller is not blocked while running tests stop
+	m_cancelled = true;
+
+	std::lock_guard<std::mutex> guard(m_mutex);
 
-	if (m_async_busy) {
-		os_event_wait(m_event_async_done);
+	for (auto test : m_active_tests) {
+		test->signal_state_changed();
 	}
 }
 
@@ -324,67 +405,25 @@ void StreamElementsBandwidthTestClient::TestMultipleServersBitsPerSecondAsync(
 	const int durationSeconds,
 	const TestMultipleServersBitsPerSecondAsyncCallback progress_callback,
 	const TestMultipleServersBitsPerSecondAsyncCallback callback,
-	void* const data)
+	void* const data,
+	const int maxConcurrentTests)
 {
-	struct local_context {
-		StreamElementsBandwidthTestClient* self;
-		TestMultipleServersBitsPerSecondAsyncCallback callback;
-		void* data;
-		std::vector<Server> servers;
-		std::vector<Result> results;
-
-		int maxBitrateBitsPerSecond;
-		std::string bindToIP;
-		int durationSeconds;
-	};
-
-	local_context* context = new local_context();
+	progress_func_t progress = nullptr;
 
-	context->self = this;
-	context->callback = callback;
-	context->data = data;
-	context->servers = servers;
-
-	if (bindToIP) {
-		context->bindToIP = bindToIP;
+	if (progress_callback) {
+		progress = [progress_callback, data](std::vector<Result>& completed) {
+			progress_callback(&completed, data);
+		};
 	}
 
-	context->maxBitrateBitsPerSecond = maxBitrateBitsPerSecond;
-	context->durationSeconds = durationSeconds;
-
-	context->self->m_async_busy = true;
-
-	std::thread worker = std::thread([=]() {
-		for (int i = 0; i < context->servers.size(); ++i) {
-			Result testResult;
-
-			TestServerBitsPerSecond(
-				context->servers[i].url.c_str(),
-				context->servers[i].streamKey.c_str(),
-				context->maxBitrateBitsPerSecond,
-				context->bindToIP.empty() ? nullptr : context->bindToIP.c_str(),
-				context->durationSeconds,
-				false,
-				nullptr,
-				nullptr,
-				&testResult);
-
-			if (testResult.cancelled)
-				break;
-
-			context->results.push_back(testResult);
-
-			if (progress_callback) {
-				progress_callback(&context->results, context->data);
-			}
-		}
-
-		context->callback(&context->results, context->data);
-
-		context->self->m_async_busy = false;
-
-		delete context;
-	});
-
-	worker.detach();
+	StartSession(
+		servers,
+		maxBitrateBitsPerSecond,
+		bindToIP ? bindToIP : "",
+		durationSeconds,
+		maxConcurrentTests,
+		progress,
+		[callback, data](std::vector<Result>& results) {
+			callback(&results, data);
+		});
 }
@@ -4,6 +4,10 @@
 
 #include <string>
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 #include <obs.h>
 #include <util/platform.h>
@@ -67,20 +71,34 @@ private:
 private:
 	enum state_enum {
 		Running = 0,
-		Stopped = 1,
-		Cancelled = 2
+		Stopped = 1
 	};
 
-	os_event_t* m_event_state_changed;
-	os_event_t* m_event_async_done;
-	state_enum m_state = Stopped;
-	bool m_async_busy = false;
+	///
+	// State of a single server test, one per output
+	//
+	class TestState
+	{
+	public:
+		os_event_t* event_state_changed;
+		std::atomic<int> state;
 
-private:
-	void wait_state_changed() { os_event_wait(m_event_state_changed); }
-	void wait_state_changed(unsigned long milliseconds) { os_event_timedwait(m_event_state_changed, milliseconds); }
-	void signal_state_changed() { os_event_signal(m_event_state_changed); }
-	void set_state(const state_enum new_state) { m_state = new_state; signal_state_changed(); }
+		TestState() : state(Stopped) { os_event_init(&event_state_changed, OS_EVENT_TYPE_AUTO); }
+		~TestState() { os_event_destroy(event_state_changed); }
+
+		void wait_state_changed() { os_event_wait(event_state_changed); }
+		void wait_state_changed(unsigned long milliseconds) { os_event_timedwait(event_state_changed, milliseconds); }
+		void signal_state_changed() { os_event_signal(event_state_changed); }
+		void set_state(const state_enum new_state) { state = new_state; signal_state_changed(); }
+	};
+
+	std::mutex m_mutex;
+	std::vector<TestState*> m_active_tests;
+	std::atomic<bool> m_cancelled = { false };
+
+	// Runs a test session, joined by the next session and the destructor
+	std::mutex m_session_mutex;
+	std::thread m_session_thread;
 
 public:
 	typedef void(*TestServerBitsPerSecondAsyncCallback)(Result*, void*);
@@ -101,6 +119,19 @@ public:
 		const TestServerBitsPerSecondAsyncCallback callback,
 		void* const data);
 
+	///
+	// Test multiple servers, up to maxConcurrentTests at a time.
+	//
+	// All concurrent tests share a single video and audio encoder whose
+	// output is fanned out to one rtmp output per server.
+	//
+	// progress_callback is called as each server test completes, with
+	// the results completed so far in completion order. callback is
+	// called once with the results of completed tests in server order.
+	//
+	// Both callbacks run on the session thread, which the destructor
+	// joins: they must not delete this client.
+	//
 	void TestMultipleServersBitsPerSecondAsync(
 		std::vector<Server> servers,
 		const int maxBitrateBitsPerSecond,
@@ -108,19 +139,30 @@ public:
 		const int durationSeconds,
 		const TestMultipleServersBitsPerSecondAsyncCallback progress_callback,
 		const TestMultipleServersBitsPerSecondAsyncCallback callback,
-		void* const data);
+		void* const data,
+		const int maxConcurrentTests = 1);
 
 	void CancelAll();
 
 private:
+	typedef std::function<void(std::vector<Result>& completed)> progress_func_t;
+	typedef std::function<void(std::vector<Result>& results)> done_func_t;
+
+	void StartSession(
+		std::vector<Server> servers,
+		const int maxBitrateBitsPerSecond,
+		std::string bindToIP,
+		const int durationSeconds,
+		const int maxConcurrentTests,
+		progress_func_t progress,
+		done_func_t done);
+
 	void TestServerBitsPerSecond(
-		const char* serverUrl,
-		const char* streamKey,
+		const Server& server,
 		const int maxBitrateBitsPerSecond,
 		const char* bindToIP,
 		const int durationSeconds,
-		const bool useAuth,
-		const char* const authUsername,
-		const char* const authPassword,
+		obs_encoder_t* vencoder,
+		obs_encoder_t* aencoder,
 		StreamElementsBandwidthTestClient::Result* result);
 };
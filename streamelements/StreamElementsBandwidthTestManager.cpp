@@ -12,6 +12,21 @@ static void DispatchJSEvent(CefRefPtr<CefBrowser> browser, const char *eventName
 	SendBrowserProcessMessage(browser, PID_RENDERER, msg);
 }
 
+static CefRefPtr<CefValue> SerializeTestResult(const StreamElementsBandwidthTestClient::Result& testResult)
+{
+	CefRefPtr<CefValue> itemValue = CefValue::Create();
+	CefRefPtr<CefDictionaryValue> item = CefDictionaryValue::Create();
+	itemValue->SetDictionary(item);
+
+	item->SetBool("success", testResult.success);
+	item->SetBool("wasCancelled", testResult.cancelled);
+	item->SetString("serverUrl", testResult.serverUrl);
+	item->SetString("streamKey", testResult.streamKey);
+	item->SetInt("connectTimeMilliseconds", testResult.connectTimeMilliseconds);
+
+	return itemValue;
+}
+
 StreamElementsBandwidthTestManager::StreamElementsBandwidthTestManager()
 {
 	m_isTestInProgress = false;
@@ -40,6 +55,12 @@ bool StreamElementsBandwidthTestManager::BeginBandwidthTest(CefRefPtr<CefValue>
 		if (settings->HasKey("maxBitsPerSecond") && settings->HasKey("serverTestDurationSeconds")) {
 			int maxBitsPerSecond = settings->GetInt("maxBitsPerSecond");
 			int serverTestDurationSeconds = settings->GetInt("serverTestDurationSeconds");
+			int maxConcurrentTests = 1;
+
+			// Concurrent tests share the uplink: opt-in only
+			if (settings->HasKey("maxConcurrentTests") && settings->GetType("maxConcurrentTests") == VTYPE_INT) {
+				maxConcurrentTests = settings->GetInt("maxConcurrentTests");
+			}
 
 			m_last_test_servers.clear();
 
@@ -98,8 +119,12 @@ bool StreamElementsBandwidthTestManager::BeginBandwidthTest(CefRefPtr<CefValue>
 						// Copy
 						context->self->m_last_test_results = *results;
 
-						// Signal test progress
-						DispatchJSEvent(context->browser, "hostBandwidthTestProgress", nullptr);
+						// Signal test progress with the result which has just completed
+						std::string json = results->size() ?
+							CefWriteJSON(SerializeTestResult(results->back()), JSON_WRITER_DEFAULT).ToString() :
+							"null";
+
+						DispatchJSEvent(context->browser, "hostBandwidthTestProgress", json.c_str());
 					},
 					[](std::vector<StreamElementsBandwidthTestClient::Result>* results, void* data) {
 						local_context* context = (local_context*)data;
@@ -116,7 +141,8 @@ bool StreamElementsBandwidthTestManager::BeginBandwidthTest(CefRefPtr<CefValue>
 
 						delete context;
 					},
-					context);
+					context,
+					maxConcurrentTests);
 			}
 		}
 	}
@@ -177,17 +203,7 @@ CefRefPtr<CefDictionaryValue> StreamElementsBandwidthTestManager::GetBandwidthTe
 		value->SetList(list);
 
 		for (auto testResult : m_last_test_results) {
-			CefRefPtr<CefValue> itemValue = CefValue::Create();
-			CefRefPtr<CefDictionaryValue> item = CefDictionaryValue::Create();
-			itemValue->SetDictionary(item);
-
-			item->SetBool("success", testResult.success);
-			item->SetBool("wasCancelled", testResult.cancelled);
-			item->SetString("serverUrl", testResult.serverUrl);
-			item->SetString("streamKey", testResult.streamKey);
-			item->SetInt("connectTimeMilliseconds", testResult.connectTimeMilliseconds);
-
-			list->SetValue(list->GetSize(), itemValue);
+			list->SetValue(list->GetSize(), SerializeTestResult(testResult));
 		}
 
 		resultDictionary->SetValue("results", value);
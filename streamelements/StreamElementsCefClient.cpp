@@ -3,6 +3,8 @@
 #include "StreamElementsGlobalStateManager.hpp"
 #include "StreamElementsMessageBus.hpp"
 #include "StreamElementsFileSystemMapper.hpp"
+#include "StreamElementsTracer.hpp"
+#include "StreamElementsSnapshotList.hpp"
 #include "base64/base64.hpp"
 #include "json11/json11.hpp"
 #include <obs-frontend-api.h>
@@ -13,14 +15,17 @@
 #include <regex>
 #include <sstream>
 #include <algorithm>
+#include <memory>
 
 #include <QWindow>
 #include <QIcon>
 #include <QWidget>
 #include <QFile>
 
-static std::recursive_mutex s_browsers_mutex;
-static std::vector<CefRefPtr<CefBrowser>> s_browsers;
+/* OnAfterCreated/OnBeforeClose replace the list, DispatchJSEvent walks a
+ * snapshot without the lock */
+static StreamElementsSnapshotList<CefRefPtr<CefBrowser>>
+	s_browsers("browsers list");
 
 /* ========================================================================= */
 
@@ -354,36 +359,43 @@ void StreamElementsCefClient::OnAfterCreated(CefRefPtr<CefBrowser> browser)
 {
 	SetWindowDefaultIcon(browser->GetHost()->GetWindowHandle());
 
-	{
-		std::lock_guard<std::recursive_mutex> guard(s_browsers_mutex);
-
-		s_browsers.push_back(browser);
+	s_browsers.Update([&](std::vector<CefRefPtr<CefBrowser>> &list) {
+		list.push_back(browser);
 
 		StreamElementsMessageBus::GetInstance()->AddBrowserListener(
 			browser, m_msgDestType);
-	}
+	});
 }
 
 void StreamElementsCefClient::OnBeforeClose(CefRefPtr<CefBrowser> browser)
 {
-	std::lock_guard<std::recursive_mutex> guard(s_browsers_mutex);
+	bool empty = false;
 
-	StreamElementsMessageBus::GetInstance()->RemoveBrowserListener(browser);
+	s_browsers.Update([&](std::vector<CefRefPtr<CefBrowser>> &list) {
+		StreamElementsMessageBus::GetInstance()->RemoveBrowserListener(
+			browser);
 
-	auto index =
-		std::find(s_browsers.begin(), s_browsers.end(), browser.get());
+		list.erase(std::remove_if(list.begin(), list.end(),
+					  [&](CefRefPtr<CefBrowser> item) {
+						  return item->IsSame(browser);
+					  }),
+			   list.end());
 
-	if (index != s_browsers.end()) {
-		s_browsers.erase(index);
-	}
+		empty = list.empty();
+	});
+
+	if (empty)
+		s_browsers.LogLockStats();
 }
 
 void StreamElementsCefClient::DispatchJSEvent(std::string event,
 					      std::string eventArgsJson)
 {
-	std::lock_guard<std::recursive_mutex> guard(s_browsers_mutex);
+	SE_TRACE_SCOPE("event", event);
+
+	auto browsers = s_browsers.Snapshot();
 
-	for (CefRefPtr<CefBrowser> browser : s_browsers) {
+	for (CefRefPtr<CefBrowser> browser : *browsers) {
 		CefRefPtr<CefProcessMessage> msg =
 			CefProcessMessage::Create("DispatchJSEvent");
 		CefRefPtr<CefListValue> args = msg->GetArgumentList();
@@ -402,6 +414,8 @@ void StreamElementsCefClient::DispatchJSEvent(CefRefPtr<CefBrowser> browser,
 		return;
 	}
 
+	SE_TRACE_SCOPE("event", event);
+
 	CefRefPtr<CefProcessMessage> msg =
 		CefProcessMessage::Create("DispatchJSEvent");
 	CefRefPtr<CefListValue> args = msg->GetArgumentList();
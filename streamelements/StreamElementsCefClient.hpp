@@ -11,6 +11,8 @@
 #include <QUrl>
 #include <QDesktopServices>
 
+#include <atomic>
+
 class StreamElementsCefClientEventHandler : public CefBaseRefCounted {
 public:
 	virtual void OnLoadingStateChange([[maybe_unused]] CefRefPtr<CefBrowser> browser,
@@ -44,6 +46,9 @@ class StreamElementsCefClient : public CefClient,
 private:
 	std::string m_containerId = "";
 	std::string m_locationArea = "unknown";
+	int m_viewWidth = 1920;
+	int m_viewHeight = 1080;
+	std::atomic<uint64_t> m_paintCount = {0};
 
 public:
 	StreamElementsCefClient(
@@ -63,6 +68,17 @@ public:
 	std::string GetLocationArea() { return m_locationArea; }
 	void SetLocationArea(std::string area) { m_locationArea = area; }
 
+	/* Windowless view size, set before the browser is created */
+	void SetViewSize(int width, int height)
+	{
+		m_viewWidth = width;
+		m_viewHeight = height;
+	}
+	int GetViewWidth() { return m_viewWidth; }
+	int GetViewHeight() { return m_viewHeight; }
+
+	uint64_t GetPaintCount() { return m_paintCount; }
+
 	void SerializeForeignPopupWindowsSettings(CefRefPtr<CefValue> &output)
 	{
 		CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
@@ -378,14 +394,14 @@ public:
 #endif
 		CefRefPtr<CefBrowser> browser, CefRect &rect) override
 	{
-		rect.Set(0, 0, 1920, 1080);
+		rect.Set(0, 0, m_viewWidth, m_viewHeight);
 	}
 
 	virtual void OnPaint(CefRefPtr<CefBrowser> browser,
 			     PaintElementType type, const RectList &dirtyRects,
 			     const void *buffer, int width, int height) override
 	{
-		// NOOP
+		++m_paintCount;
 	}
 
 #if EXPERIMENTAL_SHARED_TEXTURE_SUPPORT_ENABLED
@@ -1,5 +1,7 @@
 #include "StreamElementsExternalSceneDataProviderSlobsClient.hpp"
 
+#include <unordered_map>
+
 bool StreamElementsExternalSceneDataProviderSlobsClient::GetSceneCollections(
 	std::vector<scene_collection_t>& result)
 {
@@ -100,14 +102,23 @@ bool StreamElementsExternalSceneDataProviderSlobsClient::GetSceneCollections(
 	return success;
 }
 
-static void dumpPaths(CefRefPtr<CefValue> parent, std::vector<std::wstring>& paths)
+static void dumpPaths(CefRefPtr<CefValue> parent, std::vector<std::wstring>& paths, std::unordered_map<std::string, bool>& visited)
 {
 	if (parent->GetType() == VTYPE_STRING) {
-		std::wstring candidate =
-			parent->GetString().ToWString();
+		std::string candidate = parent->GetString().ToString();
+
+		if (!IsPotentialLocalFilePath(candidate) || visited.count(candidate)) {
+			// Can not be a file path or already checked
+			return;
+		}
+
+		visited[candidate] = true;
+
+		std::wstring wcandidate = parent->GetString().ToWString();
 
-		if (std::filesystem::is_regular_file(candidate)) {
-			paths.push_back(candidate);
+		std::error_code ec;
+		if (std::filesystem::is_regular_file(wcandidate, ec)) {
+			paths.push_back(wcandidate);
 		}
 		else {
 			// Not a file or file does not exist
@@ -118,7 +129,7 @@ static void dumpPaths(CefRefPtr<CefValue> parent, std::vector<std::wstring>& pat
 		CefRefPtr<CefListValue> list = parent->GetList();
 
 		for (size_t i = 0; i < list->GetSize(); ++i) {
-			dumpPaths(list->GetValue(i), paths);
+			dumpPaths(list->GetValue(i), paths, visited);
 		}
 	}
 
@@ -128,12 +139,19 @@ static void dumpPaths(CefRefPtr<CefValue> parent, std::vector<std::wstring>& pat
 		CefDictionaryValue::KeyList keys;
 		if (d->GetKeys(keys)) {
 			for (auto key : keys) {
-				dumpPaths(d->GetValue(key), paths);
+				dumpPaths(d->GetValue(key), paths, visited);
 			}
 		}
 	}
 }
 
+static void dumpPaths(CefRefPtr<CefValue> parent, std::vector<std::wstring>& paths)
+{
+	std::unordered_map<std::string, bool> visited;
+
+	dumpPaths(parent, paths, visited);
+}
+
 bool StreamElementsExternalSceneDataProviderSlobsClient::GetSceneCollection(
 	std::string collectionId,
 	scene_collection_content_t& result)
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Coalesces concurrent fetches of the same key into a single request.
+ *
+ * The first Join() for a key returns true and the caller issues the fetch.
+ * Later Join() calls for that key only add their waiter, until the fetch
+ * calls Complete() and takes the waiters to notify. A fetch which could not
+ * be issued must still call Complete(), or the key waits forever.
+ */
+template<class Waiter> class StreamElementsFetchCoalescer {
+public:
+	/* Adds waiter (if any) to key; returns true if the fetch for key must
+	 * be issued by the caller */
+	bool Join(const std::string &key, const Waiter *waiter)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		auto it = m_pending.find(key);
+		bool issue = it == m_pending.end();
+
+		if (issue)
+			it = m_pending.emplace(key, std::vector<Waiter>())
+				     .first;
+
+		if (waiter)
+			it->second.push_back(*waiter);
+
+		return issue;
+	}
+
+	/* Ends the fetch for key, returning the waiters to notify */
+	std::vector<Waiter> Complete(const std::string &key)
+	{
+		std::vector<Waiter> waiters;
+
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		auto it = m_pending.find(key);
+
+		if (it != m_pending.end()) {
+			waiters.swap(it->second);
+
+			m_pending.erase(it);
+		}
+
+		return waiters;
+	}
+
+	size_t InFlight()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		return m_pending.size();
+	}
+
+private:
+	std::mutex m_mutex;
+	std::map<std::string, std::vector<Waiter>> m_pending;
+};
@@ -0,0 +1,166 @@
+#include "StreamElementsFileReferenceScanner.hpp"
+
+#include <util/platform.h>
+
+#include <unordered_map>
+
+bool IsPotentialLocalFilePath(const std::string &candidate)
+{
+	static const size_t MAX_PATH_LENGTH = 4096;
+
+	if (candidate.size() < 2 || candidate.size() > MAX_PATH_LENGTH)
+		return false;
+
+	if (candidate.find_first_of("/\\") == std::string::npos)
+		return false;
+
+	if (candidate.find_first_of("\r\n") != std::string::npos)
+		return false;
+
+	/* URL schemes: http://, https://, file://, data: etc. */
+	size_t schemeEnd = candidate.find(':');
+	if (schemeEnd != std::string::npos && schemeEnd > 1) {
+		bool isScheme = true;
+
+		for (size_t i = 0; i < schemeEnd && isScheme; ++i) {
+			char ch = candidate[i];
+
+			isScheme = (ch >= 'a' && ch <= 'z') ||
+				   (ch >= 'A' && ch <= 'Z') ||
+				   (ch >= '0' && ch <= '9') || ch == '+' ||
+				   ch == '-' || ch == '.';
+		}
+
+		if (isScheme)
+			return false;
+	}
+
+	return true;
+}
+
+struct file_reference_scan_context_t {
+	file_reference_handler_t handler;
+	std::unordered_map<std::string, bool> fileExistsCache;
+};
+
+static bool ScanStringForFileReference(file_reference_scan_context_t &context,
+				       const std::string &path,
+				       std::string &replacement)
+{
+	replacement.clear();
+
+	if (!IsPotentialLocalFilePath(path))
+		return true;
+
+	/* The same path is usually referenced many times in a collection:
+	 * stat each candidate only once */
+	auto cached = context.fileExistsCache.find(path);
+
+	bool exists;
+
+	if (cached != context.fileExistsCache.end()) {
+		exists = cached->second;
+	} else {
+		exists = os_file_exists(path.c_str());
+
+		context.fileExistsCache[path] = exists;
+	}
+
+	if (!exists)
+		return true;
+
+	return context.handler(path, replacement);
+}
+
+static bool ScanForFileReferences(file_reference_scan_context_t &context,
+				  CefRefPtr<CefDictionaryValue> d);
+
+/* List and dictionary values are walked in place: nested containers
+ * returned by CEF reference the parent's data, so only string values
+ * which actually refer to files are replaced.
+ */
+static bool ScanForFileReferences(file_reference_scan_context_t &context,
+				  CefRefPtr<CefListValue> list)
+{
+	std::string replacement;
+
+	for (size_t index = 0; index < list->GetSize(); ++index) {
+		switch (list->GetType(index)) {
+		case VTYPE_STRING:
+			if (!ScanStringForFileReference(
+				    context, list->GetString(index).ToString(),
+				    replacement))
+				return false;
+
+			if (replacement.size())
+				list->SetString(index, replacement);
+			break;
+		case VTYPE_LIST:
+			if (!ScanForFileReferences(context,
+						   list->GetList(index)))
+				return false;
+			break;
+		case VTYPE_DICTIONARY:
+			if (!ScanForFileReferences(context,
+						   list->GetDictionary(index)))
+				return false;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+static bool ScanForFileReferences(file_reference_scan_context_t &context,
+				  CefRefPtr<CefDictionaryValue> d)
+{
+	std::string replacement;
+
+	CefDictionaryValue::KeyList keys;
+	if (!d->GetKeys(keys))
+		return true;
+
+	for (auto &key : keys) {
+		switch (d->GetType(key)) {
+		case VTYPE_STRING:
+			if (!ScanStringForFileReference(
+				    context, d->GetString(key).ToString(),
+				    replacement))
+				return false;
+
+			if (replacement.size())
+				d->SetString(key, replacement);
+			break;
+		case VTYPE_LIST:
+			if (!ScanForFileReferences(context, d->GetList(key)))
+				return false;
+			break;
+		case VTYPE_DICTIONARY:
+			if (!ScanForFileReferences(context,
+						   d->GetDictionary(key)))
+				return false;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return true;
+}
+
+bool ScanForFileReferences(CefRefPtr<CefValue> &content,
+			   file_reference_handler_t handler)
+{
+	file_reference_scan_context_t context;
+
+	context.handler = handler;
+
+	if (content->GetType() == VTYPE_DICTIONARY)
+		return ScanForFileReferences(context, content->GetDictionary());
+	else if (content->GetType() == VTYPE_LIST)
+		return ScanForFileReferences(context, content->GetList());
+
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "../cef-headers.hpp"
+
+#include <functional>
+#include <string>
+
+/* Cheap check whether a string could possibly refer to a local file.
+ *
+ * Used to skip file system calls for the vast majority of string values
+ * found in scene collections (names, text, URLs, settings).
+ */
+bool IsPotentialLocalFilePath(const std::string &candidate);
+
+/* Called for each string value which refers to an existing local file.
+ * Setting replacement replaces the value in place, leaving it empty keeps
+ * the value. Returning false stops the scan.
+ */
+typedef std::function<bool(const std::string &path, std::string &replacement)>
+	file_reference_handler_t;
+
+/* Walks content in place, without copying it. Strings which can not be
+ * local paths are skipped without a file system call, and each remaining
+ * candidate is stat'ed once per scan.
+ *
+ * Returns false if handler stopped the scan.
+ */
+bool ScanForFileReferences(CefRefPtr<CefValue> &content,
+			   file_reference_handler_t handler);
@@ -13,6 +13,7 @@
 #include <util/util.hpp>
 
 #include <string>
+#include <future>
 #include <errno.h>
 
 #include <QPushButton>
@@ -284,22 +285,104 @@ StreamElementsGlobalStateManager::GetInstance()
 #include <QWindow>
 #include <QObjectList>
 
+void StreamElementsGlobalStateManager::LogInitTime(const char *name,
+						   uint64_t startTime)
+{
+	blog(LOG_INFO, "obs-browser: init: %s: %.3f ms", name,
+	     (double)(os_gettime_ns() - startTime) / 1000000.0);
+}
+
+template<class T>
+static T *TimedCreate(const char *name, std::function<T *()> create)
+{
+	uint64_t startTime = os_gettime_ns();
+
+	T *result = create();
+
+	StreamElementsGlobalStateManager::LogInitTime(name, startTime);
+
+	return result;
+}
+
 void StreamElementsGlobalStateManager::Initialize(QMainWindow *obs_main_window)
 {
+	uint64_t initStartTime = os_gettime_ns();
+
 	m_mainWindow = obs_main_window;
 
 	// Initialize on the main thread
-	m_crashHandler = new StreamElementsCrashHandler();
+	m_crashHandler = TimedCreate<StreamElementsCrashHandler>(
+		"crash handler",
+		[]() { return new StreamElementsCrashHandler(); });
+
+	// Read config on the calling thread before any worker touches it
+	uint64_t configStartTime = os_gettime_ns();
+	std::string base64EncodedState =
+		StreamElementsConfig::GetInstance()->GetStartupState();
+	LogInitTime("config", configStartTime);
+
+	// Independent I/O-bound setup runs in parallel with the UI setup
+	// performed on the main thread below
+	std::string storagePath = GetCEFStoragePath();
+
+	std::future<int> storagePathFuture =
+		std::async(std::launch::async, [storagePath]() -> int {
+			uint64_t startTime = os_gettime_ns();
+
+			int result = os_mkdirs(storagePath.c_str());
+
+			LogInitTime("cookie storage path", startTime);
+
+			return result;
+		});
+
+	std::future<StreamElementsLocalWebFilesServer *> localWebFilesServerFuture =
+		std::async(std::launch::async, []() {
+			return TimedCreate<StreamElementsLocalWebFilesServer>(
+				"local web files server", []() {
+					char *webRootPath =
+						obs_module_file("localwebroot");
+					auto result =
+						new StreamElementsLocalWebFilesServer(
+							webRootPath ? webRootPath
+								    : "");
+					bfree(webRootPath);
+
+					return result;
+				});
+		});
+
+	std::future<CefRefPtr<CefValue>> startupStateFuture = std::async(
+		std::launch::async, [base64EncodedState]() {
+			uint64_t startTime = os_gettime_ns();
+
+			CefRefPtr<CefValue> result =
+				ReadStartupState(base64EncodedState);
+
+			LogInitTime("startup state reading", startTime);
+
+			return result;
+		});
 
 	struct local_context {
 		StreamElementsGlobalStateManager *self;
 		QMainWindow *obs_main_window;
+		std::string storagePath;
+		std::future<int> *storagePathFuture;
+		std::future<StreamElementsLocalWebFilesServer *>
+			*localWebFilesServerFuture;
+		std::future<CefRefPtr<CefValue>> *startupStateFuture;
+		json11::Json::object initializedEventProps;
 	};
 
 	local_context context;
 
 	context.self = this;
 	context.obs_main_window = obs_main_window;
+	context.storagePath = storagePath;
+	context.storagePathFuture = &storagePathFuture;
+	context.localWebFilesServerFuture = &localWebFilesServerFuture;
+	context.startupStateFuture = &startupStateFuture;
 
 	QtExecSync(
 		[](void *data) -> void {
@@ -319,57 +402,62 @@ void StreamElementsGlobalStateManager::Initialize(QMainWindow *obs_main_window)
 		//		Qt::NoDockWidgetArea,
 		//		context->self->m_themeChangeListener);
 
-			std::string storagePath = GetCEFStoragePath();
-			int os_mkdirs_ret = os_mkdirs(storagePath.c_str());
+			std::string storagePath = context->storagePath;
+			QMainWindow *mainWindow = context->obs_main_window;
 
-			char *webRootPath = obs_module_file("localwebroot");
-			context->self->m_localWebFilesServer =
-				new StreamElementsLocalWebFilesServer(
-					webRootPath ? webRootPath : "");
-			bfree(webRootPath);
-			context->self->m_cookieManager =
-				new StreamElementsCookieManager(storagePath);
-			context->self->m_httpClient =
-				new StreamElementsHttpClient();
-			context->self->m_analyticsEventsManager =
-				new StreamElementsAnalyticsEventsManager();
+			// Bandwidth test, HTTP client, external scene data
+			// providers, profiles, backup, cleanup, worker and
+			// hotkey managers are created on first use. Analytics
+			// and the performance history tracker start after
+			// the first frame.
 			context->self->m_widgetManager =
-				new StreamElementsBrowserWidgetManager(
-					context->obs_main_window);
+				TimedCreate<StreamElementsBrowserWidgetManager>(
+					"browser widget manager", [mainWindow]() {
+						return new StreamElementsBrowserWidgetManager(
+							mainWindow);
+					});
 			context->self->m_obsSceneManager =
-				new StreamElementsObsSceneManager(
-					context->obs_main_window);
+				TimedCreate<StreamElementsObsSceneManager>(
+					"scene manager", [mainWindow]() {
+						return new StreamElementsObsSceneManager(
+							mainWindow);
+					});
 			context->self->m_menuManager =
-				new StreamElementsMenuManager(
-					context->obs_main_window);
-			context->self->m_bwTestManager =
-				new StreamElementsBandwidthTestManager();
+				TimedCreate<StreamElementsMenuManager>(
+					"menu manager", [mainWindow]() {
+						return new StreamElementsMenuManager(
+							mainWindow);
+					});
 			context->self->m_outputSettingsManager =
-				new StreamElementsOutputSettingsManager();
-			context->self->m_workerManager =
-				new StreamElementsWorkerManager();
-			context->self->m_hotkeyManager =
-				new StreamElementsHotkeyManager();
-			context->self->m_performanceHistoryTracker =
-				new StreamElementsPerformanceHistoryTracker();
-			context->self->m_externalSceneDataProviderManager =
-				new StreamElementsExternalSceneDataProviderManager();
+				TimedCreate<StreamElementsOutputSettingsManager>(
+					"output settings manager", []() {
+						return new StreamElementsOutputSettingsManager();
+					});
 			context->self->m_nativeObsControlsManager =
 				StreamElementsNativeOBSControlsManager::
 					GetInstance();
-			context->self->m_profilesManager =
-				new StreamElementsProfilesManager();
-			context->self->m_backupManager =
-				new StreamElementsBackupManager();
-			context->self->m_cleanupManager =
-				new StreamElementsCleanupManager();
 			context->self->m_previewManager =
-				new StreamElementsPreviewManager(
-					context->self->mainWindow());
+				TimedCreate<StreamElementsPreviewManager>(
+					"preview manager", [mainWindow]() {
+						return new StreamElementsPreviewManager(
+							mainWindow);
+					});
 			context->self->m_windowStateEventFilter =
 				new WindowStateChangeEventFilter(
 					context->self->mainWindow());
 
+			int os_mkdirs_ret = context->storagePathFuture->get();
+
+			context->self->m_cookieManager =
+				TimedCreate<StreamElementsCookieManager>(
+					"cookie manager", [storagePath]() {
+						return new StreamElementsCookieManager(
+							storagePath);
+					});
+
+			context->self->m_localWebFilesServer =
+				context->localWebFilesServerFuture->get();
+
 			{
 				// Set up "Live Support" button
 				/*QPushButton* liveSupport = new QPushButton(
@@ -474,6 +562,11 @@ void StreamElementsGlobalStateManager::Initialize(QMainWindow *obs_main_window)
 					"Start-up flags indicate on-boarding mode";
 			}
 
+			CefRefPtr<CefValue> startupState =
+				context->startupStateFuture->get();
+
+			uint64_t restoreStartTime = os_gettime_ns();
+
 			if (isOnBoarding) {
 				// On-boarding
 
@@ -482,36 +575,37 @@ void StreamElementsGlobalStateManager::Initialize(QMainWindow *obs_main_window)
 			} else {
 				// Regular
 
-				context->self->RestoreState();
+				context->self->RestoreState(startupState);
 			}
 
+			LogInitTime("state restore", restoreStartTime);
+
 			QApplication::sendPostedEvents();
 
 			context->self->m_menuManager->Update();
 
-			{
-				json11::Json::object eventProps = {
-					{"isOnBoarding", isOnBoarding},
-				};
-				if (isOnBoarding) {
-					eventProps["onBoardingReason"] =
+			context->initializedEventProps["isOnBoarding"] =
+				isOnBoarding;
+			if (isOnBoarding) {
+				context->initializedEventProps
+					["onBoardingReason"] =
 						onBoardingReason.c_str();
-				}
-
-				context->self->GetAnalyticsEventsManager()
-					->trackEvent("Initialized", eventProps);
 			}
 		},
 		&context);
 
-	QtPostTask(
-		[](void * /*data*/) {
-			// Update visible state
-			StreamElementsGlobalStateManager::GetInstance()
-				->GetMenuManager()
-				->Update();
-		},
-		this);
+	json11::Json::object initializedEventProps =
+		context.initializedEventProps;
+
+	QtPostTask([this, initializedEventProps]() {
+		// Update visible state
+		GetMenuManager()->Update();
+
+		// Both start a thread, analytics also reads its spool
+		GetPerformanceHistoryTracker();
+		GetAnalyticsEventsManager()->trackEvent("Initialized",
+							initializedEventProps);
+	});
 
 	register_cookie_manager(CefCookieManager::GetGlobalManager(nullptr));
 
@@ -519,6 +613,8 @@ void StreamElementsGlobalStateManager::Initialize(QMainWindow *obs_main_window)
 	m_persistStateEnabled = true;
 
 	obs_frontend_add_event_callback(handle_obs_frontend_event, nullptr);
+
+	LogInitTime("total", initStartTime);
 }
 
 void StreamElementsGlobalStateManager::Shutdown()
@@ -964,7 +1060,45 @@ bool StreamElementsGlobalStateManager::DeserializeUserInterfaceState(
 	return result;
 }
 
+/* Persisted state is partitioned per subsystem. Each partition is stored
+ * as a separate JSON file and is rewritten only when its content changes.
+ */
+static const char *const s_persistedStatePartitions[] = {
+	"dockingBrowserWidgets", "notificationBar", "workers",
+	"hotkeyBindings", "userInterfaceState"};
+
+// Coalesces state changes requested in quick succession
+static const int PERSIST_STATE_DEBOUNCE_MS = 500;
+
+std::string
+StreamElementsGlobalStateManager::GetPersistedStatePartitionPath(const char *name)
+{
+	char *basePathPtr = obs_module_config_path("persistent_state");
+	std::string result = std::string(basePathPtr) + "/" + name + ".json";
+	bfree(basePathPtr);
+
+	return result;
+}
+
 void StreamElementsGlobalStateManager::PersistState(bool sendEventToGuest)
+{
+	if (!m_persistStateEnabled) {
+		return;
+	}
+
+	if (m_persistStateWriter.Request()) {
+		QtPostTask([this]() {
+			QTimer::singleShot(PERSIST_STATE_DEBOUNCE_MS,
+					   [this]() { PersistStateNow(); });
+		});
+	}
+
+	if (sendEventToGuest) {
+		AdviseHostUserInterfaceStateChanged();
+	}
+}
+
+void StreamElementsGlobalStateManager::PersistStateNow()
 {
 	PREVENT_RECURSIVE_REENTRY();
 
@@ -975,64 +1109,184 @@ void StreamElementsGlobalStateManager::PersistState(bool sendEventToGuest)
 	//flush_cookie_manager(GetCookieManager()->GetCefCookieManager());
 	//flush_cookie_managers();
 
-	CefRefPtr<CefValue> root = CefValue::Create();
-	CefRefPtr<CefDictionaryValue> rootDictionary =
-		CefDictionaryValue::Create();
-
-	CefRefPtr<CefValue> dockingWidgetsState = CefValue::Create();
-	CefRefPtr<CefValue> notificationBarState = CefValue::Create();
-	CefRefPtr<CefValue> workersState = CefValue::Create();
-	CefRefPtr<CefValue> hotkeysState = CefValue::Create();
-	CefRefPtr<CefValue> userInterfaceState = CefValue::Create();
-
-	GetWidgetManager()->SerializeDockingWidgets(dockingWidgetsState);
-	GetWidgetManager()->SerializeNotificationBar(notificationBarState);
-	GetWorkerManager()->Serialize(workersState);
-	GetHotkeyManager()->SerializeHotkeyBindings(hotkeysState, true);
-	SerializeUserInterfaceState(userInterfaceState);
-
-	rootDictionary->SetValue("dockingBrowserWidgets", dockingWidgetsState);
-	rootDictionary->SetValue("notificationBar", notificationBarState);
-	rootDictionary->SetValue("workers", workersState);
-	rootDictionary->SetValue("hotkeyBindings", hotkeysState);
-	rootDictionary->SetValue("userInterfaceState", userInterfaceState);
+	uint64_t serializeStartTime = os_gettime_ns();
 
-	root->SetDictionary(rootDictionary);
+	std::map<std::string, CefRefPtr<CefValue>> partitions;
 
-	CefString json = CefWriteJSON(root, JSON_WRITER_DEFAULT);
+	for (auto name : s_persistedStatePartitions) {
+		partitions[name] = CefValue::Create();
+	}
 
-	std::string base64EncodedJSON = base64_encode(json.ToString());
+	GetWidgetManager()->SerializeDockingWidgets(
+		partitions["dockingBrowserWidgets"]);
+	GetWidgetManager()->SerializeNotificationBar(
+		partitions["notificationBar"]);
+	GetWorkerManager()->Serialize(partitions["workers"]);
+	GetHotkeyManager()->SerializeHotkeyBindings(
+		partitions["hotkeyBindings"], true);
+	SerializeUserInterfaceState(partitions["userInterfaceState"]);
 
-	StreamElementsConfig::GetInstance()->SetStartupState(base64EncodedJSON);
+	std::map<std::string, std::string> partitionsJson;
 
-	if (sendEventToGuest) {
-		AdviseHostUserInterfaceStateChanged();
+	for (auto kv : partitions) {
+		partitionsJson[kv.first] =
+			CefWriteJSON(kv.second, JSON_WRITER_DEFAULT).ToString();
 	}
+
+	size_t dirtyCount = m_persistStateWriter.Update(partitionsJson);
+
+	double serializeMs =
+		(double)(os_gettime_ns() - serializeStartTime) / 1000000.0;
+
+	if (!dirtyCount) {
+		blog(LOG_DEBUG,
+		     "obs-browser: state: no changes to persist (serialize %.3f ms)",
+		     serializeMs);
+		return;
+	}
+
+	blog(LOG_DEBUG,
+	     "obs-browser: state: %d of %d partitions changed (serialize %.3f ms)",
+	     (int)dirtyCount, (int)partitions.size(), serializeMs);
+
+	m_persistStateQueue.Enqueue([this]() { WritePendingPersistedState(); });
 }
 
-void StreamElementsGlobalStateManager::RestoreState()
+void StreamElementsGlobalStateManager::WritePendingPersistedState()
 {
-	std::string base64EncodedJSON =
-		StreamElementsConfig::GetInstance()->GetStartupState();
+	char *basePathPtr = obs_module_config_path("persistent_state");
+	os_mkdirs(basePathPtr);
+	bfree(basePathPtr);
 
-	if (!base64EncodedJSON.size()) {
+	auto result = m_persistStateWriter.WritePending();
+
+	if (!result.partitions || result.failed) {
 		return;
 	}
 
-	blog(LOG_INFO, "obs-browser: state: restoring state from base64: %s",
-	     base64EncodedJSON.c_str());
+	std::lock_guard<std::mutex> guard(m_persistStateWriteMutex);
 
-	CefString json = base64_decode(base64EncodedJSON);
+	if (!m_legacyStartupStateCleared) {
+		// All partitions are on disk now: drop the legacy single
+		// blob state from the module config
+		m_legacyStartupStateCleared = true;
 
-	if (!json.size()) {
-		return;
+		if (StreamElementsConfig::GetInstance()
+			    ->GetStartupState()
+			    .size()) {
+			StreamElementsConfig::GetInstance()->SetStartupState("");
+		}
+	}
+}
+
+bool StreamElementsGlobalStateManager::WritePersistedStatePartition(
+	const std::string &name, const std::string &content)
+{
+	std::string path = GetPersistedStatePartitionPath(name.c_str());
+
+	if (os_quick_write_utf8_file_safe(path.c_str(), content.c_str(),
+					  content.size(), false, "tmp",
+					  "bak")) {
+		return true;
+	}
+
+	blog(LOG_ERROR,
+	     "obs-browser: state: failed writing partition '%s' to '%s'",
+	     name.c_str(), path.c_str());
+
+	return false;
+}
+
+void StreamElementsGlobalStateManager::RestoreState()
+{
+	// Make sure the state on disk is current
+	WritePendingPersistedState();
+
+	RestoreState(ReadStartupState(
+		StreamElementsConfig::GetInstance()->GetStartupState()));
+}
+
+CefRefPtr<CefValue> StreamElementsGlobalStateManager::ReadStartupState(
+	std::string legacyBase64EncodedJSON)
+{
+	CefRefPtr<CefDictionaryValue> rootDictionary = nullptr;
+
+	// State persisted by older versions as a single base64 blob
+	if (legacyBase64EncodedJSON.size()) {
+		std::string json;
+
+		if (base64_decode(legacyBase64EncodedJSON, json)) {
+			blog(LOG_INFO,
+			     "obs-browser: state: restoring legacy state: %d bytes",
+			     (int)json.size());
+		} else {
+			blog(LOG_WARNING,
+			     "obs-browser: state: ignoring malformed legacy state: %d bytes",
+			     (int)legacyBase64EncodedJSON.size());
+		}
+
+		CefRefPtr<CefValue> root = CefParseJSON(
+			json, JSON_PARSER_ALLOW_TRAILING_COMMAS);
+
+		if (root.get() && root->GetType() == VTYPE_DICTIONARY) {
+			rootDictionary = root->GetDictionary()->Copy(false);
+		}
 	}
 
-	blog(LOG_INFO, "obs-browser: state: restoring state from json: %s",
-	     json.ToString().c_str());
+	// Partitions on disk supersede the legacy blob
+	for (auto name : s_persistedStatePartitions) {
+		std::string path = GetPersistedStatePartitionPath(name);
+
+		if (!os_file_exists(path.c_str())) {
+			continue;
+		}
+
+		char *buffer = os_quick_read_utf8_file(path.c_str());
+
+		if (!buffer) {
+			continue;
+		}
+
+		std::string json = buffer;
+		bfree(buffer);
+
+		blog(LOG_INFO,
+		     "obs-browser: state: restoring partition '%s': %d bytes",
+		     name, (int)json.size());
+
+		CefRefPtr<CefValue> value =
+			CefParseJSON(json, JSON_PARSER_ALLOW_TRAILING_COMMAS);
+
+		if (!value.get()) {
+			blog(LOG_ERROR,
+			     "obs-browser: state: failed parsing partition '%s'",
+			     name);
+			continue;
+		}
+
+		if (!rootDictionary.get()) {
+			rootDictionary = CefDictionaryValue::Create();
+		}
+
+		rootDictionary->SetValue(name, value);
+	}
+
+	if (!rootDictionary.get()) {
+		return nullptr;
+	}
+
+	CefRefPtr<CefValue> root = CefValue::Create();
+	root->SetDictionary(rootDictionary);
+
+	return root;
+}
+
+void StreamElementsGlobalStateManager::RestoreState(CefRefPtr<CefValue> root)
+{
+	if (!root.get()) {
+		return;
+	}
 
-	CefRefPtr<CefValue> root =
-		CefParseJSON(json, JSON_PARSER_ALLOW_TRAILING_COMMAS);
 	CefRefPtr<CefDictionaryValue> rootDictionary = root->GetDictionary();
 
 	if (!rootDictionary.get()) {
@@ -1048,39 +1302,24 @@ void StreamElementsGlobalStateManager::RestoreState()
 		rootDictionary->GetValue("userInterfaceState");
 
 	if (workersState.get()) {
-		blog(LOG_INFO, "obs-browser: state: restoring workers: %s",
-		     CefWriteJSON(workersState, JSON_WRITER_DEFAULT)
-			     .ToString()
-			     .c_str());
+		blog(LOG_INFO, "obs-browser: state: restoring workers");
 		GetWorkerManager()->Deserialize(workersState);
 	}
 
 	if (dockingWidgetsState.get()) {
-		blog(LOG_INFO,
-		     "obs-browser: state: restoring docking widgets: %s",
-		     CefWriteJSON(dockingWidgetsState, JSON_WRITER_DEFAULT)
-			     .ToString()
-			     .c_str());
+		blog(LOG_INFO, "obs-browser: state: restoring docking widgets");
 		GetWidgetManager()->DeserializeDockingWidgets(
 			dockingWidgetsState);
 	}
 
 	if (notificationBarState.get()) {
-		blog(LOG_INFO,
-		     "obs-browser: state: restoring notification bar: %s",
-		     CefWriteJSON(notificationBarState, JSON_WRITER_DEFAULT)
-			     .ToString()
-			     .c_str());
+		blog(LOG_INFO, "obs-browser: state: restoring notification bar");
 		GetWidgetManager()->DeserializeNotificationBar(
 			notificationBarState);
 	}
 
 	if (hotkeysState.get()) {
-		blog(LOG_INFO,
-		     "obs-browser: state: restoring hotkey bindings: %s",
-		     CefWriteJSON(hotkeysState, JSON_WRITER_DEFAULT)
-			     .ToString()
-			     .c_str());
+		blog(LOG_INFO, "obs-browser: state: restoring hotkey bindings");
 		GetHotkeyManager()->DeserializeHotkeyBindings(hotkeysState);
 	}
 
@@ -1091,7 +1330,9 @@ void StreamElementsGlobalStateManager::RestoreState()
 
 void StreamElementsGlobalStateManager::OnObsExit()
 {
-	PersistState(false);
+	// Flush synchronously: there will be no further event loop iterations
+	PersistStateNow();
+	WritePendingPersistedState();
 
 	m_persistStateEnabled = false;
 }
@@ -21,6 +21,11 @@
 #include "StreamElementsBackupManager.hpp"
 #include "StreamElementsCleanupManager.hpp"
 #include "StreamElementsPreviewManager.hpp"
+#include "StreamElementsAsyncTaskQueue.hpp"
+#include "StreamElementsStatePartitionWriter.hpp"
+
+#include <map>
+#include <atomic>
 
 class StreamElementsGlobalStateManager : public StreamElementsObsAppMonitor {
 private:
@@ -80,6 +85,8 @@ public:
 	void PersistState(bool sendEventToGuest = true);
 	void RestoreState();
 
+	static void LogInitTime(const char *name, uint64_t startTime);
+
 	StreamElementsBrowserWidgetManager *GetWidgetManager()
 	{
 		return m_widgetManager;
@@ -91,7 +98,8 @@ public:
 	StreamElementsMenuManager *GetMenuManager() { return m_menuManager; }
 	StreamElementsBandwidthTestManager *GetBandwidthTestManager()
 	{
-		return m_bwTestManager;
+		return GetOrCreateOnFirstUse(m_bwTestManager,
+					     "bandwidth test manager");
 	}
 	StreamElementsOutputSettingsManager *GetOutputSettingsManager()
 	{
@@ -99,19 +107,21 @@ public:
 	}
 	StreamElementsWorkerManager *GetWorkerManager()
 	{
-		return m_workerManager;
+		return GetOrCreateOnFirstUse(m_workerManager, "worker manager");
 	}
 	StreamElementsHotkeyManager *GetHotkeyManager()
 	{
-		return m_hotkeyManager;
+		return GetOrCreateOnFirstUse(m_hotkeyManager, "hotkey manager");
 	}
 	StreamElementsPerformanceHistoryTracker *GetPerformanceHistoryTracker()
 	{
-		return m_performanceHistoryTracker;
+		return GetOrCreateOnFirstUse(m_performanceHistoryTracker,
+					     "performance history tracker");
 	}
 	StreamElementsAnalyticsEventsManager *GetAnalyticsEventsManager()
 	{
-		return m_analyticsEventsManager;
+		return GetOrCreateOnFirstUse(m_analyticsEventsManager,
+					     "analytics events manager");
 	}
 	StreamElementsLocalWebFilesServer *GetLocalWebFilesServer()
 	{
@@ -120,9 +130,13 @@ public:
 	StreamElementsExternalSceneDataProviderManager *
 	GetExternalSceneDataProviderManager()
 	{
-		return m_externalSceneDataProviderManager;
+		return GetOrCreateOnFirstUse(m_externalSceneDataProviderManager,
+					     "external scene data provider manager");
+	}
+	StreamElementsHttpClient *GetHttpClient()
+	{
+		return GetOrCreateOnFirstUse(m_httpClient, "http client");
 	}
-	StreamElementsHttpClient *GetHttpClient() { return m_httpClient; }
 	StreamElementsNativeOBSControlsManager *GetNativeOBSControlsManager()
 	{
 		return m_nativeObsControlsManager;
@@ -133,15 +147,17 @@ public:
 	}
 	StreamElementsProfilesManager *GetProfilesManager()
 	{
-		return m_profilesManager;
+		return GetOrCreateOnFirstUse(m_profilesManager,
+					     "profiles manager");
 	}
 	StreamElementsBackupManager *GetBackupManager()
 	{
-		return m_backupManager;
+		return GetOrCreateOnFirstUse(m_backupManager, "backup manager");
 	}
 	StreamElementsCleanupManager *GetCleanupManager()
 	{
-		return m_cleanupManager;
+		return GetOrCreateOnFirstUse(m_cleanupManager,
+					     "cleanup manager");
 	}
 	StreamElementsPreviewManager* GetPreviewManager()
 	{
@@ -161,8 +177,40 @@ public:
 	void SerializeUserInterfaceState(CefRefPtr<CefValue> &output);
 	bool DeserializeUserInterfaceState(CefRefPtr<CefValue> input);
 
+private:
+	static CefRefPtr<CefValue>
+	ReadStartupState(std::string legacyBase64EncodedJSON);
+	static std::string GetPersistedStatePartitionPath(const char *name);
+	void RestoreState(CefRefPtr<CefValue> root);
+
+	/* Serializes all state partitions on the main thread and queues
+	 * the ones which changed since they were last persisted */
+	void PersistStateNow();
+	/* Writes queued state partitions to disk on the calling thread */
+	void WritePendingPersistedState();
+	static bool WritePersistedStatePartition(const std::string &name,
+						 const std::string &content);
+
+	/* Managers which are not needed to show the first frame are
+	 * constructed when they are first used */
+	template<class T> T *GetOrCreateOnFirstUse(T *&instance, const char *name)
+	{
+		std::lock_guard<std::mutex> guard(m_lazyInitMutex);
+
+		if (!instance) {
+			uint64_t startTime = os_gettime_ns();
+
+			instance = new T();
+
+			LogInitTime(name, startTime);
+		}
+
+		return instance;
+	}
+
 private:
 	std::recursive_mutex m_mutex;
+	std::mutex m_lazyInitMutex;
 	long m_apiTransactionLevel = 0;
 
 protected:
@@ -170,6 +218,16 @@ protected:
 
 private:
 	bool m_persistStateEnabled = false;
+
+	// Debounced, changed-only partition writes and their counters
+	StreamElementsStatePartitionWriter m_persistStateWriter = {
+		WritePersistedStatePartition};
+
+	std::mutex m_persistStateWriteMutex;
+	bool m_legacyStartupStateCleared = false;
+	StreamElementsAsyncTaskQueue m_persistStateQueue = {
+		"StreamElementsGlobalStateManager: persist state"};
+
 	bool m_initialized = false;
 	QMainWindow *m_mainWindow = nullptr;
 	QWidget *m_nativeCentralWidget = nullptr;
@@ -0,0 +1,139 @@
+#include "StreamElementsJsonFileScanner.hpp"
+
+#include <util/platform.h>
+
+#include <mutex>
+#include <sys/stat.h>
+
+bool ReadObsSceneCollectionName(const char *path, std::string &name)
+{
+	FILE *file = os_fopen(path, "rb");
+
+	if (!file)
+		return false;
+
+	JsonFileScanner scanner(file);
+
+	bool found = false;
+
+	/* UTF-8 BOM */
+	if (scanner.Peek() == 0xEF) {
+		scanner.Next();
+		scanner.Next();
+		scanner.Next();
+	}
+
+	if (scanner.NextToken() == '{') {
+		int ch = scanner.NextToken();
+
+		while (ch == '"') {
+			std::string key;
+
+			if (!scanner.ReadString(key) ||
+			    scanner.NextToken() != ':')
+				break;
+
+			ch = scanner.NextToken();
+
+			if (key == "name" && ch == '"') {
+				found = scanner.ReadString(name);
+				break;
+			}
+
+			if (!scanner.SkipValue(ch))
+				break;
+
+			ch = scanner.NextToken();
+
+			if (ch != ',')
+				break;
+
+			ch = scanner.NextToken();
+		}
+	}
+
+	fclose(file);
+
+	return found;
+}
+
+bool ReadObsSceneCollectionNames(const char *path,
+				 std::map<std::string, std::string> &output)
+{
+	/* Collection names by file path, valid while mtime and size match */
+	struct cache_item {
+		int64_t mtime;
+		int64_t size;
+		bool hasName;
+		std::string name;
+	};
+
+	static std::mutex s_cacheMutex;
+	static std::map<std::string, cache_item> s_cache;
+
+	std::string basePath = path;
+
+	os_dir_t *dir = os_opendir(basePath.c_str());
+
+	if (!dir)
+		return false;
+
+	static const std::string EXTENSION = ".json";
+
+	std::lock_guard<std::mutex> guard(s_cacheMutex);
+
+	std::map<std::string, cache_item> cache;
+
+	struct os_dirent *entry;
+
+	while ((entry = os_readdir(dir)) != NULL) {
+		if (entry->directory || *entry->d_name == '.')
+			continue;
+
+		std::string fileName = entry->d_name;
+
+		if (fileName.size() <= EXTENSION.size() ||
+		    fileName.compare(fileName.size() - EXTENSION.size(),
+				     EXTENSION.size(), EXTENSION) != 0)
+			continue;
+
+		std::string id =
+			fileName.substr(0, fileName.size() - EXTENSION.size());
+
+		std::string filePath = basePath + "/" + fileName;
+
+		struct stat st;
+
+		if (os_stat(filePath.c_str(), &st) != 0)
+			continue;
+
+		auto cached = s_cache.find(filePath);
+
+		cache_item item;
+
+		if (cached != s_cache.end() &&
+		    cached->second.mtime == (int64_t)st.st_mtime &&
+		    cached->second.size == (int64_t)st.st_size) {
+			item = cached->second;
+		} else {
+			item.mtime = (int64_t)st.st_mtime;
+			item.size = (int64_t)st.st_size;
+			item.hasName = ReadObsSceneCollectionName(
+				filePath.c_str(), item.name);
+		}
+
+		if (!item.hasName)
+			continue;
+
+		output[id] = item.name;
+
+		cache[filePath] = item;
+	}
+
+	os_closedir(dir);
+
+	/* Drop entries of deleted files */
+	s_cache.swap(cache);
+
+	return true;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+/* Buffered forward-only reader over a JSON file */
+class JsonFileScanner {
+private:
+	static const size_t BUFFER_SIZE = 64 * 1024;
+
+public:
+	JsonFileScanner(FILE *file) : m_file(file), m_buffer(BUFFER_SIZE) {}
+
+	int Peek()
+	{
+		if (m_pos == m_len && !Fill())
+			return -1;
+
+		return (unsigned char)m_buffer[m_pos];
+	}
+
+	int Next()
+	{
+		int ch = Peek();
+
+		if (ch >= 0)
+			++m_pos;
+
+		return ch;
+	}
+
+	int NextToken()
+	{
+		int ch;
+
+		do {
+			ch = Next();
+		} while (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n');
+
+		return ch;
+	}
+
+	/* Reads the rest of a string whose opening quote was consumed */
+	bool ReadString(std::string &output)
+	{
+		while (true) {
+			int ch = Next();
+
+			if (ch < 0)
+				return false;
+
+			if (ch == '"')
+				return true;
+
+			if (ch != '\\') {
+				output += (char)ch;
+				continue;
+			}
+
+			ch = Next();
+
+			switch (ch) {
+			case 'b':
+				output += '\b';
+				break;
+			case 'f':
+				output += '\f';
+				break;
+			case 'n':
+				output += '\n';
+				break;
+			case 'r':
+				output += '\r';
+				break;
+			case 't':
+				output += '\t';
+				break;
+			case 'u': {
+				uint32_t codepoint;
+
+				if (!ReadHex4(codepoint))
+					return false;
+
+				if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+					uint32_t low;
+
+					if (Next() != '\\' || Next() != 'u' ||
+					    !ReadHex4(low) || low < 0xDC00 ||
+					    low > 0xDFFF)
+						return false;
+
+					codepoint = 0x10000 +
+						    ((codepoint - 0xD800) << 10) +
+						    (low - 0xDC00);
+				}
+
+				AppendUtf8(output, codepoint);
+				break;
+			}
+			default:
+				if (ch < 0)
+					return false;
+
+				output += (char)ch;
+				break;
+			}
+		}
+	}
+
+	/* Skips the rest of a string whose opening quote was consumed */
+	bool SkipString()
+	{
+		while (true) {
+			int ch = Next();
+
+			if (ch < 0)
+				return false;
+
+			if (ch == '"')
+				return true;
+
+			if (ch == '\\' && Next() < 0)
+				return false;
+		}
+	}
+
+	/* Skips a value whose first char was consumed */
+	bool SkipValue(int ch)
+	{
+		size_t depth = 0;
+
+		while (true) {
+			if (ch < 0)
+				return false;
+
+			if (ch == '"') {
+				if (!SkipString())
+					return false;
+			} else if (ch == '{' || ch == '[') {
+				++depth;
+			} else if (ch == '}' || ch == ']') {
+				if (!depth)
+					return false;
+
+				--depth;
+			}
+
+			if (!depth) {
+				/* Scalars end at the next delimiter */
+				int next = Peek();
+
+				if (next < 0 || next == ',' || next == '}' ||
+				    next == ']' || next == ' ' || next == '\t' ||
+				    next == '\r' || next == '\n')
+					return true;
+			}
+
+			ch = Next();
+		}
+	}
+
+private:
+	bool Fill()
+	{
+		m_pos = 0;
+		m_len = fread(m_buffer.data(), 1, m_buffer.size(), m_file);
+
+		return m_len > 0;
+	}
+
+	bool ReadHex4(uint32_t &value)
+	{
+		value = 0;
+
+		for (int i = 0; i < 4; ++i) {
+			int ch = Next();
+
+			value <<= 4;
+
+			if (ch >= '0' && ch <= '9')
+				value |= ch - '0';
+			else if (ch >= 'a' && ch <= 'f')
+				value |= ch - 'a' + 10;
+			else if (ch >= 'A' && ch <= 'F')
+				value |= ch - 'A' + 10;
+			else
+				return false;
+		}
+
+		return true;
+	}
+
+	static void AppendUtf8(std::string &output, uint32_t codepoint)
+	{
+		if (codepoint < 0x80) {
+			output += (char)codepoint;
+		} else if (codepoint < 0x800) {
+			output += (char)(0xC0 | (codepoint >> 6));
+			output += (char)(0x80 | (codepoint & 0x3F));
+		} else if (codepoint < 0x10000) {
+			output += (char)(0xE0 | (codepoint >> 12));
+			output += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+			output += (char)(0x80 | (codepoint & 0x3F));
+		} else {
+			output += (char)(0xF0 | (codepoint >> 18));
+			output += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+			output += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+			output += (char)(0x80 | (codepoint & 0x3F));
+		}
+	}
+
+private:
+	FILE *m_file;
+	std::vector<char> m_buffer;
+	size_t m_pos = 0;
+	size_t m_len = 0;
+};
+
+/* Reads the top-level "name" string of a scene collection file, stopping
+ * as soon as it is found. Nested values are skipped without being parsed.
+ */
+bool ReadObsSceneCollectionName(const char *path, std::string &name);
+
+/* Reads the names of the scene collection files in path into output,
+ * keyed by file name without extension. Names are cached by file path and
+ * only re-read when a file's mtime or size changes.
+ */
+bool ReadObsSceneCollectionNames(const char *path,
+				 std::map<std::string, std::string> &output);
@@ -95,7 +95,7 @@ void StreamElementsNativeOBSControlsManager::SetStreamingActiveState()
 {
 	if (!m_startStopStreamingButton) return;
 
-	QtExecSync([&] {
+	QtExecAsync([this] {
 		m_startStopStreamingButton->setText(obs_module_text("StreamElements.Action.StopStreaming"));
 		m_startStopStreamingButton->setEnabled(true);
 
@@ -111,7 +111,7 @@ void StreamElementsNativeOBSControlsManager::SetStreamingStoppedState()
 
 	StopTimeoutTracker();
 
-	QtExecSync([&] {
+	QtExecAsync([this] {
 		m_startStopStreamingButton->setText(obs_module_text("StreamElements.Action.StartStreaming"));
 		m_startStopStreamingButton->setEnabled(true);
 
@@ -139,7 +139,7 @@ void StreamElementsNativeOBSControlsManager::SetStreamingTransitionStartingState
 
 	StopTimeoutTracker();
 
-	QtExecSync([&] {
+	QtExecAsync([this] {
 		m_startStopStreamingButton->setText(obs_module_text("StreamElements.Action.StartStreaming.InProgress"));
 		m_startStopStreamingButton->setEnabled(false);
 
@@ -151,15 +151,17 @@ void StreamElementsNativeOBSControlsManager::SetStreamingTransitionStartingState
 
 void StreamElementsNativeOBSControlsManager::SetStreamingRequestedState()
 {
-	QtExecSync([&] {
+	// Start the tracker before returning: a StopTimeoutTracker() from
+	// AdviseRequestStartStreamingAccepted/Rejected must never run before it
+	StartTimeoutTracker();
+
+	QtExecAsync([this] {
 		m_startStopStreamingButton->setText(obs_module_text("StreamElements.Action.StartStreaming.RequestInProgress"));
 		m_startStopStreamingButton->setEnabled(false);
 
 		SetStreamingStyle(true);
 
 		OnStartStopStreamingButtonUpdate();
-
-		StartTimeoutTracker();
 	});
 }
 
@@ -169,7 +171,7 @@ void StreamElementsNativeOBSControlsManager::SetStreamingTransitionStoppingState
 
 	StopTimeoutTracker();
 
-	QtExecSync([&] {
+	QtExecAsync([this] {
 		m_startStopStreamingButton->setText(obs_module_text("StreamElements.Action.StopStreaming.InProgress"));
 		m_startStopStreamingButton->setEnabled(false);
 
@@ -196,7 +198,7 @@ void StreamElementsNativeOBSControlsManager::OnStartStopStreamingButtonClicked()
 
 void StreamElementsNativeOBSControlsManager::OnStartStopStreamingButtonUpdate()
 {
-	QtExecSync([this]() -> void {
+	QtExecAsync([this]() -> void {
 		m_startStopStreamingButton->setMenu(m_nativeStartStopStreamingButton->menu());
 	});
 }
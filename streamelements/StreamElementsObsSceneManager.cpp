@@ -2,6 +2,7 @@
 #include "StreamElementsUtils.hpp"
 #include "StreamElementsCefClient.hpp"
 #include "StreamElementsConfig.hpp"
+#include "StreamElementsSceneSerializer.hpp"
 
 #include <util/platform.h>
 
@@ -221,7 +222,7 @@ void StreamElementsObsSceneManager::RefreshObsSceneItemsList()
 	if (!listView)
 		return;
 
-	QtExecSync([listView]() -> void {
+	QtExecAsync([listView]() -> void {
 #if ENABLE_OBS_GROUP_ADD_REMOVE_ITEM
 		QMetaObject::invokeMethod(listView, "SceneChanged",
 					  Qt::DirectConnection);
@@ -350,387 +351,6 @@ static bool IsBrowserSourceSceneItemInfoValid(CefRefPtr<CefValue> &input)
 
 ///////////////////////////////////////////////////////////////////////
 
-static CefRefPtr<CefValue> SerializeData(obs_data_t *data)
-{
-	CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
-
-	for (obs_data_item_t *item = obs_data_first(data); item;
-	     obs_data_item_next(&item)) {
-		enum obs_data_type type = obs_data_item_gettype(item);
-		const char *name = obs_data_item_get_name(item);
-
-		if (!name)
-			continue;
-
-		if (type == OBS_DATA_STRING) {
-			if (obs_data_item_has_user_value(item) ||
-			    obs_data_item_has_default_value(item)) {
-				const char *str =
-					obs_data_item_get_string(item);
-
-				if (str) {
-					d->SetString(name, str);
-				} else {
-					d->SetNull(name);
-				}
-			} else {
-				d->SetNull(name);
-			}
-		} else if (type == OBS_DATA_NUMBER) {
-			if (obs_data_item_numtype(item) == OBS_DATA_NUM_INT) {
-				d->SetInt(name, obs_data_item_get_int(item));
-			} else if (obs_data_item_numtype(item) ==
-				   OBS_DATA_NUM_DOUBLE) {
-				d->SetDouble(name,
-					     obs_data_item_get_double(item));
-			}
-		} else if (type == OBS_DATA_BOOLEAN)
-			d->SetBool(name, obs_data_item_get_bool(item));
-		else if (type == OBS_DATA_OBJECT) {
-			obs_data_t *obj = obs_data_item_get_obj(item);
-			d->SetValue(name, SerializeData(obj));
-			obs_data_release(obj);
-		} else if (type == OBS_DATA_ARRAY) {
-			CefRefPtr<CefListValue> list = CefListValue::Create();
-
-			obs_data_array_t *array = obs_data_item_get_array(item);
-			size_t count = obs_data_array_count(array);
-
-			for (size_t idx = 0; idx < count; idx++) {
-				obs_data_t *sub_item =
-					obs_data_array_item(array, idx);
-
-				list->SetValue(list->GetSize(),
-					       SerializeData(sub_item));
-
-				obs_data_release(sub_item);
-			}
-
-			obs_data_array_release(array);
-		}
-	}
-
-	CefRefPtr<CefValue> result = CefValue::Create();
-	result->SetDictionary(d);
-
-	/*
-	return CefParseJSON(obs_data_get_json(data),
-			JSON_PARSER_ALLOW_TRAILING_COMMAS);
-	*/
-
-	return result;
-}
-
-static bool DeserializeData(CefRefPtr<CefValue> input, obs_data_t *data)
-{
-	if (!input.get() || input->GetType() != VTYPE_DICTIONARY)
-		return false;
-
-	CefRefPtr<CefDictionaryValue> d = input->GetDictionary();
-
-	CefDictionaryValue::KeyList keys;
-
-	if (!d->GetKeys(keys))
-		return false;
-
-	for (std::string key : keys) {
-		CefRefPtr<CefValue> v = d->GetValue(key);
-
-		if (v->GetType() == VTYPE_STRING)
-			obs_data_set_string(data, key.c_str(),
-					    v->GetString().ToString().c_str());
-		else if (v->GetType() == VTYPE_INT)
-			obs_data_set_int(data, key.c_str(), v->GetInt());
-		else if (v->GetType() == VTYPE_DOUBLE)
-			obs_data_set_double(data, key.c_str(), v->GetDouble());
-		else if (v->GetType() == VTYPE_BOOL)
-			obs_data_set_bool(data, key.c_str(), v->GetBool());
-		else if (v->GetType() == VTYPE_DICTIONARY) {
-			obs_data_t *obj = obs_data_create_from_json(
-				CefWriteJSON(v, JSON_WRITER_DEFAULT)
-					.ToString()
-					.c_str());
-
-			obs_data_set_obj(data, key.c_str(), obj);
-
-			obs_data_release(obj);
-		} else if (v->GetType() == VTYPE_LIST) {
-			CefRefPtr<CefListValue> list = v->GetList();
-
-			obs_data_array_t *array = obs_data_array_create();
-
-			for (size_t index = 0; index < list->GetSize();
-			     ++index) {
-				obs_data_t *obj = obs_data_create_from_json(
-					CefWriteJSON(v, JSON_WRITER_DEFAULT)
-						.ToString()
-						.c_str());
-
-				obs_data_array_push_back(array, obj);
-
-				obs_data_release(obj);
-			}
-
-			obs_data_set_array(data, key.c_str(), array);
-
-			obs_data_array_release(array);
-		} else {
-			/* Unexpected data type */
-			return false;
-		}
-	}
-
-	return true;
-}
-
-static CefRefPtr<CefValue> SerializeObsSourceSettings(obs_source_t *source)
-{
-	CefRefPtr<CefValue> result = CefValue::Create();
-
-	if (source) {
-		obs_data_t *data = obs_source_get_settings(source);
-
-		if (data) {
-			result = SerializeData(data);
-
-			obs_data_release(data);
-		}
-	} else {
-		result->SetNull();
-	}
-
-	return result;
-}
-
-static CefRefPtr<CefDictionaryValue> SerializeVec2(vec2 &vec)
-{
-	CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
-
-	d->SetDouble("x", vec.x);
-	d->SetDouble("y", vec.y);
-
-	return d;
-}
-
-static vec2 DeserializeVec2(CefRefPtr<CefValue> &input)
-{
-	vec2 result = {0};
-
-	if (!!input.get() && input->GetType() == VTYPE_DICTIONARY) {
-		CefRefPtr<CefDictionaryValue> d = input->GetDictionary();
-
-		if (d->HasKey("x") && d->HasKey("y")) {
-			result.x = d->GetDouble("x");
-			result.y = d->GetDouble("y");
-		}
-	}
-
-	return result;
-}
-
-static uint32_t GetInt32FromAlignmentId(std::string alignment)
-{
-	uint32_t result = 0;
-
-	if (std::regex_search(alignment, std::regex("left")))
-		result |= OBS_ALIGN_LEFT;
-
-	if (std::regex_search(alignment, std::regex("right")))
-		result |= OBS_ALIGN_RIGHT;
-
-	if (std::regex_search(alignment, std::regex("top")))
-		result |= OBS_ALIGN_TOP;
-
-	if (std::regex_search(alignment, std::regex("bottom")))
-		result |= OBS_ALIGN_BOTTOM;
-
-	return result;
-}
-
-static std::string GetAlignmentIdFromInt32(uint32_t a)
-{
-	std::string h = "center";
-	std::string v = "center";
-
-	if (a & OBS_ALIGN_LEFT) {
-		h = "left";
-	} else if (a & OBS_ALIGN_RIGHT) {
-		h = "right";
-	}
-
-	if (a & OBS_ALIGN_TOP) {
-		v = "top";
-	} else if (a & OBS_ALIGN_BOTTOM) {
-		v = "bottom";
-	}
-
-	if (h == v) {
-		return "center";
-	} else {
-		return v + "_" + h;
-	}
-}
-
-static bool DeserializeSceneItemComposition(CefRefPtr<CefValue> &input,
-					    obs_transform_info &info,
-					    obs_sceneitem_crop &crop)
-{
-	if (!input.get() || input->GetType() != VTYPE_DICTIONARY) {
-		return false;
-	}
-
-	CefRefPtr<CefDictionaryValue> root = input->GetDictionary();
-
-	if (!root->HasKey("composition") ||
-	    root->GetType("composition") != VTYPE_DICTIONARY) {
-		return false;
-	}
-
-	memset(&info, 0, sizeof(info));
-	memset(&crop, 0, sizeof(crop));
-
-	CefRefPtr<CefDictionaryValue> d = root->GetDictionary("composition");
-	if (d->HasKey("position")) {
-		CefRefPtr<CefValue> val = d->GetValue("position");
-		info.pos = DeserializeVec2(val);
-	}
-	if (d->HasKey("scale")) {
-		CefRefPtr<CefValue> val = d->GetValue("scale");
-		info.scale = DeserializeVec2(val);
-	} else
-		info.scale = {1, 1};
-
-	if (d->HasKey("rotationDegrees"))
-		info.rot = d->GetDouble("rotationDegrees");
-
-	if (d->HasKey("crop") && d->GetType("crop") == VTYPE_DICTIONARY) {
-		CefRefPtr<CefDictionaryValue> c = d->GetDictionary("crop");
-
-		auto get = [&](const char *key, double defaultValue = 0) {
-			if (!c->HasKey(key))
-				return defaultValue;
-
-			if (c->GetType(key) == VTYPE_INT)
-				return (double)c->GetInt(key);
-			else if (c->GetType(key) == VTYPE_DOUBLE)
-				return c->GetDouble(key);
-			else
-				return defaultValue;
-		};
-
-		crop.left = get("left");
-		crop.top = get("top");
-		crop.right = get("right");
-		crop.bottom = get("bottom");
-	}
-
-	if (d->HasKey("alignment")) {
-		std::string val = d->GetString("alignment");
-		info.alignment = GetInt32FromAlignmentId(val);
-	} else {
-		info.alignment = OBS_ALIGN_LEFT | OBS_ALIGN_TOP;
-	}
-
-	if (d->HasKey("boundsType")) {
-		std::string v = d->GetString("boundsType");
-
-		if (v == "none")
-			info.bounds_type = OBS_BOUNDS_NONE;
-		else if (v == "stretch")
-			info.bounds_type = OBS_BOUNDS_STRETCH;
-		else if (v == "scale_to_inner_rect")
-			info.bounds_type = OBS_BOUNDS_SCALE_INNER;
-		else if (v == "scale_to_outer_rect")
-			info.bounds_type = OBS_BOUNDS_SCALE_OUTER;
-		else if (v == "scale_to_width")
-			info.bounds_type = OBS_BOUNDS_SCALE_TO_WIDTH;
-		else if (v == "scale_to_height")
-			info.bounds_type = OBS_BOUNDS_SCALE_TO_HEIGHT;
-		else if (v == "max_size_only")
-			info.bounds_type = OBS_BOUNDS_MAX_ONLY;
-		else
-			return false;
-
-		if (info.bounds_type != OBS_BOUNDS_NONE) {
-			if (d->HasKey("bounds")) {
-				CefRefPtr<CefValue> val = d->GetValue("bounds");
-				info.bounds = DeserializeVec2(val);
-			}
-			if (d->HasKey("boundsAlignment") &&
-			    d->GetType("boundsAlignment") == VTYPE_STRING) {
-				std::string val = d->GetString("boundsAlignment");
-				info.bounds_alignment = GetInt32FromAlignmentId(val);
-			} else
-				info.bounds_alignment = OBS_ALIGN_CENTER;
-		}
-	}
-
-	return true;
-}
-
-static CefRefPtr<CefDictionaryValue>
-SerializeObsSceneItemCompositionSettings(obs_source_t *source,
-					 obs_sceneitem_t *sceneitem)
-{
-	CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
-
-	if (source) {
-		d->SetInt("srcWidth", obs_source_get_width(source));
-		d->SetInt("srcHeight", obs_source_get_height(source));
-	}
-
-	obs_transform_info info;
-	obs_sceneitem_get_info(sceneitem, &info);
-
-	d->SetDictionary("position", SerializeVec2(info.pos));
-	d->SetDictionary("scale", SerializeVec2(info.scale));
-	d->SetDouble("rotationDegrees", (double)info.rot);
-
-	obs_sceneitem_crop crop;
-	obs_sceneitem_get_crop(sceneitem, &crop);
-
-	CefRefPtr<CefDictionaryValue> cropInfo = CefDictionaryValue::Create();
-
-	cropInfo->SetInt("left", crop.left);
-	cropInfo->SetInt("top", crop.top);
-	cropInfo->SetInt("right", crop.right);
-	cropInfo->SetInt("bottom", crop.bottom);
-
-	d->SetDictionary("crop", cropInfo);
-
-	d->SetString("alignment", GetAlignmentIdFromInt32(info.alignment));
-
-	switch (info.bounds_type) {
-	case OBS_BOUNDS_NONE: /**< no bounds */
-		d->SetString("boundsType", "none");
-		break;
-	case OBS_BOUNDS_STRETCH: /**< stretch (ignores base scale) */
-		d->SetString("boundsType", "stretch");
-		break;
-	case OBS_BOUNDS_SCALE_INNER: /**< scales to inner rectangle */
-		d->SetString("boundsType", "scale_to_inner_rect");
-		break;
-	case OBS_BOUNDS_SCALE_OUTER: /**< scales to outer rectangle */
-		d->SetString("boundsType", "scale_to_outer_rect");
-		break;
-	case OBS_BOUNDS_SCALE_TO_WIDTH: /**< scales to the width  */
-		d->SetString("boundsType", "scale_to_width");
-		break;
-	case OBS_BOUNDS_SCALE_TO_HEIGHT: /**< scales to the height */
-		d->SetString("boundsType", "scale_to_height");
-		break;
-	case OBS_BOUNDS_MAX_ONLY: /**< no scaling: maximum size only */
-		d->SetString("boundsType", "max_size_only");
-		break;
-	}
-
-	d->SetDictionary("bounds", SerializeVec2(info.bounds));
-	d->SetString("boundsAlignment",
-		     GetAlignmentIdFromInt32(info.bounds_alignment));
-
-	return d;
-}
-
 static void SerializeSourceAndSceneItem(CefRefPtr<CefValue> &result,
 					obs_source_t *source,
 					obs_sceneitem_t *sceneitem,
@@ -1,5 +1,6 @@
 #include "StreamElementsOutputSettingsManager.hpp"
 #include "StreamElementsUtils.hpp"
+#include "StreamElementsOutputStop.hpp"
 
 #include <obs-frontend-api.h>
 #include <obs-module.h>
@@ -69,32 +70,8 @@ void StreamElementsOutputSettingsManager::GetAvailableEncoders(CefRefPtr<CefValu
 	}
 }
 
-void StreamElementsOutputSettingsManager::StopAllOutputs()
-{
-	SYNC_ACCESS();
-
-	if (obs_frontend_replay_buffer_active()) {
-		obs_frontend_replay_buffer_stop();
-	}
-
-	if (obs_frontend_streaming_active()) {
-		obs_frontend_streaming_stop();
-	}
-
-	if (obs_frontend_recording_active()) {
-		obs_frontend_recording_stop();
-	}
-
-	// Wait for streaming to stop
-	while (obs_frontend_streaming_active()) {
-		os_sleep_ms(10);
-	}
-}
-
 bool StreamElementsOutputSettingsManager::SetStreamingSettings(CefRefPtr<CefValue> input)
 {
-	SYNC_ACCESS();
-
 	if (!input.get()) return false;
 	CefRefPtr<CefDictionaryValue> d = input->GetDictionary();
 
@@ -108,7 +85,12 @@ bool StreamElementsOutputSettingsManager::SetStreamingSettings(CefRefPtr<CefValu
 	std::string authUsername = (useAuth && d->HasKey("authUsername")) ? d->GetString("authUsername") : "";
 	std::string authPassword = (useAuth && d->HasKey("authPassword")) ? d->GetString("authPassword") : "";
 
-	StopAllOutputs();
+	// Not under SYNC_ACCESS: a slow output stop must not block other callers
+	if (!StopAllFrontendOutputs()) {
+		return false;
+	}
+
+	SYNC_ACCESS();
 
 	// Streaming service
 	obs_service_t* service = obs_service_create("rtmp_custom", "default_service", NULL, NULL);
@@ -16,7 +16,4 @@ public:
 
 	bool SetEncodingSettings(CefRefPtr<CefValue> input);
 	bool GetEncodingSettings(CefRefPtr<CefValue>& output);
-
-private:
-	void StopAllOutputs();
 };
@@ -0,0 +1,141 @@
+#include "StreamElementsOutputStop.hpp"
+
+#include <obs.h>
+#include <obs-frontend-api.h>
+#include <util/platform.h>
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+struct OutputStopState {
+	std::mutex mutex;
+	std::condition_variable cv;
+	size_t pending = 0;
+};
+
+struct OutputStopWait {
+	const char *name;
+	obs_output_t *output;
+	bool (*active)(void);
+	void (*stop)(void);
+
+	OutputStopState *state = nullptr;
+	bool waiting = false;
+	bool stopped = false;
+	uint64_t stopTime = 0;
+};
+
+static void handle_output_stop(void *data, calldata_t *)
+{
+	OutputStopWait *wait = (OutputStopWait *)data;
+
+	std::lock_guard<std::mutex> guard(wait->state->mutex);
+
+	if (!wait->waiting || wait->stopped)
+		return;
+
+	wait->stopped = true;
+	wait->stopTime = os_gettime_ns();
+
+	--wait->state->pending;
+	wait->state->cv.notify_all();
+}
+
+// Starts waiting for the output before checking it, so a stop in between is
+// counted. Returns false if the output was not running.
+static bool begin_output_wait(OutputStopWait &wait)
+{
+	OutputStopState &state = *wait.state;
+
+	{
+		std::lock_guard<std::mutex> guard(state.mutex);
+
+		wait.waiting = true;
+		++state.pending;
+	}
+
+	// The frontend flags clear later than the output itself: they are
+	// updated when the main thread handles the stop event.
+	if (obs_output_active(wait.output))
+		return true;
+
+	std::lock_guard<std::mutex> guard(state.mutex);
+
+	if (!wait.stopped) {
+		wait.waiting = false;
+		--state.pending;
+	}
+
+	return false;
+}
+
+bool StopAllFrontendOutputs(unsigned int timeoutMs)
+{
+	OutputStopState state;
+
+	OutputStopWait waits[] = {
+		{"replay buffer", obs_frontend_get_replay_buffer_output(),
+		 obs_frontend_replay_buffer_active,
+		 obs_frontend_replay_buffer_stop},
+		{"streaming", obs_frontend_get_streaming_output(),
+		 obs_frontend_streaming_active, obs_frontend_streaming_stop},
+		{"recording", obs_frontend_get_recording_output(),
+		 obs_frontend_recording_active, obs_frontend_recording_stop},
+	};
+
+	uint64_t startTime = os_gettime_ns();
+
+	for (OutputStopWait &wait : waits) {
+		wait.state = &state;
+
+		if (!wait.output) {
+			// Nothing to wait on, request the stop only
+			if (wait.active())
+				wait.stop();
+
+			continue;
+		}
+
+		signal_handler_connect(
+			obs_output_get_signal_handler(wait.output), "stop",
+			handle_output_stop, &wait);
+
+		if (begin_output_wait(wait))
+			wait.stop();
+	}
+
+	bool success;
+	{
+		std::unique_lock<std::mutex> lock(state.mutex);
+
+		success = state.cv.wait_for(
+			lock, std::chrono::milliseconds(timeoutMs),
+			[&] { return state.pending == 0; });
+	}
+
+	for (OutputStopWait &wait : waits) {
+		if (!wait.output)
+			continue;
+
+		// Disconnect waits for a running handler to return
+		signal_handler_disconnect(
+			obs_output_get_signal_handler(wait.output), "stop",
+			handle_output_stop, &wait);
+
+		if (wait.stopped) {
+			blog(LOG_INFO,
+			     "obs-browser: output settings: %s output stopped in %.1f ms",
+			     wait.name,
+			     (double)(wait.stopTime - startTime) / 1000000.0);
+		} else if (wait.waiting) {
+			blog(LOG_WARNING,
+			     "obs-browser: output settings: %s output did not stop within %u ms",
+			     wait.name, timeoutMs);
+		}
+
+		obs_output_release(wait.output);
+	}
+
+	return success;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+// Longest time StopAllFrontendOutputs() waits for all outputs to stop
+#define OUTPUT_STOP_TIMEOUT_MS 10000
+
+// Requests the replay buffer, streaming and recording outputs to stop and
+// waits for their "stop" signals, up to timeoutMs. No lock is held while
+// waiting.
+//
+// Must not be called on the Qt main thread: the frontend queues each stop
+// request to that thread, so a caller blocking it would always time out.
+//
+// Returns false if any output did not stop in time.
+//
+bool StopAllFrontendOutputs(unsigned int timeoutMs = OUTPUT_STOP_TIMEOUT_MS);
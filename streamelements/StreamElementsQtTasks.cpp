@@ -0,0 +1,331 @@
+#include "StreamElementsQtTasks.hpp"
+#include "StreamElementsTracer.hpp"
+
+#include <util/base.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <QEvent>
+#include <QObject>
+
+#include <deque>
+#include <mutex>
+
+/* Runs posted tasks on the Qt main thread in batches. A wake event is
+ * posted when none is pending, and the tasks queued when that event is
+ * handled run as one batch. Tasks are taken off the front of the
+ * shared queue one at a time, so post order holds even when a task spins
+ * a nested event loop (QMessageBox, QtExecSync on the main thread) which
+ * dispatches further tasks before the batch is done.
+ */
+class QtTaskDispatcher : public QObject {
+private:
+	struct Task {
+		std::function<void()> task;
+		void (*func)(void *);
+		void *data;
+		uint64_t postTime;
+	};
+
+	static const uint64_t STATS_INTERVAL_NS = 60000000000ULL;
+	static const uint64_t SYNC_WAIT_WARNING_NS = 1000000000ULL;
+
+public:
+	QtTaskDispatcher() : m_wakeEventType(QEvent::registerEventType()) {}
+
+	static QtTaskDispatcher *GetInstance()
+	{
+		/* Intentionally never destroyed: tasks may be posted while
+		 * static objects are torn down on exit. */
+		static QtTaskDispatcher *s_instance = []() {
+			QtTaskDispatcher *instance = new QtTaskDispatcher();
+			instance->moveToThread(qApp->thread());
+			return instance;
+		}();
+
+		return s_instance;
+	}
+
+	void Post(std::function<void()> task, void (*func)(void *),
+		  void *data)
+	{
+		bool wake;
+
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+
+			wake = !m_wakePending;
+			m_wakePending = true;
+
+			m_pending.push_back(
+				{std::move(task), func, data, os_gettime_ns()});
+		}
+
+		if (wake)
+			QCoreApplication::postEvent(
+				this, new QEvent((QEvent::Type)m_wakeEventType));
+	}
+
+	QtPostTaskStats GetStats()
+	{
+		QtPostTaskStats result;
+
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+
+			result.queueDepth = m_pending.size();
+		}
+
+		std::lock_guard<std::mutex> guard(m_statsMutex);
+
+		result.tasksRun = m_tasksRun;
+		result.batchesRun = m_batchesRun;
+		result.latencyAvgNs =
+			m_tasksRun ? m_latencyTotal / m_tasksRun : 0;
+		result.latencyMaxNs = m_latencyMax;
+		result.syncWaits = m_syncWaits;
+		result.syncWaitAvgNs =
+			m_syncWaits ? m_syncWaitTotal / m_syncWaits : 0;
+		result.syncWaitMaxNs = m_syncWaitMax;
+
+		return result;
+	}
+
+	void RecordSyncWait(uint64_t waitTime)
+	{
+		if (waitTime >= SYNC_WAIT_WARNING_NS)
+			blog(LOG_WARNING,
+			     "obs-browser: main thread tasks: QtExecSync waited %.3f ms",
+			     (double)waitTime / 1000000.0);
+
+		std::lock_guard<std::mutex> guard(m_statsMutex);
+
+		++m_syncWaits;
+		m_syncWaitTotal += waitTime;
+		if (waitTime > m_syncWaitMax)
+			m_syncWaitMax = waitTime;
+	}
+
+protected:
+	virtual bool event(QEvent *e) override
+	{
+		if (e->type() != m_wakeEventType)
+			return QObject::event(e);
+
+		RunPendingTasks();
+
+		return true;
+	}
+
+private:
+	void RunPendingTasks()
+	{
+		size_t batchSize;
+
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+
+			m_wakePending = false;
+			batchSize = m_pending.size();
+		}
+
+		if (!batchSize)
+			return;
+
+		SE_TRACE_SCOPE("qt", "QtPostTask batch");
+
+		size_t tasksRun = 0;
+		uint64_t latencyTotal = 0;
+		uint64_t latencyMax = 0;
+
+		while (tasksRun < batchSize) {
+			Task item;
+			bool wake = false;
+
+			{
+				std::lock_guard<std::mutex> guard(m_mutex);
+
+				/* Drained by a nested event loop */
+				if (m_pending.empty())
+					break;
+
+				item = std::move(m_pending.front());
+				m_pending.pop_front();
+
+				/* Keep a wake event queued while tasks remain,
+				 * so a nested event loop spun by this task
+				 * goes on dispatching them */
+				if (!m_pending.empty() && !m_wakePending) {
+					m_wakePending = true;
+					wake = true;
+				}
+			}
+
+			if (wake)
+				QCoreApplication::postEvent(
+					this,
+					new QEvent((QEvent::Type)m_wakeEventType));
+
+			++tasksRun;
+
+			uint64_t latency = os_gettime_ns() - item.postTime;
+
+			latencyTotal += latency;
+			if (latency > latencyMax)
+				latencyMax = latency;
+
+			SE_TRACE_SCOPE("qt", "QtPostTask");
+
+			if (item.func)
+				item.func(item.data);
+			else
+				item.task();
+		}
+
+		UpdateStats(tasksRun, latencyTotal, latencyMax);
+	}
+
+	void UpdateStats(size_t tasks, uint64_t latencyTotal,
+			 uint64_t latencyMax)
+	{
+		uint64_t now = os_gettime_ns();
+
+		std::lock_guard<std::mutex> guard(m_statsMutex);
+
+		if (!m_statsStartTime)
+			m_statsStartTime = now;
+
+		m_tasksRun += tasks;
+		++m_batchesRun;
+		m_latencyTotal += latencyTotal;
+		if (latencyMax > m_latencyMax)
+			m_latencyMax = latencyMax;
+
+		if (now - m_statsStartTime < STATS_INTERVAL_NS)
+			return;
+
+		blog(LOG_DEBUG,
+		     "obs-browser: main thread tasks: %llu tasks in %llu batches in %.1f s, "
+		     "latency avg %.3f ms max %.3f ms, "
+		     "%llu sync waits avg %.3f ms max %.3f ms",
+		     (unsigned long long)m_tasksRun,
+		     (unsigned long long)m_batchesRun,
+		     (double)(now - m_statsStartTime) / 1000000000.0,
+		     m_tasksRun ? (double)m_latencyTotal / (double)m_tasksRun /
+					  1000000.0
+				: 0.0,
+		     (double)m_latencyMax / 1000000.0,
+		     (unsigned long long)m_syncWaits,
+		     m_syncWaits ? (double)m_syncWaitTotal /
+					   (double)m_syncWaits / 1000000.0
+				 : 0.0,
+		     (double)m_syncWaitMax / 1000000.0);
+
+		m_statsStartTime = now;
+		m_tasksRun = 0;
+		m_batchesRun = 0;
+		m_latencyTotal = 0;
+		m_latencyMax = 0;
+		m_syncWaits = 0;
+		m_syncWaitTotal = 0;
+		m_syncWaitMax = 0;
+	}
+
+private:
+	const int m_wakeEventType;
+
+	std::mutex m_mutex;
+	std::deque<Task> m_pending;
+	bool m_wakePending = false;
+
+	std::mutex m_statsMutex;
+	uint64_t m_statsStartTime = 0;
+	uint64_t m_tasksRun = 0;
+	uint64_t m_batchesRun = 0;
+	uint64_t m_latencyTotal = 0;
+	uint64_t m_latencyMax = 0;
+	uint64_t m_syncWaits = 0;
+	uint64_t m_syncWaitTotal = 0;
+	uint64_t m_syncWaitMax = 0;
+};
+
+void QtPostTask(std::function<void()> task)
+{
+	QtTaskDispatcher::GetInstance()->Post(std::move(task), nullptr,
+					      nullptr);
+}
+
+void QtPostTask(void (*func)(void *), void *const data)
+{
+	QtTaskDispatcher::GetInstance()->Post(nullptr, func, data);
+}
+
+QtPostTaskStats QtGetPostTaskStats()
+{
+	return QtTaskDispatcher::GetInstance()->GetStats();
+}
+
+void QtExecSync(std::function<void()> task)
+{
+	struct local_context {
+		std::function<void()> task;
+	};
+
+	local_context *context = new local_context();
+	context->task = task;
+
+	QtExecSync(
+		[](void *data) {
+			local_context *context = (local_context *)data;
+
+			context->task();
+
+			delete context;
+		},
+		context);
+}
+
+void QtExecSync(void (*func)(void *), void *const data)
+{
+	if (QThread::currentThread() == qApp->thread()) {
+		func(data);
+	} else {
+		struct local_context {
+			void (*func)(void *);
+			void *data;
+			os_event_t *completeEvent;
+		};
+
+		local_context context = {func, data, nullptr};
+
+		os_event_init(&context.completeEvent, OS_EVENT_TYPE_AUTO);
+
+		QtTaskDispatcher::GetInstance()->Post(
+			nullptr,
+			[](void *data) {
+				local_context *context = (local_context *)data;
+
+				{
+					SE_TRACE_SCOPE("qt", "QtExecSync");
+
+					context->func(context->data);
+				}
+
+				os_event_signal(context->completeEvent);
+			},
+			&context);
+
+		uint64_t waitStartTime = os_gettime_ns();
+
+		{
+			SE_TRACE_SCOPE("qt", "QtExecSync wait");
+
+			os_event_wait(context.completeEvent);
+		}
+
+		os_event_destroy(context.completeEvent);
+
+		QtTaskDispatcher::GetInstance()->RecordSyncWait(
+			os_gettime_ns() - waitStartTime);
+	}
+}
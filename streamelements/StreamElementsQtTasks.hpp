@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+#include <QCoreApplication>
+#include <QThread>
+
+/* Tasks run on the Qt main thread. Kept apart from StreamElementsUtils so
+ * the dispatcher only depends on QtCore and libobs.
+ */
+
+void QtPostTask(void (*func)(void *), void *const data);
+void QtPostTask(std::function<void()> task);
+
+/* Main thread task queue statistics since the last periodic log */
+struct QtPostTaskStats {
+	size_t queueDepth = 0;
+	uint64_t tasksRun = 0;
+	uint64_t batchesRun = 0;
+	uint64_t latencyAvgNs = 0;
+	uint64_t latencyMaxNs = 0;
+	uint64_t syncWaits = 0;
+	uint64_t syncWaitAvgNs = 0;
+	uint64_t syncWaitMaxNs = 0;
+};
+
+QtPostTaskStats QtGetPostTaskStats();
+
+/* Blocks the calling thread until task ran on the Qt main thread. The
+ * time spent waiting is recorded in QtPostTaskStats.
+ */
+void QtExecSync(void (*func)(void *), void *const data);
+void QtExecSync(std::function<void()> task);
+
+/* Runs task on the Qt main thread without blocking the caller: inline when
+ * called on the main thread, posted otherwise. The returned future holds
+ * the task result and may be dropped when the result is not needed.
+ */
+template<typename F>
+auto QtExecAsync(F task) -> std::future<decltype(task())>
+{
+	typedef decltype(task()) result_t;
+
+	auto packagedTask =
+		std::make_shared<std::packaged_task<result_t()>>(
+			std::move(task));
+
+	std::future<result_t> result = packagedTask->get_future();
+
+	if (QThread::currentThread() == qApp->thread())
+		(*packagedTask)();
+	else
+		QtPostTask([packagedTask]() { (*packagedTask)(); });
+
+	return result;
+}
+
+/* Continuation form of QtExecAsync(): once task returned, callback is
+ * invoked on the Qt main thread with its result (no arguments for a void
+ * task). Nothing waits on a future, so the caller can resume elsewhere
+ * from callback, e.g. by posting to a CEF thread.
+ */
+template<typename F, typename C> void QtExecAsync(F task, C callback)
+{
+	auto run = [task, callback]() mutable {
+		if constexpr (std::is_void<decltype(task())>::value) {
+			task();
+			callback();
+		} else {
+			callback(task());
+		}
+	};
+
+	if (QThread::currentThread() == qApp->thread())
+		run();
+	else
+		QtPostTask(run);
+}
@@ -1,7 +1,16 @@
 #include "StreamElementsRemoteIconLoader.hpp"
+#include "StreamElementsFetchCoalescer.hpp"
 
 #include <QCache>
 #include <QReadWriteLock>
+#include <QFile>
+#include <QDir>
+
+#include <include/cef_parser.h>
+
+#include <map>
+#include <vector>
+#include <algorithm>
 
 //static
 class CachedPixmap : QObject {
@@ -46,6 +55,159 @@ static void SetCached(const QString &key, const QIcon &icon)
 	s_cacheLock.unlock();
 }
 
+/* ========================================================= */
+
+/* Persistent icon cache
+ *
+ * Each URL maps to two files named after the SHA-256 of the URL:
+ * <digest>.bin holds the downloaded image data as received, and
+ * <digest>.json holds the ETag/Last-Modified validators used to
+ * revalidate the entry with a conditional GET.
+ */
+
+static std::string GetDiskCacheBasePath(const std::string &url)
+{
+	char *basePathPtr = obs_module_config_path("remote_icon_cache");
+
+	if (!basePathPtr)
+		return "";
+
+	std::string basePath = basePathPtr;
+	bfree(basePathPtr);
+
+	std::string digestInput = url;
+
+	return basePath + "/" + CreateSHA256Digest(digestInput);
+}
+
+static bool ReadDiskCacheValidators(const std::string &url,
+				    http_client_headers_t &headers)
+{
+	std::string basePath = GetDiskCacheBasePath(url);
+
+	if (!basePath.size())
+		return false;
+
+	if (!os_file_exists((basePath + ".bin").c_str()))
+		return false;
+
+	char *buffer = os_quick_read_utf8_file((basePath + ".json").c_str());
+
+	if (!buffer)
+		return false;
+
+	CefRefPtr<CefValue> meta = CefParseJSON(
+		CefString(buffer), JSON_PARSER_ALLOW_TRAILING_COMMAS);
+
+	bfree(buffer);
+
+	if (!meta.get() || meta->GetType() != VTYPE_DICTIONARY)
+		return false;
+
+	CefRefPtr<CefDictionaryValue> d = meta->GetDictionary();
+
+	if (d->GetType("etag") == VTYPE_STRING)
+		headers.emplace("If-None-Match",
+				d->GetString("etag").ToString());
+
+	if (d->GetType("lastModified") == VTYPE_STRING)
+		headers.emplace("If-Modified-Since",
+				d->GetString("lastModified").ToString());
+
+	return headers.size() > 0;
+}
+
+static bool ReadDiskCache(const std::string &url, QIcon &icon)
+{
+	std::string basePath = GetDiskCacheBasePath(url);
+
+	if (!basePath.size())
+		return false;
+
+	QFile file(QString::fromStdString(basePath + ".bin"));
+
+	if (!file.open(QFile::ReadOnly))
+		return false;
+
+	QPixmap pixmap;
+
+	if (!pixmap.loadFromData(file.readAll())) {
+		file.close();
+		file.remove();
+
+		return false;
+	}
+
+	icon = QIcon(pixmap);
+
+	return true;
+}
+
+static void WriteDiskCache(const std::string &url, void *data, size_t len,
+			   CefRefPtr<CefResponse> response)
+{
+	std::string basePath = GetDiskCacheBasePath(url);
+
+	if (!basePath.size())
+		return;
+
+	QDir().mkpath(QString::fromStdString(
+		GetFolderPathFromFilePath(basePath)));
+
+	CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
+
+	d->SetString("url", url);
+
+	if (response.get()) {
+		CefResponse::HeaderMap headers;
+		response->GetHeaderMap(headers);
+
+		for (auto header : headers) {
+			std::string name = header.first.ToString();
+
+			std::transform(name.begin(), name.end(), name.begin(),
+				       ::tolower);
+
+			if (name == "etag")
+				d->SetString("etag", header.second);
+			else if (name == "last-modified")
+				d->SetString("lastModified", header.second);
+		}
+	}
+
+	CefRefPtr<CefValue> meta = CefValue::Create();
+	meta->SetDictionary(d);
+
+	std::string json = CefWriteJSON(meta, JSON_WRITER_DEFAULT);
+
+	/* Write data first: validators without data are ignored */
+	QFile file(QString::fromStdString(basePath + ".bin"));
+
+	if (!file.open(QFile::WriteOnly | QFile::Truncate))
+		return;
+
+	bool success = (qint64)len == file.write((const char *)data, len);
+
+	file.close();
+
+	if (success)
+		os_quick_write_utf8_file((basePath + ".json").c_str(),
+					 json.c_str(), json.size(), false);
+	else
+		file.remove();
+}
+
+/* ========================================================= */
+
+struct pending_fetch_waiter_t {
+	CefRefPtr<StreamElementsRemoteIconLoader> loader;
+	long loadId;
+};
+
+static StreamElementsFetchCoalescer<pending_fetch_waiter_t> s_pending;
+
+/* ========================================================= */
+
 StreamElementsRemoteIconLoader::StreamElementsRemoteIconLoader(
 	setIcon_callback_t setIcon, const char *url, QPixmap *defaultPixmap,
 	bool requireQtPostTaskOnCached)
@@ -108,19 +270,9 @@ void StreamElementsRemoteIconLoader::Cancel()
 {
 	std::lock_guard<std::recursive_mutex> guard(m_mutex);
 
+	/* A shared fetch in flight is not aborted: other loaders may be
+	 * waiting on it, and its result is cached either way */
 	m_cancelled = true;
-
-	if (m_task) {
-		// m_task->Cancel();
-
-		m_task = nullptr;
-	}
-
-	if (m_request) {
-		m_request->Cancel();
-
-		m_request = nullptr;
-	}
 }
 
 void StreamElementsRemoteIconLoader::LoadUrl(const char* url)
@@ -128,6 +280,31 @@ void StreamElementsRemoteIconLoader::LoadUrl(const char* url)
 	LoadUrlInternal(url, true);
 }
 
+void StreamElementsRemoteIconLoader::SetIconInternal(const QIcon icon,
+						     long loadId,
+						     bool requireQtPostTask)
+{
+	if (!requireQtPostTask) {
+		std::lock_guard<std::recursive_mutex> guard(m_mutex);
+
+		if (!m_cancelled && loadId == m_loadId) {
+			m_setIcon(icon);
+		}
+	} else {
+		this->AddRef();
+
+		QtPostTask([this, icon, loadId]() {
+			std::lock_guard<std::recursive_mutex> guard(m_mutex);
+
+			if (!m_cancelled && loadId == m_loadId) {
+				m_setIcon(icon);
+			}
+
+			this->Release();
+		});
+	}
+}
+
 void StreamElementsRemoteIconLoader::LoadUrlInternal(
 	const char *url, bool requireQtPostTaskOnCached)
 {
@@ -140,71 +317,93 @@ void StreamElementsRemoteIconLoader::LoadUrlInternal(
 
 	m_cancelled = false;
 
+	long loadId = ++m_loadId;
+
 	QString cacheKey(url);
 
 	QIcon cached;
 	if (GetCached(cacheKey, cached)) {
-		if (!requireQtPostTaskOnCached) {
-			if (!m_cancelled) {
-				m_setIcon(cached);
-			}
-		} else {
-			this->AddRef();
+		SetIconInternal(cached, loadId, requireQtPostTaskOnCached);
 
-			QtPostTask([this, cached]() {
-				std::lock_guard<std::recursive_mutex> guard(
-					m_mutex);
+		return;
+	}
 
-				if (!m_cancelled) {
-					m_setIcon(cached);
-				}
+	if (ReadDiskCache(url, cached)) {
+		SetCached(cacheKey, cached);
 
-				this->Release();
-			});
-		}
+		SetIconInternal(cached, loadId, requireQtPostTaskOnCached);
+
+		/* Revalidate once per session, without waiters */
+		FetchShared(url, nullptr, 0);
 
 		return;
 	}
 
-	this->AddRef();
+	FetchShared(url, this, loadId);
+}
 
-	m_task = CefHttpGetAsync(
-		url,
-		[&](CefRefPtr<CefURLRequest> request) { m_request = request; },
-		[this, cacheKey](bool success, void *data, size_t len) {
-			std::lock_guard<std::recursive_mutex> guard(m_mutex);
+void StreamElementsRemoteIconLoader::FetchShared(
+	std::string url, CefRefPtr<StreamElementsRemoteIconLoader> waiter,
+	long loadId)
+{
+	pending_fetch_waiter_t pendingWaiter = {waiter, loadId};
 
-			if (m_request) {
-				m_request = nullptr;
-			}
+	if (!s_pending.Join(url, waiter.get() ? &pendingWaiter : nullptr)) {
+		/* Already in flight */
+		return;
+	}
+
+	http_client_headers_t headers;
+	ReadDiskCacheValidators(url, headers);
 
-			m_task = nullptr;
+	CefRefPtr<CefCancelableTask> task = CefHttpGetAsync(
+		url.c_str(), headers, [](CefRefPtr<CefURLRequest>) {},
+		[url](bool success, int http_code, void *data, size_t len,
+		      CefRefPtr<CefResponse> response) {
+			QString cacheKey(url.c_str());
 
-			if (success && !m_cancelled) {
+			QIcon icon;
+			bool hasIcon = false;
+
+			if (success && http_code == 304) {
+				/* Not modified: disk cache is still valid */
+				hasIcon = GetCached(cacheKey, icon) ||
+					  ReadDiskCache(url, icon);
+			} else if (success) {
 				QByteArray buffer = QByteArray::fromRawData(
 					(char *)data, len);
 				QPixmap pixmap;
 				if (pixmap.loadFromData(buffer)) {
-					QIcon icon(pixmap);
+					icon = QIcon(pixmap);
+					hasIcon = true;
 
 					SetCached(cacheKey, icon);
 
-					this->AddRef();
+					WriteDiskCache(url, data, len,
+						       response);
+				}
+			}
 
-					QtPostTask([this, icon]() {
-						std::lock_guard<
-							std::recursive_mutex>
-							guard(m_mutex);
+			std::vector<pending_fetch_waiter_t> waiters =
+				s_pending.Complete(url);
 
-						if (!m_cancelled) {
-							m_setIcon(icon);
-						}
+			if (!hasIcon)
+				return;
 
-						this->Release();
-					});
-				}
+			for (auto &waiter : waiters) {
+				waiter.loader->SetIconInternal(
+					icon, waiter.loadId, true);
 			}
-
-			this->Release();
 		});
+
+	if (!task.get()) {
+		/* Never issued: the callback above will not run, so drop the
+		 * entry here or later loads of this URL would wait forever.
+		 * Waiters are treated like any other failed fetch. */
+		blog(LOG_WARNING,
+		     "obs-browser: remote icon: failed issuing request: %s",
+		     url.c_str());
+
+		s_pending.Complete(url);
+	}
 }
@@ -23,6 +23,16 @@ private:
 	~StreamElementsRemoteIconLoader();
 
 	void LoadUrlInternal(const char *url, bool requireQtPostTaskOnCached);
+	void SetIconInternal(const QIcon icon, long loadId,
+			     bool requireQtPostTask);
+
+	/* Fetch |url| once for all loaders waiting on it: concurrent
+	 * requests for the same URL are coalesced into a single download.
+	 * |waiter| may be null to revalidate a disk-cached icon only.
+	 */
+	static void FetchShared(std::string url,
+				CefRefPtr<StreamElementsRemoteIconLoader> waiter,
+				long loadId);
 
 public:
 	void Cancel();
@@ -30,10 +40,9 @@ public:
 
 private:
 	std::recursive_mutex m_mutex;
-	CefRefPtr<CefURLRequest> m_request = nullptr;
-	CefRefPtr<CefCancelableTask> m_task = nullptr;
 	setIcon_callback_t m_setIcon;
 	bool m_cancelled = false;
+	long m_loadId = 0;
 
 	IMPLEMENT_REFCOUNTING(StreamElementsRemoteIconLoader);
 };
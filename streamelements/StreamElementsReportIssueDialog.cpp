@@ -4,6 +4,7 @@
 #include "StreamElementsGlobalStateManager.hpp"
 #include "StreamElementsNetworkDialog.hpp"
 #include "StreamElementsConfig.hpp"
+#include "StreamElementsReportIssuePackage.hpp"
 #include "Version.hpp"
 #include "ui_StreamElementsReportIssueDialog.h"
 
@@ -196,7 +197,7 @@ void StreamElementsReportIssueDialog::accept()
 
 		std::wstring obsDataPath = QString(programDataPathBuf).toStdWString();
 
-		zip_t* zip = zip_open(tempBufPath.c_str(), 9, 'w');
+		zip_t* zip = zip_open(tempBufPath.c_str(), ZIP_DEFAULT_COMPRESSION_LEVEL, 'w');
 
 		auto addBufferToZip = [&](BYTE* buf, size_t bufLen, std::wstring zipPath)
 		{
@@ -209,12 +210,15 @@ void StreamElementsReportIssueDialog::accept()
 
 		auto addLinesBufferToZip = [&](std::vector<std::string>& lines, std::wstring zipPath)
 		{
+			std::string buf;
+			for (auto& line : lines) {
+				buf.append(line);
+				buf.append("\r\n");
+			}
+
 			zip_entry_open(zip, wstring_to_utf8(zipPath).c_str());
 
-			for (auto line : lines) {
-				zip_entry_write(zip, line.c_str(), line.size());
-				zip_entry_write(zip, "\r\n", 2);
-			}
+			zip_entry_write(zip, buf.c_str(), buf.size());
 
 			zip_entry_close(zip);
 		};
@@ -235,43 +239,6 @@ void StreamElementsReportIssueDialog::accept()
 			zip_entry_close(zip);
 		};
 
-		auto addFileToZip = [&](std::wstring localPath, std::wstring zipPath)
-		{
-			int fd = _wsopen(
-				localPath.c_str(),
-				_O_RDONLY | _O_BINARY,
-				_SH_DENYNO,
-				0 /*_S_IREAD | _S_IWRITE*/);
-
-			if (-1 != fd) {
-				size_t BUF_LEN = 32768;
-
-				BYTE* buf = new BYTE[BUF_LEN];
-
-				zip_entry_open(zip, wstring_to_utf8(zipPath).c_str());
-
-				int read = _read(fd, buf, BUF_LEN);
-				while (read > 0) {
-					if (0 != zip_entry_write(zip, buf, read)) {
-						break;
-					}
-
-					read = _read(fd, buf, BUF_LEN);
-				}
-
-				zip_entry_close(zip);
-
-				delete[] buf;
-
-				_close(fd);
-			}
-			else {
-				blog(LOG_ERROR,
-					"obs-browser: report issue: failed opening file for reading: %s",
-					wstring_to_utf8(zipPath).c_str());
-			}
-		};
-
 		auto addWindowCaptureToZip = [&](const HWND& hWnd, int nBitCount, std::wstring zipPath)
 		{
 			//calculate the number of color indexes in the color table
@@ -443,35 +410,45 @@ void StreamElementsReportIssueDialog::accept()
 				L"crashes/"
 			};
 
-			// Collect all files
-			for (auto &i : std::experimental::filesystem::
-				     recursive_directory_iterator(
-					     programDataPathBuf)) {
-				if (!std::experimental::filesystem::is_directory(
-					    i.path())) {
-					std::wstring local_path = i.path().c_str();
-					std::wstring zip_path = local_path.substr(obsDataPath.size() + 1);
-
-					std::wstring zip_path_lcase = zip_path;
-					std::transform(zip_path_lcase.begin(), zip_path_lcase.end(), zip_path_lcase.begin(), ::towlower);
-					std::transform(zip_path_lcase.begin(), zip_path_lcase.end(), zip_path_lcase.begin(), [](wchar_t ch) {
-						return ch == L'\\' ? L'/' : ch;
-					});
-
-					bool accept = true;
-					for (auto item : blacklist) {
-						if (zip_path_lcase.size() >= item.size()) {
-							if (zip_path_lcase.substr(0, item.size()) == item) {
-								accept = false;
-
-								break;
-							}
+			auto isBlacklisted = [&](const std::wstring& zip_path_lcase) -> bool {
+				for (auto& item : blacklist) {
+					if (zip_path_lcase.size() >= item.size()) {
+						if (zip_path_lcase.compare(0, item.size(), item) == 0) {
+							return true;
 						}
 					}
+				}
+
+				return false;
+			};
 
-					if (accept) {
-						local_to_zip_files_map[local_path] = L"obs-studio\\" + zip_path;
+			// Collect all files, without descending into blacklisted directories
+			for (auto it = std::experimental::filesystem::
+				     recursive_directory_iterator(
+					     programDataPathBuf);
+			     it != std::experimental::filesystem::
+					   recursive_directory_iterator();
+			     ++it) {
+				std::wstring local_path = it->path().c_str();
+				std::wstring zip_path = local_path.substr(obsDataPath.size() + 1);
+
+				std::wstring zip_path_lcase = zip_path;
+				std::transform(zip_path_lcase.begin(), zip_path_lcase.end(), zip_path_lcase.begin(), ::towlower);
+				std::transform(zip_path_lcase.begin(), zip_path_lcase.end(), zip_path_lcase.begin(), [](wchar_t ch) {
+					return ch == L'\\' ? L'/' : ch;
+				});
+
+				if (std::experimental::filesystem::is_directory(
+					    it->path())) {
+					if (isBlacklisted(zip_path_lcase + L"/")) {
+						it.disable_recursion_pending();
 					}
+
+					continue;
+				}
+
+				if (!isBlacklisted(zip_path_lcase)) {
+					local_to_zip_files_map[local_path] = L"obs-studio\\" + zip_path;
 				}
 			}
 
@@ -495,23 +472,52 @@ void StreamElementsReportIssueDialog::accept()
 
 		dialog.setMessage(obs_module_text("StreamElements.ReportIssue.Progress.Message.CollectingFiles"));
 
-		size_t count = 0;
-		size_t total = local_to_zip_files_map.size();
+		{
+			std::vector<report_file> files;
+			uint64_t totalBytes = 0;
 
-		for (auto item : local_to_zip_files_map) {
-			if (dialog.cancelled()) {
-				goto cancelled;
+			for (auto& item : local_to_zip_files_map) {
+				report_file file;
+
+				file.local_path = item.first;
+				file.zip_path = wstring_to_utf8(item.second);
+
+				std::wstring zip_path_lcase = item.second;
+				std::transform(zip_path_lcase.begin(), zip_path_lcase.end(), zip_path_lcase.begin(), ::towlower);
+
+				file.is_log =
+					zip_path_lcase.compare(0, 16, L"obs-studio\\logs\\") == 0 ||
+					(zip_path_lcase.size() > 4 && zip_path_lcase.compare(zip_path_lcase.size() - 4, 4, L".log") == 0);
+
+				std::error_code ec;
+				file.size = std::experimental::filesystem::file_size(item.first, ec);
+				if (ec) {
+					file.size = 0;
+				}
+
+				if (file.is_log && file.size > REPORT_ISSUE_MAX_LOG_SIZE) {
+					file.size = REPORT_ISSUE_MAX_LOG_SIZE;
+				}
+
+				totalBytes += file.size;
+
+				files.push_back(file);
 			}
 
-			++count;
+			// Progress is reported in 1/1000ths of totalBytes
+			dialog.setProgress(0, 1000, 0);
 
-			addFileToZip(item.first, item.second);
+			bool completed = add_report_files_to_zip(zip, files, [&](uint64_t bytes) -> bool {
+				if (totalBytes) {
+					dialog.setProgress(0, 1000, (int)(bytes * 1000 / totalBytes));
+				}
 
-			dialog.setProgress(0, (int)total, (int)count);
-		}
+				return !dialog.cancelled();
+			});
 
-		if (dialog.cancelled()) {
-			goto cancelled;
+			if (!completed) {
+				goto cancelled;
+			}
 		}
 
 		dialog.setMessage(obs_module_text("StreamElements.ReportIssue.Progress.Message.CollectingCpuBenchmark"));
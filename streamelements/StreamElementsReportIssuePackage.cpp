@@ -0,0 +1,219 @@
+#include "StreamElementsReportIssuePackage.hpp"
+
+#include "deps/zip/zip.h"
+
+#include <util/base.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <share.h>
+
+typedef __int64 file_offset_t;
+#define file_seek _lseeki64
+#define file_read _read
+#define file_close _close
+#else
+#include <unistd.h>
+
+typedef off_t file_offset_t;
+#define file_seek lseek
+#define file_read read
+#define file_close close
+#endif
+
+struct compressed_report_file {
+	size_t index;
+	void *data;
+	size_t size;
+	size_t uncompressed_size;
+	unsigned int uncomp_crc32;
+};
+
+bool read_report_file(const report_file &file, std::string &output)
+{
+#ifdef _WIN32
+	// Logs are still open for writing, do not deny sharing
+	int fd = _wsopen(file.local_path.c_str(), _O_RDONLY | _O_BINARY,
+			 _SH_DENYNO, 0);
+#else
+	int fd = open(file.local_path.c_str(), O_RDONLY);
+#endif
+
+	if (-1 == fd)
+		return false;
+
+	file_offset_t size = file_seek(fd, 0, SEEK_END);
+	file_offset_t offset = 0;
+	size_t max_size = SIZE_MAX;
+
+	if (file.is_log) {
+		max_size = REPORT_ISSUE_MAX_LOG_SIZE;
+
+		if (size > (file_offset_t)max_size) {
+			offset = size - max_size;
+
+			char note[128];
+			snprintf(note, sizeof(note),
+				 "[report issue: first %lld bytes omitted]\r\n",
+				 (long long)offset);
+			output += note;
+		}
+	}
+
+	file_seek(fd, offset, SEEK_SET);
+
+	size_t start = output.size();
+	if (size > offset)
+		output.reserve(start + (size_t)(size - offset));
+
+	// The file may still be growing: read until EOF or max_size
+	for (;;) {
+		size_t read_size = output.size() - start;
+		if (read_size >= max_size)
+			break;
+
+		unsigned int block = (unsigned int)std::min<size_t>(
+			REPORT_ISSUE_READ_BLOCK_SIZE, max_size - read_size);
+
+		size_t pos = output.size();
+		output.resize(pos + block);
+
+		int bytes_read = (int)file_read(fd, &output[pos], block);
+		if (bytes_read <= 0) {
+			output.resize(pos);
+			break;
+		}
+
+		output.resize(pos + bytes_read);
+	}
+
+	file_close(fd);
+
+	return true;
+}
+
+bool add_report_files_to_zip(struct zip_t *zip,
+			     const std::vector<report_file> &files,
+			     std::function<bool(uint64_t)> on_progress)
+{
+	if (files.empty())
+		return true;
+
+	size_t worker_count = std::min<size_t>(
+		std::max<size_t>(std::thread::hardware_concurrency(), 1),
+		REPORT_ISSUE_MAX_WORKERS);
+	worker_count = std::min<size_t>(worker_count, files.size());
+
+	// Bound memory held by compressed files waiting to be written
+	const size_t max_queued = worker_count * 2;
+
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<compressed_report_file> completed;
+	std::atomic<size_t> next_index(0);
+	std::atomic<bool> cancelled(false);
+
+	auto worker = [&]() {
+		for (;;) {
+			size_t index = next_index++;
+
+			if (index >= files.size() || cancelled)
+				break;
+
+			compressed_report_file result = {index, nullptr, 0, 0,
+							 0};
+
+			std::string buf;
+			if (read_report_file(files[index], buf)) {
+				result.data = zip_deflate(
+					buf.data(), buf.size(),
+					ZIP_DEFAULT_COMPRESSION_LEVEL,
+					&result.size, &result.uncomp_crc32);
+				result.uncompressed_size = buf.size();
+			}
+
+			std::unique_lock<std::mutex> lock(mutex);
+
+			cv.wait(lock, [&] {
+				return completed.size() < max_queued ||
+				       cancelled;
+			});
+
+			completed.push_back(result);
+			cv.notify_all();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < worker_count; ++i)
+		workers.emplace_back(worker);
+
+	uint64_t bytes_done = 0;
+
+	for (size_t count = 0; count < files.size(); ++count) {
+		compressed_report_file result;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			cv.wait(lock, [&] { return !completed.empty(); });
+
+			result = completed.front();
+			completed.pop_front();
+
+			cv.notify_all();
+		}
+
+		const report_file &file = files[result.index];
+
+		if (!result.data) {
+			blog(LOG_ERROR,
+			     "obs-browser: report issue: failed reading file: %s",
+			     file.zip_path.c_str());
+		} else {
+			if (0 != zip_entry_write_deflated(zip,
+							  file.zip_path.c_str(),
+							  result.data,
+							  result.size,
+							  result.uncompressed_size,
+							  result.uncomp_crc32)) {
+				blog(LOG_ERROR,
+				     "obs-browser: report issue: failed adding file: %s",
+				     file.zip_path.c_str());
+			}
+
+			free(result.data);
+		}
+
+		bytes_done += file.size;
+
+		if (!on_progress(bytes_done)) {
+			cancelled = true;
+
+			std::lock_guard<std::mutex> guard(mutex);
+			cv.notify_all();
+
+			break;
+		}
+	}
+
+	for (auto &thread : workers)
+		thread.join();
+
+	for (auto &result : completed)
+		free(result.data);
+
+	return !cancelled;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct zip_t;
+
+// Log files keep only their most recent REPORT_ISSUE_MAX_LOG_SIZE bytes
+#define REPORT_ISSUE_MAX_LOG_SIZE (8 * 1024 * 1024)
+#define REPORT_ISSUE_READ_BLOCK_SIZE (1024 * 1024)
+#define REPORT_ISSUE_MAX_WORKERS 8
+
+struct report_file {
+#ifdef _WIN32
+	std::wstring local_path;
+#else
+	std::string local_path;
+#endif
+	std::string zip_path;
+	uint64_t size; // bytes expected to be read, after capping
+	bool is_log;
+};
+
+// Appends the contents of file to output. Logs are capped to their last
+// REPORT_ISSUE_MAX_LOG_SIZE bytes, preceded by a note on what was omitted.
+//
+// Returns false if the file could not be opened.
+//
+bool read_report_file(const report_file &file, std::string &output);
+
+// Reads and compresses files on worker threads, while entries are added to
+// zip on the calling thread as they complete. on_progress receives the number
+// of bytes processed so far, and returns false to cancel.
+//
+// Returns false if cancelled.
+//
+bool add_report_files_to_zip(struct zip_t *zip,
+			     const std::vector<report_file> &files,
+			     std::function<bool(uint64_t)> on_progress);
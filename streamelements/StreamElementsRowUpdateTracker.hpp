@@ -0,0 +1,76 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/* Tracks which rows of a list need updating between deferred updates.
+ *
+ * MarkAll() requests a pass over all rows, for changes which may move
+ * rows. MarkKey() requests an update of the row showing key only. The
+ * update calls Take(): when it returns true the caller updates every row
+ * and records the new layout with SetRows(). Otherwise it updates just the
+ * rows returned, found through the layout recorded by the last SetRows().
+ */
+template<class Key> class StreamElementsRowUpdateTracker {
+public:
+	typedef std::vector<std::pair<int, Key>> rows_t;
+
+	void MarkAll()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		m_all = true;
+	}
+
+	void MarkKey(const Key &key)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		m_keys.insert(key);
+	}
+
+	/* Takes the pending updates; returns true if every row must be
+	 * updated, otherwise fills rows with the marked keys which have a
+	 * row */
+	bool Take(rows_t &rows)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		bool all = m_all;
+
+		if (!all) {
+			for (auto &key : m_keys) {
+				auto it = m_rows.find(key);
+
+				if (it != m_rows.end())
+					rows.emplace_back(it->second, key);
+			}
+		}
+
+		m_all = false;
+		m_keys.clear();
+
+		return all;
+	}
+
+	/* Records the layout after a pass over all rows: keys[i] is shown
+	 * in row i */
+	void SetRows(const std::vector<Key> &keys)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		m_rows.clear();
+
+		for (size_t i = 0; i < keys.size(); ++i)
+			m_rows[keys[i]] = (int)i;
+	}
+
+private:
+	std::mutex m_mutex;
+	bool m_all = true;
+	std::unordered_set<Key> m_keys;
+	std::unordered_map<Key, int> m_rows;
+};
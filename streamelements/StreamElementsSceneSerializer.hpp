@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../cef-headers.hpp"
+
+#include <obs.h>
+
+/* Conversion between libobs scene data and the CefValue trees of the scene
+ * API. Depends on neither Qt nor the frontend API.
+ */
+
+/* obs_data_t and CefValue trees are converted directly, in a single pass,
+ * without going through JSON text */
+CefRefPtr<CefValue> SerializeData(obs_data_t *data);
+bool DeserializeData(CefRefPtr<CefValue> input, obs_data_t *data);
+
+/* Settings of source as a dictionary, null for no source */
+CefRefPtr<CefValue> SerializeObsSourceSettings(obs_source_t *source);
+
+/* "composition" of a scene item: transform, crop and bounds */
+CefRefPtr<CefDictionaryValue>
+SerializeObsSceneItemCompositionSettings(obs_source_t *source,
+					 obs_sceneitem_t *sceneitem);
+bool DeserializeSceneItemComposition(CefRefPtr<CefValue> &input,
+				     obs_transform_info &info,
+				     obs_sceneitem_crop &crop);
@@ -166,12 +166,12 @@ public:
 
 	ItemData *data(obs_source_t *key) const
 	{
-		for (auto kv : m_itemData) {
-			if (kv.first == key)
-				return kv.second;
-		}
+		auto it = m_itemData.find(key);
+
+		if (it == m_itemData.end())
+			return nullptr;
 
-		return nullptr;
+		return it->second;
 	}
 
 	static SourceDataManager *instance() { return &s_instance; }
@@ -468,7 +468,12 @@ void StreamElementsScenesListWidgetManager::HandleSceneRename(
 	StreamElementsScenesListWidgetManager *self =
 		(StreamElementsScenesListWidgetManager *)data;
 
-	self->ScheduleUpdateWidgets();
+	obs_source_t *source = (obs_source_t *)calldata_ptr(params, "source");
+
+	if (!source || !obs_scene_from_source(source))
+		return;
+
+	self->ScheduleUpdateScene(source);
 }
 
 void StreamElementsScenesListWidgetManager::HandleScenesModelReset()
@@ -536,7 +541,7 @@ void StreamElementsScenesListWidgetManager::SetScenePropertyValue(
 	obs_data_release(private_data);
 
 	if (triggerUpdate) {
-		ScheduleUpdateWidgets();
+		ScheduleUpdateScene(scene);
 	}
 }
 
@@ -632,6 +637,20 @@ void StreamElementsScenesListWidgetManager::ScheduleUpdateWidgets()
 	if (!m_enableSignals)
 		return;
 
+	m_rowUpdates.MarkAll();
+
+	m_updateWidgetsDeferredExecutive.Signal([this]() { UpdateWidgets(); },
+						250);
+}
+
+void StreamElementsScenesListWidgetManager::ScheduleUpdateScene(
+	obs_source_t *scene)
+{
+	if (!m_enableSignals)
+		return;
+
+	m_rowUpdates.MarkKey(scene);
+
 	m_updateWidgetsDeferredExecutive.Signal([this]() { UpdateWidgets(); },
 						250);
 }
@@ -681,43 +700,29 @@ void StreamElementsScenesListWidgetManager::UpdateScenesToolbar()
 	m_scenesToolBar->addWidget(widget);
 }
 
-void StreamElementsScenesListWidgetManager::UpdateWidgets()
+void StreamElementsScenesListWidgetManager::UpdateRow(int rowIndex,
+							obs_source_t *scene,
+							bool isSignedIn)
 {
-	struct obs_frontend_source_list sources = {};
-
-	obs_frontend_get_scenes(&sources);
-
-	obs_source_t *current_scene = obs_frontend_get_current_scene();
+	QListWidgetItem *item = m_nativeWidget->item(rowIndex);
 
-	if (!current_scene)
+	if (!item)
 		return;
 
-	bool isSignedIn =
-		!StreamElementsConfig::GetInstance()->IsOnBoardingMode();
+	QIcon icon;
 
-	SourceDataManager::instance()->removeDataNotInList(sources);
-
-	for (int rowIndex = 0; rowIndex < m_nativeWidget->count() &&
-				rowIndex < sources.sources.num;
-		++rowIndex) {
-		if (!isSignedIn) {
-			m_nativeWidget->item(rowIndex)->setIcon(
-				QIcon());
-
-			continue;
-		}
-
-		obs_source_t *scene = sources.sources.array[rowIndex];
-
-		ItemData *data =
-			SourceDataManager::instance()->data(scene);
+	if (isSignedIn) {
+		ItemData *data = SourceDataManager::instance()->data(scene);
 
 		if (!data) {
-			data = new ItemData(
-				[this]() { ScheduleUpdateWidgets(); });
+			/* Auxiliary data is decoded once per scene, later
+			 * changes go through the Set* methods.
+			 */
+			data = new ItemData([this, scene]() {
+				ScheduleUpdateScene(scene);
+			});
 
-			SourceDataManager::instance()->setData(scene,
-								data);
+			SourceDataManager::instance()->setData(scene, data);
 
 			data->DeserializeIcon(GetSceneIcon(scene));
 
@@ -728,18 +733,70 @@ void StreamElementsScenesListWidgetManager::UpdateWidgets()
 				GetSceneContextMenu(scene));
 		}
 
-		if (m_nativeWidget->viewMode() == QListView::IconMode) {
-			/* Grid Mode: icons are not supported */
-			m_nativeWidget->item(rowIndex)->setIcon(QIcon());
-		} else {
-			m_nativeWidget->item(rowIndex)->setIcon(data->icon());
+		/* Grid Mode: icons are not supported */
+		if (m_nativeWidget->viewMode() != QListView::IconMode)
+			icon = data->icon();
+	}
+
+	/* Setting an icon emits dataChanged() and relayouts the row */
+	if (item->icon().cacheKey() != icon.cacheKey())
+		item->setIcon(icon);
+}
+
+void StreamElementsScenesListWidgetManager::UpdateWidgets()
+{
+	StreamElementsRowUpdateTracker<obs_source_t *>::rows_t dirtyRows;
+
+	bool updateRows = m_rowUpdates.Take(dirtyRows);
+
+	bool isSignedIn =
+		!StreamElementsConfig::GetInstance()->IsOnBoardingMode();
+
+	if (!updateRows) {
+		/* Row layout is unchanged: only touch the rows of scenes
+		 * whose data changed.
+		 */
+		for (auto &row : dirtyRows) {
+			if (row.first >= m_nativeWidget->count())
+				continue;
+
+			UpdateRow(row.first, row.second, isSignedIn);
 		}
+
+		return;
+	}
+
+	struct obs_frontend_source_list sources = {};
+
+	obs_frontend_get_scenes(&sources);
+
+	obs_source_t *current_scene = obs_frontend_get_current_scene();
+
+	if (!current_scene) {
+		obs_frontend_source_list_free(&sources);
+
+		return;
 	}
 
+	SourceDataManager::instance()->removeDataNotInList(sources);
+
+	std::vector<obs_source_t *> sceneRows;
+
+	for (int rowIndex = 0; rowIndex < m_nativeWidget->count() &&
+			       rowIndex < (int)sources.sources.num;
+	     ++rowIndex) {
+		obs_source_t *scene = sources.sources.array[rowIndex];
+
+		sceneRows.push_back(scene);
+
+		UpdateRow(rowIndex, scene, isSignedIn);
+	}
+
+	m_rowUpdates.SetRows(sceneRows);
+
 	obs_source_release(current_scene);
 
-	obs_frontend_source_list_free(
-		(obs_frontend_source_list *)&sources);
+	obs_frontend_source_list_free(&sources);
 }
 
 void StreamElementsScenesListWidgetManager::HandleScenesItemDoubleClicked(
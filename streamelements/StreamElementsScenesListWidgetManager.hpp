@@ -1,6 +1,7 @@
 #pragma once
 
 #include "StreamElementsDeferredExecutive.hpp"
+#include "StreamElementsRowUpdateTracker.hpp"
 #include "StreamElementsUtils.hpp"
 
 #include <obs.h>
@@ -78,7 +79,9 @@ private:
 	void HandleScenesItemDoubleClicked(QListWidgetItem *item);
 
 	void ScheduleUpdateWidgets();
+	void ScheduleUpdateScene(obs_source_t *scene);
 	void UpdateWidgets();
+	void UpdateRow(int rowIndex, obs_source_t *scene, bool isSignedIn);
 
 	void UpdateScenesToolbar();
 
@@ -93,4 +96,9 @@ private:
 	QToolBar *m_scenesToolBar = nullptr;
 	QObject *m_eventFilter = nullptr;
 	QListWidget::ViewMode m_prevViewMode = QListView::ListMode;
+
+	/* Pending updates: a pass over all rows, or the rows of specific
+	 * scenes when the row layout is unchanged.
+	 */
+	StreamElementsRowUpdateTracker<obs_source_t *> m_rowUpdates;
 };
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <util/base.h>
+#include <util/platform.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* Copy-on-write list for registries which are read far more often than
+ * they change, such as the browsers a broadcast is sent to.
+ *
+ * Readers take a reference to the current immutable list under the lock
+ * and walk it without holding the lock. Writers copy the list, change the
+ * copy and swap it in under the lock. How long the lock is held is
+ * recorded, and holds of 1 ms or more are logged.
+ */
+template<class T> class StreamElementsSnapshotList {
+public:
+	typedef std::vector<T> list_t;
+	typedef std::shared_ptr<const list_t> snapshot_t;
+
+	struct lock_stats_t {
+		uint64_t holds;
+		uint64_t total_ns;
+		uint64_t max_ns;
+	};
+
+	/* name is used in log messages */
+	explicit StreamElementsSnapshotList(const char *name)
+		: m_name(name), m_list(std::make_shared<const list_t>())
+	{
+	}
+
+	snapshot_t Snapshot()
+	{
+		Lock lock(this);
+
+		return m_list;
+	}
+
+	/* Replaces the list with a copy changed by update. update runs under
+	 * the lock. */
+	void Update(std::function<void(list_t &)> update)
+	{
+		/* Released after the lock: may hold the last refs to items */
+		snapshot_t prevList;
+
+		Lock lock(this);
+
+		std::shared_ptr<list_t> list =
+			std::make_shared<list_t>(*m_list);
+
+		update(*list);
+
+		prevList = std::move(m_list);
+		m_list = std::move(list);
+	}
+
+	lock_stats_t GetLockStats() const
+	{
+		return {m_lockHolds, m_lockTotalNs, m_lockMaxNs};
+	}
+
+	void LogLockStats() const
+	{
+		lock_stats_t stats = GetLockStats();
+
+		if (!stats.holds)
+			return;
+
+		blog(LOG_DEBUG,
+		     "obs-browser: %s lock held %llu times, avg %.3f ms, max %.3f ms",
+		     m_name.c_str(), (unsigned long long)stats.holds,
+		     (double)stats.total_ns / (double)stats.holds / 1000000.0,
+		     (double)stats.max_ns / 1000000.0);
+	}
+
+private:
+	static const uint64_t SLOW_LOCK_NS = 1000000ULL;
+
+	class Lock {
+	public:
+		Lock(StreamElementsSnapshotList *owner)
+			: m_owner(owner),
+			  m_guard(owner->m_mutex),
+			  m_startTime(os_gettime_ns())
+		{
+		}
+
+		~Lock()
+		{
+			uint64_t holdTime = os_gettime_ns() - m_startTime;
+
+			++m_owner->m_lockHolds;
+			m_owner->m_lockTotalNs += holdTime;
+
+			uint64_t maxTime = m_owner->m_lockMaxNs;
+			while (holdTime > maxTime &&
+			       !m_owner->m_lockMaxNs.compare_exchange_weak(
+				       maxTime, holdTime))
+				;
+
+			if (holdTime >= SLOW_LOCK_NS)
+				blog(LOG_WARNING,
+				     "obs-browser: %s lock held for %.3f ms",
+				     m_owner->m_name.c_str(),
+				     (double)holdTime / 1000000.0);
+		}
+
+	private:
+		StreamElementsSnapshotList *m_owner;
+		std::lock_guard<std::recursive_mutex> m_guard;
+		uint64_t m_startTime;
+	};
+
+	std::string m_name;
+
+	/* Recursive: update may call back into code reading the list */
+	std::recursive_mutex m_mutex;
+	snapshot_t m_list;
+
+	std::atomic<uint64_t> m_lockHolds{0};
+	std::atomic<uint64_t> m_lockTotalNs{0};
+	std::atomic<uint64_t> m_lockMaxNs{0};
+};
@@ -0,0 +1,147 @@
+#include "StreamElementsStatePartitionWriter.hpp"
+
+#include <util/base.h>
+#include <util/platform.h>
+
+StreamElementsStatePartitionWriter::StreamElementsStatePartitionWriter(
+	write_func_t write)
+	: m_write(write)
+{
+}
+
+bool StreamElementsStatePartitionWriter::Request()
+{
+	if (m_scheduled.exchange(true))
+		return false;
+
+	m_requestTime = os_gettime_ns();
+
+	return true;
+}
+
+size_t StreamElementsStatePartitionWriter::Update(
+	const std::map<std::string, std::string> &partitions)
+{
+	m_scheduled = false;
+
+	uint64_t requestTime = m_requestTime.exchange(0);
+
+	if (!requestTime)
+		requestTime = os_gettime_ns();
+
+	std::map<std::string, std::string> dirty;
+
+	for (auto &kv : partitions) {
+		auto persisted = m_persisted.find(kv.first);
+
+		if (persisted != m_persisted.end() &&
+		    persisted->second == kv.second)
+			continue;
+
+		m_persisted[kv.first] = kv.second;
+		dirty[kv.first] = kv.second;
+	}
+
+	if (!dirty.size())
+		return 0;
+
+	std::lock_guard<std::mutex> guard(m_pendingMutex);
+
+	// Newer content supersedes content which was not written yet
+	for (auto &kv : dirty)
+		m_pending[kv.first] = kv.second;
+
+	if (!m_pendingSince || requestTime < m_pendingSince)
+		m_pendingSince = requestTime;
+
+	return dirty.size();
+}
+
+StreamElementsStatePartitionWriter::write_result_t
+StreamElementsStatePartitionWriter::WritePending()
+{
+	std::lock_guard<std::mutex> writeGuard(m_writeMutex);
+
+	write_result_t result = {};
+
+	std::map<std::string, std::string> writes;
+	uint64_t pendingSince = 0;
+
+	{
+		std::lock_guard<std::mutex> guard(m_pendingMutex);
+
+		writes.swap(m_pending);
+		pendingSince = m_pendingSince;
+		m_pendingSince = 0;
+	}
+
+	if (!writes.size())
+		return result;
+
+	uint64_t writeStartTime = os_gettime_ns();
+
+	std::map<std::string, std::string> failed;
+
+	for (auto &kv : writes) {
+		if (m_write(kv.first, kv.second)) {
+			result.bytes += kv.second.size();
+			++result.partitions;
+		} else {
+			failed[kv.first] = kv.second;
+		}
+	}
+
+	if (failed.size()) {
+		std::lock_guard<std::mutex> guard(m_pendingMutex);
+
+		// Retry on next write unless superseded by newer content
+		for (auto &kv : failed)
+			m_pending.emplace(kv.first, kv.second);
+
+		if (!m_pendingSince)
+			m_pendingSince = pendingSince;
+
+		result.failed = failed.size();
+	}
+
+	uint64_t now = os_gettime_ns();
+	result.latencyNs = pendingSince ? now - pendingSince : 0;
+
+	stats_t stats;
+
+	{
+		std::lock_guard<std::mutex> guard(m_statsMutex);
+
+		m_stats.bytesWritten += result.bytes;
+		m_stats.partitionsWritten += result.partitions;
+		m_stats.totalLatencyNs += result.latencyNs;
+		++m_stats.writeCount;
+
+		if (result.latencyNs > m_stats.maxLatencyNs)
+			m_stats.maxLatencyNs = result.latencyNs;
+
+		stats = m_stats;
+	}
+
+	blog(LOG_INFO,
+	     "obs-browser: state: persisted %d partitions, %llu bytes (write %.3f ms, latency %.3f ms); totals: %llu bytes, %llu partitions, %llu writes, average latency %.3f ms, max %.3f ms",
+	     (int)result.partitions, (unsigned long long)result.bytes,
+	     (double)(now - writeStartTime) / 1000000.0,
+	     (double)result.latencyNs / 1000000.0,
+	     (unsigned long long)stats.bytesWritten,
+	     (unsigned long long)stats.partitionsWritten,
+	     (unsigned long long)stats.writeCount,
+	     (double)stats.totalLatencyNs / (double)stats.writeCount /
+		     1000000.0,
+	     (double)stats.maxLatencyNs / 1000000.0);
+
+	return result;
+}
+
+StreamElementsStatePartitionWriter::stats_t
+StreamElementsStatePartitionWriter::GetStats()
+{
+	std::lock_guard<std::mutex> guard(m_statsMutex);
+
+	return m_stats;
+}
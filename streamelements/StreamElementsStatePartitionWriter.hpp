@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+/* Persistence of state partitions, written only when they change.
+ *
+ * Persist requests made in quick succession are coalesced: Request()
+ * returns true only for the first request since the last snapshot, and
+ * the owner schedules one Update() for all of them. Update() compares each
+ * partition's content with what was last persisted and queues the changed
+ * ones. WritePending() writes the queue through the supplied function,
+ * normally on a background thread; failed writes are retried on the next
+ * call unless newer content supersedes them.
+ *
+ * File I/O is supplied by the owner, so this depends on neither Qt nor
+ * CEF.
+ */
+class StreamElementsStatePartitionWriter {
+public:
+	/* Writes content as partition name; returns true on success */
+	typedef std::function<bool(const std::string &name,
+				   const std::string &content)>
+		write_func_t;
+
+	struct write_result_t {
+		size_t partitions;
+		size_t bytes;
+		size_t failed;
+		uint64_t latencyNs;
+	};
+
+	struct stats_t {
+		uint64_t bytesWritten;
+		uint64_t partitionsWritten;
+		uint64_t writeCount;
+		uint64_t totalLatencyNs;
+		uint64_t maxLatencyNs;
+	};
+
+	StreamElementsStatePartitionWriter(write_func_t write);
+
+	/* Records a persist request. Returns true if a snapshot must be
+	 * scheduled, false if one already is. */
+	bool Request();
+
+	/* Takes a snapshot of all partitions (name to content), and queues
+	 * the ones which changed. Returns the number queued. */
+	size_t Update(const std::map<std::string, std::string> &partitions);
+
+	/* Writes queued partitions on the calling thread */
+	write_result_t WritePending();
+
+	stats_t GetStats();
+
+private:
+	write_func_t m_write;
+
+	std::atomic<bool> m_scheduled = {false};
+	std::atomic<uint64_t> m_requestTime = {0};
+
+	// Last content of each partition (snapshot thread)
+	std::map<std::string, std::string> m_persisted;
+
+	// Partitions waiting to be written, and the time the earliest of
+	// them was requested
+	std::mutex m_pendingMutex;
+	std::map<std::string, std::string> m_pending;
+	uint64_t m_pendingSince = 0;
+
+	std::mutex m_writeMutex;
+
+	std::mutex m_statsMutex;
+	stats_t m_stats = {};
+};
@@ -0,0 +1,235 @@
+#include "StreamElementsTracer.hpp"
+
+#include "json11/json11.hpp"
+
+#include <util/platform.h>
+
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <cstring>
+
+// Events kept per thread, older events are overwritten
+#define THREAD_BUFFER_CAPACITY 8192
+
+// Buffers of exited threads are dropped beyond this count
+#define MAX_THREAD_BUFFERS 256
+
+std::atomic<bool> StreamElementsTracer::s_enabled = {false};
+
+namespace {
+struct trace_event_t {
+	uint64_t timestamp;
+	uint64_t id;
+	const char *category;
+	char phase;
+	char name[63];
+};
+
+class ThreadBuffer {
+public:
+	ThreadBuffer(uint32_t tid) : tid(tid), alive(true) {}
+
+	void Record(char phase, const char *category, const char *name,
+		    uint64_t id)
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+
+		if (events.empty())
+			events.resize(THREAD_BUFFER_CAPACITY);
+
+		trace_event_t &event = events[next];
+
+		event.timestamp = os_gettime_ns();
+		event.id = id;
+		event.category = category;
+		event.phase = phase;
+
+		if (name) {
+			strncpy(event.name, name, sizeof(event.name) - 1);
+			event.name[sizeof(event.name) - 1] = 0;
+		} else {
+			event.name[0] = 0;
+		}
+
+		next = (next + 1) % THREAD_BUFFER_CAPACITY;
+
+		if (count < THREAD_BUFFER_CAPACITY)
+			++count;
+	}
+
+	std::mutex mutex;
+	std::vector<trace_event_t> events;
+	size_t next = 0;
+	size_t count = 0;
+	const uint32_t tid;
+	std::atomic<bool> alive;
+};
+
+class BufferRegistry {
+public:
+	std::mutex mutex;
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	uint32_t nextTid = 1;
+};
+
+BufferRegistry &GetRegistry()
+{
+	// Never destroyed: threads may still record during static destruction
+	static BufferRegistry *registry = new BufferRegistry();
+
+	return *registry;
+}
+
+struct thread_buffer_holder_t {
+	std::shared_ptr<ThreadBuffer> buffer;
+
+	~thread_buffer_holder_t()
+	{
+		if (buffer)
+			buffer->alive = false;
+	}
+};
+
+thread_local thread_buffer_holder_t t_holder;
+
+ThreadBuffer *GetThreadBuffer(bool create)
+{
+	if (t_holder.buffer || !create)
+		return t_holder.buffer.get();
+
+	BufferRegistry &registry = GetRegistry();
+
+	std::lock_guard<std::mutex> guard(registry.mutex);
+
+	if (registry.buffers.size() >= MAX_THREAD_BUFFERS) {
+		for (auto it = registry.buffers.begin();
+		     it != registry.buffers.end();) {
+			if ((*it)->alive)
+				++it;
+			else
+				it = registry.buffers.erase(it);
+		}
+
+		if (registry.buffers.size() >= MAX_THREAD_BUFFERS)
+			return nullptr;
+	}
+
+	t_holder.buffer = std::make_shared<ThreadBuffer>(registry.nextTid++);
+	registry.buffers.push_back(t_holder.buffer);
+
+	return t_holder.buffer.get();
+}
+
+void Record(char phase, const char *category, const char *name, uint64_t id,
+	    bool create = true)
+{
+	ThreadBuffer *buffer = GetThreadBuffer(create);
+
+	if (buffer)
+		buffer->Record(phase, category, name, id);
+}
+}
+
+void StreamElementsTracer::SetEnabled(bool enabled)
+{
+	s_enabled = enabled;
+}
+
+void StreamElementsTracer::Clear()
+{
+	BufferRegistry &registry = GetRegistry();
+
+	std::lock_guard<std::mutex> guard(registry.mutex);
+
+	for (auto buffer : registry.buffers) {
+		std::lock_guard<std::mutex> bufferGuard(buffer->mutex);
+
+		buffer->next = 0;
+		buffer->count = 0;
+	}
+}
+
+void StreamElementsTracer::RecordBegin(const char *category, const char *name)
+{
+	if (IsEnabled())
+		Record('B', category, name, 0);
+}
+
+void StreamElementsTracer::RecordEnd(const char *category)
+{
+	// Close spans which were opened before tracing was disabled
+	Record('E', category, nullptr, 0, IsEnabled());
+}
+
+uint64_t StreamElementsTracer::NewAsyncId()
+{
+	static std::atomic<uint64_t> s_nextId = {1};
+
+	return s_nextId++;
+}
+
+void StreamElementsTracer::RecordAsyncBegin(const char *category,
+					    const char *name, uint64_t id)
+{
+	if (IsEnabled())
+		Record('b', category, name, id);
+}
+
+void StreamElementsTracer::RecordAsyncEnd(const char *category,
+					  const char *name, uint64_t id)
+{
+	Record('e', category, name, id, IsEnabled());
+}
+
+std::string StreamElementsTracer::SerializeChromeTrace()
+{
+	json11::Json::array traceEvents;
+
+	BufferRegistry &registry = GetRegistry();
+
+	std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+	{
+		std::lock_guard<std::mutex> guard(registry.mutex);
+
+		buffers = registry.buffers;
+	}
+
+	for (auto buffer : buffers) {
+		std::lock_guard<std::mutex> guard(buffer->mutex);
+
+		size_t first = (buffer->next + THREAD_BUFFER_CAPACITY -
+				buffer->count) %
+			       THREAD_BUFFER_CAPACITY;
+
+		for (size_t i = 0; i < buffer->count; ++i) {
+			const trace_event_t &event =
+				buffer->events[(first + i) %
+					       THREAD_BUFFER_CAPACITY];
+
+			json11::Json::object item = {
+				{"ph", std::string(1, event.phase)},
+				{"cat", event.category ? event.category : ""},
+				{"ts", (double)event.timestamp / 1000.0},
+				{"pid", 1},
+				{"tid", (int)buffer->tid},
+			};
+
+			if (event.name[0])
+				item["name"] = event.name;
+
+			if (event.phase == 'b' || event.phase == 'e')
+				item["id"] = std::to_string(event.id);
+
+			traceEvents.push_back(item);
+		}
+	}
+
+	json11::Json root = json11::Json::object{
+		{"traceEvents", traceEvents},
+		{"displayTimeUnit", "ms"},
+	};
+
+	return root.dump();
+}
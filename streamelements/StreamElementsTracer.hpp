@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+///
+// Low-overhead span tracer.
+//
+// Events are recorded into per-thread ring buffers while tracing is enabled
+// and can be serialized as Chrome trace-event JSON (chrome://tracing,
+// Perfetto). When tracing is disabled, recording costs one relaxed atomic
+// load.
+//
+// Category strings must have static storage duration. Names are copied.
+//
+class StreamElementsTracer
+{
+public:
+	static bool IsEnabled()
+	{
+		return s_enabled.load(std::memory_order_relaxed);
+	}
+
+	static void SetEnabled(bool enabled);
+	static void Clear();
+
+	static void RecordBegin(const char *category, const char *name);
+	static void RecordEnd(const char *category);
+
+	// Spans which begin and end on different threads
+	static uint64_t NewAsyncId();
+	static void RecordAsyncBegin(const char *category, const char *name,
+				     uint64_t id);
+	static void RecordAsyncEnd(const char *category, const char *name,
+				   uint64_t id);
+
+	// Chrome trace-event JSON of all recorded events
+	static std::string SerializeChromeTrace();
+
+public:
+	///
+	// Records a span for the lifetime of the scope
+	//
+	class Scope
+	{
+	public:
+		Scope(const char *category, const char *name)
+			: m_category(category),
+			  m_active(StreamElementsTracer::IsEnabled())
+		{
+			if (m_active)
+				RecordBegin(category, name);
+		}
+
+		Scope(const char *category, const std::string &name)
+			: m_category(category),
+			  m_active(StreamElementsTracer::IsEnabled())
+		{
+			if (m_active)
+				RecordBegin(category, name.c_str());
+		}
+
+		~Scope()
+		{
+			if (m_active)
+				RecordEnd(m_category);
+		}
+
+	private:
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+
+		const char *m_category;
+		bool m_active;
+	};
+
+private:
+	static std::atomic<bool> s_enabled;
+};
+
+#define SE_TRACE_CONCAT_INNER(a, b) a##b
+#define SE_TRACE_CONCAT(a, b) SE_TRACE_CONCAT_INNER(a, b)
+
+#define SE_TRACE_SCOPE(category, name)                                      \
+	StreamElementsTracer::Scope SE_TRACE_CONCAT(se_trace_scope_, __LINE__)( \
+		category, name)
@@ -4,6 +4,8 @@
 #include "StreamElementsGlobalStateManager.hpp"
 #include "StreamElementsRemoteIconLoader.hpp"
 #include "StreamElementsPleaseWaitWindow.hpp"
+#include "StreamElementsTracer.hpp"
+#include "StreamElementsJsonFileScanner.hpp"
 #include "Version.hpp"
 #include "wide-string.hpp"
 
@@ -16,8 +18,10 @@
 #include <vector>
 #include <regex>
 #include <unordered_map>
+#include <mutex>
 
 #include <curl/curl.h>
+#include <sys/stat.h>
 
 #include <obs-frontend-api.h>
 
@@ -70,89 +74,6 @@ static std::vector<std::string> tokenizeString(const std::string &str,
 
 /* ========================================================= */
 
-void QtPostTask(std::function<void()> task)
-{
-	struct local_context {
-		std::function<void()> task;
-	};
-
-	local_context *context = new local_context();
-	context->task = task;
-
-	QtPostTask(
-		[](void *const data) {
-			local_context *context = (local_context *)data;
-
-			context->task();
-
-			delete context;
-		},
-		context);
-}
-
-void QtPostTask(void (*func)(void *), void *const data)
-{
-	QTimer *t = new QTimer();
-	t->moveToThread(qApp->thread());
-	t->setSingleShot(true);
-	QObject::connect(t, &QTimer::timeout, [=]() {
-		t->deleteLater();
-
-		func(data);
-	});
-	QMetaObject::invokeMethod(t, "start", Qt::QueuedConnection,
-				  Q_ARG(int, 0));
-}
-
-void QtExecSync(std::function<void()> task)
-{
-	struct local_context {
-		std::function<void()> task;
-	};
-
-	local_context *context = new local_context();
-	context->task = task;
-
-	QtExecSync(
-		[](void *data) {
-			local_context *context = (local_context *)data;
-
-			context->task();
-
-			delete context;
-		},
-		context);
-}
-
-void QtExecSync(void (*func)(void *), void *const data)
-{
-	if (QThread::currentThread() == qApp->thread()) {
-		func(data);
-	} else {
-		os_event_t *completeEvent;
-
-		os_event_init(&completeEvent, OS_EVENT_TYPE_AUTO);
-
-		QTimer *t = new QTimer();
-		t->moveToThread(qApp->thread());
-		t->setSingleShot(true);
-		QObject::connect(t, &QTimer::timeout, [=]() {
-			t->deleteLater();
-
-			func(data);
-
-			os_event_signal(completeEvent);
-		});
-		QMetaObject::invokeMethod(t, "start", Qt::QueuedConnection,
-					  Q_ARG(int, 0));
-
-		QApplication::sendPostedEvents();
-
-		os_event_wait(completeEvent);
-		os_event_destroy(completeEvent);
-	}
-}
-
 std::string DockWidgetAreaToString(const Qt::DockWidgetArea area)
 {
 	switch (area) {
@@ -1929,55 +1850,7 @@ bool ReadListOfObsSceneCollections(std::map<std::string, std::string> &output)
 	std::string basePath = basePathPtr;
 	bfree(basePathPtr);
 
-	os_dir_t *dir = os_opendir(basePath.c_str());
-
-	if (!dir)
-		return false;
-
-	struct os_dirent *entry;
-
-	while ((entry = os_readdir(dir)) != NULL) {
-		if (entry->directory || *entry->d_name == '.')
-			continue;
-
-		std::string fileName = entry->d_name;
-
-		std::smatch match;
-
-		if (!std::regex_search(fileName, match,
-				       std::regex("^(.+?)\\.json$")))
-			continue;
-
-		std::string id = match[1].str();
-
-		std::string filePath = basePath + "/" + fileName;
-
-		char *content = os_quick_read_utf8_file(filePath.c_str());
-
-		if (content) {
-			CefRefPtr<CefValue> root =
-				CefParseJSON(CefString(content),
-					     JSON_PARSER_ALLOW_TRAILING_COMMAS);
-
-			if (root.get() && root->GetType() == VTYPE_DICTIONARY) {
-				CefRefPtr<CefDictionaryValue> d =
-					root->GetDictionary();
-
-				if (d->HasKey("name") &&
-				    d->GetType("name") == VTYPE_STRING) {
-					std::string name = d->GetString("name");
-
-					output[id] = name;
-				}
-			}
-
-			bfree(content);
-		}
-	}
-
-	os_closedir(dir);
-
-	return true;
+	return ReadObsSceneCollectionNames(basePath.c_str(), output);
 }
 
 bool ReadListOfObsProfiles(std::map<std::string, std::string> &output)
@@ -2026,7 +1899,7 @@ bool ReadListOfObsProfiles(std::map<std::string, std::string> &output)
 //static
 class LocalCefURLRequestClient : public CefURLRequestClient {
 public:
-	LocalCefURLRequestClient(cef_http_request_callback_t callback)
+	LocalCefURLRequestClient(cef_http_request_response_callback_t callback)
 		: m_callback(callback)
 	{
 	}
@@ -2061,7 +1934,7 @@ public:
 
 private:
 	std::vector<char> m_buffer;
-	cef_http_request_callback_t m_callback;
+	cef_http_request_response_callback_t m_callback;
 
 public:
 	IMPLEMENT_REFCOUNTING(LocalCefURLRequestClient);
@@ -2078,16 +1951,18 @@ void LocalCefURLRequestClient::OnDownloadData(CefRefPtr<CefURLRequest> request,
 void LocalCefURLRequestClient::OnRequestComplete(
 	CefRefPtr<CefURLRequest> request)
 {
-	if (request->GetRequestStatus() == UR_CANCELED)
-		return;
+	CefRefPtr<CefResponse> response = request->GetResponse();
+
+	int http_code = response.get() ? response->GetStatus() : 0;
 
 	if (request->GetRequestStatus() == UR_SUCCESS) {
 		// Success
 
-		m_callback(true, m_buffer.data(), m_buffer.size());
+		m_callback(true, http_code, m_buffer.data(), m_buffer.size(),
+			   response);
 	} else {
 		// Failure
-		m_callback(false, nullptr, 0);
+		m_callback(false, http_code, nullptr, 0, response);
 	}
 }
 
@@ -2095,7 +1970,8 @@ CefRefPtr<CefCancelableTask> QueueCefCancelableTask(std::function<void()> task)
 {
 	CefRefPtr<CefCancelableTask> result = new CefCancelableTask(task);
 
-	CefPostTask(TID_UI, result);
+	if (!CefPostTask(TID_UI, result))
+		return nullptr;
 
 	return result;
 }
@@ -2104,17 +1980,39 @@ CefRefPtr<CefCancelableTask>
 CefHttpGetAsync(const char *url,
 		std::function<void(CefRefPtr<CefURLRequest>)> init_callback,
 		cef_http_request_callback_t callback)
+{
+	return CefHttpGetAsync(
+		url, http_client_headers_t(), init_callback,
+		[callback](bool success, int, void *data, size_t len,
+			   CefRefPtr<CefResponse>) {
+			callback(success, data, len);
+		});
+}
+
+CefRefPtr<CefCancelableTask>
+CefHttpGetAsync(const char *url, http_client_headers_t request_headers,
+		std::function<void(CefRefPtr<CefURLRequest>)> init_callback,
+		cef_http_request_response_callback_t callback)
 {
 	CefRefPtr<CefRequest> request = CefRequest::Create();
 
 	request->SetURL(url);
 	request->SetMethod("GET");
 
+	if (request_headers.size()) {
+		CefRequest::HeaderMap headerMap;
+
+		for (auto header : request_headers)
+			headerMap.insert(std::make_pair(
+				CefString(header.first),
+				CefString(header.second)));
+
+		request->SetHeaderMap(headerMap);
+	}
+
 	CefRefPtr<LocalCefURLRequestClient> client =
 		new LocalCefURLRequestClient(callback);
 
-	extern bool QueueCEFTask(std::function<void()> task);
-
 	return QueueCefCancelableTask([=]() -> void {
 		CefRefPtr<CefURLRequest> cefRequest = CefURLRequest::Create(
 			request, client,
@@ -2122,9 +2020,16 @@ CefHttpGetAsync(const char *url,
 				->GetCookieManager()
 				->GetCefRequestContext());
 
+		if (!cefRequest.get()) {
+			callback(false, 0, nullptr, 0, nullptr);
+
+			return;
+		}
+
 		init_callback(cefRequest);
 	});
 }
+
 //static
 class QRemoteIconMenu : public QMenu {
 public:
@@ -14,6 +14,8 @@
 #include <map>
 
 #include <functional>
+#include <future>
+#include <type_traits>
 
 #include <util/threading.h>
 #include <util/platform.h>
@@ -37,6 +39,9 @@
 #include <QString>
 #include <QWidget>
 
+#include "StreamElementsQtTasks.hpp"
+#include "StreamElementsFileReferenceScanner.hpp"
+
 template<typename... Args> std::string FormatString(const char *format, ...)
 {
 	int size = 512;
@@ -57,10 +62,6 @@ template<typename... Args> std::string FormatString(const char *format, ...)
 	return ret;
 }
 
-void QtPostTask(void (*func)(void *), void *const data);
-void QtPostTask(std::function<void()> task);
-void QtExecSync(void (*func)(void *), void *const data);
-void QtExecSync(std::function<void()> task);
 std::string DockWidgetAreaToString(const Qt::DockWidgetArea area);
 std::string GetCommandLineOptionValue(const std::string key);
 std::string LoadResourceString(std::string path);
@@ -260,10 +261,17 @@ public:
 	IMPLEMENT_REFCOUNTING(CefCancelableTask);
 };
 
+/* Returns nullptr if the task could not be posted to the CEF UI thread */
 CefRefPtr<CefCancelableTask> QueueCefCancelableTask(std::function<void()> task);
 
 /* ========================================================= */
 
+/* Once a request is issued (non-null return), callback is invoked exactly
+ * once, with success=false if the request fails, is canceled or cannot be
+ * created. A null return means nothing was issued and callback is never
+ * invoked. Canceling the returned task before it runs also drops the
+ * callback.
+ */
 typedef std::function<void(bool success, void *, size_t)>
 	cef_http_request_callback_t;
 
@@ -272,6 +280,15 @@ CefHttpGetAsync(const char *url,
 		std::function<void(CefRefPtr<CefURLRequest>)> init_callback,
 		cef_http_request_callback_t callback);
 
+typedef std::function<void(bool success, int http_code, void *, size_t,
+			   CefRefPtr<CefResponse> response)>
+	cef_http_request_response_callback_t;
+
+CefRefPtr<CefCancelableTask>
+CefHttpGetAsync(const char *url, http_client_headers_t request_headers,
+		std::function<void(CefRefPtr<CefURLRequest>)> init_callback,
+		cef_http_request_response_callback_t callback);
+
 /* ========================================================= */
 
 bool DeserializeAndInvokeAction(CefRefPtr<CefValue> input,
@@ -1,6 +1,7 @@
 #include "StreamElementsWorkerManager.hpp"
 #include "StreamElementsApiMessageHandler.hpp"
 #include "StreamElementsGlobalStateManager.hpp"
+#include "StreamElementsWorkerRenderProfile.hpp"
 
 #include <QUuid>
 #include <QWidget>
@@ -29,11 +30,13 @@ class StreamElementsWorkerManager::StreamElementsWorker : public QWidget {
 public:
 	StreamElementsWorker(std::string id, std::string content,
 			     std::string url,
-			     std::string executeJavascriptOnLoad)
+			     std::string executeJavascriptOnLoad,
+			     bool lightweight)
 		: QWidget(),
 		  m_content(content),
 		  m_url(url),
 		  m_executeJavascriptOnLoad(executeJavascriptOnLoad),
+		  m_lightweight(lightweight),
 		  m_cef_browser(nullptr)
 	{
 		cef_window_handle_t windowHandle = (cef_window_handle_t)winId();
@@ -43,16 +46,20 @@ public:
 				return;
 			}
 
+			StreamElementsWorkerRenderProfile profile =
+				StreamElementsWorkerRenderProfile::Get(
+					m_lightweight);
+
 			CefRect clientRect;
 			clientRect.x = 0;
 			clientRect.y = 0;
-			clientRect.width = 1920;
-			clientRect.height = 1080;
+			clientRect.width = profile.width;
+			clientRect.height = profile.height;
 
 			// CEF window attributes
 			CefWindowInfo windowInfo;
-			windowInfo.width = 1920;
-			windowInfo.height = 1080;
+			windowInfo.width = profile.width;
+			windowInfo.height = profile.height;
 			windowInfo.windowless_rendering_enabled = true;
 			//windowInfo.SetAsChild(windowHandle, clientRect);
 
@@ -64,7 +71,13 @@ public:
 			cefBrowserSettings.local_storage = STATE_ENABLED;
 			cefBrowserSettings.databases = STATE_ENABLED;
 			cefBrowserSettings.web_security = STATE_ENABLED;
-			cefBrowserSettings.webgl = STATE_ENABLED;
+
+			cefBrowserSettings.webgl =
+				profile.webgl ? STATE_ENABLED : STATE_DISABLED;
+
+			if (profile.frameRate)
+				cefBrowserSettings.windowless_frame_rate =
+					profile.frameRate;
 
 			CefRefPtr<StreamElementsCefClient> cefClient =
 				new StreamElementsCefClient(
@@ -75,24 +88,41 @@ public:
 
 			cefClient->SetContainerId(id);
 			cefClient->SetLocationArea("worker");
+			cefClient->SetViewSize(profile.width, profile.height);
 
-			m_cef_browser = CefBrowserHost::CreateBrowserSync(
-				windowInfo, cefClient, "about:blank",
-				cefBrowserSettings,
+			CefRefPtr<CefBrowser> browser =
+				CefBrowserHost::CreateBrowserSync(
+					windowInfo, cefClient, "about:blank",
+					cefBrowserSettings,
 #if CHROME_VERSION_BUILD >= 3770
-				CefRefPtr<CefDictionaryValue>(),
+					CefRefPtr<CefDictionaryValue>(),
 #endif
-				StreamElementsGlobalStateManager::GetInstance()
-					->GetCookieManager()
-					->GetCefRequestContext());
+					StreamElementsGlobalStateManager::
+						GetInstance()
+							->GetCookieManager()
+							->GetCefRequestContext());
+
+			if (profile.hidden) {
+				// Hidden browsers do not paint
+				browser->GetHost()->WasHidden(true);
+			}
 
-			m_cef_browser->GetMainFrame()->LoadString(content,
-								   url);
+			{
+				std::lock_guard<std::mutex> guard(m_mutex);
+
+				m_cef_browser = browser;
+				m_cef_client = cefClient;
+				m_profile = profile;
+			}
+
+			browser->GetMainFrame()->LoadString(content, url);
 		});
 	}
 
 	~StreamElementsWorker()
 	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
 		if (m_cef_browser.get()) {
 #ifdef _WIN32
 			// Detach browser to prevent WM_CLOSE event from being sent
@@ -103,17 +133,38 @@ public:
 			m_cef_browser->GetHost()->CloseBrowser(true);
 			m_cef_browser = NULL;
 		}
+
+		m_cef_client = nullptr;
 	}
 
 	std::string GetUrl() { return m_url; }
 	std::string GetContent() { return m_content; }
 	std::string GetExecuteJavaScriptOnLoad() { return m_executeJavascriptOnLoad; }
+	bool IsLightweight() { return m_lightweight; }
+
+	void SerializeStats(CefRefPtr<CefValue> &output)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+
+		if (!m_cef_client.get()) {
+			SerializeWorkerRenderStats(output, m_lightweight,
+						   nullptr, 0);
+			return;
+		}
+
+		SerializeWorkerRenderStats(output, m_lightweight, &m_profile,
+					   m_cef_client->GetPaintCount());
+	}
 
 private:
 	std::string m_content;
 	std::string m_url;
 	std::string m_executeJavascriptOnLoad;
+	bool m_lightweight;
+	std::mutex m_mutex;
 	CefRefPtr<CefBrowser> m_cef_browser;
+	CefRefPtr<StreamElementsCefClient> m_cef_client;
+	StreamElementsWorkerRenderProfile m_profile = {};
 };
 
 StreamElementsWorkerManager::StreamElementsWorkerManager() {}
@@ -134,7 +185,8 @@ void StreamElementsWorkerManager::RemoveAll()
 std::string
 StreamElementsWorkerManager::Add(std::string requestedId, std::string content,
 				 std::string url,
-				 std::string executeJavascriptOnLoad)
+				 std::string executeJavascriptOnLoad,
+				 bool lightweight)
 {
 	std::lock_guard<std::recursive_mutex> guard(m_mutex);
 
@@ -145,7 +197,8 @@ StreamElementsWorkerManager::Add(std::string requestedId, std::string content,
 	}
 
 	m_items[id] = new StreamElementsWorker(id, content, url,
-					       executeJavascriptOnLoad);
+					       executeJavascriptOnLoad,
+					       lightweight);
 
 	return id;
 }
@@ -202,6 +255,7 @@ void StreamElementsWorkerManager::Serialize(CefRefPtr<CefValue> &output)
 		item->SetString("url", it->second->GetUrl());
 		item->SetString("executeJavaScriptOnLoad",
 				it->second->GetExecuteJavaScriptOnLoad());
+		item->SetBool("lightweight", it->second->IsLightweight());
 
 		root->SetValue(it->first, itemValue);
 	}
@@ -243,14 +297,38 @@ void StreamElementsWorkerManager::Deserialize(CefRefPtr<CefValue> &input)
 								.ToString();
 					}
 
+					bool lightweight =
+						dict->HasKey("lightweight") &&
+						dict->GetType("lightweight") ==
+							VTYPE_BOOL &&
+						dict->GetBool("lightweight");
+
 					Add(id, content, url,
-					    executeJavaScriptOnLoad);
+					    executeJavaScriptOnLoad,
+					    lightweight);
 				}
 			}
 		}
 	}
 }
 
+void StreamElementsWorkerManager::SerializeStats(CefRefPtr<CefValue> &output)
+{
+	std::lock_guard<std::recursive_mutex> guard(m_mutex);
+
+	CefRefPtr<CefDictionaryValue> root = CefDictionaryValue::Create();
+
+	for (auto it = m_items.begin(); it != m_items.end(); ++it) {
+		CefRefPtr<CefValue> itemValue = CefValue::Create();
+
+		it->second->SerializeStats(itemValue);
+
+		root->SetValue(it->first, itemValue);
+	}
+
+	output->SetDictionary(root);
+}
+
 bool StreamElementsWorkerManager::SerializeOne(std::string id,
 					       CefRefPtr<CefValue> &output)
 {
@@ -264,6 +342,7 @@ bool StreamElementsWorkerManager::SerializeOne(std::string id,
 	item->SetString("url", m_items[id]->GetUrl());
 	item->SetString("executeJavaScriptOnLoad",
 			m_items[id]->GetExecuteJavaScriptOnLoad());
+	item->SetBool("lightweight", m_items[id]->IsLightweight());
 
 	return true;
 }
@@ -294,7 +373,13 @@ StreamElementsWorkerManager::DeserializeOne(CefRefPtr<CefValue> input)
 						.ToString();
 			}
 
-			return Add(id, content, url, executeJavaScriptOnLoad);
+			bool lightweight =
+				dict->HasKey("lightweight") &&
+				dict->GetType("lightweight") == VTYPE_BOOL &&
+				dict->GetBool("lightweight");
+
+			return Add(id, content, url, executeJavaScriptOnLoad,
+				   lightweight);
 		}
 	}
 
@@ -23,7 +23,8 @@ public:
 public:
 	void RemoveAll();
 	std::string Add(std::string requestedId, std::string content,
-			std::string url, std::string executeJavascriptOnLoad);
+			std::string url, std::string executeJavascriptOnLoad,
+			bool lightweight = false);
 	void Remove(std::string id);
 	std::string GetContent(std::string id);
 	void GetIdentifiers(std::vector<std::string>& result);
@@ -35,6 +36,9 @@ public:
 	bool SerializeOne(std::string id, CefRefPtr<CefValue>& output);
 	std::string DeserializeOne(CefRefPtr<CefValue> input);
 
+	// Per-worker viewport, paint count and backing store size
+	void SerializeStats(CefRefPtr<CefValue>& output);
+
 protected:
 	virtual void OnObsExit();
 
@@ -0,0 +1,35 @@
+#include "StreamElementsWorkerRenderProfile.hpp"
+
+StreamElementsWorkerRenderProfile
+StreamElementsWorkerRenderProfile::Get(bool lightweight)
+{
+	if (lightweight)
+		return {1, 1, false, 1, true};
+
+	return {1920, 1080, true, 0, false};
+}
+
+uint64_t StreamElementsWorkerRenderProfile::GetBackingStoreBytes() const
+{
+	return (uint64_t)width * (uint64_t)height * 4;
+}
+
+void SerializeWorkerRenderStats(
+	CefRefPtr<CefValue> &output, bool lightweight,
+	const StreamElementsWorkerRenderProfile *profile, uint64_t paintCount)
+{
+	CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
+
+	d->SetBool("lightweight", lightweight);
+	d->SetBool("loaded", !!profile);
+
+	if (profile) {
+		d->SetInt("viewportWidth", profile->width);
+		d->SetInt("viewportHeight", profile->height);
+		d->SetDouble("paintCount", (double)paintCount);
+		d->SetDouble("backingStoreBytes",
+			     (double)profile->GetBackingStoreBytes());
+	}
+
+	output->SetDictionary(d);
+}
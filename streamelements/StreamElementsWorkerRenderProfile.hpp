@@ -0,0 +1,31 @@
+#pragma once
+
+#include "cef-headers.hpp"
+
+#include <cstdint>
+
+/* How a background worker's windowless browser is created.
+ *
+ * Workers are never shown. Lightweight workers keep a single pixel backing
+ * store, no WebGL and the minimum frame rate, and are hidden right after
+ * creation so they do not paint at all.
+ */
+struct StreamElementsWorkerRenderProfile {
+	int width;
+	int height;
+	bool webgl;
+	int frameRate; /* 0: CEF default */
+	bool hidden;
+
+	static StreamElementsWorkerRenderProfile Get(bool lightweight);
+
+	/* 32bpp windowless backing store */
+	uint64_t GetBackingStoreBytes() const;
+};
+
+/* Sets output to a worker's stats: viewport, paint count and backing store
+ * size. Workers whose browser is not created yet are reported as not
+ * loaded, with no stats. */
+void SerializeWorkerRenderStats(
+	CefRefPtr<CefValue> &output, bool lightweight,
+	const StreamElementsWorkerRenderProfile *profile, uint64_t paintCount);
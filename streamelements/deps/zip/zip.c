@@ -613,6 +613,53 @@ int zip_entry_fwrite(struct zip_t *zip, const char *filename) {
 	return status;
 }
 
+void *zip_deflate(const void *buf, size_t bufsize, int level,
+		  size_t *outsize, unsigned int *uncomp_crc32) {
+	mz_uint flags;
+
+	if ((!buf && bufsize) || !outsize || !uncomp_crc32 || level < 1 ||
+		level > MZ_UBER_COMPRESSION) {
+		return NULL;
+	}
+
+	*uncomp_crc32 = (unsigned int)mz_crc32(MZ_CRC32_INIT, (const mz_uint8 *)buf,
+		bufsize);
+
+	// Raw deflate stream, as stored in zip entries
+	flags = tdefl_create_comp_flags_from_zip_params(level, -15,
+		MZ_DEFAULT_STRATEGY);
+
+	return tdefl_compress_mem_to_heap(buf, bufsize, outsize, (int)flags);
+}
+
+int zip_entry_write_deflated(struct zip_t *zip, const char *entryname,
+			     const void *buf, size_t bufsize,
+			     size_t uncompsize, unsigned int uncomp_crc32) {
+	char *name = NULL;
+	mz_bool success;
+
+	if (!zip || !entryname || strlen(entryname) < 1 || (!buf && bufsize)) {
+		return -1;
+	}
+
+	if (zip->archive.m_zip_mode != MZ_ZIP_MODE_WRITING) {
+		return -1;
+	}
+
+	name = strrpl(entryname, strlen(entryname), '\\', '/');
+	if (!name) {
+		return -1;
+	}
+
+	success = mz_zip_writer_add_mem_ex(
+		&(zip->archive), name, buf, bufsize, NULL, 0,
+		MZ_ZIP_FLAG_COMPRESSED_DATA, uncompsize, uncomp_crc32);
+
+	CLEANUP(name);
+
+	return success ? 0 : -1;
+}
+
 int zip_entry_read(struct zip_t *zip, void **buf, size_t *bufsize) {
 	mz_zip_archive *pzip = NULL;
 	mz_uint idx;
@@ -156,6 +156,43 @@ extern "C" {
 	*/
 	extern int zip_entry_fwrite(struct zip_t *zip, const char *filename);
 
+	/*
+	Compresses a memory buffer without a zip archive handler, so several
+	buffers can be compressed in parallel and added sequentially with
+	zip_entry_write_deflated.
+	Args:
+	buf: input buffer.
+	bufsize: input buffer size (in bytes).
+	level: compression level (1-9).
+	outsize: compressed buffer size (in bytes).
+	uncomp_crc32: CRC-32 of the input buffer.
+	Note:
+	- release the returned buffer with free().
+	Returns:
+	The compressed (raw deflate) buffer, or NULL on error.
+	*/
+	extern void *zip_deflate(const void *buf, size_t bufsize, int level,
+				 size_t *outsize, unsigned int *uncomp_crc32);
+
+	/*
+	Appends a new entry holding data compressed by zip_deflate.
+	No entry may be open when this is called.
+	Args:
+	zip: zip archive handler.
+	entryname: an entry name in local dictionary.
+	buf: compressed buffer.
+	bufsize: compressed buffer size (in bytes).
+	uncompsize: uncompressed size (in bytes).
+	uncomp_crc32: CRC-32 of the uncompressed data.
+	Returns:
+	The return code - 0 on success, negative number (< 0) on error.
+	*/
+	extern int zip_entry_write_deflated(struct zip_t *zip,
+					    const char *entryname,
+					    const void *buf, size_t bufsize,
+					    size_t uncompsize,
+					    unsigned int uncomp_crc32);
+
 	/*
 	Extracts the current zip entry into output buffer.
 	The function allocates sufficient memory for a output buffer.
@@ -0,0 +1,75 @@
+#include "test-common.hpp"
+#include "stub-control.hpp"
+#include "cef-stub-control.hpp"
+
+#include "StreamElementsApiMessageHandler.hpp"
+
+void StreamElementsApiMessageHandler::RegisterIncomingApiCallHandlers()
+{
+	RegisterIncomingApiCallHandler(
+		"getState",
+		[](StreamElementsApiMessageHandler *,
+		   CefRefPtr<CefProcessMessage>, CefRefPtr<CefListValue> args,
+		   CefRefPtr<CefValue> &result, CefRefPtr<CefBrowser>,
+		   const long, std::function<void()> complete_callback) {
+			result->SetInt((int)args->GetSize());
+
+			complete_callback();
+		});
+}
+
+/* Round trips of small API calls, the common case for widgets polling the
+ * host: renderer message in, handler on the main thread, callback message
+ * out. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int calls = quick ? 5000 : 200000;
+
+	stub::qt_set_main_thread();
+
+	CefRefPtr<StreamElementsApiMessageHandler> handler =
+		new StreamElementsApiMessageHandler();
+	CefRefPtr<CefBrowser> browser = stub::cef_create_browser();
+
+	handler->OnProcessMessageReceived(
+		browser, browser->GetMainFrame(), PID_RENDERER,
+		CefProcessMessage::Create(
+			"CefRenderProcessHandler::OnContextCreated"),
+		1);
+	stub::cef_take_sent_messages(browser);
+
+	size_t replies = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < calls; ++i) {
+		CefRefPtr<CefProcessMessage> message =
+			CefProcessMessage::Create(
+				"StreamElementsApiMessageHandler::OnIncomingApiCall");
+		CefRefPtr<CefListValue> args = message->GetArgumentList();
+
+		args->SetInt(0, 3);
+		args->SetString(1, "main");
+		args->SetString(2, "window.host.getState");
+		args->SetString(3, "{\"id\":\"widget\",\"fields\":[1,2,3]}");
+		args->SetInt(4, i);
+
+		handler->OnProcessMessageReceived(browser,
+						  browser->GetMainFrame(),
+						  PID_RENDERER, message, 1);
+
+		/* Drain in batches, as a busy main thread would */
+		if (i % 64 == 63 || i == calls - 1) {
+			stub::qt_process_events();
+			replies += stub::cef_take_sent_messages(browser).size();
+		}
+	}
+	double elapsed = bench_elapsed_ms(start);
+
+	CHECK_EQ(replies, (size_t)calls);
+
+	printf("api dispatch: %d calls: %.1f ms (%.2f us/call)\n", calls,
+	       elapsed, elapsed * 1e3 / calls);
+
+	return test_result();
+}
@@ -0,0 +1,67 @@
+#include "test-common.hpp"
+#include "stub-control.hpp"
+
+#include "obs-browser-source-audio-mix.hpp"
+
+#include <vector>
+
+/* Audio callbacks of a browser source playing several streams at once, one
+ * per audio tick. Streams start a few frames apart, so every tick mixes
+ * partial buffers. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int ticks = quick ? 2000 : 200000;
+	const size_t stream_count = 4;
+	const size_t channels = 2;
+	const size_t sample_rate = 48000;
+
+	std::vector<obs_source_t *> streams;
+	for (size_t i = 0; i < stream_count; ++i) {
+		obs_source_t *source = obs_source_create_private(
+			"audio_line", "stream", nullptr);
+
+		stub::set_source_audio(
+			source, 1000000000ULL + i * 1000000ULL,
+			std::vector<std::vector<float>>(
+				channels,
+				std::vector<float>(AUDIO_OUTPUT_FRAMES, 0.1f)));
+
+		streams.push_back(source);
+	}
+
+	std::vector<float> buffers[MAX_AUDIO_CHANNELS];
+	audio_output_data out = {};
+	for (size_t ch = 0; ch < channels; ++ch) {
+		buffers[ch].assign(AUDIO_OUTPUT_FRAMES, 0.0f);
+		out.data[ch] = buffers[ch].data();
+	}
+
+	uint64_t ts = 0;
+	int mixed = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < ticks; ++i) {
+		for (size_t ch = 0; ch < channels; ++ch)
+			memset(out.data[ch], 0,
+			       AUDIO_OUTPUT_FRAMES * sizeof(float));
+
+		mixed += MixAudioStreams(streams, &ts, &out, channels,
+					 sample_rate);
+	}
+	double elapsed = bench_elapsed_ms(start);
+
+	CHECK_EQ(mixed, ticks);
+	CHECK_EQ(ts, 1000000000ULL);
+	CHECK(buffers[0][0] > 0.39f);
+
+	for (obs_source_t *source : streams)
+		obs_source_release(source);
+
+	printf("audio mix: %d ticks of %zu streams x %zu channels: %.1f ms "
+	       "(%.2f us/tick, %.1f%% of a 21.3 ms tick)\n",
+	       ticks, stream_count, channels, elapsed, elapsed * 1e3 / ticks,
+	       elapsed / ticks / (1024.0 / 48.0) * 100.0);
+
+	return test_result();
+}
@@ -0,0 +1,43 @@
+#include "test-common.hpp"
+
+#include "obs-browser-source-audio-pool.hpp"
+#include "stub-control.hpp"
+
+/* Start/stop cycles of a single audio stream, as produced by pages that
+ * play short sound effects. Source creation is nearly free in the stub, so
+ * this measures the pool overhead; the allocation counts are the point. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int cycles = quick ? 10000 : 1000000;
+
+	stub::reset_source_counters();
+
+	obs_source_t *parent =
+		obs_source_create_private("browser_source", "parent", nullptr);
+
+	double elapsed;
+	uint64_t created;
+	{
+		AudioSourcePool pool(parent);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < cycles; ++i) {
+			OBSSource source = pool.Acquire();
+			pool.Release(source);
+		}
+		elapsed = bench_elapsed_ms(start);
+		created = pool.Created();
+	}
+
+	CHECK_EQ(created, (uint64_t)1);
+
+	obs_source_release(parent);
+
+	printf("audio source pool: %d stream cycles: %.1f ms "
+	       "(%.0f ns/cycle), %llu audio_line sources created\n",
+	       cycles, elapsed, elapsed * 1e6 / cycles,
+	       (unsigned long long)created);
+
+	return test_result();
+}
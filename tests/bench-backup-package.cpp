@@ -0,0 +1,149 @@
+#include "test-common.hpp"
+
+#include "StreamElementsBackupPackage.hpp"
+
+#include "deps/zip/zip.h"
+
+#include <vector>
+
+static size_t write_extracted(void *arg, unsigned long long, const void *data,
+			      size_t size)
+{
+	return fwrite(data, 1, size, (FILE *)arg);
+}
+
+/* Restores a synthetic package of small scene, profile and asset files,
+ * once the way restore used to run (an entry walk through zip_entry_*()
+ * followed by sequential extraction) and once through
+ * read_backup_package_index() and extract_backup_package(). */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int count = quick ? 1000 : 10000;
+
+	TempDir dir;
+	std::mt19937 rng(11);
+
+	std::string zip_path = (dir.path() / "package.zip").string();
+	uint64_t total = 0;
+
+	{
+		struct zip_t *zip = zip_open(zip_path.c_str(),
+					     ZIP_DEFAULT_COMPRESSION_LEVEL,
+					     'w');
+		CHECK(zip != nullptr);
+
+		for (int i = 0; zip && i < count; ++i) {
+			std::string name;
+			switch (i % 4) {
+			case 0:
+				name = "basic/scenes/collection " +
+				       std::to_string(i) + ".json";
+				break;
+			case 1:
+				name = "basic/profiles/profile " +
+				       std::to_string(i % 97) + "/file " +
+				       std::to_string(i) + ".json";
+				break;
+			default:
+				name = "plugin_config/obs-browser/assets/" +
+				       std::to_string(i % 50) + "/" +
+				       std::to_string(i) + ".bin";
+			}
+
+			std::string content(256 + rng() % 8192, '\0');
+			for (auto &c : content)
+				c = (char)('a' + rng() % 16);
+
+			CHECK_EQ(zip_entry_open(zip, name.c_str()), 0);
+			CHECK_EQ(zip_entry_write(zip, content.data(),
+						 content.size()),
+				 0);
+			zip_entry_close(zip);
+
+			total += content.size();
+		}
+
+		zip_close(zip);
+	}
+
+	/* Before: walk the archive entry by entry, then extract in order */
+	std::filesystem::path sequential_out = dir.path() / "sequential";
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		struct zip_t *zip = zip_open(zip_path.c_str(), 0, 'r');
+		CHECK(zip != nullptr);
+
+		std::vector<std::pair<int, std::string>> entries;
+		int entry_count = zip ? zip_total_entries(zip) : 0;
+
+		for (int i = 0; i < entry_count; ++i) {
+			CHECK_EQ(zip_entry_openbyindex(zip, i), 0);
+			entries.emplace_back(i, zip_entry_name(zip));
+			zip_entry_close(zip);
+		}
+
+		for (auto &entry : entries) {
+			std::filesystem::path out =
+				sequential_out / entry.second;
+			std::filesystem::create_directories(
+				out.parent_path());
+
+			FILE *file = fopen(out.string().c_str(), "wb");
+			CHECK(file != nullptr);
+			if (!file)
+				continue;
+
+			CHECK_EQ(zip_entry_openbyindex(zip, entry.first), 0);
+			CHECK_EQ(zip_entry_extract(zip, write_extracted, file),
+				 0);
+			zip_entry_close(zip);
+			fclose(file);
+		}
+
+		if (zip)
+			zip_close(zip);
+	}
+	double sequential_ms = bench_elapsed_ms(start);
+
+	std::filesystem::path parallel_out = dir.path() / "parallel";
+
+	start = std::chrono::steady_clock::now();
+	auto index = read_backup_package_index(zip_path);
+	double index_ms = bench_elapsed_ms(start);
+
+	CHECK(index != nullptr);
+	if (!index)
+		return test_result();
+
+	CHECK_EQ(index->entries.size(), (size_t)count);
+
+	size_t progress_calls = 0;
+	CHECK(extract_backup_package(*index, parallel_out.string(), {}, {},
+				     [&](size_t, size_t, uint64_t, uint64_t) {
+					     ++progress_calls;
+				     }));
+	double parallel_ms = bench_elapsed_ms(start);
+
+	/* A second query of the same package is served from the cache */
+	start = std::chrono::steady_clock::now();
+	CHECK(read_backup_package_index(zip_path) == index);
+	double cached_ms = bench_elapsed_ms(start);
+
+	size_t restored = 0;
+	for (auto &item :
+	     std::filesystem::recursive_directory_iterator(parallel_out))
+		if (item.is_regular_file())
+			++restored;
+	CHECK_EQ(restored, (size_t)count);
+
+	printf("backup package restore: %d entries, %.1f MiB: sequential "
+	       "%.1f ms, index %.1f ms + parallel extract %.1f ms (%.1fx), "
+	       "cached index %.3f ms, %zu progress reports\n",
+	       count, (double)total / (1 << 20), sequential_ms, index_ms,
+	       parallel_ms - index_ms, sequential_ms / parallel_ms, cached_ms,
+	       progress_calls);
+
+	return test_result();
+}
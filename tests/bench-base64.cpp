@@ -0,0 +1,40 @@
+#include "test-common.hpp"
+
+#include "base64/base64.hpp"
+
+/* Encodes and decodes a screenshot-sized payload, the common case for
+ * image data passed between the plugin and its web pages. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const size_t size = quick ? (256 << 10) : (8 << 20);
+	const int rounds = quick ? 2 : 20;
+
+	std::mt19937 rng(42);
+	std::string data(size, '\0');
+	for (auto &c : data)
+		c = (char)rng();
+
+	std::string encoded;
+	std::string decoded;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; ++i)
+		encoded = base64_encode(data);
+	double encode_ms = bench_elapsed_ms(start);
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < rounds; ++i)
+		CHECK(base64_decode(encoded, decoded));
+	double decode_ms = bench_elapsed_ms(start);
+
+	CHECK_EQ(decoded, data);
+
+	double mb = (double)size * rounds / (1 << 20);
+	printf("base64: %zu bytes x %d: encode %.1f ms (%.0f MB/s), "
+	       "decode %.1f ms (%.0f MB/s)\n",
+	       size, rounds, encode_ms, mb * 1000.0 / encode_ms, decode_ms,
+	       mb * 1000.0 / decode_ms);
+
+	return test_result();
+}
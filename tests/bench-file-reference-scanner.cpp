@@ -0,0 +1,126 @@
+#include "test-common.hpp"
+#include "stub-control.hpp"
+
+#include "StreamElementsFileReferenceScanner.hpp"
+
+#include <util/platform.h>
+
+/* Scene collection of text and browser sources, with a few media sources
+ * sharing a handful of local files */
+static std::string make_collection(const TempDir &dir, size_t size)
+{
+	std::vector<std::string> files;
+	for (int i = 0; i < 8; ++i)
+		files.push_back(dir.Write("media/clip" + std::to_string(i) +
+						  ".mp4",
+					  "mp4"));
+
+	std::string doc = "{\"name\":\"Collection\",\"sources\":[";
+
+	for (int i = 0; doc.size() < size; ++i) {
+		if (i)
+			doc += ",";
+
+		std::string n = std::to_string(i);
+
+		switch (i % 4) {
+		case 0:
+			doc += "{\"name\":\"Media " + n +
+			       "\",\"id\":\"ffmpeg_source\",\"settings\":{"
+			       "\"local_file\":\"" +
+			       files[(i / 4) % files.size()] +
+			       "\",\"looping\":true}}";
+			break;
+		case 1:
+			doc += "{\"name\":\"Overlay " + n +
+			       "\",\"id\":\"browser_source\",\"settings\":{"
+			       "\"url\":\"https://example.com/overlay/" +
+			       n + "\",\"css\":\"body { margin: 0; }\"}}";
+			break;
+		default:
+			doc += "{\"name\":\"Text " + n +
+			       "\",\"id\":\"text_ft2_source\",\"settings\":{"
+			       "\"text\":\"Follower goal " +
+			       n +
+			       " of 100\",\"font\":{\"face\":\"Arial\","
+			       "\"style\":\"Regular\"}},\"filters\":[]}";
+			break;
+		}
+	}
+
+	return doc + "]}";
+}
+
+/* The previous scan, after a deep copy of the tree: a stat for each
+ * string */
+static void stat_all(CefRefPtr<CefValue> copy, size_t &found)
+{
+	switch (copy->GetType()) {
+	case VTYPE_STRING:
+		if (os_file_exists(copy->GetString().ToString().c_str()))
+			++found;
+		break;
+	case VTYPE_LIST: {
+		CefRefPtr<CefListValue> list = copy->GetList();
+		for (size_t i = 0; i < list->GetSize(); ++i)
+			stat_all(list->GetValue(i), found);
+	} break;
+	case VTYPE_DICTIONARY: {
+		CefRefPtr<CefDictionaryValue> d = copy->GetDictionary();
+		CefDictionaryValue::KeyList keys;
+		d->GetKeys(keys);
+		for (auto &key : keys)
+			stat_all(d->GetValue(key), found);
+	} break;
+	default:
+		break;
+	}
+}
+
+/* File reference scan of a scene collection, as done for each collection
+ * in a backup */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const size_t size = quick ? (2 << 20) : (20 << 20);
+
+	TempDir dir;
+	std::string json = make_collection(dir, size);
+
+	auto start = std::chrono::steady_clock::now();
+	CefRefPtr<CefValue> content = CefParseJSON(json, JSON_PARSER_RFC);
+	double parse_ms = bench_elapsed_ms(start);
+
+	CHECK(content.get() != nullptr);
+	if (!content)
+		return test_result();
+
+	size_t baseline_found = 0;
+	stub::reset_os_file_exists_calls();
+	start = std::chrono::steady_clock::now();
+	stat_all(content->Copy(), baseline_found);
+	double baseline_ms = bench_elapsed_ms(start);
+	size_t baseline_stats = stub::os_file_exists_calls();
+
+	size_t found = 0;
+	stub::reset_os_file_exists_calls();
+	start = std::chrono::steady_clock::now();
+	CHECK(ScanForFileReferences(
+		content, [&](const std::string &, std::string &replacement) {
+			replacement = "${MONIKER}/" + std::to_string(found++);
+			return true;
+		}));
+	double scan_ms = bench_elapsed_ms(start);
+	size_t stats = stub::os_file_exists_calls();
+
+	CHECK_EQ(found, baseline_found);
+	CHECK_EQ(stats, 8u);
+
+	printf("file reference scan: %zu MiB collection (parse %.1f ms): "
+	       "%.1f ms, %zu stat calls; copy and stat every string %.1f ms, "
+	       "%zu stat calls; %zu references\n",
+	       json.size() >> 20, parse_ms, scan_ms, stats, baseline_ms,
+	       baseline_stats, found);
+
+	return test_result();
+}
@@ -0,0 +1,47 @@
+#include "test-common.hpp"
+
+#include "StreamElementsFileSystemMapper.hpp"
+
+/* Resolves request paths against a redirect table of N rules, which is what
+ * the local web files server does for every request it serves. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int rules = quick ? 20 : 200;
+	const int lookups = quick ? 1000 : 100000;
+
+	TempDir dir;
+
+	std::string toml;
+	for (int i = 0; i < rules; ++i) {
+		toml += "[[redirects]]\nfrom = \"/r" + std::to_string(i) +
+			"/*\"\nto = \"/t" + std::to_string(i) +
+			"/:splat\"\n";
+	}
+	dir.Write("redirects.toml", toml);
+	dir.Write("t0/index.html", "<html></html>");
+
+	StreamElementsFileSystemMapper mapper(dir.path().string());
+
+	auto start = std::chrono::steady_clock::now();
+
+	int mapped = 0;
+	std::string path;
+	for (int i = 0; i < lookups; ++i) {
+		std::string relative =
+			"/r" + std::to_string(i % rules) + "/index.html";
+		if (mapper.MapRelativePath(relative) != relative)
+			++mapped;
+	}
+
+	double elapsed = bench_elapsed_ms(start);
+
+	CHECK_EQ(mapped, lookups);
+	CHECK(mapper.MapAbsolutePath("/r0/index.html", path));
+
+	printf("file-system-mapper: %d rules, %d lookups: %.1f ms "
+	       "(%.2f us/lookup)\n",
+	       rules, lookups, elapsed, elapsed * 1000.0 / lookups);
+
+	return test_result();
+}
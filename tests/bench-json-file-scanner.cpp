@@ -0,0 +1,75 @@
+#include "test-common.hpp"
+
+#include "StreamElementsJsonFileScanner.hpp"
+
+#include "json11/json11.hpp"
+
+/* Scene collection with its sources array ahead of the top-level name, the
+ * worst case for the scan since everything before the name is skipped. */
+static std::string make_collection(size_t size, int index)
+{
+	std::string doc = "{\"sources\":[";
+
+	for (int i = 0; doc.size() < size; ++i) {
+		if (i)
+			doc += ",";
+		doc += "{\"name\":\"Source " + std::to_string(i) +
+		       "\",\"id\":\"browser_source\",\"settings\":{\"url\":"
+		       "\"https://example.com/overlay?id=" +
+		       std::to_string(i) +
+		       "\",\"css\":\"body { margin: 0; }\",\"width\":1920,"
+		       "\"height\":1080},\"volume\":1.0,\"muted\":false}";
+	}
+
+	return doc + "],\"name\":\"Collection " + std::to_string(index) + "\"}";
+}
+
+/* Lists scene collection names the way the backup and scene collection
+ * APIs do: a cold scan of every file, then a scan served from the cache. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int files = quick ? 3 : 30;
+	const size_t size = quick ? (1 << 20) : (20 << 20);
+
+	TempDir dir;
+	std::string path = dir.path().string();
+
+	std::string content;
+	for (int i = 0; i < files; ++i) {
+		content = make_collection(size, i);
+		dir.Write("collection" + std::to_string(i) + ".json", content);
+	}
+
+	std::map<std::string, std::string> names;
+
+	auto start = std::chrono::steady_clock::now();
+	CHECK(ReadObsSceneCollectionNames(path.c_str(), names));
+	double cold_ms = bench_elapsed_ms(start);
+
+	CHECK_EQ(names.size(), (size_t)files);
+	CHECK_EQ(names["collection0"], "Collection 0");
+
+	names.clear();
+	start = std::chrono::steady_clock::now();
+	CHECK(ReadObsSceneCollectionNames(path.c_str(), names));
+	double cached_ms = bench_elapsed_ms(start);
+
+	CHECK_EQ(names.size(), (size_t)files);
+
+	/* Reference: fully parsing one file into a document tree */
+	start = std::chrono::steady_clock::now();
+	std::string err;
+	json11::Json parsed = json11::Json::parse(content, err);
+	double parse_ms = bench_elapsed_ms(start);
+
+	CHECK(err.empty());
+	CHECK_EQ(parsed["name"].string_value(),
+		 "Collection " + std::to_string(files - 1));
+
+	printf("scene collection names: %d x %zu MiB: cold scan %.1f ms, "
+	       "cached %.2f ms; full parse of one file %.1f ms\n",
+	       files, size >> 20, cold_ms, cached_ms, parse_ms);
+
+	return test_result();
+}
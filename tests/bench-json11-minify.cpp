@@ -0,0 +1,61 @@
+#include "test-common.hpp"
+
+#include "json11/json11.hpp"
+
+using namespace json11;
+
+static std::string make_payload(int items)
+{
+	std::string json = "{\"event\":\"update\",\"items\":[";
+
+	for (int i = 0; i < items; ++i) {
+		if (i)
+			json += ", ";
+		json += "{\"id\": " + std::to_string(i) +
+			", \"name\": \"item " + std::to_string(i) +
+			"\", \"value\": " + std::to_string(i * 1.5) +
+			", \"tags\": [\"a\", \"b\"], \"enabled\": true}";
+	}
+
+	return json + "]}";
+}
+
+/* Compares the old DispatchJSEvent round trip, parse() followed by dump(),
+ * with minify() on event payloads of typical sizes. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int iterations = quick ? 200 : 20000;
+
+	for (int items : {1, 12, 250}) {
+		std::string payload = make_payload(items);
+		std::string err;
+		std::string dumped;
+		std::string minified;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			Json::object json;
+			json["detail"] = Json::parse(payload, err);
+			dumped = Json(json).dump();
+		}
+		double parse_ms = bench_elapsed_ms(start);
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i) {
+			minified = "{\"detail\":";
+			CHECK(Json::minify(payload, minified, err));
+			minified += "}";
+		}
+		double minify_ms = bench_elapsed_ms(start);
+
+		CHECK(Json::parse(dumped, err) == Json::parse(minified, err));
+
+		printf("json11: %zu byte payload x %d: parse+dump %.1f ms, "
+		       "minify %.1f ms (%.1fx)\n",
+		       payload.size(), iterations, parse_ms, minify_ms,
+		       parse_ms / minify_ms);
+	}
+
+	return test_result();
+}
@@ -0,0 +1,114 @@
+#include "test-common.hpp"
+
+#include "StreamElementsQtTasks.hpp"
+#include "stub-control.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/* QtPostTask from 4 threads while the main thread drains its event queue,
+ * as CEF IO/UI threads do when pages call into the API in bursts. The
+ * baseline posts one event per task, which is what QtPostTask did before
+ * tasks were batched. */
+
+static const int PRODUCERS = 4;
+
+class PerTaskReceiver : public QObject {
+public:
+	class TaskEvent : public QEvent {
+	public:
+		TaskEvent(int type, std::function<void()> task)
+			: QEvent((QEvent::Type)type), task(std::move(task))
+		{
+		}
+
+		std::function<void()> task;
+	};
+
+	const int eventType = QEvent::registerEventType();
+
+protected:
+	virtual bool event(QEvent *e) override
+	{
+		static_cast<TaskEvent *>(e)->task();
+		return true;
+	}
+};
+
+struct run_result {
+	double elapsed_ms;
+	size_t events;
+};
+
+template<typename P> static run_result run(int tasks, P post)
+{
+	std::atomic<int> completed(0);
+	std::atomic<bool> producers_done(false);
+
+	stub::qt_reset_posted_events();
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> producers;
+	for (int p = 0; p < PRODUCERS; ++p) {
+		producers.push_back(std::thread([&]() {
+			for (int i = 0; i < tasks / PRODUCERS; ++i)
+				post([&completed]() { ++completed; });
+		}));
+	}
+
+	while (completed < tasks) {
+		stub::qt_wait_for_events(10);
+		stub::qt_process_events();
+	}
+
+	double elapsed = bench_elapsed_ms(start);
+
+	for (auto &producer : producers)
+		producer.join();
+
+	return {elapsed, stub::qt_posted_events()};
+}
+
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int tasks = quick ? 10000 : 100000;
+
+	stub::qt_set_main_thread();
+
+	PerTaskReceiver receiver;
+
+	run_result baseline = run(tasks, [&](std::function<void()> task) {
+		QCoreApplication::postEvent(
+			&receiver, new PerTaskReceiver::TaskEvent(
+					   receiver.eventType, std::move(task)));
+	});
+
+	QtPostTaskStats before = QtGetPostTaskStats();
+
+	run_result batched = run(tasks, [](std::function<void()> task) {
+		QtPostTask(std::move(task));
+	});
+
+	QtPostTaskStats after = QtGetPostTaskStats();
+
+	CHECK_EQ(after.tasksRun - before.tasksRun, (uint64_t)tasks);
+	CHECK(batched.events <= (size_t)tasks);
+	CHECK_EQ(after.queueDepth, 0u);
+
+	printf("qt post task: %d tasks from %d threads\n", tasks, PRODUCERS);
+	printf("  event per task: %.1f ms (%.0f ns/task), %zu events\n",
+	       baseline.elapsed_ms, baseline.elapsed_ms * 1e6 / tasks,
+	       baseline.events);
+	printf("  batched:        %.1f ms (%.0f ns/task), %zu events, "
+	       "%llu batches, latency avg %.3f ms max %.3f ms\n",
+	       batched.elapsed_ms, batched.elapsed_ms * 1e6 / tasks,
+	       batched.events,
+	       (unsigned long long)(after.batchesRun - before.batchesRun),
+	       (double)after.latencyAvgNs / 1000000.0,
+	       (double)after.latencyMaxNs / 1000000.0);
+
+	return test_result();
+}
@@ -0,0 +1,94 @@
+#include "test-common.hpp"
+
+#include "StreamElementsReportIssuePackage.hpp"
+
+#include "deps/zip/zip.h"
+
+/* Packages a logs directory the way the report issue dialog does, once
+ * sequentially through zip_entry_write() and once through the parallel
+ * add_report_files_to_zip(). */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int count = quick ? 20 : 500;
+	const size_t average_size = quick ? (64 << 10) : (1 << 20);
+
+	TempDir dir;
+	std::mt19937 rng(7);
+
+	std::string line_pool;
+	for (int i = 0; i < 4096; ++i)
+		line_pool += "12:00:00.000: [obs-browser] message " +
+			     std::to_string(rng() % 1000000) + "\n";
+
+	std::vector<report_file> files;
+	uint64_t total = 0;
+
+	for (int i = 0; i < count; ++i) {
+		size_t size = average_size / 4 +
+			      rng() % (average_size * 3 / 2);
+		std::string content;
+		while (content.size() < size) {
+			size_t pos = rng() % (line_pool.size() / 2);
+			content.append(line_pool, pos,
+				       std::min<size_t>(size - content.size(),
+							4096));
+		}
+
+		report_file file;
+		file.local_path = dir.Write(
+			"logs/" + std::to_string(i) + ".txt", content);
+		file.zip_path = "obs-studio\\logs\\" + std::to_string(i) +
+				".txt";
+		file.size = content.size();
+		file.is_log = true;
+
+		total += file.size;
+		files.push_back(file);
+	}
+
+	std::string sequential_path = (dir.path() / "sequential.zip").string();
+	std::string parallel_path = (dir.path() / "parallel.zip").string();
+
+	auto start = std::chrono::steady_clock::now();
+	{
+		struct zip_t *zip = zip_open(sequential_path.c_str(),
+					     ZIP_DEFAULT_COMPRESSION_LEVEL,
+					     'w');
+		for (auto &file : files) {
+			std::string buf;
+			CHECK(read_report_file(file, buf));
+			CHECK_EQ(zip_entry_open(zip, file.zip_path.c_str()), 0);
+			CHECK_EQ(zip_entry_write(zip, buf.data(), buf.size()),
+				 0);
+			zip_entry_close(zip);
+		}
+		zip_close(zip);
+	}
+	double sequential_ms = bench_elapsed_ms(start);
+
+	start = std::chrono::steady_clock::now();
+	{
+		struct zip_t *zip = zip_open(parallel_path.c_str(),
+					     ZIP_DEFAULT_COMPRESSION_LEVEL,
+					     'w');
+		CHECK(add_report_files_to_zip(zip, files,
+					      [](uint64_t) { return true; }));
+		zip_close(zip);
+	}
+	double parallel_ms = bench_elapsed_ms(start);
+
+	struct zip_t *zip = zip_open(parallel_path.c_str(), 0, 'r');
+	CHECK(zip != nullptr);
+	if (zip) {
+		CHECK_EQ(zip_total_entries(zip), count);
+		zip_close(zip);
+	}
+
+	printf("report issue package: %d logs, %.1f MiB: sequential %.1f ms, "
+	       "parallel %.1f ms (%.1fx)\n",
+	       count, (double)total / (1 << 20), sequential_ms, parallel_ms,
+	       sequential_ms / parallel_ms);
+
+	return test_result();
+}
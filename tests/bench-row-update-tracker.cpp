@@ -0,0 +1,266 @@
+#include "test-common.hpp"
+
+#include "StreamElementsRowUpdateTracker.hpp"
+
+#include <obs.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+/* Stands in for the scenes QListWidget and the per-scene icons: a row's
+ * icon is its cacheKey, and setIcon() is counted as each one emits
+ * dataChanged() and relayouts the row */
+struct scenes_list_t {
+	std::vector<obs_source_t *> scenes;
+	std::vector<int64_t> rowIcons;
+	std::map<obs_source_t *, int64_t> icons;
+	size_t setIcons = 0;
+	size_t rowsTouched = 0;
+
+	void SetIcon(int row, int64_t icon)
+	{
+		++setIcons;
+		rowIcons[row] = icon;
+	}
+
+	bool Consistent() const
+	{
+		for (size_t i = 0; i < scenes.size(); ++i) {
+			if (rowIcons[i] != icons.at(scenes[i]))
+				return false;
+		}
+		return true;
+	}
+};
+
+/* The previous update: every change ran a pass over all rows, looked each
+ * scene up with a linear scan and set every icon */
+static void update_all_rows(scenes_list_t &list)
+{
+	for (size_t row = 0; row < list.scenes.size(); ++row) {
+		int64_t icon = 0;
+		for (auto kv : list.icons) {
+			if (kv.first == list.scenes[row]) {
+				icon = kv.second;
+				break;
+			}
+		}
+
+		++list.rowsTouched;
+		list.SetIcon((int)row, icon);
+	}
+}
+
+/* UpdateWidgets() and UpdateRow() as they are now */
+static void update_row(scenes_list_t &list, int row, obs_source_t *scene)
+{
+	auto it = list.icons.find(scene);
+	int64_t icon = it == list.icons.end() ? 0 : it->second;
+
+	++list.rowsTouched;
+	if (list.rowIcons[row] != icon)
+		list.SetIcon(row, icon);
+}
+
+static void update_widgets(scenes_list_t &list,
+			   StreamElementsRowUpdateTracker<obs_source_t *> &rows)
+{
+	StreamElementsRowUpdateTracker<obs_source_t *>::rows_t dirtyRows;
+
+	if (!rows.Take(dirtyRows)) {
+		for (auto &row : dirtyRows) {
+			if (row.first >= (int)list.scenes.size())
+				continue;
+
+			update_row(list, row.first, row.second);
+		}
+
+		return;
+	}
+
+	for (size_t row = 0; row < list.scenes.size(); ++row)
+		update_row(list, (int)row, list.scenes[row]);
+
+	rows.SetRows(list.scenes);
+}
+
+struct counts_t {
+	size_t rowsTouched;
+	size_t setIcons;
+};
+
+static counts_t take_counts(scenes_list_t &list)
+{
+	counts_t counts = {list.rowsTouched, list.setIcons};
+	list.rowsTouched = 0;
+	list.setIcons = 0;
+	return counts;
+}
+
+static std::vector<obs_scene_t *> create_scenes(scenes_list_t &list,
+						size_t count)
+{
+	std::vector<obs_scene_t *> scenes;
+
+	for (size_t i = 0; i < count; ++i) {
+		std::string name = "Scene " + std::to_string(i);
+		obs_scene_t *scene = obs_scene_create(name.c_str());
+		obs_source_t *source = obs_scene_get_source(scene);
+
+		scenes.push_back(scene);
+		list.scenes.push_back(source);
+		list.icons[source] = (int64_t)i + 1;
+	}
+
+	list.rowIcons.assign(count, 0);
+
+	return scenes;
+}
+
+static void print_counts(const char *what, counts_t before, counts_t after)
+{
+	printf("  %s: %zu rows touched, %zu setIcon() before; "
+	       "%zu rows touched, %zu setIcon() now\n",
+	       what, before.rowsTouched, before.setIcons, after.rowsTouched,
+	       after.setIcons);
+}
+
+/* Scene list updates with 500 scenes, against the previous pass over all
+ * rows for every change */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const size_t count = 500;
+	const size_t iterations = quick ? 200 : 5000;
+
+	scenes_list_t before, after;
+	auto beforeScenes = create_scenes(before, count);
+	auto afterScenes = create_scenes(after, count);
+
+	StreamElementsRowUpdateTracker<obs_source_t *> rows;
+
+	printf("scenes list with %zu scenes:\n", count);
+
+	/* The first pass sets every icon either way */
+	update_all_rows(before);
+	update_widgets(after, rows);
+	CHECK(before.Consistent());
+	CHECK(after.Consistent());
+	take_counts(before);
+	take_counts(after);
+
+	/* One scene's icon changes */
+	before.icons[before.scenes[10]] = -1;
+	update_all_rows(before);
+
+	after.icons[after.scenes[10]] = -1;
+	rows.MarkKey(after.scenes[10]);
+	update_widgets(after, rows);
+
+	CHECK(before.Consistent());
+	CHECK(after.Consistent());
+	counts_t b = take_counts(before), a = take_counts(after);
+	CHECK_EQ(b.setIcons, count);
+	CHECK_EQ(a.rowsTouched, 1u);
+	CHECK_EQ(a.setIcons, 1u);
+	print_counts("one scene icon changed", b, a);
+
+	/* 50 remote icons complete within one deferred update */
+	for (size_t i = 0; i < 50; ++i)
+		before.icons[before.scenes[i * 10]] = -(int64_t)i - 100;
+	update_all_rows(before);
+
+	for (size_t i = 0; i < 50; ++i) {
+		obs_source_t *scene = after.scenes[i * 10];
+		after.icons[scene] = -(int64_t)i - 100;
+		rows.MarkKey(scene);
+	}
+	update_widgets(after, rows);
+
+	CHECK(before.Consistent());
+	CHECK(after.Consistent());
+	b = take_counts(before), a = take_counts(after);
+	CHECK_EQ(a.rowsTouched, 50u);
+	CHECK_EQ(a.setIcons, 50u);
+	print_counts("50 icons loaded", b, a);
+
+	/* A scene is renamed: its data is unchanged */
+	update_all_rows(before);
+
+	rows.MarkKey(after.scenes[20]);
+	update_widgets(after, rows);
+
+	b = take_counts(before), a = take_counts(after);
+	CHECK_EQ(a.rowsTouched, 1u);
+	CHECK_EQ(a.setIcons, 0u);
+	print_counts("scene renamed", b, a);
+
+	/* The model is reset with the same rows */
+	update_all_rows(before);
+
+	rows.MarkAll();
+	update_widgets(after, rows);
+
+	b = take_counts(before), a = take_counts(after);
+	CHECK_EQ(a.rowsTouched, count);
+	CHECK_EQ(a.setIcons, 0u);
+	print_counts("model reset", b, a);
+
+	/* A scene moves up two rows: only the rows whose icon moved are set */
+	std::rotate(before.scenes.begin() + 5, before.scenes.begin() + 7,
+		    before.scenes.begin() + 8);
+	update_all_rows(before);
+
+	std::rotate(after.scenes.begin() + 5, after.scenes.begin() + 7,
+		    after.scenes.begin() + 8);
+	rows.MarkAll();
+	update_widgets(after, rows);
+
+	CHECK(before.Consistent());
+	CHECK(after.Consistent());
+	b = take_counts(before), a = take_counts(after);
+	CHECK_EQ(a.setIcons, 3u);
+	print_counts("scene moved", b, a);
+
+	/* A scene's row is found through the moved layout */
+	after.icons[after.scenes[5]] = -2;
+	rows.MarkKey(after.scenes[5]);
+	update_widgets(after, rows);
+	CHECK(after.Consistent());
+	take_counts(after);
+
+	/* Time per single scene change */
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; ++i) {
+		before.icons[before.scenes[i % count]] = -(int64_t)i - 1000;
+		update_all_rows(before);
+	}
+	double before_us = bench_elapsed_ms(start) * 1000.0 / iterations;
+
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; ++i) {
+		obs_source_t *scene = after.scenes[i % count];
+		after.icons[scene] = -(int64_t)i - 1000;
+		rows.MarkKey(scene);
+		update_widgets(after, rows);
+	}
+	double after_us = bench_elapsed_ms(start) * 1000.0 / iterations;
+
+	CHECK(before.Consistent());
+	CHECK(after.Consistent());
+	b = take_counts(before), a = take_counts(after);
+	CHECK_EQ(a.setIcons, iterations);
+
+	printf("  one scene change, %zu times: %.1f us and %zu setIcon() "
+	       "per update before, %.2f us and %.0f setIcon() now\n",
+	       iterations, before_us, b.setIcons / iterations, after_us,
+	       (double)a.setIcons / iterations);
+
+	for (auto scene : beforeScenes)
+		obs_scene_release(scene);
+	for (auto scene : afterScenes)
+		obs_scene_release(scene);
+
+	return test_result();
+}
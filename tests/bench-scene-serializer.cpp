@@ -0,0 +1,121 @@
+#include "test-common.hpp"
+
+#include "StreamElementsSceneSerializer.hpp"
+
+static void add_filter(obs_data_array_t *filters, size_t i)
+{
+	obs_data_t *filter = obs_data_create();
+	obs_data_set_string(filter, "id", "color_filter");
+	obs_data_set_string(filter, "name",
+			    ("Color " + std::to_string(i)).c_str());
+	obs_data_set_double(filter, "gamma", 0.25 * (i % 4));
+	obs_data_set_int(filter, "color", 4294967295LL - i);
+	obs_data_set_bool(filter, "enabled", i % 2 == 0);
+
+	obs_data_t *extra = obs_data_create();
+	obs_data_set_string(extra, "lut", "/home/user/luts/warm.cube");
+	obs_data_set_obj(filter, "extra", extra);
+	obs_data_release(extra);
+
+	obs_data_array_push_back(filters, filter);
+	obs_data_release(filter);
+}
+
+/* Browser source settings with a list of filters, grown to about size bytes
+ * of JSON */
+static obs_data_t *make_settings(size_t size)
+{
+	obs_data_t *data = obs_data_create();
+	obs_data_set_string(data, "url", "https://example.com/overlay?id=1");
+	obs_data_set_int(data, "width", 1920);
+	obs_data_set_int(data, "height", 1080);
+	obs_data_set_double(data, "fps", 29.97);
+	obs_data_set_bool(data, "shutdown", true);
+	obs_data_set_string(data, "css",
+			    "body { background-color: rgba(0, 0, 0, 0); }");
+
+	obs_data_array_t *filters = obs_data_array_create();
+	obs_data_set_array(data, "filters", filters);
+
+	/* Filters are all about the same size: measure a few, then add the
+	 * rest */
+	const size_t sample = 4;
+	const size_t base = strlen(obs_data_get_json(data));
+
+	for (size_t i = 0; i < sample; ++i)
+		add_filter(filters, i);
+
+	size_t per_filter = (strlen(obs_data_get_json(data)) - base) / sample;
+	size_t count = (size - std::min(size, base)) / per_filter;
+
+	for (size_t i = sample; i < count; ++i)
+		add_filter(filters, i);
+
+	obs_data_array_release(filters);
+
+	return data;
+}
+
+static void bench_size(size_t size, size_t total_bytes)
+{
+	obs_data_t *data = make_settings(size);
+	const size_t json_size = strlen(obs_data_get_json(data));
+	const int iterations = (int)std::max<size_t>(total_bytes / json_size, 3);
+
+	/* obs_data -> CefValue */
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i)
+		CHECK(SerializeData(data)->GetType() == VTYPE_DICTIONARY);
+	double direct_ser_ms = bench_elapsed_ms(start);
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i)
+		CHECK(CefParseJSON(obs_data_get_json(data), JSON_PARSER_RFC)
+			      ->GetType() == VTYPE_DICTIONARY);
+	double json_ser_ms = bench_elapsed_ms(start);
+
+	/* CefValue -> obs_data */
+	CefRefPtr<CefValue> value = SerializeData(data);
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		obs_data_t *out = obs_data_create();
+		CHECK(DeserializeData(value, out));
+		obs_data_release(out);
+	}
+	double direct_deser_ms = bench_elapsed_ms(start);
+
+	start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		obs_data_t *out = obs_data_create_from_json(
+			CefWriteJSON(value, JSON_WRITER_DEFAULT)
+				.ToString()
+				.c_str());
+		CHECK(out != nullptr);
+		obs_data_release(out);
+	}
+	double json_deser_ms = bench_elapsed_ms(start);
+
+	obs_data_release(data);
+
+	printf("obs_data <-> CefValue, %zu bytes x %d: serialize %.3f ms "
+	       "(JSON %.3f ms), deserialize %.3f ms (JSON %.3f ms) per call\n",
+	       json_size, iterations, direct_ser_ms / iterations,
+	       json_ser_ms / iterations, direct_deser_ms / iterations,
+	       json_deser_ms / iterations);
+}
+
+/* Source settings conversion on scene API calls and events, against the
+ * previous path through JSON text. Both sides run on the in-memory
+ * obs_data and CEF stubs, so only the ratio carries over. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const size_t total_bytes = quick ? (2 << 20) : (50 << 20);
+
+	bench_size(1 << 10, total_bytes);
+	bench_size(100 << 10, total_bytes);
+	bench_size(1 << 20, total_bytes);
+
+	return test_result();
+}
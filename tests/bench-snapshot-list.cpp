@@ -0,0 +1,199 @@
+#include "test-common.hpp"
+#include "cef-stub-control.hpp"
+
+#include "StreamElementsSnapshotList.hpp"
+
+#include <include/cef_process_message.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+typedef CefRefPtr<CefBrowser> browser_t;
+
+static void send_event(browser_t browser)
+{
+	CefRefPtr<CefProcessMessage> msg =
+		CefProcessMessage::Create("DispatchJSEvent");
+	CefRefPtr<CefListValue> args = msg->GetArgumentList();
+
+	args->SetString(0, "hostActiveSceneChanged");
+	args->SetString(1, "{\"name\":\"Scene 1\"}");
+	browser->SendProcessMessage(PID_RENDERER, msg);
+}
+
+/* The previous registry: broadcasts send with the lock held */
+class LockedList {
+public:
+	void Broadcast()
+	{
+		uint64_t start = Lock();
+		for (auto &browser : m_list)
+			send_event(browser);
+		Unlock(start);
+	}
+
+	void Update(std::function<void(std::vector<browser_t> &)> update)
+	{
+		uint64_t start = Lock();
+		update(m_list);
+		Unlock(start);
+	}
+
+	uint64_t max_ns() const { return m_maxNs; }
+	double avg_ns() const { return (double)m_totalNs / m_holds; }
+
+private:
+	uint64_t Lock()
+	{
+		m_mutex.lock();
+		return os_gettime_ns();
+	}
+
+	void Unlock(uint64_t start)
+	{
+		uint64_t hold = os_gettime_ns() - start;
+		++m_holds;
+		m_totalNs += hold;
+		m_maxNs = std::max(m_maxNs, hold);
+		m_mutex.unlock();
+	}
+
+	std::mutex m_mutex;
+	std::vector<browser_t> m_list;
+	uint64_t m_holds = 0;
+	uint64_t m_totalNs = 0;
+	uint64_t m_maxNs = 0;
+};
+
+class SnapshotList {
+public:
+	SnapshotList() : m_list("browsers list") {}
+
+	void Broadcast()
+	{
+		auto browsers = m_list.Snapshot();
+		for (auto &browser : *browsers)
+			send_event(browser);
+	}
+
+	void Update(std::function<void(std::vector<browser_t> &)> update)
+	{
+		m_list.Update(update);
+	}
+
+	uint64_t max_ns() const { return m_list.GetLockStats().max_ns; }
+	double avg_ns() const
+	{
+		auto stats = m_list.GetLockStats();
+		return (double)stats.total_ns / stats.holds;
+	}
+
+private:
+	StreamElementsSnapshotList<browser_t> m_list;
+};
+
+struct result_t {
+	double broadcast_us;
+	double register_max_us;
+	size_t registrations;
+	double hold_avg_us;
+	double hold_max_us;
+};
+
+/* threads broadcast to browsers while one more thread keeps replacing
+ * the oldest browser with a new one */
+template<class List>
+static result_t run(size_t threads, size_t browsers, size_t broadcasts)
+{
+	List list;
+	list.Update([&](std::vector<browser_t> &items) {
+		for (size_t i = 0; i < browsers; ++i)
+			items.push_back(stub::cef_create_browser());
+	});
+
+	std::atomic<bool> running(true);
+	std::atomic<size_t> registrations(0);
+	std::atomic<uint64_t> register_max_ns(0);
+
+	std::thread writer([&]() {
+		while (running) {
+			browser_t browser = stub::cef_create_browser();
+
+			/* Includes waiting for the lock */
+			uint64_t start = os_gettime_ns();
+			list.Update([&](std::vector<browser_t> &items) {
+				items.erase(items.begin());
+				items.push_back(browser);
+			});
+			uint64_t elapsed = os_gettime_ns() - start;
+
+			if (elapsed > register_max_ns)
+				register_max_ns = elapsed;
+			++registrations;
+
+			std::this_thread::sleep_for(
+				std::chrono::microseconds(200));
+		}
+	});
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> broadcasters;
+	for (size_t t = 0; t < threads; ++t) {
+		broadcasters.emplace_back([&]() {
+			for (size_t i = 0; i < broadcasts; ++i)
+				list.Broadcast();
+		});
+	}
+	for (auto &thread : broadcasters)
+		thread.join();
+
+	double elapsed_ms = bench_elapsed_ms(start);
+
+	running = false;
+	writer.join();
+
+	return {elapsed_ms * 1000.0 / (threads * broadcasts),
+		register_max_ns / 1000.0, registrations,
+		list.avg_ns() / 1000.0, list.max_ns() / 1000.0};
+}
+
+/* Broadcasts from several threads while browsers come and go, against the
+ * previous lock-held broadcast. The writer's worst wait for the lock is
+ * what shows up as stalls on browser creation and destruction. */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const size_t threads = 4;
+	const size_t browsers = 50;
+	const size_t broadcasts = quick ? 500 : 5000;
+
+	size_t sent = stub::cef_sent_message_count();
+
+	result_t locked = run<LockedList>(threads, browsers, broadcasts);
+	result_t snapshot = run<SnapshotList>(threads, browsers, broadcasts);
+
+	/* Every broadcast reached every browser */
+	CHECK_EQ(stub::cef_sent_message_count() - sent,
+		 2 * threads * browsers * broadcasts);
+	CHECK(snapshot.registrations > 0);
+
+	printf("broadcast to %zu browsers from %zu threads (%u CPUs), "
+	       "browser replaced every 200 us:\n"
+	       "  lock held while sending: %.1f us per broadcast, lock held "
+	       "avg %.1f us, max %.1f us, registration waited up to %.1f us "
+	       "(%zu registrations)\n"
+	       "  snapshot: %.1f us per broadcast, lock held avg %.1f us, "
+	       "max %.1f us, registration waited up to %.1f us "
+	       "(%zu registrations)\n",
+	       browsers, threads, std::thread::hardware_concurrency(),
+	       locked.broadcast_us, locked.hold_avg_us, locked.hold_max_us,
+	       locked.register_max_us, locked.registrations,
+	       snapshot.broadcast_us, snapshot.hold_avg_us,
+	       snapshot.hold_max_us, snapshot.register_max_us,
+	       snapshot.registrations);
+
+	return test_result();
+}
@@ -0,0 +1,77 @@
+#include "test-common.hpp"
+
+#include "StreamElementsTracer.hpp"
+
+#include <thread>
+#include <vector>
+
+static volatile int sink;
+
+static void work(int i)
+{
+	sink = i;
+}
+
+static double run_scopes(int iterations)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i) {
+		SE_TRACE_SCOPE("bench", "span");
+		work(i);
+	}
+	return bench_elapsed_ms(start);
+}
+
+/* Cost of an instrumentation point: disabled, as in production, and
+ * enabled from one and from several threads */
+int main(int argc, char **argv)
+{
+	const bool quick = bench_is_quick(argc, argv);
+	const int iterations = quick ? 200000 : 20000000;
+	const int thread_count = 4;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i)
+		work(i);
+	double baseline_ms = bench_elapsed_ms(start);
+
+	StreamElementsTracer::SetEnabled(false);
+	double disabled_ms = run_scopes(iterations);
+
+	StreamElementsTracer::SetEnabled(true);
+	double enabled_ms = run_scopes(iterations);
+
+	std::vector<std::thread> threads;
+	std::vector<double> thread_ms(thread_count);
+	for (int t = 0; t < thread_count; ++t)
+		threads.push_back(std::thread([&, t]() {
+			thread_ms[t] = run_scopes(iterations);
+		}));
+	for (auto &thread : threads)
+		thread.join();
+
+	/* Wall time of the slowest thread, over all scopes recorded */
+	double threaded_ms = 0;
+	for (double ms : thread_ms)
+		threaded_ms = std::max(threaded_ms, ms);
+	threaded_ms /= thread_count;
+
+	StreamElementsTracer::SetEnabled(false);
+
+	start = std::chrono::steady_clock::now();
+	std::string trace = StreamElementsTracer::SerializeChromeTrace();
+	double dump_ms = bench_elapsed_ms(start);
+
+	CHECK(!trace.empty());
+
+	auto ns = [&](double ms) { return ms * 1e6 / iterations; };
+
+	printf("tracer: %d scopes: disabled %.2f ns/scope over baseline, "
+	       "enabled %.1f ns/scope, enabled on %d threads (%u CPUs) "
+	       "%.1f ns/scope; trace dump %.1f ms (%zu KB)\n",
+	       iterations, ns(disabled_ms) - ns(baseline_ms), ns(enabled_ms),
+	       thread_count, std::thread::hardware_concurrency(),
+	       ns(threaded_ms), dump_ms, trace.size() >> 10);
+
+	return test_result();
+}
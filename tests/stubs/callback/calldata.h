@@ -0,0 +1,16 @@
+#pragma once
+
+/* Test stub for libobs callback/calldata.h. */
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct calldata;
+typedef struct calldata calldata_t;
+
+#ifdef __cplusplus
+}
+#endif
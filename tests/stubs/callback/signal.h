@@ -0,0 +1,24 @@
+#pragma once
+
+/* Test stub for libobs callback/signal.h. */
+
+#include "calldata.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct signal_handler;
+typedef struct signal_handler signal_handler_t;
+typedef void (*signal_callback_t)(void *, calldata_t *);
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal,
+			    signal_callback_t callback, void *data);
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal,
+			       signal_callback_t callback, void *data);
+void signal_handler_signal(signal_handler_t *handler, const char *signal,
+			   calldata_t *params);
+
+#ifdef __cplusplus
+}
+#endif
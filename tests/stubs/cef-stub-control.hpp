@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+ * Test-side controls for the CEF stubs: fake browsers and the process
+ * messages sent to their renderers, cookie managers, and the UI thread.
+ */
+
+#include <include/cef_browser.h>
+#include <include/cef_cookie.h>
+
+#include <string>
+
+#include <vector>
+
+namespace stub {
+
+CefRefPtr<CefBrowser> cef_create_browser();
+
+/* Process messages sent to the browser's main frame since the last call */
+std::vector<CefRefPtr<CefProcessMessage>>
+cef_take_sent_messages(CefRefPtr<CefBrowser> browser);
+
+/* Process messages sent to any fake browser, ever */
+size_t cef_sent_message_count();
+
+/* Cookie manager whose store is storage_path/Cookies. FlushStore() writes it
+ * on a thread of its own after flush_delay_ms, then completes; with
+ * accept_flush false it fails to start instead. */
+CefRefPtr<CefCookieManager> cef_create_cookie_manager(std::string storage_path,
+						      int flush_delay_ms,
+						      bool accept_flush = true);
+
+/* Flushes completed by cm */
+int cef_cookie_flush_count(CefRefPtr<CefCookieManager> cm);
+
+/* Makes the calling thread the one CefCurrentlyOn(TID_UI) is true on */
+void cef_set_ui_thread();
+
+}
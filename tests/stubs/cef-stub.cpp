@@ -0,0 +1,859 @@
+#include <include/cef_browser.h>
+#include <include/cef_parser.h>
+#include <include/cef_task.h>
+
+#include "cef-stub-control.hpp"
+
+#include "json11/json11.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <thread>
+
+/* ========================================================================= */
+
+CefRefPtr<CefValue> CefValue::Create()
+{
+	return new CefValue();
+}
+
+CefRefPtr<CefValue> CefValue::Copy()
+{
+	CefRefPtr<CefValue> result = CefValue::Create();
+
+	result->m_data = m_data;
+	if (m_data.dictionary_value)
+		result->m_data.dictionary_value =
+			m_data.dictionary_value->Copy();
+	if (m_data.list_value)
+		result->m_data.list_value = m_data.list_value->Copy();
+
+	return result;
+}
+
+bool CefValue::GetBool()
+{
+	return m_data.type == VTYPE_BOOL && m_data.bool_value;
+}
+
+int CefValue::GetInt()
+{
+	return m_data.type == VTYPE_INT ? m_data.int_value : 0;
+}
+
+double CefValue::GetDouble()
+{
+	if (m_data.type == VTYPE_INT)
+		return m_data.int_value;
+
+	return m_data.type == VTYPE_DOUBLE ? m_data.double_value : 0;
+}
+
+CefString CefValue::GetString()
+{
+	return m_data.type == VTYPE_STRING ? m_data.string_value
+					   : std::string();
+}
+
+CefRefPtr<CefDictionaryValue> CefValue::GetDictionary()
+{
+	return m_data.type == VTYPE_DICTIONARY ? m_data.dictionary_value
+					       : nullptr;
+}
+
+CefRefPtr<CefListValue> CefValue::GetList()
+{
+	return m_data.type == VTYPE_LIST ? m_data.list_value : nullptr;
+}
+
+static cef_value_data make_data(CefValueType type)
+{
+	cef_value_data data;
+	data.type = type;
+	return data;
+}
+
+bool CefValue::SetNull()
+{
+	m_data = make_data(VTYPE_NULL);
+	return true;
+}
+
+bool CefValue::SetBool(bool value)
+{
+	m_data = make_data(VTYPE_BOOL);
+	m_data.bool_value = value;
+	return true;
+}
+
+bool CefValue::SetInt(int value)
+{
+	m_data = make_data(VTYPE_INT);
+	m_data.int_value = value;
+	return true;
+}
+
+bool CefValue::SetDouble(double value)
+{
+	m_data = make_data(VTYPE_DOUBLE);
+	m_data.double_value = value;
+	return true;
+}
+
+bool CefValue::SetString(const CefString &value)
+{
+	m_data = make_data(VTYPE_STRING);
+	m_data.string_value = value.ToString();
+	return true;
+}
+
+bool CefValue::SetDictionary(CefRefPtr<CefDictionaryValue> value)
+{
+	if (!value)
+		return false;
+
+	m_data = make_data(VTYPE_DICTIONARY);
+	m_data.dictionary_value = value;
+	return true;
+}
+
+bool CefValue::SetList(CefRefPtr<CefListValue> value)
+{
+	if (!value)
+		return false;
+
+	m_data = make_data(VTYPE_LIST);
+	m_data.list_value = value;
+	return true;
+}
+
+/* Value read out of a container: simple types are copied, containers
+ * referenced */
+static CefRefPtr<CefValue> make_value(const cef_value_data *data)
+{
+	CefRefPtr<CefValue> value = CefValue::Create();
+
+	if (data)
+		value->set_data(*data);
+	else
+		value->set_data(make_data(VTYPE_INVALID));
+
+	return value;
+}
+
+static cef_value_data copy_data(const cef_value_data &data)
+{
+	cef_value_data result = data;
+
+	if (data.dictionary_value)
+		result.dictionary_value = data.dictionary_value->Copy();
+	if (data.list_value)
+		result.list_value = data.list_value->Copy();
+
+	return result;
+}
+
+/* ========================================================================= */
+
+CefRefPtr<CefDictionaryValue> CefDictionaryValue::Create()
+{
+	return new CefDictionaryValue();
+}
+
+CefRefPtr<CefDictionaryValue>
+CefDictionaryValue::Copy(bool exclude_empty_children)
+{
+	CefRefPtr<CefDictionaryValue> result = CefDictionaryValue::Create();
+
+	for (auto &item : m_items) {
+		if (exclude_empty_children &&
+		    ((item.second.dictionary_value &&
+		      !item.second.dictionary_value->GetSize()) ||
+		     (item.second.list_value &&
+		      !item.second.list_value->GetSize())))
+			continue;
+
+		result->m_items[item.first] = copy_data(item.second);
+	}
+
+	return result;
+}
+
+bool CefDictionaryValue::Clear()
+{
+	m_items.clear();
+	return true;
+}
+
+bool CefDictionaryValue::HasKey(const CefString &key)
+{
+	return m_items.count(key.ToString()) > 0;
+}
+
+bool CefDictionaryValue::GetKeys(KeyList &keys)
+{
+	keys.clear();
+	keys.reserve(m_items.size());
+
+	for (auto &item : m_items)
+		keys.push_back(item.first);
+
+	return true;
+}
+
+bool CefDictionaryValue::Remove(const CefString &key)
+{
+	return m_items.erase(key.ToString()) > 0;
+}
+
+const cef_value_data *CefDictionaryValue::find(const CefString &key)
+{
+	auto it = m_items.find(key.ToString());
+
+	return it == m_items.end() ? nullptr : &it->second;
+}
+
+CefValueType CefDictionaryValue::GetType(const CefString &key)
+{
+	const cef_value_data *data = find(key);
+	return data ? data->type : VTYPE_INVALID;
+}
+
+CefRefPtr<CefValue> CefDictionaryValue::GetValue(const CefString &key)
+{
+	return make_value(find(key));
+}
+
+bool CefDictionaryValue::GetBool(const CefString &key)
+{
+	return make_value(find(key))->GetBool();
+}
+
+int CefDictionaryValue::GetInt(const CefString &key)
+{
+	return make_value(find(key))->GetInt();
+}
+
+double CefDictionaryValue::GetDouble(const CefString &key)
+{
+	return make_value(find(key))->GetDouble();
+}
+
+CefString CefDictionaryValue::GetString(const CefString &key)
+{
+	const cef_value_data *data = find(key);
+
+	return data && data->type == VTYPE_STRING ? data->string_value
+						  : std::string();
+}
+
+CefRefPtr<CefDictionaryValue>
+CefDictionaryValue::GetDictionary(const CefString &key)
+{
+	const cef_value_data *data = find(key);
+
+	return data && data->type == VTYPE_DICTIONARY ? data->dictionary_value
+						      : nullptr;
+}
+
+CefRefPtr<CefListValue> CefDictionaryValue::GetList(const CefString &key)
+{
+	const cef_value_data *data = find(key);
+
+	return data && data->type == VTYPE_LIST ? data->list_value : nullptr;
+}
+
+bool CefDictionaryValue::SetValue(const CefString &key,
+				  CefRefPtr<CefValue> value)
+{
+	if (!value)
+		return false;
+
+	m_items[key.ToString()] = value->data();
+	return true;
+}
+
+bool CefDictionaryValue::SetNull(const CefString &key)
+{
+	m_items[key.ToString()] = make_data(VTYPE_NULL);
+	return true;
+}
+
+#define SET_ITEM(slot, value_type, field, value) \
+	do {                                     \
+		cef_value_data data;             \
+		data.type = value_type;          \
+		data.field = value;              \
+		slot = std::move(data);          \
+	} while (0)
+
+bool CefDictionaryValue::SetBool(const CefString &key, bool value)
+{
+	SET_ITEM(m_items[key.ToString()], VTYPE_BOOL, bool_value, value);
+	return true;
+}
+
+bool CefDictionaryValue::SetInt(const CefString &key, int value)
+{
+	SET_ITEM(m_items[key.ToString()], VTYPE_INT, int_value, value);
+	return true;
+}
+
+bool CefDictionaryValue::SetDouble(const CefString &key, double value)
+{
+	SET_ITEM(m_items[key.ToString()], VTYPE_DOUBLE, double_value, value);
+	return true;
+}
+
+bool CefDictionaryValue::SetString(const CefString &key,
+				   const CefString &value)
+{
+	SET_ITEM(m_items[key.ToString()], VTYPE_STRING, string_value,
+		 value.ToString());
+	return true;
+}
+
+bool CefDictionaryValue::SetDictionary(const CefString &key,
+				       CefRefPtr<CefDictionaryValue> value)
+{
+	if (!value)
+		return false;
+
+	SET_ITEM(m_items[key.ToString()], VTYPE_DICTIONARY, dictionary_value,
+		 value);
+	return true;
+}
+
+bool CefDictionaryValue::SetList(const CefString &key,
+				 CefRefPtr<CefListValue> value)
+{
+	if (!value)
+		return false;
+
+	SET_ITEM(m_items[key.ToString()], VTYPE_LIST, list_value, value);
+	return true;
+}
+
+/* ========================================================================= */
+
+CefRefPtr<CefListValue> CefListValue::Create()
+{
+	return new CefListValue();
+}
+
+CefRefPtr<CefListValue> CefListValue::Copy()
+{
+	CefRefPtr<CefListValue> result = CefListValue::Create();
+
+	result->m_items.reserve(m_items.size());
+	for (auto &item : m_items)
+		result->m_items.push_back(copy_data(item));
+
+	return result;
+}
+
+bool CefListValue::SetSize(size_t size)
+{
+	m_items.resize(size);
+	return true;
+}
+
+bool CefListValue::Clear()
+{
+	m_items.clear();
+	return true;
+}
+
+bool CefListValue::Remove(size_t index)
+{
+	if (index >= m_items.size())
+		return false;
+
+	m_items.erase(m_items.begin() + index);
+	return true;
+}
+
+const cef_value_data *CefListValue::find(size_t index)
+{
+	return index < m_items.size() ? &m_items[index] : nullptr;
+}
+
+/* As in CEF, setting past the end grows the list with nulls */
+cef_value_data &CefListValue::slot(size_t index)
+{
+	if (index >= m_items.size())
+		m_items.resize(index + 1);
+
+	return m_items[index];
+}
+
+CefValueType CefListValue::GetType(size_t index)
+{
+	const cef_value_data *data = find(index);
+	return data ? data->type : VTYPE_INVALID;
+}
+
+CefRefPtr<CefValue> CefListValue::GetValue(size_t index)
+{
+	return make_value(find(index));
+}
+
+bool CefListValue::GetBool(size_t index)
+{
+	return make_value(find(index))->GetBool();
+}
+
+int CefListValue::GetInt(size_t index)
+{
+	return make_value(find(index))->GetInt();
+}
+
+double CefListValue::GetDouble(size_t index)
+{
+	return make_value(find(index))->GetDouble();
+}
+
+CefString CefListValue::GetString(size_t index)
+{
+	const cef_value_data *data = find(index);
+
+	return data && data->type == VTYPE_STRING ? data->string_value
+						  : std::string();
+}
+
+CefRefPtr<CefDictionaryValue> CefListValue::GetDictionary(size_t index)
+{
+	const cef_value_data *data = find(index);
+
+	return data && data->type == VTYPE_DICTIONARY ? data->dictionary_value
+						      : nullptr;
+}
+
+CefRefPtr<CefListValue> CefListValue::GetList(size_t index)
+{
+	const cef_value_data *data = find(index);
+
+	return data && data->type == VTYPE_LIST ? data->list_value : nullptr;
+}
+
+bool CefListValue::SetValue(size_t index, CefRefPtr<CefValue> value)
+{
+	if (!value)
+		return false;
+
+	slot(index) = value->data();
+	return true;
+}
+
+bool CefListValue::SetNull(size_t index)
+{
+	slot(index) = make_data(VTYPE_NULL);
+	return true;
+}
+
+bool CefListValue::SetBool(size_t index, bool value)
+{
+	SET_ITEM(slot(index), VTYPE_BOOL, bool_value, value);
+	return true;
+}
+
+bool CefListValue::SetInt(size_t index, int value)
+{
+	SET_ITEM(slot(index), VTYPE_INT, int_value, value);
+	return true;
+}
+
+bool CefListValue::SetDouble(size_t index, double value)
+{
+	SET_ITEM(slot(index), VTYPE_DOUBLE, double_value, value);
+	return true;
+}
+
+bool CefListValue::SetString(size_t index, const CefString &value)
+{
+	SET_ITEM(slot(index), VTYPE_STRING, string_value, value.ToString());
+	return true;
+}
+
+bool CefListValue::SetDictionary(size_t index,
+				 CefRefPtr<CefDictionaryValue> value)
+{
+	if (!value)
+		return false;
+
+	SET_ITEM(slot(index), VTYPE_DICTIONARY, dictionary_value, value);
+	return true;
+}
+
+bool CefListValue::SetList(size_t index, CefRefPtr<CefListValue> value)
+{
+	if (!value)
+		return false;
+
+	SET_ITEM(slot(index), VTYPE_LIST, list_value, value);
+	return true;
+}
+
+/* ========================================================================= */
+
+/* Integral numbers which fit an int parse as VTYPE_INT, as in CEF */
+static cef_value_data from_json(const json11::Json &json)
+{
+	cef_value_data data;
+
+	switch (json.type()) {
+	case json11::Json::NUL:
+		data.type = VTYPE_NULL;
+		break;
+	case json11::Json::BOOL:
+		data.type = VTYPE_BOOL;
+		data.bool_value = json.bool_value();
+		break;
+	case json11::Json::NUMBER: {
+		double value = json.number_value();
+
+		if (std::floor(value) == value &&
+		    value >= (double)std::numeric_limits<int>::min() &&
+		    value <= (double)std::numeric_limits<int>::max()) {
+			data.type = VTYPE_INT;
+			data.int_value = (int)value;
+		} else {
+			data.type = VTYPE_DOUBLE;
+			data.double_value = value;
+		}
+	} break;
+	case json11::Json::STRING:
+		data.type = VTYPE_STRING;
+		data.string_value = json.string_value();
+		break;
+	case json11::Json::ARRAY: {
+		CefRefPtr<CefListValue> list = CefListValue::Create();
+		CefRefPtr<CefValue> item = CefValue::Create();
+
+		list->SetSize(json.array_items().size());
+		for (size_t i = 0; i < json.array_items().size(); ++i) {
+			item->set_data(from_json(json.array_items()[i]));
+			list->SetValue(i, item);
+		}
+
+		data.type = VTYPE_LIST;
+		data.list_value = list;
+	} break;
+	case json11::Json::OBJECT: {
+		CefRefPtr<CefDictionaryValue> d = CefDictionaryValue::Create();
+		CefRefPtr<CefValue> item = CefValue::Create();
+
+		for (auto &field : json.object_items()) {
+			item->set_data(from_json(field.second));
+			d->SetValue(field.first, item);
+		}
+
+		data.type = VTYPE_DICTIONARY;
+		data.dictionary_value = d;
+	} break;
+	}
+
+	return data;
+}
+
+/* Trailing commas are accepted regardless of options */
+static std::string strip_trailing_commas(const std::string &json)
+{
+	std::string result;
+	result.reserve(json.size());
+
+	bool in_string = false;
+
+	for (size_t i = 0; i < json.size(); ++i) {
+		char ch = json[i];
+
+		if (in_string) {
+			result += ch;
+
+			if (ch == '\\' && i + 1 < json.size())
+				result += json[++i];
+			else if (ch == '"')
+				in_string = false;
+
+			continue;
+		}
+
+		if (ch == '"') {
+			in_string = true;
+		} else if (ch == ',') {
+			size_t next = json.find_first_not_of(" \t\r\n", i + 1);
+
+			if (next != std::string::npos &&
+			    (json[next] == ']' || json[next] == '}'))
+				continue;
+		}
+
+		result += ch;
+	}
+
+	return result;
+}
+
+CefRefPtr<CefValue> CefParseJSON(const CefString &json_string,
+				 cef_json_parser_options_t options)
+{
+	std::string err;
+	json11::Json json = json11::Json::parse(
+		(options & JSON_PARSER_ALLOW_TRAILING_COMMAS)
+			? strip_trailing_commas(json_string.ToString())
+			: json_string.ToString(),
+		err);
+
+	if (!err.empty())
+		return nullptr;
+
+	CefRefPtr<CefValue> result = CefValue::Create();
+	result->set_data(from_json(json));
+	return result;
+}
+
+static void write_string(std::string &out, const std::string &str)
+{
+	out += '"';
+
+	for (unsigned char ch : str) {
+		switch (ch) {
+		case '"':
+			out += "\\\"";
+			break;
+		case '\\':
+			out += "\\\\";
+			break;
+		case '\b':
+			out += "\\b";
+			break;
+		case '\f':
+			out += "\\f";
+			break;
+		case '\n':
+			out += "\\n";
+			break;
+		case '\r':
+			out += "\\r";
+			break;
+		case '\t':
+			out += "\\t";
+			break;
+		default:
+			if (ch < 0x20) {
+				char buf[8];
+				snprintf(buf, sizeof(buf), "\\u%04x", ch);
+				out += buf;
+			} else {
+				out += (char)ch;
+			}
+			break;
+		}
+	}
+
+	out += '"';
+}
+
+static void write_indent(std::string &out, bool pretty, int depth)
+{
+	if (!pretty)
+		return;
+
+	out += '\n';
+	out.append(depth * 3, ' ');
+}
+
+/* Doubles keep a fractional part, as in Chromium's JSONWriter, so they
+ * read back as doubles */
+static void write_double(std::string &out, double value)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.17g", value);
+
+	out += buf;
+
+	if (std::isfinite(value) && !strpbrk(buf, ".eE"))
+		out += ".0";
+}
+
+static void write_json(std::string &out, const cef_value_data &data,
+		       bool pretty, int depth)
+{
+	switch (data.type) {
+	case VTYPE_BOOL:
+		out += data.bool_value ? "true" : "false";
+		break;
+	case VTYPE_INT:
+		out += std::to_string(data.int_value);
+		break;
+	case VTYPE_DOUBLE:
+		write_double(out, data.double_value);
+		break;
+	case VTYPE_STRING:
+		write_string(out, data.string_value);
+		break;
+	case VTYPE_LIST: {
+		auto &items = data.list_value->items();
+
+		out += '[';
+		for (size_t i = 0; i < items.size(); ++i) {
+			if (i)
+				out += ',';
+			write_indent(out, pretty, depth + 1);
+			write_json(out, items[i], pretty, depth + 1);
+		}
+		if (!items.empty())
+			write_indent(out, pretty, depth);
+		out += ']';
+	} break;
+	case VTYPE_DICTIONARY: {
+		auto &items = data.dictionary_value->items();
+
+		out += '{';
+		bool first = true;
+		for (auto &item : items) {
+			if (!first)
+				out += ',';
+			first = false;
+			write_indent(out, pretty, depth + 1);
+			write_string(out, item.first);
+			out += pretty ? ": " : ":";
+			write_json(out, item.second, pretty, depth + 1);
+		}
+		if (!items.empty())
+			write_indent(out, pretty, depth);
+		out += '}';
+	} break;
+	default:
+		out += "null";
+		break;
+	}
+}
+
+CefString CefWriteJSON(CefRefPtr<CefValue> node,
+		       cef_json_writer_options_t options)
+{
+	if (!node)
+		return CefString();
+
+	std::string out;
+	write_json(out, node->data(), !!(options & JSON_WRITER_PRETTY_PRINT),
+		   0);
+
+	if (options & JSON_WRITER_PRETTY_PRINT)
+		out += '\n';
+
+	return out;
+}
+
+/* ========================================================================= */
+
+CefRefPtr<CefProcessMessage> CefProcessMessage::Create(const CefString &name)
+{
+	CefRefPtr<CefProcessMessage> message = new CefProcessMessage();
+	message->m_name = name;
+	return message;
+}
+
+CefRefPtr<CefProcessMessage> CefProcessMessage::Copy()
+{
+	CefRefPtr<CefProcessMessage> message = Create(m_name);
+	message->m_args = m_args->Copy();
+	return message;
+}
+
+static std::atomic<int> next_browser_id{1};
+static std::atomic<size_t> sent_message_count{0};
+
+CefBrowser::CefBrowser() : m_id(next_browser_id++) {}
+
+void CefFrame::SendProcessMessage(CefProcessId,
+				  CefRefPtr<CefProcessMessage> message)
+{
+	++sent_message_count;
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+	m_sent.push_back(message);
+}
+
+std::vector<CefRefPtr<CefProcessMessage>> CefFrame::TakeSentMessages()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	std::vector<CefRefPtr<CefProcessMessage>> result;
+	result.swap(m_sent);
+	return result;
+}
+
+CefRefPtr<CefBrowser> stub::cef_create_browser()
+{
+	return new CefBrowser();
+}
+
+std::vector<CefRefPtr<CefProcessMessage>>
+stub::cef_take_sent_messages(CefRefPtr<CefBrowser> browser)
+{
+	return browser->GetMainFrame()->TakeSentMessages();
+}
+
+size_t stub::cef_sent_message_count()
+{
+	return sent_message_count;
+}
+
+/* ========================================================================= */
+
+bool CefCookieManager::FlushStore(CefRefPtr<CefCompletionCallback> callback)
+{
+	if (!m_acceptFlush)
+		return false;
+
+	CefRefPtr<CefCookieManager> self = this;
+
+	std::thread([self, callback]() {
+		std::this_thread::sleep_for(
+			std::chrono::milliseconds(self->m_flushDelayMs));
+
+		std::ofstream(self->m_storagePath + "/Cookies") << "flushed";
+		++self->m_flushes;
+
+		if (callback.get())
+			callback->OnComplete();
+	}).detach();
+
+	return true;
+}
+
+CefRefPtr<CefCookieManager>
+stub::cef_create_cookie_manager(std::string storage_path, int flush_delay_ms,
+				bool accept_flush)
+{
+	CefRefPtr<CefCookieManager> cm = new CefCookieManager();
+	cm->m_storagePath = storage_path;
+	cm->m_flushDelayMs = flush_delay_ms;
+	cm->m_acceptFlush = accept_flush;
+	return cm;
+}
+
+int stub::cef_cookie_flush_count(CefRefPtr<CefCookieManager> cm)
+{
+	return cm->m_flushes;
+}
+
+static std::atomic<std::thread::id> ui_thread_id;
+
+void stub::cef_set_ui_thread()
+{
+	ui_thread_id = std::this_thread::get_id();
+}
+
+bool CefCurrentlyOn(CefThreadId threadId)
+{
+	return threadId == TID_UI &&
+	       ui_thread_id.load() == std::this_thread::get_id();
+}
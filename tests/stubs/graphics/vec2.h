@@ -0,0 +1,7 @@
+#pragma once
+
+/* Test stub for libobs graphics/vec2.h. */
+
+struct vec2 {
+	float x, y;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+/* Test stub for CEF include/cef_base.h: intrusive reference counting and a
+ * UTF-8 CefString. */
+
+#include <atomic>
+#include <string>
+#include <utility>
+
+class CefBaseRefCounted {
+public:
+	virtual ~CefBaseRefCounted() {}
+
+	virtual void AddRef() const = 0;
+	virtual bool Release() const = 0;
+	virtual bool HasOneRef() const = 0;
+	virtual bool HasAtLeastOneRef() const = 0;
+};
+
+class CefRefCount {
+public:
+	void AddRef() const { ++m_count; }
+	bool Release() const { return --m_count == 0; }
+	bool HasOneRef() const { return m_count == 1; }
+	bool HasAtLeastOneRef() const { return m_count >= 1; }
+
+private:
+	mutable std::atomic<int> m_count{0};
+};
+
+#define IMPLEMENT_REFCOUNTING(ClassName)                                    \
+public:                                                                     \
+	void AddRef() const override { ref_count_.AddRef(); }               \
+	bool Release() const override                                       \
+	{                                                                   \
+		if (ref_count_.Release()) {                                 \
+			delete static_cast<const ClassName *>(this);        \
+			return true;                                        \
+		}                                                           \
+		return false;                                               \
+	}                                                                   \
+	bool HasOneRef() const override { return ref_count_.HasOneRef(); }  \
+	bool HasAtLeastOneRef() const override                              \
+	{                                                                   \
+		return ref_count_.HasAtLeastOneRef();                       \
+	}                                                                   \
+                                                                            \
+private:                                                                    \
+	CefRefCount ref_count_
+
+template<class T> class CefRefPtr {
+public:
+	CefRefPtr() {}
+	CefRefPtr(std::nullptr_t) {}
+	CefRefPtr(T *ptr) : m_ptr(ptr)
+	{
+		if (m_ptr)
+			m_ptr->AddRef();
+	}
+	CefRefPtr(const CefRefPtr &other) : CefRefPtr(other.m_ptr) {}
+	template<class U>
+	CefRefPtr(const CefRefPtr<U> &other) : CefRefPtr(other.get())
+	{
+	}
+	CefRefPtr(CefRefPtr &&other) : m_ptr(other.m_ptr)
+	{
+		other.m_ptr = nullptr;
+	}
+
+	~CefRefPtr()
+	{
+		if (m_ptr)
+			m_ptr->Release();
+	}
+
+	CefRefPtr &operator=(CefRefPtr other)
+	{
+		std::swap(m_ptr, other.m_ptr);
+		return *this;
+	}
+
+	T *get() const { return m_ptr; }
+	T *operator->() const { return m_ptr; }
+	T &operator*() const { return *m_ptr; }
+	operator T *() const { return m_ptr; }
+
+private:
+	T *m_ptr = nullptr;
+};
+
+class CefString {
+public:
+	CefString() {}
+	CefString(const char *str) : m_str(str ? str : "") {}
+	CefString(const std::string &str) : m_str(str) {}
+
+	std::string ToString() const { return m_str; }
+	operator std::string() const { return m_str; }
+
+	const char *c_str() const { return m_str.c_str(); }
+	size_t length() const { return m_str.size(); }
+	bool empty() const { return m_str.empty(); }
+
+	bool operator==(const CefString &other) const
+	{
+		return m_str == other.m_str;
+	}
+	bool operator!=(const CefString &other) const
+	{
+		return m_str != other.m_str;
+	}
+	bool operator<(const CefString &other) const
+	{
+		return m_str < other.m_str;
+	}
+
+private:
+	std::string m_str;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+/* Test stub for CEF include/cef_browser.h and include/cef_frame.h. Browsers
+ * are fakes with a main frame which records the process messages sent to
+ * it; see cef-stub-control.hpp.
+ */
+
+#include "cef_process_message.h"
+
+#include <mutex>
+#include <vector>
+
+class CefFrame : public CefBaseRefCounted {
+public:
+	void SendProcessMessage(CefProcessId target_process,
+				CefRefPtr<CefProcessMessage> message);
+
+	/* Stub internals */
+	std::vector<CefRefPtr<CefProcessMessage>> TakeSentMessages();
+
+private:
+	std::mutex m_mutex;
+	std::vector<CefRefPtr<CefProcessMessage>> m_sent;
+
+	IMPLEMENT_REFCOUNTING(CefFrame);
+};
+
+class CefBrowser : public CefBaseRefCounted {
+public:
+	CefBrowser();
+
+	int GetIdentifier() { return m_id; }
+	bool IsSame(CefRefPtr<CefBrowser> that) { return that.get() == this; }
+
+	CefRefPtr<CefFrame> GetMainFrame() { return m_frame; }
+
+	void SendProcessMessage(CefProcessId target_process,
+				CefRefPtr<CefProcessMessage> message)
+	{
+		m_frame->SendProcessMessage(target_process, message);
+	}
+
+private:
+	int m_id;
+	CefRefPtr<CefFrame> m_frame = new CefFrame();
+
+	IMPLEMENT_REFCOUNTING(CefBrowser);
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+/* Test stub for CEF include/cef_client.h: only the browser fakes. */
+
+#include "cef_browser.h"
+#include "cef_parser.h"
@@ -0,0 +1,29 @@
+#pragma once
+
+/* Test stub for CEF include/cef_cookie.h: cookie managers whose stores are
+ * files under a storage path, flushed on a thread of their own after a
+ * delay; see cef-stub-control.hpp.
+ */
+
+#include "cef_base.h"
+
+#include <atomic>
+#include <string>
+
+class CefCompletionCallback : public virtual CefBaseRefCounted {
+public:
+	virtual void OnComplete() = 0;
+};
+
+class CefCookieManager : public CefBaseRefCounted {
+public:
+	bool FlushStore(CefRefPtr<CefCompletionCallback> callback);
+
+	/* Stub internals */
+	std::string m_storagePath;
+	int m_flushDelayMs = 0;
+	bool m_acceptFlush = true;
+	std::atomic<int> m_flushes{0};
+
+	IMPLEMENT_REFCOUNTING(CefCookieManager);
+};
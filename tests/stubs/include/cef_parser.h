@@ -0,0 +1,24 @@
+#pragma once
+
+/* Test stub for CEF include/cef_parser.h: JSON only. */
+
+#include "cef_values.h"
+
+enum cef_json_parser_options_t {
+	JSON_PARSER_RFC = 0,
+	JSON_PARSER_ALLOW_TRAILING_COMMAS = 1 << 0,
+};
+
+enum cef_json_writer_options_t {
+	JSON_WRITER_DEFAULT = 0,
+	JSON_WRITER_OMIT_BINARY_VALUES = 1 << 0,
+	JSON_WRITER_OMIT_DOUBLE_TYPE_PRESERVATION = 1 << 1,
+	JSON_WRITER_PRETTY_PRINT = 1 << 2,
+};
+
+/* Returns nullptr for invalid JSON */
+CefRefPtr<CefValue> CefParseJSON(const CefString &json_string,
+				 cef_json_parser_options_t options);
+
+CefString CefWriteJSON(CefRefPtr<CefValue> node,
+		       cef_json_writer_options_t options);
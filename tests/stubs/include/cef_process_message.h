@@ -0,0 +1,31 @@
+#pragma once
+
+/* Test stub for CEF include/cef_process_message.h. */
+
+#include "cef_values.h"
+
+enum CefProcessId {
+	PID_BROWSER,
+	PID_RENDERER,
+};
+
+typedef CefProcessId cef_process_id_t;
+
+class CefProcessMessage : public CefBaseRefCounted {
+public:
+	static CefRefPtr<CefProcessMessage> Create(const CefString &name);
+
+	bool IsValid() { return true; }
+	bool IsReadOnly() { return false; }
+
+	CefRefPtr<CefProcessMessage> Copy();
+
+	CefString GetName() { return m_name; }
+	CefRefPtr<CefListValue> GetArgumentList() { return m_args; }
+
+private:
+	CefString m_name;
+	CefRefPtr<CefListValue> m_args = CefListValue::Create();
+
+	IMPLEMENT_REFCOUNTING(CefProcessMessage);
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+/* Test stub for CEF include/cef_request_context_handler.h: the browser and
+ * cookie manager fakes. */
+
+#include "cef_browser.h"
+#include "cef_cookie.h"
+#include "cef_parser.h"
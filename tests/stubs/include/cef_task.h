@@ -0,0 +1,15 @@
+#pragma once
+
+/* Test stub for CEF include/cef_task.h: the browser fakes, and a UI thread
+ * set by the test; see cef-stub-control.hpp. */
+
+#include "cef_browser.h"
+#include "cef_parser.h"
+
+typedef enum {
+	TID_UI,
+	TID_FILE_BACKGROUND,
+	TID_IO,
+} CefThreadId;
+
+bool CefCurrentlyOn(CefThreadId threadId);
@@ -0,0 +1,175 @@
+#pragma once
+
+/* Test stub for CEF include/cef_values.h.
+ *
+ * As in CEF, values read from a container copy simple types and reference
+ * lists and dictionaries, so nested containers can be changed in place.
+ * Unlike CEF, a container set into another one stays shared with the
+ * caller's reference instead of being detached from it.
+ */
+
+#include "cef_base.h"
+
+#include <map>
+#include <vector>
+
+enum CefValueType {
+	VTYPE_INVALID = 0,
+	VTYPE_NULL,
+	VTYPE_BOOL,
+	VTYPE_INT,
+	VTYPE_DOUBLE,
+	VTYPE_STRING,
+	VTYPE_BINARY,
+	VTYPE_DICTIONARY,
+	VTYPE_LIST,
+};
+
+typedef CefValueType cef_value_type_t;
+
+class CefValue;
+class CefListValue;
+class CefDictionaryValue;
+
+/* One slot of a value, list or dictionary */
+struct cef_value_data {
+	CefValueType type = VTYPE_NULL;
+	bool bool_value = false;
+	int int_value = 0;
+	double double_value = 0;
+	std::string string_value;
+	CefRefPtr<CefDictionaryValue> dictionary_value;
+	CefRefPtr<CefListValue> list_value;
+};
+
+class CefValue : public CefBaseRefCounted {
+public:
+	static CefRefPtr<CefValue> Create();
+
+	bool IsValid() { return true; }
+	bool IsOwned() { return false; }
+	bool IsReadOnly() { return false; }
+
+	CefRefPtr<CefValue> Copy();
+
+	CefValueType GetType() { return m_data.type; }
+	bool GetBool();
+	int GetInt();
+	double GetDouble();
+	CefString GetString();
+	CefRefPtr<CefDictionaryValue> GetDictionary();
+	CefRefPtr<CefListValue> GetList();
+
+	bool SetNull();
+	bool SetBool(bool value);
+	bool SetInt(int value);
+	bool SetDouble(double value);
+	bool SetString(const CefString &value);
+	bool SetDictionary(CefRefPtr<CefDictionaryValue> value);
+	bool SetList(CefRefPtr<CefListValue> value);
+
+	/* Stub internals */
+	const cef_value_data &data() const { return m_data; }
+	void set_data(const cef_value_data &data) { m_data = data; }
+
+private:
+	cef_value_data m_data;
+
+	IMPLEMENT_REFCOUNTING(CefValue);
+};
+
+class CefDictionaryValue : public CefBaseRefCounted {
+public:
+	typedef std::vector<CefString> KeyList;
+
+	static CefRefPtr<CefDictionaryValue> Create();
+
+	bool IsValid() { return true; }
+	bool IsOwned() { return false; }
+	bool IsReadOnly() { return false; }
+
+	CefRefPtr<CefDictionaryValue> Copy(bool exclude_empty_children = false);
+
+	size_t GetSize() { return m_items.size(); }
+	bool Clear();
+	bool HasKey(const CefString &key);
+	bool GetKeys(KeyList &keys);
+	bool Remove(const CefString &key);
+
+	CefValueType GetType(const CefString &key);
+	CefRefPtr<CefValue> GetValue(const CefString &key);
+	bool GetBool(const CefString &key);
+	int GetInt(const CefString &key);
+	double GetDouble(const CefString &key);
+	CefString GetString(const CefString &key);
+	CefRefPtr<CefDictionaryValue> GetDictionary(const CefString &key);
+	CefRefPtr<CefListValue> GetList(const CefString &key);
+
+	bool SetValue(const CefString &key, CefRefPtr<CefValue> value);
+	bool SetNull(const CefString &key);
+	bool SetBool(const CefString &key, bool value);
+	bool SetInt(const CefString &key, int value);
+	bool SetDouble(const CefString &key, double value);
+	bool SetString(const CefString &key, const CefString &value);
+	bool SetDictionary(const CefString &key,
+			   CefRefPtr<CefDictionaryValue> value);
+	bool SetList(const CefString &key, CefRefPtr<CefListValue> value);
+
+	/* Stub internals */
+	const std::map<std::string, cef_value_data> &items() const
+	{
+		return m_items;
+	}
+
+private:
+	const cef_value_data *find(const CefString &key);
+
+	std::map<std::string, cef_value_data> m_items;
+
+	IMPLEMENT_REFCOUNTING(CefDictionaryValue);
+};
+
+class CefListValue : public CefBaseRefCounted {
+public:
+	static CefRefPtr<CefListValue> Create();
+
+	bool IsValid() { return true; }
+	bool IsOwned() { return false; }
+	bool IsReadOnly() { return false; }
+
+	CefRefPtr<CefListValue> Copy();
+
+	bool SetSize(size_t size);
+	size_t GetSize() { return m_items.size(); }
+	bool Clear();
+	bool Remove(size_t index);
+
+	CefValueType GetType(size_t index);
+	CefRefPtr<CefValue> GetValue(size_t index);
+	bool GetBool(size_t index);
+	int GetInt(size_t index);
+	double GetDouble(size_t index);
+	CefString GetString(size_t index);
+	CefRefPtr<CefDictionaryValue> GetDictionary(size_t index);
+	CefRefPtr<CefListValue> GetList(size_t index);
+
+	bool SetValue(size_t index, CefRefPtr<CefValue> value);
+	bool SetNull(size_t index);
+	bool SetBool(size_t index, bool value);
+	bool SetInt(size_t index, int value);
+	bool SetDouble(size_t index, double value);
+	bool SetString(size_t index, const CefString &value);
+	bool SetDictionary(size_t index, CefRefPtr<CefDictionaryValue> value);
+	bool SetList(size_t index, CefRefPtr<CefListValue> value);
+
+	/* Stub internals */
+	const std::vector<cef_value_data> &items() const { return m_items; }
+
+private:
+	const cef_value_data *find(size_t index);
+	cef_value_data &slot(size_t index);
+
+	std::vector<cef_value_data> m_items;
+
+	IMPLEMENT_REFCOUNTING(CefListValue);
+};
@@ -0,0 +1,6 @@
+#pragma once
+
+/* Test stub for CEF include/cef_version.h. */
+
+#define CHROME_VERSION_MAJOR 75
+#define CHROME_VERSION_BUILD 3770
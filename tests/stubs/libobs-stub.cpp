@@ -0,0 +1,838 @@
+#include "obs.h"
+#include "obs-frontend-api.h"
+#include "util/platform.h"
+#include "util/threading.h"
+#include "stub-control.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* ========================================================================= */
+
+extern "C" void blog(int log_level, const char *format, ...)
+{
+	static std::mutex mutex;
+	static const bool verbose = !!getenv("OBS_STUB_VERBOSE");
+
+	/* Info logging of per-call paths would drown benchmark output */
+	if (log_level > LOG_WARNING && !verbose)
+		return;
+
+	std::lock_guard<std::mutex> guard(mutex);
+
+	va_list args;
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
+
+extern "C" void *bmalloc(size_t size)
+{
+	return malloc(size ? size : 1);
+}
+
+extern "C" void bfree(void *ptr)
+{
+	free(ptr);
+}
+
+extern "C" char *bstrdup(const char *str)
+{
+	if (!str)
+		return nullptr;
+
+	size_t len = strlen(str) + 1;
+	char *dup = (char *)bmalloc(len);
+	memcpy(dup, str, len);
+	return dup;
+}
+
+/* ========================================================================= */
+
+extern "C" FILE *os_fopen(const char *path, const char *mode)
+{
+	return fopen(path, mode);
+}
+
+extern "C" int os_stat(const char *file, struct stat *st)
+{
+	return stat(file, st);
+}
+
+extern "C" int64_t os_get_file_size(const char *path)
+{
+	struct stat st;
+	if (stat(path, &st) != 0)
+		return -1;
+	return (int64_t)st.st_size;
+}
+
+static std::atomic<size_t> file_exists_calls{0};
+
+size_t stub::os_file_exists_calls()
+{
+	return file_exists_calls;
+}
+
+void stub::reset_os_file_exists_calls()
+{
+	file_exists_calls = 0;
+}
+
+extern "C" bool os_file_exists(const char *path)
+{
+	++file_exists_calls;
+
+	return access(path, F_OK) == 0;
+}
+
+extern "C" char *os_quick_read_utf8_file(const char *path)
+{
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		return nullptr;
+
+	std::string content;
+	char buf[65536];
+	size_t size;
+
+	while ((size = fread(buf, 1, sizeof(buf), file)) > 0)
+		content.append(buf, size);
+
+	fclose(file);
+
+	/* Skip the UTF-8 byte order mark, as libobs does */
+	size_t offset = content.compare(0, 3, "\xEF\xBB\xBF") == 0 ? 3 : 0;
+
+	return bstrdup(content.c_str() + offset);
+}
+
+extern "C" bool os_quick_write_utf8_file(const char *path, const char *str,
+					 size_t len, bool marker)
+{
+	FILE *file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	bool success = (!marker || fwrite("\xEF\xBB\xBF", 1, 3, file) == 3) &&
+		       fwrite(str, 1, len, file) == len;
+
+	return fclose(file) == 0 && success;
+}
+
+extern "C" int os_mkdirs(const char *path)
+{
+	std::error_code ec;
+
+	if (std::filesystem::is_directory(path, ec))
+		return MKDIR_EXISTS;
+
+	return std::filesystem::create_directories(path, ec) ? MKDIR_SUCCESS
+							      : MKDIR_ERROR;
+}
+
+extern "C" int os_rename(const char *old_path, const char *new_path)
+{
+	return rename(old_path, new_path);
+}
+
+extern "C" int os_unlink(const char *path)
+{
+	return unlink(path);
+}
+
+extern "C" uint64_t os_gettime_ns(void)
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		       std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+extern "C" void os_sleep_ms(uint32_t duration)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(duration));
+}
+
+struct os_dir {
+	std::string path;
+	DIR *dir;
+	struct os_dirent out;
+};
+
+extern "C" os_dir_t *os_opendir(const char *path)
+{
+	DIR *dir = opendir(path);
+	if (!dir)
+		return nullptr;
+
+	os_dir_t *result = new os_dir_t();
+	result->path = path;
+	result->dir = dir;
+	return result;
+}
+
+extern "C" struct os_dirent *os_readdir(os_dir_t *dir)
+{
+	if (!dir)
+		return nullptr;
+
+	struct dirent *entry = readdir(dir->dir);
+	if (!entry)
+		return nullptr;
+
+	strncpy(dir->out.d_name, entry->d_name, sizeof(dir->out.d_name) - 1);
+	dir->out.d_name[sizeof(dir->out.d_name) - 1] = 0;
+
+	std::string full = dir->path + "/" + entry->d_name;
+	struct stat st;
+	dir->out.directory = stat(full.c_str(), &st) == 0 &&
+			     S_ISDIR(st.st_mode);
+	return &dir->out;
+}
+
+extern "C" void os_closedir(os_dir_t *dir)
+{
+	if (!dir)
+		return;
+
+	closedir(dir->dir);
+	delete dir;
+}
+
+/* ========================================================================= */
+
+struct os_event_data {
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool signalled = false;
+	bool manual = false;
+};
+
+extern "C" int os_event_init(os_event_t **event, enum os_event_type type)
+{
+	*event = new os_event_data();
+	(*event)->manual = type == OS_EVENT_TYPE_MANUAL;
+	return 0;
+}
+
+extern "C" void os_event_destroy(os_event_t *event)
+{
+	delete event;
+}
+
+extern "C" int os_event_wait(os_event_t *event)
+{
+	std::unique_lock<std::mutex> lock(event->mutex);
+	event->cv.wait(lock, [event]() { return event->signalled; });
+	if (!event->manual)
+		event->signalled = false;
+	return 0;
+}
+
+extern "C" int os_event_timedwait(os_event_t *event,
+				  unsigned long milliseconds)
+{
+	std::unique_lock<std::mutex> lock(event->mutex);
+	if (!event->cv.wait_for(lock, std::chrono::milliseconds(milliseconds),
+				[event]() { return event->signalled; }))
+		return ETIMEDOUT;
+	if (!event->manual)
+		event->signalled = false;
+	return 0;
+}
+
+extern "C" int os_event_try(os_event_t *event)
+{
+	std::lock_guard<std::mutex> guard(event->mutex);
+	if (!event->signalled)
+		return EAGAIN;
+	if (!event->manual)
+		event->signalled = false;
+	return 0;
+}
+
+extern "C" int os_event_signal(os_event_t *event)
+{
+	std::lock_guard<std::mutex> guard(event->mutex);
+	event->signalled = true;
+	if (event->manual)
+		event->cv.notify_all();
+	else
+		event->cv.notify_one();
+	return 0;
+}
+
+extern "C" void os_event_reset(os_event_t *event)
+{
+	std::lock_guard<std::mutex> guard(event->mutex);
+	event->signalled = false;
+}
+
+/* ========================================================================= */
+
+struct signal_handler {
+	struct connection {
+		std::string signal;
+		signal_callback_t callback;
+		void *data;
+	};
+
+	std::recursive_mutex mutex;
+	std::vector<connection> connections;
+};
+
+extern "C" void signal_handler_connect(signal_handler_t *handler,
+				       const char *signal,
+				       signal_callback_t callback, void *data)
+{
+	std::lock_guard<std::recursive_mutex> guard(handler->mutex);
+	handler->connections.push_back({signal, callback, data});
+}
+
+extern "C" void signal_handler_disconnect(signal_handler_t *handler,
+					  const char *signal,
+					  signal_callback_t callback,
+					  void *data)
+{
+	std::lock_guard<std::recursive_mutex> guard(handler->mutex);
+
+	auto &list = handler->connections;
+	for (auto it = list.begin(); it != list.end(); ++it) {
+		if (it->signal == signal && it->callback == callback &&
+		    it->data == data) {
+			list.erase(it);
+			return;
+		}
+	}
+}
+
+extern "C" void signal_handler_signal(signal_handler_t *handler,
+				      const char *signal, calldata_t *params)
+{
+	/* Callbacks run under the handler lock, so a disconnect returns
+	 * only after any in-flight callback completes, as in libobs. */
+	std::lock_guard<std::recursive_mutex> guard(handler->mutex);
+
+	auto list = handler->connections;
+	for (auto &connection : list) {
+		if (connection.signal == signal)
+			connection.callback(connection.data, params);
+	}
+}
+
+/* ========================================================================= */
+
+static std::mutex source_mutex;
+static stub::source_counters source_stats;
+
+struct obs_source {
+	std::atomic<long> refs{1};
+	std::string id;
+	std::string name;
+	obs_data_t *settings = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+
+	/* Owned, for sources of scenes */
+	obs_scene_t *scene = nullptr;
+
+	bool audio_pending = true;
+	uint64_t audio_timestamp = 0;
+	std::vector<float> audio[MAX_AUDIO_CHANNELS];
+};
+
+struct obs_scene_item {
+	std::atomic<long> refs{1};
+	obs_scene_t *parent = nullptr;
+	obs_source_t *source = nullptr;
+	struct obs_transform_info info = {};
+	struct obs_sceneitem_crop crop = {};
+};
+
+struct obs_scene {
+	obs_source_t *source = nullptr;
+	std::vector<obs_sceneitem_t *> items;
+};
+
+static void destroy_scene(obs_scene_t *scene);
+
+extern "C" obs_source_t *obs_source_create_private(const char *id,
+						   const char *name,
+						   obs_data_t *settings)
+{
+	obs_source_t *source = new obs_source_t();
+	source->id = id ? id : "";
+	source->name = name ? name : "";
+	source->settings = settings ? settings : obs_data_create();
+	if (settings)
+		obs_data_addref(settings);
+
+	std::lock_guard<std::mutex> guard(source_mutex);
+	++source_stats.created;
+	return source;
+}
+
+extern "C" void obs_source_addref(obs_source_t *source)
+{
+	if (source)
+		++source->refs;
+}
+
+extern "C" void obs_source_release(obs_source_t *source)
+{
+	if (!source || --source->refs != 0)
+		return;
+
+	if (source->scene)
+		destroy_scene(source->scene);
+
+	obs_data_release(source->settings);
+	delete source;
+
+	std::lock_guard<std::mutex> guard(source_mutex);
+	++source_stats.destroyed;
+}
+
+extern "C" bool obs_source_add_active_child(obs_source_t *parent,
+					    obs_source_t *child)
+{
+	if (!parent || !child)
+		return false;
+
+	std::lock_guard<std::mutex> guard(source_mutex);
+	++source_stats.active_children;
+	return true;
+}
+
+extern "C" void obs_source_remove_active_child(obs_source_t *parent,
+					       obs_source_t *child)
+{
+	if (!parent || !child)
+		return;
+
+	std::lock_guard<std::mutex> guard(source_mutex);
+	--source_stats.active_children;
+}
+
+extern "C" const char *obs_source_get_name(const obs_source_t *source)
+{
+	return source ? source->name.c_str() : nullptr;
+}
+
+extern "C" const char *obs_source_get_id(const obs_source_t *source)
+{
+	return source ? source->id.c_str() : nullptr;
+}
+
+extern "C" uint32_t obs_source_get_width(obs_source_t *source)
+{
+	return source ? source->width : 0;
+}
+
+extern "C" uint32_t obs_source_get_height(obs_source_t *source)
+{
+	return source ? source->height : 0;
+}
+
+extern "C" obs_data_t *obs_source_get_settings(const obs_source_t *source)
+{
+	if (!source)
+		return nullptr;
+
+	obs_data_addref(source->settings);
+	return source->settings;
+}
+
+/* Replaces the settings: libobs merges, which the tested code does not
+ * depend on */
+extern "C" void obs_source_update(obs_source_t *source, obs_data_t *settings)
+{
+	if (!source || !settings)
+		return;
+
+	obs_data_addref(settings);
+	obs_data_release(source->settings);
+	source->settings = settings;
+}
+
+extern "C" bool obs_source_audio_pending(const obs_source_t *source)
+{
+	return !source || source->audio_pending;
+}
+
+extern "C" uint64_t obs_source_get_audio_timestamp(const obs_source_t *source)
+{
+	return source ? source->audio_timestamp : 0;
+}
+
+extern "C" void obs_source_get_audio_mix(const obs_source_t *source,
+					 struct obs_source_audio_mix *audio)
+{
+	memset(audio, 0, sizeof(*audio));
+
+	if (!source)
+		return;
+
+	for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ++ch) {
+		if (!source->audio[ch].empty())
+			audio->output[0].data[ch] =
+				const_cast<float *>(source->audio[ch].data());
+	}
+}
+
+void stub::set_source_size(obs_source_t *source, uint32_t width,
+			   uint32_t height)
+{
+	source->width = width;
+	source->height = height;
+}
+
+void stub::set_source_audio(obs_source_t *source, uint64_t timestamp,
+			    const std::vector<std::vector<float>> &channels)
+{
+	source->audio_pending = channels.empty();
+	source->audio_timestamp = timestamp;
+
+	for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ++ch) {
+		source->audio[ch].clear();
+
+		if (ch < channels.size()) {
+			source->audio[ch] = channels[ch];
+			source->audio[ch].resize(AUDIO_OUTPUT_FRAMES);
+		}
+	}
+}
+
+/* ========================================================================= */
+
+extern "C" obs_scene_t *obs_scene_create(const char *name)
+{
+	obs_scene_t *scene = new obs_scene_t();
+
+	scene->source = obs_source_create_private("scene", name, nullptr);
+	scene->source->scene = scene;
+
+	return scene;
+}
+
+extern "C" void obs_scene_release(obs_scene_t *scene)
+{
+	if (scene)
+		obs_source_release(scene->source);
+}
+
+static void destroy_scene(obs_scene_t *scene)
+{
+	for (obs_sceneitem_t *item : scene->items) {
+		item->parent = nullptr;
+		obs_sceneitem_release(item);
+	}
+
+	delete scene;
+}
+
+extern "C" obs_source_t *obs_scene_get_source(const obs_scene_t *scene)
+{
+	return scene ? scene->source : nullptr;
+}
+
+extern "C" obs_scene_t *obs_scene_from_source(const obs_source_t *source)
+{
+	return source ? source->scene : nullptr;
+}
+
+extern "C" obs_sceneitem_t *obs_scene_add(obs_scene_t *scene,
+					  obs_source_t *source)
+{
+	if (!scene || !source)
+		return nullptr;
+
+	obs_sceneitem_t *item = new obs_sceneitem_t();
+
+	item->parent = scene;
+	item->source = source;
+	obs_source_addref(source);
+
+	item->info.scale = {1.0f, 1.0f};
+	item->info.alignment = OBS_ALIGN_LEFT | OBS_ALIGN_TOP;
+	item->info.bounds_alignment = OBS_ALIGN_CENTER;
+
+	scene->items.push_back(item);
+	return item;
+}
+
+extern "C" void obs_scene_enum_items(obs_scene_t *scene,
+				     bool (*callback)(obs_scene_t *,
+						      obs_sceneitem_t *,
+						      void *),
+				     void *param)
+{
+	if (!scene)
+		return;
+
+	for (obs_sceneitem_t *item : scene->items) {
+		if (!callback(scene, item, param))
+			break;
+	}
+}
+
+extern "C" void obs_sceneitem_addref(obs_sceneitem_t *item)
+{
+	if (item)
+		++item->refs;
+}
+
+extern "C" void obs_sceneitem_release(obs_sceneitem_t *item)
+{
+	if (!item || --item->refs != 0)
+		return;
+
+	obs_source_release(item->source);
+	delete item;
+}
+
+extern "C" obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item)
+{
+	return item ? item->source : nullptr;
+}
+
+extern "C" void obs_sceneitem_set_info(obs_sceneitem_t *item,
+				       const struct obs_transform_info *info)
+{
+	if (item && info)
+		item->info = *info;
+}
+
+extern "C" void obs_sceneitem_get_info(const obs_sceneitem_t *item,
+				       struct obs_transform_info *info)
+{
+	if (item && info)
+		*info = item->info;
+}
+
+extern "C" void obs_sceneitem_set_crop(obs_sceneitem_t *item,
+				       const struct obs_sceneitem_crop *crop)
+{
+	if (item && crop)
+		item->crop = *crop;
+}
+
+extern "C" void obs_sceneitem_get_crop(const obs_sceneitem_t *item,
+				       struct obs_sceneitem_crop *crop)
+{
+	if (item && crop)
+		*crop = item->crop;
+}
+
+stub::source_counters stub::get_source_counters()
+{
+	std::lock_guard<std::mutex> guard(source_mutex);
+	return source_stats;
+}
+
+void stub::reset_source_counters()
+{
+	std::lock_guard<std::mutex> guard(source_mutex);
+	source_stats = stub::source_counters();
+}
+
+/* ========================================================================= */
+
+static std::atomic<long> output_count{0};
+
+struct obs_output {
+	std::atomic<long> refs{1};
+	std::atomic<bool> active{false};
+	std::atomic<bool> frontend_active{false};
+	std::atomic<bool> stopping{false};
+	stub::fake_output_config config;
+	signal_handler_t signals;
+
+	obs_output() { ++output_count; }
+	~obs_output() { --output_count; }
+};
+
+extern "C" void obs_output_addref(obs_output_t *output)
+{
+	if (output)
+		++output->refs;
+}
+
+extern "C" void obs_output_release(obs_output_t *output)
+{
+	if (output && --output->refs == 0)
+		delete output;
+}
+
+extern "C" bool obs_output_active(const obs_output_t *output)
+{
+	return output && output->active;
+}
+
+extern "C" signal_handler_t *
+obs_output_get_signal_handler(const obs_output_t *output)
+{
+	return output ? const_cast<signal_handler_t *>(&output->signals)
+		      : nullptr;
+}
+
+struct fake_frontend_output {
+	obs_output_t *output = nullptr;
+	int stop_calls = 0;
+};
+
+static std::mutex frontend_mutex;
+static fake_frontend_output frontend_outputs[3];
+static std::vector<std::thread> stop_workers;
+
+static fake_frontend_output &get_frontend_output(stub::frontend_output which)
+{
+	return frontend_outputs[(int)which];
+}
+
+static obs_output_t *get_output(stub::frontend_output which)
+{
+	std::lock_guard<std::mutex> guard(frontend_mutex);
+
+	obs_output_t *output = get_frontend_output(which).output;
+	obs_output_addref(output);
+	return output;
+}
+
+static bool get_frontend_active(stub::frontend_output which)
+{
+	std::lock_guard<std::mutex> guard(frontend_mutex);
+
+	obs_output_t *output = get_frontend_output(which).output;
+	return output && output->frontend_active;
+}
+
+/* Emulates the frontend: the stop request is handled asynchronously, the
+ * output emits "stop" once it winds down and the frontend flag clears a
+ * little later, when the main thread handles the stop event. */
+static void stop_output(stub::frontend_output which)
+{
+	std::lock_guard<std::mutex> guard(frontend_mutex);
+
+	fake_frontend_output &fake = get_frontend_output(which);
+	++fake.stop_calls;
+
+	obs_output_t *output = fake.output;
+	if (!output || !output->active || output->config.hang ||
+	    output->stopping.exchange(true))
+		return;
+
+	obs_output_addref(output);
+	stop_workers.emplace_back([output]() {
+		os_sleep_ms(output->config.stop_delay_ms);
+		output->active = false;
+		signal_handler_signal(&output->signals, "stop", nullptr);
+		os_sleep_ms(output->config.frontend_lag_ms);
+		output->frontend_active = false;
+		obs_output_release(output);
+	});
+}
+
+void stub::set_frontend_output(frontend_output which,
+			       const fake_output_config &config)
+{
+	obs_output_t *output = new obs_output_t();
+	output->config = config;
+	output->active = config.active;
+	output->frontend_active = config.frontend_active;
+
+	std::lock_guard<std::mutex> guard(frontend_mutex);
+
+	fake_frontend_output &fake = get_frontend_output(which);
+	obs_output_release(fake.output);
+	fake.output = output;
+	fake.stop_calls = 0;
+}
+
+void stub::clear_frontend_outputs()
+{
+	std::vector<std::thread> workers;
+	{
+		std::lock_guard<std::mutex> guard(frontend_mutex);
+		workers.swap(stop_workers);
+	}
+
+	for (auto &worker : workers)
+		worker.join();
+
+	std::lock_guard<std::mutex> guard(frontend_mutex);
+	for (auto &fake : frontend_outputs) {
+		obs_output_release(fake.output);
+		fake = fake_frontend_output();
+	}
+}
+
+int stub::frontend_stop_calls(frontend_output which)
+{
+	std::lock_guard<std::mutex> guard(frontend_mutex);
+	return get_frontend_output(which).stop_calls;
+}
+
+long stub::live_outputs()
+{
+	return output_count;
+}
+
+extern "C" obs_output_t *obs_frontend_get_streaming_output(void)
+{
+	return get_output(stub::frontend_output::streaming);
+}
+
+extern "C" obs_output_t *obs_frontend_get_recording_output(void)
+{
+	return get_output(stub::frontend_output::recording);
+}
+
+extern "C" obs_output_t *obs_frontend_get_replay_buffer_output(void)
+{
+	return get_output(stub::frontend_output::replay_buffer);
+}
+
+extern "C" bool obs_frontend_streaming_active(void)
+{
+	return get_frontend_active(stub::frontend_output::streaming);
+}
+
+extern "C" bool obs_frontend_recording_active(void)
+{
+	return get_frontend_active(stub::frontend_output::recording);
+}
+
+extern "C" bool obs_frontend_replay_buffer_active(void)
+{
+	return get_frontend_active(stub::frontend_output::replay_buffer);
+}
+
+extern "C" void obs_frontend_streaming_stop(void)
+{
+	stop_output(stub::frontend_output::streaming);
+}
+
+extern "C" void obs_frontend_recording_stop(void)
+{
+	stop_output(stub::frontend_output::recording);
+}
+
+extern "C" void obs_frontend_replay_buffer_stop(void)
+{
+	stop_output(stub::frontend_output::replay_buffer);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+/* Test stub for libobs media-io/audio-io.h. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MAX_AUDIO_MIXES 6
+#define MAX_AUDIO_CHANNELS 8
+#define AUDIO_OUTPUT_FRAMES 1024
+
+struct audio_output_data {
+	float *data[MAX_AUDIO_CHANNELS];
+};
+
+static inline uint64_t ns_to_audio_frames(size_t sample_rate, uint64_t ns)
+{
+	return (uint64_t)((unsigned __int128)ns * sample_rate / 1000000000ULL);
+}
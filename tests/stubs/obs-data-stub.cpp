@@ -0,0 +1,525 @@
+#include "obs.h"
+
+#include "json11/json11.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Items keep their insertion order, as in libobs. Only user values and
+ * string defaults are modelled. */
+
+struct obs_data_item {
+	obs_data_t *parent = nullptr;
+	size_t index = 0;
+
+	std::string name;
+	enum obs_data_type type = OBS_DATA_NULL;
+	bool has_user_value = false;
+	bool has_default_value = false;
+
+	std::string string_value;
+	std::string default_string_value;
+	enum obs_data_number_type num_type = OBS_DATA_NUM_INVALID;
+	long long int_value = 0;
+	double double_value = 0;
+	bool bool_value = false;
+	obs_data_t *obj = nullptr;
+	obs_data_array_t *array = nullptr;
+};
+
+struct obs_data {
+	std::atomic<long> refs{1};
+	std::vector<std::unique_ptr<obs_data_item>> items;
+	std::string json;
+};
+
+struct obs_data_array {
+	std::atomic<long> refs{1};
+	std::vector<obs_data_t *> objects;
+};
+
+static void clear_value(obs_data_item_t *item)
+{
+	obs_data_release(item->obj);
+	obs_data_array_release(item->array);
+
+	item->obj = nullptr;
+	item->array = nullptr;
+	item->string_value.clear();
+	item->num_type = OBS_DATA_NUM_INVALID;
+}
+
+static obs_data_item_t *find_item(obs_data_t *data, const char *name)
+{
+	if (!data || !name)
+		return nullptr;
+
+	for (auto &item : data->items) {
+		if (item->name == name)
+			return item.get();
+	}
+
+	return nullptr;
+}
+
+static obs_data_item_t *get_item(obs_data_t *data, const char *name,
+				 enum obs_data_type type)
+{
+	obs_data_item_t *item = find_item(data, name);
+
+	if (!item) {
+		data->items.push_back(std::make_unique<obs_data_item>());
+
+		item = data->items.back().get();
+		item->parent = data;
+		item->index = data->items.size() - 1;
+		item->name = name;
+	} else if (item->type != type) {
+		clear_value(item);
+		item->has_default_value = false;
+	}
+
+	item->type = type;
+	return item;
+}
+
+static obs_data_item_t *set_item(obs_data_t *data, const char *name,
+				 enum obs_data_type type)
+{
+	obs_data_item_t *item = get_item(data, name, type);
+
+	clear_value(item);
+	item->has_user_value = true;
+
+	return item;
+}
+
+extern "C" obs_data_t *obs_data_create(void)
+{
+	return new obs_data_t();
+}
+
+extern "C" void obs_data_addref(obs_data_t *data)
+{
+	if (data)
+		++data->refs;
+}
+
+extern "C" void obs_data_release(obs_data_t *data)
+{
+	if (!data || --data->refs != 0)
+		return;
+
+	for (auto &item : data->items)
+		clear_value(item.get());
+
+	delete data;
+}
+
+extern "C" void obs_data_set_string(obs_data_t *data, const char *name,
+				    const char *val)
+{
+	if (!data || !name)
+		return;
+
+	set_item(data, name, OBS_DATA_STRING)->string_value = val ? val : "";
+}
+
+extern "C" void obs_data_set_default_string(obs_data_t *data,
+					    const char *name, const char *val)
+{
+	if (!data || !name)
+		return;
+
+	obs_data_item_t *item = get_item(data, name, OBS_DATA_STRING);
+
+	item->has_default_value = true;
+	item->default_string_value = val ? val : "";
+}
+
+extern "C" void obs_data_set_int(obs_data_t *data, const char *name,
+				 long long val)
+{
+	if (!data || !name)
+		return;
+
+	obs_data_item_t *item = set_item(data, name, OBS_DATA_NUMBER);
+	item->num_type = OBS_DATA_NUM_INT;
+	item->int_value = val;
+}
+
+extern "C" void obs_data_set_double(obs_data_t *data, const char *name,
+				    double val)
+{
+	if (!data || !name)
+		return;
+
+	obs_data_item_t *item = set_item(data, name, OBS_DATA_NUMBER);
+	item->num_type = OBS_DATA_NUM_DOUBLE;
+	item->double_value = val;
+}
+
+extern "C" void obs_data_set_bool(obs_data_t *data, const char *name,
+				  bool val)
+{
+	if (!data || !name)
+		return;
+
+	set_item(data, name, OBS_DATA_BOOLEAN)->bool_value = val;
+}
+
+extern "C" void obs_data_set_obj(obs_data_t *data, const char *name,
+				 obs_data_t *obj)
+{
+	if (!data || !name)
+		return;
+
+	obs_data_addref(obj);
+	set_item(data, name, OBS_DATA_OBJECT)->obj = obj;
+}
+
+extern "C" void obs_data_set_array(obs_data_t *data, const char *name,
+				   obs_data_array_t *array)
+{
+	if (!data || !name)
+		return;
+
+	obs_data_array_addref(array);
+	set_item(data, name, OBS_DATA_ARRAY)->array = array;
+}
+
+extern "C" bool obs_data_has_user_value(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = find_item(data, name);
+	return item && item->has_user_value;
+}
+
+extern "C" const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = find_item(data, name);
+	return item ? obs_data_item_get_string(item) : "";
+}
+
+extern "C" long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = find_item(data, name);
+	return item ? obs_data_item_get_int(item) : 0;
+}
+
+extern "C" double obs_data_get_double(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = find_item(data, name);
+	return item ? obs_data_item_get_double(item) : 0;
+}
+
+extern "C" bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = find_item(data, name);
+	return item && obs_data_item_get_bool(item);
+}
+
+extern "C" obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name)
+{
+	obs_data_item_t *item = find_item(data, name);
+	return item ? obs_data_item_get_obj(item) : nullptr;
+}
+
+extern "C" obs_data_array_t *obs_data_get_array(obs_data_t *data,
+						const char *name)
+{
+	obs_data_item_t *item = find_item(data, name);
+	return item ? obs_data_item_get_array(item) : nullptr;
+}
+
+/* ========================================================================= */
+
+extern "C" obs_data_array_t *obs_data_array_create(void)
+{
+	return new obs_data_array_t();
+}
+
+extern "C" void obs_data_array_addref(obs_data_array_t *array)
+{
+	if (array)
+		++array->refs;
+}
+
+extern "C" void obs_data_array_release(obs_data_array_t *array)
+{
+	if (!array || --array->refs != 0)
+		return;
+
+	for (obs_data_t *obj : array->objects)
+		obs_data_release(obj);
+
+	delete array;
+}
+
+extern "C" size_t obs_data_array_count(obs_data_array_t *array)
+{
+	return array ? array->objects.size() : 0;
+}
+
+extern "C" obs_data_t *obs_data_array_item(obs_data_array_t *array,
+					   size_t idx)
+{
+	if (!array || idx >= array->objects.size())
+		return nullptr;
+
+	obs_data_addref(array->objects[idx]);
+	return array->objects[idx];
+}
+
+extern "C" size_t obs_data_array_push_back(obs_data_array_t *array,
+					   obs_data_t *obj)
+{
+	if (!array || !obj)
+		return 0;
+
+	obs_data_addref(obj);
+	array->objects.push_back(obj);
+	return array->objects.size() - 1;
+}
+
+/* ========================================================================= */
+
+/* Items hold a reference on their parent while iterated */
+extern "C" obs_data_item_t *obs_data_first(obs_data_t *data)
+{
+	if (!data || data->items.empty())
+		return nullptr;
+
+	obs_data_addref(data);
+	return data->items.front().get();
+}
+
+extern "C" bool obs_data_item_next(obs_data_item_t **item)
+{
+	if (!item || !*item)
+		return false;
+
+	obs_data_t *parent = (*item)->parent;
+	size_t next = (*item)->index + 1;
+
+	if (next < parent->items.size()) {
+		*item = parent->items[next].get();
+		return true;
+	}
+
+	*item = nullptr;
+	obs_data_release(parent);
+	return false;
+}
+
+extern "C" void obs_data_item_release(obs_data_item_t **item)
+{
+	if (!item || !*item)
+		return;
+
+	obs_data_release((*item)->parent);
+	*item = nullptr;
+}
+
+extern "C" enum obs_data_type obs_data_item_gettype(obs_data_item_t *item)
+{
+	return item ? item->type : OBS_DATA_NULL;
+}
+
+extern "C" enum obs_data_number_type
+obs_data_item_numtype(obs_data_item_t *item)
+{
+	return item && item->type == OBS_DATA_NUMBER ? item->num_type
+						     : OBS_DATA_NUM_INVALID;
+}
+
+extern "C" const char *obs_data_item_get_name(obs_data_item_t *item)
+{
+	return item ? item->name.c_str() : nullptr;
+}
+
+extern "C" bool obs_data_item_has_user_value(obs_data_item_t *item)
+{
+	return item && item->has_user_value;
+}
+
+extern "C" bool obs_data_item_has_default_value(obs_data_item_t *item)
+{
+	return item && item->has_default_value;
+}
+
+extern "C" const char *obs_data_item_get_string(obs_data_item_t *item)
+{
+	if (!item || item->type != OBS_DATA_STRING)
+		return "";
+
+	return item->has_user_value ? item->string_value.c_str()
+				    : item->default_string_value.c_str();
+}
+
+extern "C" long long obs_data_item_get_int(obs_data_item_t *item)
+{
+	if (!item || item->type != OBS_DATA_NUMBER)
+		return 0;
+
+	return item->num_type == OBS_DATA_NUM_INT ? item->int_value
+						  : (long long)item->double_value;
+}
+
+extern "C" double obs_data_item_get_double(obs_data_item_t *item)
+{
+	if (!item || item->type != OBS_DATA_NUMBER)
+		return 0;
+
+	return item->num_type == OBS_DATA_NUM_DOUBLE ? item->double_value
+						     : (double)item->int_value;
+}
+
+extern "C" bool obs_data_item_get_bool(obs_data_item_t *item)
+{
+	return item && item->type == OBS_DATA_BOOLEAN && item->bool_value;
+}
+
+extern "C" obs_data_t *obs_data_item_get_obj(obs_data_item_t *item)
+{
+	if (!item || item->type != OBS_DATA_OBJECT)
+		return nullptr;
+
+	obs_data_addref(item->obj);
+	return item->obj;
+}
+
+extern "C" obs_data_array_t *obs_data_item_get_array(obs_data_item_t *item)
+{
+	if (!item || item->type != OBS_DATA_ARRAY)
+		return nullptr;
+
+	obs_data_array_addref(item->array);
+	return item->array;
+}
+
+/* ========================================================================= */
+
+/* JSON goes through json11 where libobs uses jansson. Integral numbers
+ * read back as ints, as jansson does for numbers without a fraction. */
+
+static json11::Json to_json(obs_data_t *data);
+
+static json11::Json item_to_json(obs_data_item_t *item)
+{
+	switch (item->type) {
+	case OBS_DATA_STRING:
+		return item->string_value;
+	case OBS_DATA_NUMBER:
+		return item->num_type == OBS_DATA_NUM_INT
+			       ? json11::Json((double)item->int_value)
+			       : json11::Json(item->double_value);
+	case OBS_DATA_BOOLEAN:
+		return item->bool_value;
+	case OBS_DATA_OBJECT:
+		return to_json(item->obj);
+	case OBS_DATA_ARRAY: {
+		json11::Json::array array;
+
+		for (obs_data_t *obj : item->array->objects)
+			array.push_back(to_json(obj));
+
+		return array;
+	}
+	default:
+		return nullptr;
+	}
+}
+
+static json11::Json to_json(obs_data_t *data)
+{
+	json11::Json::object object;
+
+	for (auto &item : data->items) {
+		if (item->has_user_value)
+			object[item->name] = item_to_json(item.get());
+	}
+
+	return object;
+}
+
+static void from_json(obs_data_t *data, const json11::Json &json);
+
+static void set_json_value(obs_data_t *data, const char *name,
+			   const json11::Json &value)
+{
+	switch (value.type()) {
+	case json11::Json::STRING:
+		obs_data_set_string(data, name, value.string_value().c_str());
+		break;
+	case json11::Json::NUMBER: {
+		double number = value.number_value();
+
+		if (std::floor(number) == number &&
+		    std::fabs(number) <
+			    (double)std::numeric_limits<long long>::max())
+			obs_data_set_int(data, name, (long long)number);
+		else
+			obs_data_set_double(data, name, number);
+	} break;
+	case json11::Json::BOOL:
+		obs_data_set_bool(data, name, value.bool_value());
+		break;
+	case json11::Json::OBJECT: {
+		obs_data_t *obj = obs_data_create();
+		from_json(obj, value);
+		obs_data_set_obj(data, name, obj);
+		obs_data_release(obj);
+	} break;
+	case json11::Json::ARRAY: {
+		obs_data_array_t *array = obs_data_array_create();
+
+		for (auto &element : value.array_items()) {
+			if (!element.is_object())
+				continue;
+
+			obs_data_t *obj = obs_data_create();
+			from_json(obj, element);
+			obs_data_array_push_back(array, obj);
+			obs_data_release(obj);
+		}
+
+		obs_data_set_array(data, name, array);
+		obs_data_array_release(array);
+	} break;
+	default:
+		break;
+	}
+}
+
+static void from_json(obs_data_t *data, const json11::Json &json)
+{
+	for (auto &field : json.object_items())
+		set_json_value(data, field.first.c_str(), field.second);
+}
+
+extern "C" obs_data_t *obs_data_create_from_json(const char *json_string)
+{
+	std::string err;
+	json11::Json json =
+		json11::Json::parse(json_string ? json_string : "", err);
+
+	if (!err.empty() || !json.is_object())
+		return nullptr;
+
+	obs_data_t *data = obs_data_create();
+	from_json(data, json);
+	return data;
+}
+
+extern "C" const char *obs_data_get_json(obs_data_t *data)
+{
+	if (!data)
+		return nullptr;
+
+	data->json = to_json(data).dump();
+	return data->json.c_str();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+/* Test stub for obs-frontend-api.h backed by the fake outputs. */
+
+#include "obs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+obs_output_t *obs_frontend_get_streaming_output(void);
+obs_output_t *obs_frontend_get_recording_output(void);
+obs_output_t *obs_frontend_get_replay_buffer_output(void);
+
+bool obs_frontend_streaming_active(void);
+bool obs_frontend_recording_active(void);
+bool obs_frontend_replay_buffer_active(void);
+
+void obs_frontend_streaming_stop(void);
+void obs_frontend_recording_stop(void);
+void obs_frontend_replay_buffer_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
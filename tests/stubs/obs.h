@@ -0,0 +1,195 @@
+#pragma once
+
+/*
+ * Test stub for the slice of libobs the tested code touches. Sources count
+ * references and active children and carry settings, a size and scripted
+ * audio; scenes hold items with a transform; outputs are fakes driven
+ * through stub-control.hpp. obs_data is a full in-memory implementation.
+ */
+
+#include "util/base.h"
+#include "util/bmem.h"
+#include "callback/signal.h"
+#include "graphics/vec2.h"
+#include "media-io/audio-io.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct obs_data;
+struct obs_data_item;
+struct obs_data_array;
+struct obs_source;
+struct obs_scene;
+struct obs_scene_item;
+struct obs_output;
+typedef struct obs_data obs_data_t;
+typedef struct obs_data_item obs_data_item_t;
+typedef struct obs_data_array obs_data_array_t;
+typedef struct obs_source obs_source_t;
+typedef struct obs_scene obs_scene_t;
+typedef struct obs_scene_item obs_sceneitem_t;
+typedef struct obs_output obs_output_t;
+
+/* ------------------------------------------------------------------------- */
+
+enum obs_data_type {
+	OBS_DATA_NULL,
+	OBS_DATA_STRING,
+	OBS_DATA_NUMBER,
+	OBS_DATA_BOOLEAN,
+	OBS_DATA_OBJECT,
+	OBS_DATA_ARRAY,
+};
+
+enum obs_data_number_type {
+	OBS_DATA_NUM_INVALID,
+	OBS_DATA_NUM_INT,
+	OBS_DATA_NUM_DOUBLE,
+};
+
+obs_data_t *obs_data_create(void);
+obs_data_t *obs_data_create_from_json(const char *json_string);
+void obs_data_addref(obs_data_t *data);
+void obs_data_release(obs_data_t *data);
+/* Valid until the next call on data or its release */
+const char *obs_data_get_json(obs_data_t *data);
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val);
+void obs_data_set_int(obs_data_t *data, const char *name, long long val);
+void obs_data_set_double(obs_data_t *data, const char *name, double val);
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val);
+void obs_data_set_obj(obs_data_t *data, const char *name, obs_data_t *obj);
+void obs_data_set_array(obs_data_t *data, const char *name,
+			obs_data_array_t *array);
+void obs_data_set_default_string(obs_data_t *data, const char *name,
+				 const char *val);
+
+bool obs_data_has_user_value(obs_data_t *data, const char *name);
+const char *obs_data_get_string(obs_data_t *data, const char *name);
+long long obs_data_get_int(obs_data_t *data, const char *name);
+double obs_data_get_double(obs_data_t *data, const char *name);
+bool obs_data_get_bool(obs_data_t *data, const char *name);
+obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name);
+obs_data_array_t *obs_data_get_array(obs_data_t *data, const char *name);
+
+obs_data_array_t *obs_data_array_create(void);
+void obs_data_array_addref(obs_data_array_t *array);
+void obs_data_array_release(obs_data_array_t *array);
+size_t obs_data_array_count(obs_data_array_t *array);
+obs_data_t *obs_data_array_item(obs_data_array_t *array, size_t idx);
+size_t obs_data_array_push_back(obs_data_array_t *array, obs_data_t *obj);
+
+obs_data_item_t *obs_data_first(obs_data_t *data);
+bool obs_data_item_next(obs_data_item_t **item);
+void obs_data_item_release(obs_data_item_t **item);
+enum obs_data_type obs_data_item_gettype(obs_data_item_t *item);
+enum obs_data_number_type obs_data_item_numtype(obs_data_item_t *item);
+const char *obs_data_item_get_name(obs_data_item_t *item);
+bool obs_data_item_has_user_value(obs_data_item_t *item);
+bool obs_data_item_has_default_value(obs_data_item_t *item);
+const char *obs_data_item_get_string(obs_data_item_t *item);
+long long obs_data_item_get_int(obs_data_item_t *item);
+double obs_data_item_get_double(obs_data_item_t *item);
+bool obs_data_item_get_bool(obs_data_item_t *item);
+obs_data_t *obs_data_item_get_obj(obs_data_item_t *item);
+obs_data_array_t *obs_data_item_get_array(obs_data_item_t *item);
+
+/* ------------------------------------------------------------------------- */
+
+obs_source_t *obs_source_create_private(const char *id, const char *name,
+					obs_data_t *settings);
+void obs_source_addref(obs_source_t *source);
+void obs_source_release(obs_source_t *source);
+bool obs_source_add_active_child(obs_source_t *parent, obs_source_t *child);
+void obs_source_remove_active_child(obs_source_t *parent,
+				    obs_source_t *child);
+
+const char *obs_source_get_name(const obs_source_t *source);
+const char *obs_source_get_id(const obs_source_t *source);
+uint32_t obs_source_get_width(obs_source_t *source);
+uint32_t obs_source_get_height(obs_source_t *source);
+obs_data_t *obs_source_get_settings(const obs_source_t *source);
+void obs_source_update(obs_source_t *source, obs_data_t *settings);
+
+struct obs_source_audio_mix {
+	struct audio_output_data output[MAX_AUDIO_MIXES];
+};
+
+bool obs_source_audio_pending(const obs_source_t *source);
+uint64_t obs_source_get_audio_timestamp(const obs_source_t *source);
+void obs_source_get_audio_mix(const obs_source_t *source,
+			      struct obs_source_audio_mix *audio);
+
+/* ------------------------------------------------------------------------- */
+
+#define OBS_ALIGN_CENTER (0)
+#define OBS_ALIGN_LEFT (1 << 0)
+#define OBS_ALIGN_RIGHT (1 << 1)
+#define OBS_ALIGN_TOP (1 << 2)
+#define OBS_ALIGN_BOTTOM (1 << 3)
+
+enum obs_bounds_type {
+	OBS_BOUNDS_NONE,
+	OBS_BOUNDS_STRETCH,
+	OBS_BOUNDS_SCALE_INNER,
+	OBS_BOUNDS_SCALE_OUTER,
+	OBS_BOUNDS_SCALE_TO_WIDTH,
+	OBS_BOUNDS_SCALE_TO_HEIGHT,
+	OBS_BOUNDS_MAX_ONLY,
+};
+
+struct obs_transform_info {
+	struct vec2 pos;
+	float rot;
+	struct vec2 scale;
+	uint32_t alignment;
+
+	enum obs_bounds_type bounds_type;
+	uint32_t bounds_alignment;
+	struct vec2 bounds;
+};
+
+struct obs_sceneitem_crop {
+	int left;
+	int top;
+	int right;
+	int bottom;
+};
+
+obs_scene_t *obs_scene_create(const char *name);
+void obs_scene_release(obs_scene_t *scene);
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene);
+obs_scene_t *obs_scene_from_source(const obs_source_t *source);
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source);
+void obs_scene_enum_items(obs_scene_t *scene,
+			  bool (*callback)(obs_scene_t *, obs_sceneitem_t *,
+					   void *),
+			  void *param);
+
+void obs_sceneitem_addref(obs_sceneitem_t *item);
+void obs_sceneitem_release(obs_sceneitem_t *item);
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item);
+void obs_sceneitem_set_info(obs_sceneitem_t *item,
+			    const struct obs_transform_info *info);
+void obs_sceneitem_get_info(const obs_sceneitem_t *item,
+			    struct obs_transform_info *info);
+void obs_sceneitem_set_crop(obs_sceneitem_t *item,
+			    const struct obs_sceneitem_crop *crop);
+void obs_sceneitem_get_crop(const obs_sceneitem_t *item,
+			    struct obs_sceneitem_crop *crop);
+
+/* ------------------------------------------------------------------------- */
+
+void obs_output_addref(obs_output_t *output);
+void obs_output_release(obs_output_t *output);
+bool obs_output_active(const obs_output_t *output);
+signal_handler_t *obs_output_get_signal_handler(const obs_output_t *output);
+
+#ifdef __cplusplus
+}
+#endif
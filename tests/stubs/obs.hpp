@@ -0,0 +1,58 @@
+#pragma once
+
+/* Test stub for libobs obs.hpp: the OBSRef holder with the same semantics. */
+
+#include "obs.h"
+
+template<typename T, void addref(T), void release(T)> class OBSRef {
+	T val = nullptr;
+
+	inline OBSRef &Replace(T valIn)
+	{
+		addref(valIn);
+		release(val);
+		val = valIn;
+		return *this;
+	}
+
+public:
+	inline OBSRef() {}
+	inline OBSRef(T val_) : val(val_) { addref(val); }
+	inline OBSRef(const OBSRef &ref) : val(ref.val) { addref(val); }
+	inline OBSRef(OBSRef &&ref) : val(ref.val) { ref.val = nullptr; }
+
+	inline ~OBSRef() { release(val); }
+
+	inline OBSRef &operator=(T valIn) { return Replace(valIn); }
+	inline OBSRef &operator=(const OBSRef &ref) { return Replace(ref.val); }
+
+	inline OBSRef &operator=(OBSRef &&ref)
+	{
+		if (this != &ref) {
+			release(val);
+			val = ref.val;
+			ref.val = nullptr;
+		}
+
+		return *this;
+	}
+
+	inline operator T() const { return val; }
+
+	inline bool operator==(T p) const { return val == p; }
+	inline bool operator!=(T p) const { return val != p; }
+};
+
+inline void OBSSourceAddRef(obs_source_t *source)
+{
+	if (source)
+		obs_source_addref(source);
+}
+
+inline void OBSSourceRelease(obs_source_t *source)
+{
+	if (source)
+		obs_source_release(source);
+}
+
+using OBSSource = OBSRef<obs_source_t *, OBSSourceAddRef, OBSSourceRelease>;
@@ -0,0 +1,133 @@
+#include <QCoreApplication>
+
+#include "stub-control.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/* ========================================================================= */
+
+static std::atomic<int> next_event_type(QEvent::User);
+
+int QEvent::registerEventType(int hint)
+{
+	(void)hint;
+	return next_event_type++;
+}
+
+/* ========================================================================= */
+
+static std::mutex main_thread_mutex;
+static QThread *main_thread = nullptr;
+
+QThread *QThread::currentThread()
+{
+	static thread_local QThread current;
+	return &current;
+}
+
+QThread *QObject::thread() const
+{
+	std::lock_guard<std::mutex> guard(main_thread_mutex);
+
+	if (!main_thread)
+		main_thread = QThread::currentThread();
+
+	return main_thread;
+}
+
+void stub::qt_set_main_thread()
+{
+	std::lock_guard<std::mutex> guard(main_thread_mutex);
+
+	main_thread = QThread::currentThread();
+}
+
+/* ========================================================================= */
+
+static std::mutex queue_mutex;
+static std::condition_variable queue_cv;
+static std::deque<std::pair<QObject *, QEvent *>> queue;
+static size_t posted_count = 0;
+
+QCoreApplication *QCoreApplication::instance()
+{
+	static QCoreApplication *app = new QCoreApplication();
+	return app;
+}
+
+void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int)
+{
+	{
+		std::lock_guard<std::mutex> guard(queue_mutex);
+
+		queue.emplace_back(receiver, event);
+		++posted_count;
+	}
+
+	queue_cv.notify_all();
+}
+
+void QCoreApplication::deliver(QObject *receiver, QEvent *event)
+{
+	receiver->event(event);
+	delete event;
+}
+
+void QCoreApplication::sendPostedEvents(QObject *, int)
+{
+	stub::qt_process_events();
+}
+
+void QCoreApplication::processEvents()
+{
+	stub::qt_process_events();
+}
+
+size_t stub::qt_process_events()
+{
+	size_t delivered = 0;
+
+	for (;;) {
+		std::pair<QObject *, QEvent *> item;
+
+		{
+			std::lock_guard<std::mutex> guard(queue_mutex);
+
+			if (queue.empty())
+				break;
+
+			item = queue.front();
+			queue.pop_front();
+		}
+
+		QCoreApplication::deliver(item.first, item.second);
+		++delivered;
+	}
+
+	return delivered;
+}
+
+bool stub::qt_wait_for_events(unsigned int timeout_ms)
+{
+	std::unique_lock<std::mutex> lock(queue_mutex);
+
+	return queue_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+				 []() { return !queue.empty(); });
+}
+
+size_t stub::qt_posted_events()
+{
+	std::lock_guard<std::mutex> guard(queue_mutex);
+	return posted_count;
+}
+
+void stub::qt_reset_posted_events()
+{
+	std::lock_guard<std::mutex> guard(queue_mutex);
+	posted_count = 0;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+/*
+ * Test-side controls for the libobs stubs: allocation counters, size and
+ * audio of sources, file system call counters and scriptable fake frontend
+ * outputs. Also drives the QtCore stubs' event queue.
+ */
+
+#include "obs.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace stub {
+
+struct source_counters {
+	long created = 0;
+	long destroyed = 0;
+	long active_children = 0;
+};
+
+source_counters get_source_counters();
+void reset_source_counters();
+
+/* Size reported by obs_source_get_width() and obs_source_get_height() */
+void set_source_size(obs_source_t *source, uint32_t width, uint32_t height);
+/* Audio returned by obs_source_get_audio_mix(), one buffer per channel,
+ * padded to AUDIO_OUTPUT_FRAMES. No channels marks the audio pending. */
+void set_source_audio(obs_source_t *source, uint64_t timestamp,
+		      const std::vector<std::vector<float>> &channels);
+
+/* Calls to os_file_exists() since the last reset */
+size_t os_file_exists_calls();
+void reset_os_file_exists_calls();
+
+enum class frontend_output { streaming, recording, replay_buffer };
+
+struct fake_output_config {
+	/* Output is running, as reported by obs_output_active() */
+	bool active = false;
+	/* Value reported by obs_frontend_*_active() */
+	bool frontend_active = false;
+	/* Delay between obs_frontend_*_stop() and the "stop" signal */
+	unsigned int stop_delay_ms = 0;
+	/* Delay between the "stop" signal and the frontend flag clearing */
+	unsigned int frontend_lag_ms = 0;
+	/* Output never stops */
+	bool hang = false;
+};
+
+/* Installs a fresh fake output behind obs_frontend_get_*_output(). */
+void set_frontend_output(frontend_output which,
+			 const fake_output_config &config);
+/* Joins pending stop workers and drops all fake outputs. */
+void clear_frontend_outputs();
+
+int frontend_stop_calls(frontend_output which);
+/* Fake outputs not yet freed, including ones still installed. */
+long live_outputs();
+
+/* Makes the calling thread the Qt main thread (qApp->thread()). */
+void qt_set_main_thread();
+/* Delivers posted events on the calling thread until the queue is empty,
+ * including events posted meanwhile. Returns the number delivered. */
+size_t qt_process_events();
+/* Waits up to timeout_ms for a posted event. Returns true if one is
+ * pending. */
+bool qt_wait_for_events(unsigned int timeout_ms);
+/* Events posted since the last reset. */
+size_t qt_posted_events();
+void qt_reset_posted_events();
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+/* Test stub for libobs util/base.h. */
+
+#include <stdarg.h>
+
+enum {
+	LOG_ERROR = 100,
+	LOG_WARNING = 200,
+	LOG_INFO = 300,
+	LOG_DEBUG = 400,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void blog(int log_level, const char *format, ...);
+
+#ifdef __cplusplus
+}
+#endif
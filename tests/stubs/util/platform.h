@@ -0,0 +1,50 @@
+#pragma once
+
+/* Test stub for libobs util/platform.h: POSIX-backed file and time helpers. */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include "base.h"
+#include "bmem.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+FILE *os_fopen(const char *path, const char *mode);
+int os_stat(const char *file, struct stat *st);
+int64_t os_get_file_size(const char *path);
+bool os_file_exists(const char *path);
+
+char *os_quick_read_utf8_file(const char *path);
+bool os_quick_write_utf8_file(const char *path, const char *str, size_t len,
+			      bool marker);
+
+#define MKDIR_EXISTS 1
+#define MKDIR_SUCCESS 0
+#define MKDIR_ERROR -1
+
+int os_mkdirs(const char *path);
+int os_rename(const char *old_path, const char *new_path);
+int os_unlink(const char *path);
+
+uint64_t os_gettime_ns(void);
+void os_sleep_ms(uint32_t duration);
+
+struct os_dirent {
+	char d_name[256];
+	bool directory;
+};
+
+typedef struct os_dir os_dir_t;
+
+os_dir_t *os_opendir(const char *path);
+struct os_dirent *os_readdir(os_dir_t *dir);
+void os_closedir(os_dir_t *dir);
+
+#ifdef __cplusplus
+}
+#endif
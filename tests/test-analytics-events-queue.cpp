@@ -0,0 +1,262 @@
+#include "test-common.hpp"
+
+#include "StreamElementsAnalyticsEventsQueue.hpp"
+
+#define MINIZ_HEADER_FILE_ONLY
+#include "deps/zip/miniz.h"
+
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Stands in for the track endpoint: decodes each request and counts it */
+class Endpoint {
+public:
+	explicit Endpoint(int status = 200) : m_status(status) {}
+
+	StreamElementsAnalyticsEventsQueue::post_func_t Post()
+	{
+		return [this](const std::multimap<std::string, std::string>
+				      &headers,
+			      const void *body, size_t body_len, int &status) {
+			std::lock_guard<std::mutex> guard(m_mutex);
+
+			bool deflate = headers.count("Content-Encoding") > 0;
+			std::string json = deflate ? Inflate(body, body_len)
+						   : std::string((const char *)
+									 body,
+								 body_len);
+
+			++m_requests;
+			if (deflate)
+				++m_compressed;
+
+			status = m_status;
+			if (m_status != 200)
+				return false;
+
+			std::string err;
+			json11::Json batch = json11::Json::parse(json, err);
+			CHECK(err.empty());
+			CHECK_EQ(batch["app_id"].string_value(), "app");
+
+			m_events += batch["events"].array_items().size();
+			return true;
+		};
+	}
+
+	size_t requests()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		return m_requests;
+	}
+
+	size_t compressed()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		return m_compressed;
+	}
+
+	size_t events()
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		return m_events;
+	}
+
+private:
+	static std::string Inflate(const void *body, size_t body_len)
+	{
+		std::vector<unsigned char> out(body_len * 8);
+
+		for (;;) {
+			mz_ulong len = (mz_ulong)out.size();
+			int result = mz_uncompress(out.data(), &len,
+						   (const unsigned char *)body,
+						   (mz_ulong)body_len);
+
+			if (result == MZ_BUF_ERROR) {
+				out.resize(out.size() * 2);
+				continue;
+			}
+
+			CHECK_EQ(result, MZ_OK);
+			return std::string((const char *)out.data(), len);
+		}
+	}
+
+	std::mutex m_mutex;
+	int m_status;
+	size_t m_requests = 0;
+	size_t m_compressed = 0;
+	size_t m_events = 0;
+};
+
+static json11::Json make_event(size_t i, size_t padding = 0)
+{
+	return json11::Json::object{
+		{"event", "widget_loaded"},
+		{"timestamp", (double)i},
+		{"properties",
+		 json11::Json::object{{"index", (int)i},
+				      {"padding", std::string(padding, 'x')}}}};
+}
+
+static double cpu_ms(std::clock_t start)
+{
+	return 1000.0 * (std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+static bool wait_for(const std::function<bool()> &done)
+{
+	for (int i = 0; i < 500 && !done(); ++i)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	return done();
+}
+
+static std::vector<std::string> spool_files(const TempDir &dir,
+					    size_t *total_bytes = nullptr)
+{
+	std::vector<std::string> files;
+	if (total_bytes)
+		*total_bytes = 0;
+
+	for (auto &entry : std::filesystem::directory_iterator(dir.path())) {
+		files.push_back(entry.path().string());
+		if (total_bytes)
+			*total_bytes += (size_t)entry.file_size();
+	}
+
+	return files;
+}
+
+/* 10k events go out as full, compressed batches of 500 */
+static void test_batching()
+{
+	Endpoint endpoint;
+	const size_t count = 10000;
+
+	std::clock_t start = std::clock();
+	{
+		StreamElementsAnalyticsEventsQueue queue("app", "",
+							 endpoint.Post());
+
+		for (size_t i = 0; i < count; ++i)
+			queue.Enqueue(make_event(i));
+	}
+	double enqueue_ms = cpu_ms(start);
+
+	CHECK_EQ(endpoint.events(), count);
+	CHECK_EQ(endpoint.requests(), count / 500);
+	CHECK_EQ(endpoint.compressed(), endpoint.requests());
+
+	/* Including the endpoint decoding and parsing every batch */
+	CHECK(enqueue_ms < 2000.0);
+
+	/* An idle queue blocks instead of polling */
+	StreamElementsAnalyticsEventsQueue queue("app", "", endpoint.Post());
+
+	start = std::clock();
+	std::this_thread::sleep_for(std::chrono::milliseconds(500));
+	double idle_ms = cpu_ms(start);
+
+	CHECK(idle_ms < 50.0);
+
+	printf("analytics queue: %zu events in %zu requests, %.1f ms CPU; "
+	       "%.1f ms CPU idle for 500 ms\n",
+	       count, endpoint.requests(), enqueue_ms, idle_ms);
+}
+
+static void test_send_now()
+{
+	Endpoint endpoint;
+	StreamElementsAnalyticsEventsQueue queue("app", "", endpoint.Post());
+
+	queue.SendNow(make_event(0));
+
+	CHECK_EQ(endpoint.requests(), 1u);
+	CHECK_EQ(endpoint.events(), 1u);
+}
+
+/* Undelivered batches are spooled, and sent by the next queue */
+static void test_spool_and_retry()
+{
+	TempDir dir;
+
+	Endpoint down(503);
+	{
+		StreamElementsAnalyticsEventsQueue queue(
+			"app", dir.path().string(), down.Post());
+
+		for (size_t i = 0; i < 1000; ++i)
+			queue.Enqueue(make_event(i));
+	}
+
+	/* Retries back off: one attempt per batch */
+	CHECK_EQ(down.requests(), 2u);
+	CHECK_EQ(spool_files(dir).size(), 2u);
+
+	Endpoint up;
+	StreamElementsAnalyticsEventsQueue queue("app", dir.path().string(),
+						 up.Post());
+
+	CHECK(wait_for([&]() { return up.events() == 1000; }));
+	CHECK(wait_for([&]() { return spool_files(dir).empty(); }));
+	CHECK_EQ(up.requests(), 2u);
+}
+
+/* The spool is capped, dropping the oldest batches */
+static void test_spool_limit()
+{
+	TempDir dir;
+	Endpoint down(503);
+
+	{
+		StreamElementsAnalyticsEventsQueue queue(
+			"app", dir.path().string(), down.Post());
+
+		/* About 5 MB, in batches of 256 KB */
+		for (size_t i = 0; i < 500; ++i)
+			queue.Enqueue(make_event(i, 10000));
+	}
+
+	size_t total_bytes = 0;
+	size_t files = spool_files(dir, &total_bytes).size();
+
+	CHECK(down.requests() > 16);
+	CHECK(files < down.requests());
+	CHECK(total_bytes <= 4 * 1024 * 1024);
+	CHECK(total_bytes > 3 * 1024 * 1024);
+}
+
+/* Rejected batches are dropped; a rejected compressed request falls back
+ * to uncompressed ones first */
+static void test_rejected()
+{
+	TempDir dir;
+	Endpoint endpoint(400);
+
+	{
+		StreamElementsAnalyticsEventsQueue queue(
+			"app", dir.path().string(), endpoint.Post());
+
+		for (size_t i = 0; i < 1000; ++i)
+			queue.Enqueue(make_event(i));
+	}
+
+	CHECK_EQ(endpoint.requests(), 3u);
+	CHECK_EQ(endpoint.compressed(), 1u);
+	CHECK(spool_files(dir).empty());
+}
+
+int main()
+{
+	test_batching();
+	test_send_now();
+	test_spool_and_retry();
+	test_spool_limit();
+	test_rejected();
+
+	return test_result();
+}
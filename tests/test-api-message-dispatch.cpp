@@ -0,0 +1,205 @@
+#include "test-common.hpp"
+#include "stub-control.hpp"
+#include "cef-stub-control.hpp"
+
+#include "StreamElementsApiMessageHandler.hpp"
+
+#include <vector>
+
+/* The API handler registry in StreamElementsApiMessageHandler.cpp depends on
+ * the whole plugin: the dispatch is driven with handlers of its own. */
+
+static std::vector<std::function<void()>> deferred_completions;
+
+void StreamElementsApiMessageHandler::RegisterIncomingApiCallHandlers()
+{
+	RegisterIncomingApiCallHandler(
+		"echo",
+		[](StreamElementsApiMessageHandler *,
+		   CefRefPtr<CefProcessMessage>, CefRefPtr<CefListValue> args,
+		   CefRefPtr<CefValue> &result, CefRefPtr<CefBrowser>,
+		   const long, std::function<void()> complete_callback) {
+			result->SetList(args);
+
+			complete_callback();
+		});
+
+	RegisterIncomingApiCallHandler(
+		"deferred",
+		[](StreamElementsApiMessageHandler *,
+		   CefRefPtr<CefProcessMessage>, CefRefPtr<CefListValue>,
+		   CefRefPtr<CefValue> &result, CefRefPtr<CefBrowser>,
+		   const long, std::function<void()> complete_callback) {
+			CefRefPtr<CefValue> deferred_result = result;
+
+			deferred_completions.push_back(
+				[deferred_result, complete_callback]() {
+					deferred_result->SetString("done");
+
+					complete_callback();
+				});
+		});
+}
+
+static const char MSG_ON_CONTEXT_CREATED[] =
+	"CefRenderProcessHandler::OnContextCreated";
+static const char MSG_INCOMING_API_CALL[] =
+	"StreamElementsApiMessageHandler::OnIncomingApiCall";
+
+static bool receive(CefRefPtr<StreamElementsApiMessageHandler> handler,
+		    CefRefPtr<CefBrowser> browser,
+		    CefRefPtr<CefProcessMessage> message)
+{
+	return handler->OnProcessMessageReceived(browser,
+						 browser->GetMainFrame(),
+						 PID_RENDERER, message, 1);
+}
+
+/* Renderer side layout: header size, frame, function path, JSON arguments
+ * and the callback id last */
+static CefRefPtr<CefProcessMessage>
+make_api_call(const char *path, const std::vector<std::string> &json_args,
+	      int callback_id)
+{
+	CefRefPtr<CefProcessMessage> message =
+		CefProcessMessage::Create(MSG_INCOMING_API_CALL);
+	CefRefPtr<CefListValue> args = message->GetArgumentList();
+
+	args->SetInt(0, 3);
+	args->SetString(1, "main");
+	args->SetString(2, path);
+	for (auto &json : json_args)
+		args->SetString(args->GetSize(), json);
+	args->SetInt(args->GetSize(), callback_id);
+
+	return message;
+}
+
+static void test_context_created(CefRefPtr<StreamElementsApiMessageHandler> handler,
+				 CefRefPtr<CefBrowser> browser)
+{
+	CHECK(receive(handler, browser,
+		      CefProcessMessage::Create(MSG_ON_CONTEXT_CREATED)));
+
+	auto sent = stub::cef_take_sent_messages(browser);
+	CHECK_EQ(sent.size(), 3u);
+	if (sent.size() != 3)
+		return;
+
+	CHECK_EQ(sent[0]->GetName().ToString(),
+		 "CefRenderProcessHandler::BindJavaScriptFunctions");
+	CHECK_EQ(sent[0]->GetArgumentList()->GetString(0).ToString(), "host");
+
+	CefRefPtr<CefValue> functions = CefParseJSON(
+		sent[0]->GetArgumentList()->GetString(1), JSON_PARSER_RFC);
+	CHECK(functions.get() != nullptr);
+	if (functions) {
+		CefRefPtr<CefDictionaryValue> d = functions->GetDictionary();
+
+		CHECK_EQ(d->GetSize(), 2u);
+		CHECK_EQ(d->GetDictionary("echo")
+				 ->GetString("message")
+				 .ToString(),
+			 MSG_INCOMING_API_CALL);
+		CHECK(d->HasKey("deferred"));
+	}
+
+	CHECK_EQ(sent[1]->GetName().ToString(),
+		 "CefRenderProcessHandler::BindJavaScriptProperties");
+	CefRefPtr<CefValue> props = CefParseJSON(
+		sent[1]->GetArgumentList()->GetString(1), JSON_PARSER_RFC);
+	CHECK(props.get() != nullptr);
+	if (props) {
+		CHECK(props->GetDictionary()->GetBool("hostReady"));
+		CHECK(!props->GetDictionary()->GetBool("hostContainerHidden"));
+	}
+
+	CHECK_EQ(sent[2]->GetName().ToString(), "DispatchJSEvent");
+	CHECK_EQ(sent[2]->GetArgumentList()->GetString(0).ToString(),
+		 "hostReady");
+}
+
+static void test_api_call(CefRefPtr<StreamElementsApiMessageHandler> handler,
+			  CefRefPtr<CefBrowser> browser)
+{
+	CHECK(receive(handler, browser,
+		      make_api_call("window.host.echo",
+				    {"\"hello\"", "42", "{\"a\":[1,2,],}"},
+				    7)));
+
+	/* Handlers run on the main thread, never in the CEF callback */
+	CHECK(stub::cef_take_sent_messages(browser).empty());
+	CHECK_EQ(stub::qt_process_events(), 1u);
+
+	auto sent = stub::cef_take_sent_messages(browser);
+	CHECK_EQ(sent.size(), 1u);
+	if (sent.size() != 1)
+		return;
+
+	CHECK_EQ(sent[0]->GetName().ToString(), "executeCallback");
+	CHECK_EQ(sent[0]->GetArgumentList()->GetInt(0), 7);
+	CHECK_EQ(sent[0]->GetArgumentList()->GetString(1).ToString(),
+		 "[\"hello\",42,{\"a\":[1,2]}]");
+}
+
+static void
+test_deferred_call(CefRefPtr<StreamElementsApiMessageHandler> handler,
+		   CefRefPtr<CefBrowser> browser)
+{
+	CHECK(receive(handler, browser,
+		      make_api_call("window.host.deferred", {}, 8)));
+	CHECK_EQ(stub::qt_process_events(), 1u);
+
+	/* The call context is gone by now: completion must not need it */
+	CHECK(stub::cef_take_sent_messages(browser).empty());
+	CHECK_EQ(deferred_completions.size(), 1u);
+
+	for (auto &complete : deferred_completions)
+		complete();
+	deferred_completions.clear();
+
+	auto sent = stub::cef_take_sent_messages(browser);
+	CHECK_EQ(sent.size(), 1u);
+	if (sent.size() == 1) {
+		CHECK_EQ(sent[0]->GetArgumentList()->GetInt(0), 8);
+		CHECK_EQ(sent[0]->GetArgumentList()->GetString(1).ToString(),
+			 "\"done\"");
+	}
+}
+
+static void
+test_unanswered_calls(CefRefPtr<StreamElementsApiMessageHandler> handler,
+		      CefRefPtr<CefBrowser> browser)
+{
+	/* No callback */
+	CHECK(receive(handler, browser,
+		      make_api_call("window.host.echo", {"1"}, -1)));
+	CHECK_EQ(stub::qt_process_events(), 1u);
+
+	/* Unknown API */
+	CHECK(receive(handler, browser,
+		      make_api_call("window.host.missing", {"1"}, 9)));
+	CHECK_EQ(stub::qt_process_events(), 0u);
+
+	/* Not an API message */
+	CHECK(!receive(handler, browser,
+		       CefProcessMessage::Create("SomethingElse")));
+
+	CHECK(stub::cef_take_sent_messages(browser).empty());
+}
+
+int main()
+{
+	stub::qt_set_main_thread();
+
+	CefRefPtr<StreamElementsApiMessageHandler> handler =
+		new StreamElementsApiMessageHandler();
+	CefRefPtr<CefBrowser> browser = stub::cef_create_browser();
+
+	test_context_created(handler, browser);
+	test_api_call(handler, browser);
+	test_deferred_call(handler, browser);
+	test_unanswered_calls(handler, browser);
+
+	return test_result();
+}
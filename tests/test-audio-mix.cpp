@@ -0,0 +1,102 @@
+#include "test-common.hpp"
+#include "stub-control.hpp"
+
+#include "obs-browser-source-audio-mix.hpp"
+
+#include <vector>
+
+static const size_t SAMPLE_RATE = 48000;
+static const uint64_t START_TS = 1000000000ULL;
+/* 480 frames at 48 kHz */
+static const uint64_t OFFSET_NS = 10000000ULL;
+
+struct mix_output {
+	std::vector<float> channels[MAX_AUDIO_CHANNELS];
+	audio_output_data data = {};
+
+	mix_output()
+	{
+		for (size_t ch = 0; ch < MAX_AUDIO_CHANNELS; ++ch) {
+			channels[ch].assign(AUDIO_OUTPUT_FRAMES, 0.0f);
+			data.data[ch] = channels[ch].data();
+		}
+	}
+};
+
+static std::vector<std::vector<float>> constant_audio(size_t channels,
+							float value)
+{
+	return std::vector<std::vector<float>>(
+		channels, std::vector<float>(AUDIO_OUTPUT_FRAMES, value));
+}
+
+static void test_mix()
+{
+	obs_source_t *a = obs_source_create_private("audio_line", "a", nullptr);
+	obs_source_t *b = obs_source_create_private("audio_line", "b", nullptr);
+	obs_source_t *pending =
+		obs_source_create_private("audio_line", "pending", nullptr);
+
+	std::vector<float> ramp(AUDIO_OUTPUT_FRAMES);
+	for (size_t i = 0; i < ramp.size(); ++i)
+		ramp[i] = (float)i;
+
+	/* b starts 480 frames after a; pending has no audio yet */
+	stub::set_source_audio(b, START_TS + OFFSET_NS, {ramp, ramp});
+	stub::set_source_audio(a, START_TS, constant_audio(2, 0.25f));
+	stub::set_source_audio(pending, START_TS - OFFSET_NS, {});
+
+	mix_output out;
+	uint64_t ts = 0;
+
+	CHECK(MixAudioStreams({pending, b, a}, &ts, &out.data, 2,
+			      SAMPLE_RATE));
+	CHECK_EQ(ts, START_TS);
+
+	/* Streams are aligned to the earliest one: b is read from its
+	 * offset on, into the start of the output */
+	for (size_t ch = 0; ch < 2; ++ch) {
+		CHECK_EQ(out.channels[ch][0], 480.25f);
+		CHECK_EQ(out.channels[ch][543], 1023.25f);
+		CHECK_EQ(out.channels[ch][544], 0.25f);
+		CHECK_EQ(out.channels[ch][AUDIO_OUTPUT_FRAMES - 1], 0.25f);
+	}
+
+	/* Channels past the requested count are left alone */
+	CHECK_EQ(out.channels[2][0], 0.0f);
+
+	obs_source_release(a);
+	obs_source_release(b);
+	obs_source_release(pending);
+}
+
+static void test_no_audio()
+{
+	obs_source_t *pending =
+		obs_source_create_private("audio_line", "pending", nullptr);
+	obs_source_t *silent =
+		obs_source_create_private("audio_line", "silent", nullptr);
+
+	stub::set_source_audio(pending, START_TS, {});
+	stub::set_source_audio(silent, 0, constant_audio(2, 1.0f));
+
+	mix_output out;
+	uint64_t ts = 42;
+
+	CHECK(!MixAudioStreams({}, &ts, &out.data, 2, SAMPLE_RATE));
+	CHECK(!MixAudioStreams({pending, silent}, &ts, &out.data, 2,
+			       SAMPLE_RATE));
+	CHECK_EQ(ts, 42u);
+	CHECK_EQ(out.channels[0][0], 0.0f);
+
+	obs_source_release(pending);
+	obs_source_release(silent);
+}
+
+int main()
+{
+	test_mix();
+	test_no_audio();
+
+	return test_result();
+}
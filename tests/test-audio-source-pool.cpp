@@ -0,0 +1,108 @@
+#include "test-common.hpp"
+
+#include "obs-browser-source-audio-pool.hpp"
+#include "stub-control.hpp"
+
+#include <vector>
+
+/* A page that keeps starting and stopping two audio streams must settle on
+ * a constant number of audio_line sources. */
+static void test_stream_cycles()
+{
+	stub::reset_source_counters();
+
+	obs_source_t *parent =
+		obs_source_create_private("browser_source", "parent", nullptr);
+
+	{
+		AudioSourcePool pool(parent);
+
+		for (int cycle = 0; cycle < 1000; ++cycle) {
+			OBSSource a = pool.Acquire();
+			OBSSource b = pool.Acquire();
+
+			CHECK(a != nullptr);
+			CHECK(b != nullptr);
+			CHECK(a != b);
+
+			pool.Release(a);
+			pool.Release(b);
+
+			stub::source_counters counters =
+				stub::get_source_counters();
+
+			/* parent + two audio_line sources, nothing freed */
+			CHECK_EQ(counters.created, 3);
+			CHECK_EQ(counters.destroyed, 0);
+			CHECK_EQ(counters.active_children, 2);
+		}
+
+		CHECK_EQ(pool.Created(), (uint64_t)2);
+		CHECK_EQ(pool.Reused(), (uint64_t)1998);
+	}
+
+	/* Pooled sources are freed with the pool */
+	CHECK_EQ(stub::get_source_counters().destroyed, 2);
+
+	obs_source_release(parent);
+}
+
+static void test_pool_cap()
+{
+	stub::reset_source_counters();
+
+	obs_source_t *parent =
+		obs_source_create_private("browser_source", "parent", nullptr);
+
+	{
+		AudioSourcePool pool(parent);
+		const int streams = MAX_POOLED_AUDIO_SOURCES + 2;
+
+		std::vector<OBSSource> active;
+		for (int i = 0; i < streams; ++i)
+			active.push_back(pool.Acquire());
+
+		CHECK_EQ(stub::get_source_counters().active_children,
+			 streams);
+
+		for (auto &source : active)
+			pool.Release(source);
+		active.clear();
+
+		/* Sources beyond the cap are retired and freed once the
+		 * stream lets go of them */
+		stub::source_counters counters = stub::get_source_counters();
+		CHECK_EQ(counters.active_children, MAX_POOLED_AUDIO_SOURCES);
+		CHECK_EQ(counters.destroyed, 2);
+
+		for (int i = 0; i < MAX_POOLED_AUDIO_SOURCES; ++i)
+			active.push_back(pool.Acquire());
+
+		CHECK_EQ(pool.Created(), (uint64_t)streams);
+		CHECK_EQ(stub::get_source_counters().created, streams + 1);
+
+		for (auto &source : active)
+			pool.Release(source);
+	}
+
+	CHECK_EQ(stub::get_source_counters().destroyed,
+		 MAX_POOLED_AUDIO_SOURCES + 2);
+
+	obs_source_release(parent);
+}
+
+static void test_release_null()
+{
+	AudioSourcePool pool(nullptr);
+	pool.Release(nullptr);
+	CHECK_EQ(pool.Created(), (uint64_t)0);
+}
+
+int main()
+{
+	test_stream_cycles();
+	test_pool_cap();
+	test_release_null();
+
+	return test_result();
+}
@@ -0,0 +1,218 @@
+#include "test-common.hpp"
+
+#include "StreamElementsBackupPackage.hpp"
+
+#include "deps/zip/zip.h"
+
+#include <map>
+#include <vector>
+
+typedef std::map<std::string, std::string> entries_t;
+
+static void write_zip(const std::string &path, const entries_t &entries,
+		      const std::vector<std::string> &dirs = {})
+{
+	struct zip_t *zip = zip_open(path.c_str(), ZIP_DEFAULT_COMPRESSION_LEVEL,
+				     'w');
+	CHECK(zip != nullptr);
+	if (!zip)
+		return;
+
+	for (auto &dir : dirs) {
+		CHECK_EQ(zip_entry_open(zip, dir.c_str()), 0);
+		zip_entry_close(zip);
+	}
+
+	for (auto &entry : entries) {
+		CHECK_EQ(zip_entry_open(zip, entry.first.c_str()), 0);
+		CHECK_EQ(zip_entry_write(zip, entry.second.data(),
+					 entry.second.size()),
+			 0);
+		zip_entry_close(zip);
+	}
+
+	zip_close(zip);
+}
+
+static std::string read_file(const std::filesystem::path &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(in),
+			   std::istreambuf_iterator<char>());
+}
+
+static const entries_t package_entries = {
+	{"basic/profiles/Main/basic.ini", "[General]\nName=Main\n"},
+	{"basic/profiles/Main/streamEncoder.json", "{}"},
+	{"basic/profiles/Gaming Setup/basic.ini", "[General]\n"},
+	{"basic/profiles/Orphan/recordEncoder.json", "{}"},
+	{"basic/scenes/Default.json", "{\"name\":\"Default\"}"},
+	{"basic/scenes/Stream Scenes.json", "{\"name\":\"Stream\"}"},
+	{"basic/scenes/Default.json.bak", "{}"},
+	{"global.ini", "[General]\n"},
+	{"plugin_config/obs-browser/assets/logo.png", std::string(5000, 'x')},
+};
+
+static void test_index(const TempDir &dir)
+{
+	std::string path = (dir.path() / "package.zip").string();
+	write_zip(path, package_entries, {"plugin_config/"});
+
+	auto index = read_backup_package_index(path);
+	CHECK(index != nullptr);
+	if (!index)
+		return;
+
+	CHECK_EQ(index->entries.size(), package_entries.size() + 1);
+	CHECK((index->profiles ==
+	       std::vector<std::string>{"Gaming Setup", "Main"}));
+	CHECK((index->collections ==
+	       std::vector<std::string>{"Default", "Stream Scenes"}));
+
+	size_t dirs = 0;
+	for (auto &entry : index->entries) {
+		if (entry.is_dir) {
+			++dirs;
+			CHECK_EQ(entry.name, "plugin_config/");
+			continue;
+		}
+
+		auto it = package_entries.find(entry.name);
+		CHECK(it != package_entries.end());
+		if (it != package_entries.end())
+			CHECK_EQ(entry.size, it->second.size());
+	}
+	CHECK_EQ(dirs, 1u);
+
+	// Unchanged packages are served from the cache
+	CHECK(read_backup_package_index(path) == index);
+
+	// A rewritten package is read again
+	entries_t changed = package_entries;
+	changed["basic/scenes/Added.json"] = "{}";
+	write_zip(path, changed);
+	auto reread = read_backup_package_index(path);
+	CHECK(reread != nullptr);
+	if (reread) {
+		CHECK(reread != index);
+		CHECK_EQ(reread->collections.size(), 3u);
+	}
+
+	CHECK(read_backup_package_index(
+		      (dir.path() / "missing.zip").string()) == nullptr);
+
+	std::string garbage = dir.Write("garbage.zip", "not a zip file");
+	CHECK(read_backup_package_index(garbage) == nullptr);
+}
+
+static void test_qualification()
+{
+	const std::unordered_set<std::string> none;
+	const std::unordered_set<std::string> main = {"Main"};
+	const std::unordered_set<std::string> stream = {"Stream Scenes"};
+
+	CHECK(is_backup_entry_qualified_for_restore(
+		"basic/profiles/Main/basic.ini", none, none));
+	CHECK(is_backup_entry_qualified_for_restore(
+		"basic/profiles/Main/basic.ini", main, none));
+	CHECK(is_backup_entry_qualified_for_restore(
+		"basic/profiles/Main/nested/file.json", main, none));
+	CHECK(!is_backup_entry_qualified_for_restore(
+		"basic/profiles/Gaming Setup/basic.ini", main, none));
+
+	CHECK(is_backup_entry_qualified_for_restore(
+		"basic/scenes/Stream Scenes.json", none, stream));
+	CHECK(!is_backup_entry_qualified_for_restore(
+		"basic/scenes/Default.json", none, stream));
+	CHECK(is_backup_entry_qualified_for_restore(
+		"basic/scenes/Default.json", main, none));
+
+	// Neither a profile nor a scene collection
+	CHECK(is_backup_entry_qualified_for_restore(
+		"basic/scenes/Default.json.bak", main, stream));
+	CHECK(is_backup_entry_qualified_for_restore("global.ini", main,
+						    stream));
+}
+
+static void test_extract(const TempDir &dir)
+{
+	std::string path = (dir.path() / "extract.zip").string();
+	write_zip(path, package_entries, {"plugin_config/"});
+
+	auto index = read_backup_package_index(path);
+	CHECK(index != nullptr);
+	if (!index)
+		return;
+
+	std::filesystem::path out = dir.path() / "out";
+
+	size_t progress_calls = 0;
+	size_t last_completed = 0;
+	size_t last_total = 0;
+	uint64_t last_bytes = 0;
+
+	CHECK(extract_backup_package(*index, out.string(), {"Main"},
+				     {"Default"},
+				     [&](size_t completed, size_t total,
+					 uint64_t completed_bytes,
+					 uint64_t total_bytes) {
+					     ++progress_calls;
+					     CHECK(completed <= total);
+					     CHECK(completed_bytes <=
+						   total_bytes);
+					     last_completed = completed;
+					     last_total = total;
+					     last_bytes = completed_bytes;
+				     }));
+
+	CHECK(progress_calls > 0);
+	CHECK_EQ(last_total, 6u);
+	CHECK_EQ(last_completed, last_total);
+	CHECK(last_bytes > 5000);
+
+	for (auto &entry : package_entries) {
+		bool expected =
+			entry.first.find("Gaming Setup") == std::string::npos &&
+			entry.first.find("Orphan") == std::string::npos &&
+			entry.first != "basic/scenes/Stream Scenes.json";
+
+		std::filesystem::path file = out / entry.first;
+
+		CHECK_EQ(std::filesystem::exists(file), expected);
+		if (expected)
+			CHECK_EQ(read_file(file), entry.second);
+	}
+
+	// No temporary files are left behind
+	for (auto &item : std::filesystem::recursive_directory_iterator(out))
+		CHECK(item.path().string().find(".restore-tmp") ==
+		      std::string::npos);
+}
+
+static void test_extract_failure(const TempDir &dir)
+{
+	std::string path = (dir.path() / "gone.zip").string();
+	write_zip(path, package_entries);
+
+	auto index = read_backup_package_index(path);
+	CHECK(index != nullptr);
+	if (!index)
+		return;
+
+	std::filesystem::remove(path);
+
+	std::filesystem::path out = dir.path() / "gone";
+	CHECK(!extract_backup_package(*index, out.string(), {}, {}, nullptr));
+}
+
+int main()
+{
+	TempDir dir;
+
+	test_index(dir);
+	test_qualification();
+	test_extract(dir);
+	test_extract_failure(dir);
+
+	return test_result();
+}
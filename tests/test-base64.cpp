@@ -0,0 +1,111 @@
+#include "test-common.hpp"
+
+#include "base64/base64.hpp"
+
+#include <vector>
+
+/* Byte-at-a-time reference encoder */
+static std::string reference_encode(const std::string &in)
+{
+	static const char chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+				    "abcdefghijklmnopqrstuvwxyz"
+				    "0123456789+/";
+	std::string out;
+
+	for (size_t i = 0; i < in.size(); i += 3) {
+		uint32_t triple = (uint8_t)in[i] << 16;
+		if (i + 1 < in.size())
+			triple |= (uint8_t)in[i + 1] << 8;
+		if (i + 2 < in.size())
+			triple |= (uint8_t)in[i + 2];
+
+		out += chars[(triple >> 18) & 63];
+		out += chars[(triple >> 12) & 63];
+		out += i + 1 < in.size() ? chars[(triple >> 6) & 63] : '=';
+		out += i + 2 < in.size() ? chars[triple & 63] : '=';
+	}
+
+	return out;
+}
+
+static void test_vectors()
+{
+	/* RFC 4648 section 10 */
+	const char *vectors[][2] = {
+		{"", ""},
+		{"f", "Zg=="},
+		{"fo", "Zm8="},
+		{"foo", "Zm9v"},
+		{"foob", "Zm9vYg=="},
+		{"fooba", "Zm9vYmE="},
+		{"foobar", "Zm9vYmFy"},
+	};
+
+	for (auto &v : vectors) {
+		std::string decoded;
+
+		CHECK_EQ(base64_encode(std::string(v[0])), v[1]);
+		CHECK_EQ(base64_decode(std::string(v[1])), v[0]);
+		CHECK(base64_decode(std::string(v[1]), decoded));
+		CHECK_EQ(decoded, v[0]);
+	}
+}
+
+static void test_roundtrip()
+{
+	std::mt19937 rng(1234);
+
+	/* Covers the SIMD blocks, the scalar loop and every tail length */
+	for (size_t len = 0; len < 300; ++len) {
+		std::string data(len, '\0');
+		for (auto &c : data)
+			c = (char)rng();
+
+		std::string encoded = base64_encode(data);
+		CHECK_EQ(encoded, reference_encode(data));
+		CHECK_EQ(base64_decode(encoded), data);
+
+		std::string decoded;
+		CHECK(base64_decode(encoded, decoded));
+		CHECK_EQ(decoded, data);
+
+		/* Unpadded input decodes the same */
+		std::string unpadded = encoded.substr(0, encoded.find('='));
+		CHECK(base64_decode(unpadded, decoded));
+		CHECK_EQ(decoded, data);
+	}
+}
+
+static void test_strict_decode()
+{
+	std::string out;
+
+	CHECK(!base64_decode(std::string("Zm9v!mFy"), out));
+	CHECK(!base64_decode(std::string("Zm9vY"), out));
+	CHECK(!base64_decode(std::string("Zg=a"), out));
+	CHECK(!base64_decode(std::string("Z==="), out));
+	CHECK(!base64_decode(std::string("Zm9v\nYmFy"), out));
+
+	/* Invalid char deep inside a SIMD-sized block */
+	std::string long_input = base64_encode(std::string(96, 'x'));
+	long_input[70] = '*';
+	CHECK(!base64_decode(long_input, out));
+}
+
+static void test_lenient_decode()
+{
+	/* The legacy decoder stops at the first char outside the alphabet */
+	CHECK_EQ(base64_decode(std::string("Zm9v!mFy")), "foo");
+	CHECK_EQ(base64_decode(std::string("Zm9vYmFy\n")), "foobar");
+	CHECK_EQ(base64_decode(std::string("Zm9")), "fo");
+}
+
+int main()
+{
+	test_vectors();
+	test_roundtrip();
+	test_strict_decode();
+	test_lenient_decode();
+
+	return test_result();
+}
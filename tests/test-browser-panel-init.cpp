@@ -0,0 +1,268 @@
+#include "test-common.hpp"
+
+#include "panel/browser-panel-init.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+static const uint64_t MS = 1000000ULL;
+
+/* Stands in for the Qt main loop and CEF startup, on a virtual clock which
+ * starts at 1 s as a monotonic clock would not start at 0 */
+struct MainLoop {
+	static const uint64_t START = 1000 * MS;
+
+	uint64_t now = START;
+	std::multimap<uint64_t, std::function<void()>> events;
+	size_t wakeups = 0;
+
+	bool cefStarted = false;
+	uint64_t cefStartTime = 0;
+	std::vector<std::function<void()>> cefStartedCallbacks;
+
+	void At(uint64_t t, std::function<void()> f)
+	{
+		events.emplace(START + t, f);
+	}
+
+	void Post(std::function<void()> f) { events.emplace(now, f); }
+
+	void Run(uint64_t end)
+	{
+		end += START;
+
+		while (!events.empty() && events.begin()->first <= end) {
+			auto it = events.begin();
+			auto f = it->second;
+
+			now = it->first;
+			events.erase(it);
+
+			++wakeups;
+			f();
+		}
+
+		now = end;
+	}
+
+	void StartCef()
+	{
+		cefStarted = true;
+		cefStartTime = now;
+
+		for (auto &callback : cefStartedCallbacks)
+			callback();
+		cefStartedCallbacks.clear();
+	}
+};
+
+/* A dock's browser widget: the show, resize and WinIdChange events of
+ * QCefWidgetInternal drive Init() */
+struct Panel {
+	MainLoop &loop;
+	bool visible = false;
+	bool hasNativeWindow = false;
+	int failQueue = 0;
+	int created = 0;
+	uint64_t shownTime = 0;
+	BrowserPanelInit init;
+
+	Panel(MainLoop &loop_, const std::string &name)
+		: loop(loop_), init(name, Callbacks())
+	{
+	}
+
+	BrowserPanelInit::Callbacks Callbacks()
+	{
+		BrowserPanelInit::Callbacks cb;
+
+		cb.isVisible = [this]() { return visible; };
+		cb.cefStarted = [this]() { return loop.cefStarted; };
+		cb.whenCefStarted = [this](std::function<void()> task) {
+			auto post = [this, task]() { loop.Post(task); };
+
+			if (loop.cefStarted)
+				post();
+			else
+				loop.cefStartedCallbacks.push_back(post);
+		};
+		cb.createNativeWindow = [this]() {
+			if (hasNativeWindow)
+				return;
+
+			/* WinIdChange */
+			hasNativeWindow = true;
+			init.Init();
+		};
+		cb.queueCreate = [this]() {
+			if (failQueue) {
+				--failQueue;
+				return false;
+			}
+
+			++created;
+			return true;
+		};
+		cb.post = [this](std::function<void()> task) {
+			loop.Post(task);
+		};
+		cb.now = [this]() { return loop.now; };
+
+		return cb;
+	}
+
+	void Show()
+	{
+		visible = true;
+		shownTime = loop.now;
+
+		/* showEvent, then resizeEvent */
+		init.Init();
+		if (!init.IsQueued())
+			init.Init();
+	}
+
+	/* From the later of shown and CEF started to creation queued */
+	uint64_t DelayAfterReady() const
+	{
+		uint64_t ready = std::max(shownTime, loop.cefStartTime);
+		return init.GetCreateTime() + init.GetQueueLatency() - ready;
+	}
+};
+
+/* The previous Init(): tried on show, then every 500 ms until CEF had
+ * started. Returns the delay after ready, and counts the timer wakeups. */
+static uint64_t timer_delay_after_ready(uint64_t shown, uint64_t cefStart,
+					size_t &wakeups)
+{
+	uint64_t queued = shown;
+
+	while (queued < cefStart) {
+		queued += 500 * MS;
+		++wakeups;
+	}
+
+	return queued - std::max(shown, cefStart);
+}
+
+/* 12 docks restored at startup, shown before CEF has started, then 2 more
+ * opened later */
+static void test_startup_docks()
+{
+	MainLoop loop;
+	std::vector<std::unique_ptr<Panel>> panels;
+
+	for (int i = 0; i < 14; ++i)
+		panels.emplace_back(
+			new Panel(loop, "dock " + std::to_string(i)));
+
+	for (int i = 0; i < 12; ++i) {
+		Panel *panel = panels[i].get();
+		loop.At((50 + 10 * i) * MS, [panel]() { panel->Show(); });
+	}
+	loop.At(730 * MS, [&loop]() { loop.StartCef(); });
+	for (int i = 12; i < 14; ++i) {
+		Panel *panel = panels[i].get();
+		loop.At(2000 * MS, [panel]() { panel->Show(); });
+	}
+
+	loop.Run(10000 * MS);
+
+	uint64_t maxDelay = 0;
+	uint64_t timerMaxDelay = 0;
+	uint64_t timerTotalDelay = 0;
+	size_t timerWakeups = 0;
+
+	for (auto &panel : panels) {
+		CHECK(panel->init.IsQueued());
+		CHECK_EQ(panel->created, 1);
+		CHECK(panel->hasNativeWindow);
+
+		maxDelay = std::max(maxDelay, panel->DelayAfterReady());
+
+		uint64_t timerDelay = timer_delay_after_ready(
+			panel->shownTime, loop.cefStartTime, timerWakeups);
+		timerMaxDelay = std::max(timerMaxDelay, timerDelay);
+		timerTotalDelay += timerDelay;
+	}
+
+	/* Created as soon as CEF started, or as soon as shown after */
+	CHECK_EQ(maxDelay, 0u);
+	CHECK_EQ(panels[0]->init.GetQueueLatency(), 730 * MS);
+	CHECK_EQ(panels[13]->init.GetQueueLatency(), 2000 * MS);
+
+	/* Shows, CEF start and one deferred Init() per waiting dock */
+	CHECK_EQ(loop.wakeups, 14u + 1 + 12);
+
+	printf("browser panels: 14 docks, 12 shown before CEF started: "
+	       "creation queued %.1f ms after ready at most, %zu main "
+	       "thread wakeups; 500 ms timer: %.1f ms average, %.1f ms max, "
+	       "%zu timer wakeups\n",
+	       maxDelay / 1e6, loop.wakeups,
+	       timerTotalDelay / 1e6 / panels.size(), timerMaxDelay / 1e6,
+	       timerWakeups);
+}
+
+/* Hidden docks are not created, and closing the browser allows it to be
+ * created again */
+static void test_hidden_and_reset()
+{
+	MainLoop loop;
+	loop.StartCef();
+
+	Panel panel(loop, "hidden");
+
+	panel.init.Init();
+	CHECK(!panel.init.IsQueued());
+	CHECK(!panel.hasNativeWindow);
+
+	panel.Show();
+	CHECK(panel.init.IsQueued());
+	CHECK_EQ(panel.created, 1);
+
+	panel.init.Init();
+	CHECK_EQ(panel.created, 1);
+
+	panel.init.Reset();
+	panel.init.Init();
+	CHECK_EQ(panel.created, 2);
+}
+
+/* A failed queue is retried once from the main loop */
+static void test_queue_failure()
+{
+	MainLoop loop;
+	loop.StartCef();
+
+	Panel panel(loop, "failing");
+	panel.failQueue = 1;
+	panel.visible = true;
+	panel.hasNativeWindow = true;
+
+	panel.init.Init();
+	CHECK(!panel.init.IsQueued());
+
+	loop.Run(1 * MS);
+	CHECK(panel.init.IsQueued());
+	CHECK_EQ(panel.created, 1);
+
+	/* Failing again after the retry is not retried in a loop */
+	Panel stuck(loop, "stuck");
+	stuck.failQueue = 100;
+
+	stuck.Show();
+	loop.Run(10 * MS);
+	CHECK(!stuck.init.IsQueued());
+	CHECK(loop.events.empty());
+}
+
+int main()
+{
+	test_startup_docks();
+	test_hidden_and_reset();
+	test_queue_failure();
+
+	return test_result();
+}
@@ -0,0 +1,210 @@
+#include "test-common.hpp"
+#include "cef-stub-control.hpp"
+
+#include "obs-browser-source-tasks.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/* Stands in for the CEF UI thread: runs queued tasks in order */
+class CefThread {
+public:
+	CefThread() : m_thread([this]() { Run(); }) {}
+
+	~CefThread()
+	{
+		Post(nullptr);
+		m_thread.join();
+	}
+
+	bool Post(std::function<void()> task)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		m_queue.push_back(task);
+		m_cond.notify_all();
+		return true;
+	}
+
+	CefTaskQueueFunc Queue()
+	{
+		return [this](std::function<void()> task) {
+			return Post(task);
+		};
+	}
+
+	/* Keeps the thread busy for ms, as a page doing heavy work would */
+	void Busy(int ms)
+	{
+		Post([ms]() {
+			std::this_thread::sleep_for(
+				std::chrono::milliseconds(ms));
+		});
+	}
+
+	void Drain()
+	{
+		std::mutex mutex;
+		std::condition_variable cond;
+		bool done = false;
+
+		Post([&]() {
+			std::lock_guard<std::mutex> guard(mutex);
+			done = true;
+			cond.notify_all();
+		});
+
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [&]() { return done; });
+	}
+
+private:
+	void Run()
+	{
+		for (;;) {
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cond.wait(lock, [this]() {
+					return !m_queue.empty();
+				});
+				task = m_queue.front();
+				m_queue.pop_front();
+			}
+
+			if (!task)
+				return;
+
+			task();
+		}
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::deque<std::function<void()>> m_queue;
+	std::thread m_thread;
+};
+
+/* What a scene transition does to each browser source: shown and
+ * activated, then the previous scene's sources are hidden */
+static const size_t SOURCES = 100;
+
+static void check_messages(std::vector<CefRefPtr<CefBrowser>> &browsers)
+{
+	size_t ordered = 0;
+
+	for (auto browser : browsers) {
+		auto msgs = stub::cef_take_sent_messages(browser);
+		if (msgs.size() != 3)
+			continue;
+
+		if (msgs[0]->GetName() == "Visibility" &&
+		    msgs[0]->GetArgumentList()->GetBool(0) &&
+		    msgs[1]->GetName() == "Active" &&
+		    msgs[1]->GetArgumentList()->GetBool(0) &&
+		    msgs[2]->GetName() == "Visibility" &&
+		    !msgs[2]->GetArgumentList()->GetBool(0))
+			++ordered;
+	}
+
+	CHECK_EQ(ordered, browsers.size());
+}
+
+static void test_async_transition()
+{
+	CefThread cef;
+	BrowserWaitStats waits;
+
+	std::vector<CefRefPtr<CefBrowser>> browsers;
+	for (size_t i = 0; i < SOURCES; ++i)
+		browsers.push_back(stub::cef_create_browser());
+
+	/* Queued as ExecuteOnBrowser() does by default */
+	cef.Busy(200);
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto browser : browsers) {
+		cef.Post([=]() { SendBrowserVisibility(browser, true); });
+		cef.Post([=]() { SendBrowserActive(browser, true); });
+		cef.Post([=]() { SendBrowserVisibility(browser, false); });
+	}
+	double caller_ms = bench_elapsed_ms(start);
+
+	cef.Drain();
+
+	/* The OBS thread never waited on the busy CEF thread */
+	CHECK_EQ(waits.Waits(), 0u);
+	CHECK_EQ(waits.MaxNs(), 0u);
+	CHECK(caller_ms < 100.0);
+
+	check_messages(browsers);
+
+	/* The previous path: one blocking wait per callback */
+	cef.Busy(200);
+
+	start = std::chrono::steady_clock::now();
+	for (auto browser : browsers) {
+		RunBrowserTaskAndWait(
+			cef.Queue(),
+			[browser]() { SendBrowserVisibility(browser, true); },
+			waits);
+		RunBrowserTaskAndWait(
+			cef.Queue(),
+			[browser]() { SendBrowserActive(browser, true); },
+			waits);
+		RunBrowserTaskAndWait(
+			cef.Queue(),
+			[browser]() { SendBrowserVisibility(browser, false); },
+			waits);
+	}
+	double blocking_ms = bench_elapsed_ms(start);
+
+	CHECK_EQ(waits.Waits(), 3 * SOURCES);
+	CHECK(blocking_ms >= 200.0);
+
+	check_messages(browsers);
+
+	printf("browser source state: %zu sources shown, activated and "
+	       "hidden with the CEF thread busy for 200 ms: caller blocked "
+	       "%.1f ms with 0 waits; %.1f ms with %llu blocking waits "
+	       "(max %.1f ms)\n",
+	       SOURCES, caller_ms, blocking_ms,
+	       (unsigned long long)waits.Waits(), waits.MaxNs() / 1e6);
+}
+
+static void test_blocking_wait_recorded()
+{
+	CefThread cef;
+	BrowserWaitStats waits;
+
+	cef.Busy(50);
+
+	bool ran = false;
+	CHECK(RunBrowserTaskAndWait(
+		cef.Queue(), [&]() { ran = true; }, waits));
+
+	CHECK(ran);
+	CHECK_EQ(waits.Waits(), 1u);
+	CHECK(waits.MaxNs() >= 40000000u);
+	CHECK_EQ(waits.TotalNs(), waits.MaxNs());
+
+	/* Not queued: nothing ran, nothing waited */
+	ran = false;
+	CefTaskQueueFunc refuse = [](std::function<void()>) { return false; };
+	CHECK(!RunBrowserTaskAndWait(refuse, [&]() { ran = true; }, waits));
+	CHECK(!ran);
+	CHECK_EQ(waits.Waits(), 1u);
+
+	/* Null browsers are skipped */
+	SendBrowserVisibility(nullptr, true);
+	SendBrowserActive(nullptr, true);
+}
+
+int main()
+{
+	test_async_transition();
+	test_blocking_wait_recorded();
+
+	return test_result();
+}
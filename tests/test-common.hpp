@@ -0,0 +1,86 @@
+#pragma once
+
+/* Minimal check macros and helpers shared by the tests and benchmarks. */
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+static int test_failures = 0;
+
+#define CHECK(cond)                                                        \
+	do {                                                               \
+		if (!(cond)) {                                             \
+			fprintf(stderr, "%s:%d: CHECK failed: %s\n",       \
+				__FILE__, __LINE__, #cond);                \
+			++test_failures;                                   \
+		}                                                          \
+	} while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+static inline int test_result()
+{
+	if (test_failures)
+		fprintf(stderr, "%d check(s) failed\n", test_failures);
+	return test_failures ? 1 : 0;
+}
+
+static inline bool bench_is_quick(int argc, char **argv)
+{
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--quick") == 0)
+			return true;
+	}
+	return false;
+}
+
+static inline double bench_elapsed_ms(
+	const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double, std::milli>(
+		       std::chrono::steady_clock::now() - start)
+		.count();
+}
+
+/* Fresh directory under the system temp path, removed on destruction. */
+class TempDir {
+public:
+	TempDir()
+	{
+		std::random_device rd;
+		std::filesystem::path base =
+			std::filesystem::temp_directory_path();
+
+		do {
+			m_path = base / ("obs-browser-test-" +
+					 std::to_string(rd()));
+		} while (!std::filesystem::create_directory(m_path));
+	}
+
+	~TempDir()
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(m_path, ec);
+	}
+
+	const std::filesystem::path &path() const { return m_path; }
+
+	std::string Write(const std::string &relative,
+			  const std::string &content) const
+	{
+		std::filesystem::path full = m_path / relative;
+		std::filesystem::create_directories(full.parent_path());
+
+		std::ofstream out(full, std::ios::binary);
+		out.write(content.data(), content.size());
+		return full.string();
+	}
+
+private:
+	std::filesystem::path m_path;
+};
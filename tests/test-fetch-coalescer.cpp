@@ -0,0 +1,287 @@
+#include "test-common.hpp"
+
+#include "StreamElementsFetchCoalescer.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+
+/* Stands in for the icon host: answers requests on its own thread after a
+ * delay, and counts them */
+class IconServer {
+public:
+	typedef std::function<void(bool success, std::string body)>
+		callback_t;
+
+	IconServer() : m_thread([this]() { Run(); }) {}
+
+	~IconServer()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_stop = true;
+		}
+		m_cond.notify_all();
+		m_thread.join();
+	}
+
+	void Get(std::string url, callback_t callback)
+	{
+		++m_requests;
+
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_queue.push_back({url, callback});
+		}
+		m_cond.notify_all();
+	}
+
+	/* The next request for url fails */
+	void FailNext(std::string url)
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		m_fail = url;
+	}
+
+	size_t requests() const { return m_requests; }
+
+private:
+	void Run()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		for (;;) {
+			m_cond.wait(lock, [this]() {
+				return m_stop || !m_queue.empty();
+			});
+
+			if (m_queue.empty())
+				return;
+
+			auto request = m_queue.front();
+			m_queue.pop_front();
+
+			bool fail = request.first == m_fail;
+			if (fail)
+				m_fail.clear();
+
+			lock.unlock();
+
+			std::this_thread::sleep_for(
+				std::chrono::milliseconds(20));
+			request.second(!fail, "icon:" + request.first);
+
+			lock.lock();
+		}
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::deque<std::pair<std::string, callback_t>> m_queue;
+	std::string m_fail;
+	bool m_stop = false;
+	std::atomic<size_t> m_requests{0};
+	std::thread m_thread;
+};
+
+struct widget_t {
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool done = false;
+	bool success = false;
+	std::string icon;
+
+	void Set(bool result, std::string body)
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		done = true;
+		success = result;
+		icon = body;
+		cond.notify_all();
+	}
+
+	bool Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		return cond.wait_for(lock, std::chrono::seconds(5),
+				     [this]() { return done; });
+	}
+};
+
+/* The remote icon loader's path: memory cache, then a shared fetch */
+class Loader {
+public:
+	explicit Loader(IconServer &server, bool coalesce = true)
+		: m_server(server), m_coalesce(coalesce)
+	{
+	}
+
+	void Load(std::string url, widget_t *widget)
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_cacheMutex);
+
+			auto it = m_cache.find(url);
+			if (it != m_cache.end()) {
+				widget->Set(true, it->second);
+				return;
+			}
+		}
+
+		if (!m_coalesce) {
+			m_server.Get(url, [widget](bool success,
+						   std::string body) {
+				widget->Set(success, body);
+			});
+			return;
+		}
+
+		if (!m_pending.Join(url, &widget))
+			return;
+
+		m_server.Get(url, [this, url](bool success, std::string body) {
+			if (success) {
+				std::lock_guard<std::mutex> guard(
+					m_cacheMutex);
+				m_cache[url] = body;
+			}
+
+			for (auto waiter : m_pending.Complete(url))
+				waiter->Set(success, body);
+		});
+	}
+
+	StreamElementsFetchCoalescer<widget_t *> &pending()
+	{
+		return m_pending;
+	}
+
+private:
+	IconServer &m_server;
+	bool m_coalesce;
+	StreamElementsFetchCoalescer<widget_t *> m_pending;
+	std::mutex m_cacheMutex;
+	std::map<std::string, std::string> m_cache;
+};
+
+static std::string icon_url(size_t i)
+{
+	return "https://cdn.example.com/icons/" + std::to_string(i % 5) +
+	       ".png";
+}
+
+/* 100 widgets sharing 5 icons, loaded from 4 threads at once */
+static size_t load_widgets(Loader &loader, std::vector<widget_t> &widgets)
+{
+	std::vector<std::thread> threads;
+
+	for (size_t t = 0; t < 4; ++t) {
+		threads.emplace_back([&, t]() {
+			for (size_t i = t; i < widgets.size(); i += 4)
+				loader.Load(icon_url(i), &widgets[i]);
+		});
+	}
+
+	for (auto &thread : threads)
+		thread.join();
+
+	size_t loaded = 0;
+	for (size_t i = 0; i < widgets.size(); ++i) {
+		if (widgets[i].Wait() && widgets[i].success &&
+		    widgets[i].icon == "icon:" + icon_url(i))
+			++loaded;
+	}
+
+	return loaded;
+}
+
+static void test_coalescing()
+{
+	IconServer server;
+	Loader loader(server);
+
+	std::vector<widget_t> widgets(100);
+	CHECK_EQ(load_widgets(loader, widgets), 100u);
+	CHECK_EQ(server.requests(), 5u);
+	CHECK_EQ(loader.pending().InFlight(), 0u);
+
+	/* Later loads are served from the cache */
+	std::vector<widget_t> more(100);
+	CHECK_EQ(load_widgets(loader, more), 100u);
+	CHECK_EQ(server.requests(), 5u);
+
+	IconServer baselineServer;
+	Loader baseline(baselineServer, false);
+
+	std::vector<widget_t> baselineWidgets(100);
+	CHECK_EQ(load_widgets(baseline, baselineWidgets), 100u);
+
+	printf("remote icons: 100 widgets sharing 5 icons: %zu requests, "
+	       "%zu without coalescing\n",
+	       server.requests(), baselineServer.requests());
+}
+
+/* A failed fetch notifies its waiters and releases the URL */
+static void test_failure()
+{
+	IconServer server;
+	Loader loader(server);
+
+	std::string url = icon_url(0);
+	server.FailNext(url);
+
+	std::vector<widget_t> widgets(10);
+	for (auto &widget : widgets)
+		loader.Load(url, &widget);
+
+	for (auto &widget : widgets) {
+		CHECK(widget.Wait());
+		CHECK(!widget.success);
+	}
+
+	CHECK_EQ(server.requests(), 1u);
+	CHECK_EQ(loader.pending().InFlight(), 0u);
+
+	widget_t retry;
+	loader.Load(url, &retry);
+	CHECK(retry.Wait());
+	CHECK(retry.success);
+	CHECK_EQ(server.requests(), 2u);
+}
+
+static void test_join_complete()
+{
+	StreamElementsFetchCoalescer<int> pending;
+
+	int a = 1, b = 2;
+	CHECK(pending.Join("x", &a));
+	CHECK(!pending.Join("x", &b));
+	CHECK(!pending.Join("x", nullptr));
+	CHECK(pending.Join("y", nullptr));
+	CHECK_EQ(pending.InFlight(), 2u);
+
+	auto waiters = pending.Complete("x");
+	CHECK_EQ(waiters.size(), 2u);
+	if (waiters.size() == 2) {
+		CHECK_EQ(waiters[0], 1);
+		CHECK_EQ(waiters[1], 2);
+	}
+
+	/* A fetch which was never issued is completed with no waiters */
+	CHECK(pending.Complete("y").empty());
+	CHECK(pending.Complete("y").empty());
+	CHECK_EQ(pending.InFlight(), 0u);
+
+	CHECK(pending.Join("x", nullptr));
+}
+
+int main()
+{
+	test_join_complete();
+	test_coalescing();
+	test_failure();
+
+	return test_result();
+}
@@ -0,0 +1,131 @@
+#include "test-common.hpp"
+#include "stub-control.hpp"
+
+#include "StreamElementsFileReferenceScanner.hpp"
+
+#include <map>
+
+static void test_potential_paths()
+{
+	CHECK(IsPotentialLocalFilePath("/home/user/logo.png"));
+	CHECK(IsPotentialLocalFilePath("C:\\Users\\user\\logo.png"));
+	CHECK(IsPotentialLocalFilePath("C:/Users/user/logo.png"));
+	CHECK(IsPotentialLocalFilePath("./logo.png"));
+
+	CHECK(!IsPotentialLocalFilePath(""));
+	CHECK(!IsPotentialLocalFilePath("logo.png"));
+	CHECK(!IsPotentialLocalFilePath("Scene 1"));
+	CHECK(!IsPotentialLocalFilePath("https://example.com/logo.png"));
+	CHECK(!IsPotentialLocalFilePath("file:///home/user/logo.png"));
+	CHECK(!IsPotentialLocalFilePath("data:image/png;base64,AAAA/"));
+	CHECK(!IsPotentialLocalFilePath("line one/\nline two"));
+	CHECK(!IsPotentialLocalFilePath("/" + std::string(5000, 'a')));
+}
+
+static CefRefPtr<CefValue> make_collection(const std::string &logo,
+					   const std::string &sound)
+{
+	std::string json =
+		"{\"name\":\"Collection\",\"sources\":[{\"name\":\"Logo\","
+		"\"settings\":{\"file\":\"" +
+		logo +
+		"\",\"url\":\"https://example.com/a/b\"}},{\"name\":\"Sound\","
+		"\"settings\":{\"playlist\":[{\"value\":\"" +
+		sound + "\"},{\"value\":\"" + logo +
+		"\"},{\"value\":\"/missing/file.mp3\"}]}}],"
+		"\"current_scene\":\"Scene/1\",\"ids\":[1,2,3]}";
+
+	return CefParseJSON(json, JSON_PARSER_RFC);
+}
+
+static void test_scan(const TempDir &dir)
+{
+	std::string logo = dir.Write("images/logo.png", "png");
+	std::string sound = dir.Write("sounds/beep.mp3", "mp3");
+
+	CefRefPtr<CefValue> content = make_collection(logo, sound);
+	CHECK(content.get() != nullptr);
+	if (!content)
+		return;
+
+	std::map<std::string, int> calls;
+
+	stub::reset_os_file_exists_calls();
+
+	CHECK(ScanForFileReferences(
+		content, [&](const std::string &path, std::string &replacement) {
+			if (!calls[path]++)
+				replacement = "${MONIKER}/" +
+					      std::to_string(calls.size());
+			return true;
+		}));
+
+	/* Each existing reference reaches the handler; each candidate path
+	 * is checked once, URLs and plain names never */
+	CHECK_EQ(calls.size(), 2u);
+	CHECK_EQ(calls[logo], 2);
+	CHECK_EQ(calls[sound], 1);
+	CHECK_EQ(stub::os_file_exists_calls(), 4u);
+
+	CefRefPtr<CefListValue> sources =
+		content->GetDictionary()->GetList("sources");
+	CHECK_EQ(sources->GetDictionary(0)
+			 ->GetDictionary("settings")
+			 ->GetString("file")
+			 .ToString(),
+		 "${MONIKER}/1");
+	CHECK_EQ(sources->GetDictionary(0)
+			 ->GetDictionary("settings")
+			 ->GetString("url")
+			 .ToString(),
+		 "https://example.com/a/b");
+
+	CefRefPtr<CefListValue> playlist = sources->GetDictionary(1)
+						   ->GetDictionary("settings")
+						   ->GetList("playlist");
+	CHECK_EQ(playlist->GetDictionary(0)->GetString("value").ToString(),
+		 "${MONIKER}/2");
+	/* An empty replacement keeps the value */
+	CHECK_EQ(playlist->GetDictionary(1)->GetString("value").ToString(),
+		 logo);
+	CHECK_EQ(playlist->GetDictionary(2)->GetString("value").ToString(),
+		 "/missing/file.mp3");
+
+	CHECK_EQ(content->GetDictionary()->GetList("ids")->GetInt(2), 3);
+}
+
+static void test_stop(const TempDir &dir)
+{
+	std::string logo = dir.Write("images/logo.png", "png");
+	std::string sound = dir.Write("sounds/beep.mp3", "mp3");
+
+	CefRefPtr<CefValue> content = make_collection(logo, sound);
+
+	int calls = 0;
+	CHECK(!ScanForFileReferences(content,
+				     [&](const std::string &, std::string &) {
+					     ++calls;
+					     return false;
+				     }));
+	CHECK_EQ(calls, 1);
+
+	CefRefPtr<CefValue> scalar = CefValue::Create();
+	scalar->SetString(logo);
+	CHECK(ScanForFileReferences(scalar,
+				    [&](const std::string &, std::string &) {
+					    ++calls;
+					    return true;
+				    }));
+	CHECK_EQ(calls, 1);
+}
+
+int main()
+{
+	TempDir dir;
+
+	test_potential_paths();
+	test_scan(dir);
+	test_stop(dir);
+
+	return test_result();
+}
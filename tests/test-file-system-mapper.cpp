@@ -0,0 +1,68 @@
+#include "test-common.hpp"
+
+#include "StreamElementsFileSystemMapper.hpp"
+
+static void test_redirects(const TempDir &dir)
+{
+	std::string root = dir.path().string();
+
+	StreamElementsFileSystemMapper mapper(root);
+
+	CHECK_EQ(mapper.MapRelativePath("/old"), "/new");
+	CHECK_EQ(mapper.MapRelativePath("/assets/img/a.png"),
+		 "/static/img/a.png");
+	CHECK_EQ(mapper.MapRelativePath("/unmapped"), "/unmapped");
+
+	std::string path;
+
+	/* Rules chain until the path stops changing */
+	CHECK(mapper.MapAbsolutePath("/chain", path));
+	CHECK_EQ(path, root + "/new.html");
+
+	CHECK(mapper.MapAbsolutePath("/assets/img/a.png", path));
+	CHECK_EQ(path, root + "/static/img/a.png");
+
+	CHECK(mapper.MapAbsolutePath("/app", path));
+	CHECK_EQ(path, root + "/app/index.html");
+
+	CHECK(!mapper.MapAbsolutePath("/missing", path));
+	CHECK_EQ(path, root + "/missing");
+}
+
+static void test_invalid_rules(const TempDir &dir)
+{
+	dir.Write("bad/redirects.toml", "[[redirects]]\n"
+					"from = \"/x\"\n"
+					"[[redirects]]\n"
+					"to = \"/y\"\n");
+
+	StreamElementsFileSystemMapper mapper(dir.path().string() + "/bad");
+
+	CHECK_EQ(mapper.MapRelativePath("/x"), "/x");
+}
+
+int main()
+{
+	TempDir dir;
+
+	dir.Write("redirects.toml", "[[redirects]]\n"
+				    "from = \"/chain\"\n"
+				    "to = \"/old\"\n"
+				    "[[redirects]]\n"
+				    "from = \"/old\"\n"
+				    "to = \"/new\"\n"
+				    "[[redirects]]\n"
+				    "from = \"/assets/*\"\n"
+				    "to = \"/static/:splat\"\n");
+	dir.Write("ignored.txt", "[[redirects]]\n"
+				 "from = \"/unmapped\"\n"
+				 "to = \"/nowhere\"\n");
+	dir.Write("new.html", "<html></html>");
+	dir.Write("static/img/a.png", "png");
+	dir.Write("app/index.html", "<html></html>");
+
+	test_redirects(dir);
+	test_invalid_rules(dir);
+
+	return test_result();
+}
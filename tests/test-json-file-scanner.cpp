@@ -0,0 +1,115 @@
+#include "test-common.hpp"
+
+#include "StreamElementsJsonFileScanner.hpp"
+
+#include <thread>
+
+static bool read_name(const TempDir &dir, const std::string &content,
+		      std::string &name)
+{
+	name.clear();
+	return ReadObsSceneCollectionName(
+		dir.Write("collection.json", content).c_str(), name);
+}
+
+static void test_collection_name()
+{
+	TempDir dir;
+	std::string name;
+
+	CHECK(read_name(dir, "{\"name\":\"Main\"}", name));
+	CHECK_EQ(name, "Main");
+
+	/* Nested values before the name are skipped, including a nested
+	 * "name" key and strings holding brackets and escaped quotes */
+	CHECK(read_name(dir,
+			"{\n  \"sources\": [{\"name\": \"inner\", \"s\": "
+			"\"]}\\\"{[\"}, 1, -2.5e3, true, null],\n"
+			"  \"current_scene\": \"Scene\",\n"
+			"  \"name\" : \"Outer\"\n}",
+			name));
+	CHECK_EQ(name, "Outer");
+
+	CHECK(read_name(dir, "\xEF\xBB\xBF{\"name\":\"Bom\"}", name));
+	CHECK_EQ(name, "Bom");
+
+	CHECK(read_name(dir,
+			"{\"name\":\"a\\\"b\\\\c\\n\\u00e9\\u20ac"
+			"\\ud83d\\ude00\"}",
+			name));
+	CHECK_EQ(name, "a\"b\\c\n\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80");
+
+	CHECK(!read_name(dir, "{\"sources\":[{\"name\":\"inner\"}]}", name));
+	CHECK(!read_name(dir, "{\"name\":5}", name));
+	CHECK(!read_name(dir, "{\"name\":\"unterminated", name));
+	CHECK(!read_name(dir, "{\"name\":\"\\ud83d\"}", name));
+	CHECK(!read_name(dir, "[\"name\", \"x\"]", name));
+	CHECK(!read_name(dir, "", name));
+	CHECK(!read_name(dir, "{\"a\":[1,2}", name));
+
+	CHECK(!ReadObsSceneCollectionName(
+		(dir.path() / "missing.json").string().c_str(), name));
+}
+
+static void test_name_across_buffer_boundary()
+{
+	TempDir dir;
+	std::string name;
+
+	/* Place the name so that its tokens straddle the 64 KiB buffer */
+	for (size_t pad = 65500; pad < 65540; ++pad) {
+		std::string doc = "{\"pad\":\"" + std::string(pad, 'x') +
+				  "\",\"name\":\"Edge\\u00e9\"}";
+
+		CHECK(read_name(dir, doc, name));
+		CHECK_EQ(name, "Edge\xc3\xa9");
+	}
+}
+
+static void test_collection_names()
+{
+	TempDir dir;
+	std::string path = dir.path().string();
+
+	dir.Write("a.json", "{\"name\":\"Alpha\"}");
+	dir.Write("b.json", "{\"sources\":[]}");
+	dir.Write("c.txt", "{\"name\":\"Text\"}");
+	dir.Write(".hidden.json", "{\"name\":\"Hidden\"}");
+	dir.Write("dir.json/x.json", "{\"name\":\"Nested\"}");
+
+	std::map<std::string, std::string> names;
+	CHECK(ReadObsSceneCollectionNames(path.c_str(), names));
+	CHECK_EQ(names.size(), (size_t)1);
+	CHECK_EQ(names["a"], "Alpha");
+
+	/* A changed size invalidates the cached name */
+	dir.Write("a.json", "{\"name\":\"Alpha 2\"}");
+	dir.Write("b.json", "{\"name\":\"Beta\"}");
+
+	names.clear();
+	CHECK(ReadObsSceneCollectionNames(path.c_str(), names));
+	CHECK_EQ(names.size(), (size_t)2);
+	CHECK_EQ(names["a"], "Alpha 2");
+	CHECK_EQ(names["b"], "Beta");
+
+	std::filesystem::remove(dir.path() / "a.json");
+
+	names.clear();
+	CHECK(ReadObsSceneCollectionNames(path.c_str(), names));
+	CHECK_EQ(names.size(), (size_t)1);
+	CHECK_EQ(names["b"], "Beta");
+
+	names.clear();
+	CHECK(!ReadObsSceneCollectionNames((path + "/missing").c_str(),
+					   names));
+	CHECK(names.empty());
+}
+
+int main()
+{
+	test_collection_name();
+	test_name_across_buffer_boundary();
+	test_collection_names();
+
+	return test_result();
+}
@@ -0,0 +1,140 @@
+#include "test-common.hpp"
+
+#include "json11/json11.hpp"
+
+using namespace json11;
+
+/* minify() must accept exactly what parse() accepts and produce a document
+ * that parses to the same value. */
+static void check_same_as_parse(const std::string &in,
+				JsonParse strategy = JsonParse::STANDARD)
+{
+	std::string parse_err;
+	Json parsed = Json::parse(in, parse_err, strategy);
+
+	std::string out = "prefix:";
+	std::string err;
+	bool ok = Json::minify(in, out, err, strategy);
+
+	CHECK_EQ(ok, parse_err.empty());
+
+	if (!ok) {
+		CHECK_EQ(out, "prefix:");
+		CHECK(!err.empty());
+		return;
+	}
+
+	CHECK_EQ(out.compare(0, 7, "prefix:"), 0);
+
+	std::string reparse_err;
+	Json reparsed = Json::parse(out.substr(7), reparse_err);
+	CHECK(reparse_err.empty());
+	CHECK(reparsed == parsed);
+}
+
+static void test_valid()
+{
+	const char *docs[] = {
+		"null",
+		" true ",
+		"false",
+		"0",
+		"-12.5e+3",
+		"\"\"",
+		"\"a\\\"b\\\\c\\/\\b\\f\\n\\r\\t\\u00e9\\ud83d\\ude00\"",
+		"[]",
+		"{}",
+		"[1, [2, [3, {\"a\": [null]}]]]",
+		"{ \"b\" : 1 ,\n\t\"a\" : { \"c\" : [ true , false ] } }",
+		"\"\xc3\xa9\xe2\x82\xac\"",
+	};
+
+	for (auto doc : docs)
+		check_same_as_parse(doc);
+}
+
+static void test_invalid()
+{
+	const char *docs[] = {
+		"",
+		"   ",
+		"nul",
+		"[1,]",
+		"{\"a\":1,}",
+		"{\"a\" 1}",
+		"{1:1}",
+		"[1 2]",
+		"01",
+		"1.",
+		"-",
+		"1e",
+		"\"abc",
+		"\"\\x\"",
+		"\"\\u12g4\"",
+		"\"a\nb\"",
+		"[1] 2",
+		"// comment\n1",
+	};
+
+	for (auto doc : docs)
+		check_same_as_parse(doc);
+}
+
+static void test_compact_output()
+{
+	std::string out;
+	std::string err;
+
+	CHECK(Json::minify("{ \"b\" : [ 1 , 2.50 ] , \"a\" : \"x y\" }", out,
+			   err));
+	/* Key order and number spelling are kept */
+	CHECK_EQ(out, "{\"b\":[1,2.50],\"a\":\"x y\"}");
+}
+
+static void test_comments()
+{
+	const char *doc = "/* head */ { // line\n \"a\" : /* mid */ 1 }";
+
+	check_same_as_parse(doc, JsonParse::COMMENTS);
+	check_same_as_parse(doc, JsonParse::STANDARD);
+
+	std::string out;
+	std::string err;
+	CHECK(Json::minify(doc, out, err, JsonParse::COMMENTS));
+	CHECK_EQ(out, "{\"a\":1}");
+}
+
+static void test_line_separators()
+{
+	std::string out;
+	std::string err;
+
+	/* Escaped like dump() does, so the output is safe inside a script */
+	CHECK(Json::minify("\"a\xe2\x80\xa8_\xe2\x80\xa9\"", out, err));
+	CHECK_EQ(out, "\"a\\u2028_\\u2029\"");
+}
+
+static void test_depth_limit()
+{
+	std::string deep(1000, '[');
+	deep += std::string(1000, ']');
+
+	check_same_as_parse(deep);
+
+	std::string shallow(100, '[');
+	shallow += std::string(100, ']');
+
+	check_same_as_parse(shallow);
+}
+
+int main()
+{
+	test_valid();
+	test_invalid();
+	test_compact_output();
+	test_comments();
+	test_line_separators();
+	test_depth_limit();
+
+	return test_result();
+}
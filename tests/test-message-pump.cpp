@@ -0,0 +1,209 @@
+#include "test-common.hpp"
+
+#include "browser-message-pump.hpp"
+
+#include <deque>
+#include <functional>
+#include <map>
+
+static const uint64_t MS = 1000000ULL;
+
+/* Stands in for the Qt main loop, timer and CEF, on a virtual clock.
+ * Times passed in are relative to the start of the clock, which is not 0
+ * as a monotonic clock would not be. */
+class MockLoop {
+public:
+	MockLoop()
+		: pump({[this](int ms) { posted.push_back(ms); },
+			[this](int ms) { timerDue = now + ms * MS; },
+			[this]() { timerDue = 0; },
+			[this]() {
+				++work;
+				if (onWork)
+					onWork();
+			},
+			[this]() { return now; }})
+	{
+	}
+
+	/* Runs f at virtual time t, as if from another thread */
+	void At(uint64_t t, std::function<void()> f)
+	{
+		events.emplace(START + t, f);
+	}
+
+	void RunUntil(uint64_t end)
+	{
+		end += START;
+
+		for (;;) {
+			if (!posted.empty()) {
+				int ms = posted.front();
+				posted.pop_front();
+
+				++wakeups;
+				pump.DoCefMessageLoop(ms);
+				continue;
+			}
+
+			uint64_t next = end;
+			if (timerDue && timerDue < next)
+				next = timerDue;
+			if (!events.empty() && events.begin()->first < next)
+				next = events.begin()->first;
+
+			if (next >= end && !(timerDue && timerDue == end))
+				break;
+
+			now = next;
+
+			if (!events.empty() && events.begin()->first == now) {
+				auto f = events.begin()->second;
+				events.erase(events.begin());
+				f();
+				continue;
+			}
+
+			timerDue = 0;
+			++wakeups;
+			++timerWakeups;
+			pump.OnPumpTimer();
+		}
+
+		now = end;
+	}
+
+	static const uint64_t START = 1000 * MS;
+
+	uint64_t now = START;
+	uint64_t timerDue = 0;
+	std::deque<int> posted;
+	std::multimap<uint64_t, std::function<void()>> events;
+
+	size_t wakeups = 0;
+	size_t timerWakeups = 0;
+	size_t work = 0;
+	std::function<void()> onWork;
+
+	CefMessagePump pump;
+};
+
+/* Idle: one request, then CEF asks for nothing. The fallback pump backs
+ * off to once a second instead of waking at 30 Hz. */
+static void test_idle()
+{
+	MockLoop loop;
+
+	loop.pump.SchedulePump(0);
+	loop.RunUntil(60000 * MS);
+
+	/* 33, 66, 132, 264, 528 ms, then once a second */
+	CHECK_EQ(loop.work, loop.wakeups);
+	CHECK(loop.wakeups >= 60);
+	CHECK(loop.wakeups <= 66);
+	CHECK_EQ(loop.pump.GetStats().requestedPumpCount, 1u);
+
+	printf("message pump, idle 60 s: %zu wakeups (fixed 30 Hz timer: "
+	       "1800)\n",
+	       loop.wakeups);
+}
+
+/* Busy with immediate work: bursts of 10 zero-delay requests every 10 ms
+ * are coalesced into one pump each, and the fallback never fires */
+static void test_busy_immediate()
+{
+	MockLoop loop;
+
+	for (uint64_t t = 0; t < 1000; t += 10) {
+		loop.At(t * MS, [&loop]() {
+			for (int i = 0; i < 10; ++i)
+				loop.pump.SchedulePump(0);
+		});
+	}
+
+	loop.RunUntil(1000 * MS);
+
+	CHECK_EQ(loop.work, 100u);
+	CHECK_EQ(loop.wakeups, 100u);
+	CHECK_EQ(loop.timerWakeups, 0u);
+
+	auto &stats = loop.pump.GetStats();
+	CHECK_EQ(stats.requestedPumpCount, 100u);
+	CHECK_EQ(stats.pumpLatencyMax, 0u);
+
+	printf("message pump, 1000 immediate requests in 1 s: %zu pumps, "
+	       "%zu wakeups\n",
+	       loop.work, loop.wakeups);
+}
+
+/* Busy with delayed work: an animation asking for a pump every 16 ms is
+ * pumped on time, not on the next 33 ms tick */
+static void test_busy_delayed()
+{
+	MockLoop loop;
+	loop.onWork = [&loop]() { loop.pump.SchedulePump(16); };
+
+	loop.pump.SchedulePump(0);
+	loop.RunUntil(1000 * MS);
+
+	/* Each frame is a queued request and its timer; the last timer is
+	 * due after the end */
+	CHECK(loop.work >= 60);
+	CHECK(loop.work <= 64);
+	CHECK_EQ(loop.timerWakeups, loop.work - 1);
+	CHECK_EQ(loop.wakeups, 2 * loop.work);
+
+	auto &stats = loop.pump.GetStats();
+	CHECK_EQ(stats.requestedPumpCount, stats.pumpCount);
+	CHECK(stats.pumpLatencyMax < 1 * MS);
+	CHECK_EQ(stats.pumpRequestsTotal, stats.pumpCount);
+
+	printf("message pump, 16 ms animation for 1 s: %zu pumps, "
+	       "%zu wakeups, max latency %.3f ms\n",
+	       loop.work, loop.wakeups, stats.pumpLatencyMax / 1e6);
+}
+
+/* An immediate request reaching the pump from a nested event loop is run
+ * once the running pump returns */
+static void test_nested()
+{
+	MockLoop loop;
+	loop.onWork = [&loop]() {
+		if (loop.work == 1)
+			loop.pump.DoCefMessageLoop(0);
+	};
+
+	loop.pump.SchedulePump(0);
+	loop.RunUntil(1 * MS);
+
+	CHECK_EQ(loop.work, 2u);
+}
+
+static void test_stop()
+{
+	MockLoop loop;
+
+	loop.pump.SchedulePump(0);
+	loop.RunUntil(1 * MS);
+	CHECK(loop.timerDue != 0);
+
+	loop.pump.Stop();
+	CHECK_EQ(loop.timerDue, 0u);
+
+	loop.pump.SchedulePump(5);
+	loop.RunUntil(10000 * MS);
+
+	CHECK_EQ(loop.work, 1u);
+	CHECK_EQ(loop.timerDue, 0u);
+}
+
+int main()
+{
+	test_idle();
+	test_busy_immediate();
+	test_busy_delayed();
+	test_nested();
+	test_stop();
+
+	return test_result();
+}
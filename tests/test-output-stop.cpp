@@ -0,0 +1,141 @@
+#include "test-common.hpp"
+
+#include "StreamElementsOutputStop.hpp"
+#include "stub-control.hpp"
+
+using stub::frontend_output;
+
+static double stop_all(bool &result, unsigned int timeoutMs = 2000)
+{
+	auto start = std::chrono::steady_clock::now();
+	result = StopAllFrontendOutputs(timeoutMs);
+	return bench_elapsed_ms(start);
+}
+
+static stub::fake_output_config running(unsigned int stop_delay_ms)
+{
+	stub::fake_output_config config;
+	config.active = true;
+	config.frontend_active = true;
+	config.stop_delay_ms = stop_delay_ms;
+	return config;
+}
+
+static void test_no_outputs()
+{
+	bool result;
+	double elapsed = stop_all(result);
+
+	CHECK(result);
+	CHECK(elapsed < 100);
+	CHECK_EQ(stub::frontend_stop_calls(frontend_output::streaming), 0);
+}
+
+static void test_inactive_outputs()
+{
+	stub::set_frontend_output(frontend_output::streaming,
+				  stub::fake_output_config());
+	stub::set_frontend_output(frontend_output::recording,
+				  stub::fake_output_config());
+
+	bool result;
+	double elapsed = stop_all(result);
+
+	CHECK(result);
+	CHECK(elapsed < 100);
+	CHECK_EQ(stub::frontend_stop_calls(frontend_output::streaming), 0);
+	CHECK_EQ(stub::frontend_stop_calls(frontend_output::recording), 0);
+
+	stub::clear_frontend_outputs();
+}
+
+static void test_outputs_stop_concurrently()
+{
+	stub::set_frontend_output(frontend_output::replay_buffer, running(100));
+	stub::set_frontend_output(frontend_output::streaming, running(200));
+	stub::set_frontend_output(frontend_output::recording, running(300));
+
+	bool result;
+	double elapsed = stop_all(result);
+
+	/* Returns on the slowest "stop" signal, not the sum */
+	CHECK(result);
+	CHECK(elapsed >= 290);
+	CHECK(elapsed < 550);
+
+	CHECK_EQ(stub::frontend_stop_calls(frontend_output::replay_buffer), 1);
+	CHECK_EQ(stub::frontend_stop_calls(frontend_output::streaming), 1);
+	CHECK_EQ(stub::frontend_stop_calls(frontend_output::recording), 1);
+
+	stub::clear_frontend_outputs();
+}
+
+/* The output already emitted "stop" but the main thread has not updated the
+ * frontend flag yet: there is nothing to wait for. */
+static void test_stopped_output_with_stale_frontend_flag()
+{
+	stub::fake_output_config config;
+	config.active = false;
+	config.frontend_active = true;
+
+	stub::set_frontend_output(frontend_output::streaming, config);
+
+	bool result;
+	double elapsed = stop_all(result);
+
+	CHECK(result);
+	CHECK(elapsed < 100);
+	CHECK_EQ(stub::frontend_stop_calls(frontend_output::streaming), 0);
+
+	stub::clear_frontend_outputs();
+}
+
+/* The frontend flag lags the "stop" signal; the wait ends on the signal. */
+static void test_frontend_flag_lag()
+{
+	stub::fake_output_config config = running(50);
+	config.frontend_lag_ms = 1000;
+
+	stub::set_frontend_output(frontend_output::streaming, config);
+
+	bool result;
+	double elapsed = stop_all(result);
+
+	CHECK(result);
+	CHECK(elapsed < 500);
+
+	stub::clear_frontend_outputs();
+}
+
+static void test_timeout()
+{
+	stub::fake_output_config config = running(0);
+	config.hang = true;
+
+	stub::set_frontend_output(frontend_output::recording, config);
+	stub::set_frontend_output(frontend_output::streaming, running(20));
+
+	bool result;
+	double elapsed = stop_all(result, 200);
+
+	CHECK(!result);
+	CHECK(elapsed >= 190);
+	CHECK(elapsed < 1000);
+
+	stub::clear_frontend_outputs();
+}
+
+int main()
+{
+	test_no_outputs();
+	test_inactive_outputs();
+	test_outputs_stop_concurrently();
+	test_stopped_output_with_stale_frontend_flag();
+	test_frontend_flag_lag();
+	test_timeout();
+
+	/* Every output reference taken was released */
+	CHECK_EQ(stub::live_outputs(), 0);
+
+	return test_result();
+}
@@ -0,0 +1,205 @@
+#include "test-common.hpp"
+
+#include "StreamElementsQtTasks.hpp"
+#include "stub-control.hpp"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static void drain_until(const std::function<bool()> &done)
+{
+	while (!done()) {
+		stub::qt_wait_for_events(100);
+		stub::qt_process_events();
+	}
+}
+
+static void test_order()
+{
+	std::vector<int> order;
+
+	for (int i = 0; i < 100; ++i)
+		QtPostTask([&order, i]() { order.push_back(i); });
+
+	stub::qt_process_events();
+
+	CHECK_EQ(order.size(), 100u);
+	for (size_t i = 0; i < order.size(); ++i)
+		CHECK_EQ(order[i], (int)i);
+}
+
+/* A task which spins a nested event loop (a modal dialog) must not let
+ * the tasks queued behind it overtake each other. */
+static void test_nested_event_loop()
+{
+	std::vector<int> order;
+
+	QtPostTask([&order]() {
+		order.push_back(0);
+		QCoreApplication::processEvents();
+		order.push_back(1);
+	});
+	for (int i = 2; i < 10; ++i)
+		QtPostTask([&order, i]() { order.push_back(i); });
+
+	stub::qt_process_events();
+
+	CHECK_EQ(order.size(), 10u);
+	/* 0 runs first, the nested loop runs 2..9, then 1 */
+	CHECK(order.size() == 10 && order[0] == 0 && order[9] == 1);
+	for (size_t i = 1; i + 1 < order.size(); ++i)
+		CHECK_EQ(order[i], (int)i + 1);
+
+	/* Posted from within a task while the batch runs */
+	order.clear();
+	QtPostTask([&order]() {
+		order.push_back(0);
+		QtPostTask([&order]() { order.push_back(2); });
+	});
+	QtPostTask([&order]() { order.push_back(1); });
+
+	stub::qt_process_events();
+
+	CHECK((order == std::vector<int>{0, 1, 2}));
+}
+
+static void test_batching()
+{
+	stub::qt_reset_posted_events();
+
+	uint64_t batches = QtGetPostTaskStats().batchesRun;
+
+	int count = 0;
+	for (int i = 0; i < 1000; ++i)
+		QtPostTask([&count]() { ++count; });
+
+	CHECK_EQ(QtGetPostTaskStats().queueDepth, 1000u);
+	CHECK_EQ(stub::qt_posted_events(), 1u);
+
+	stub::qt_process_events();
+
+	CHECK_EQ(count, 1000);
+	CHECK_EQ(QtGetPostTaskStats().queueDepth, 0u);
+	CHECK_EQ(QtGetPostTaskStats().batchesRun, batches + 1);
+}
+
+static void test_exec_sync_from_worker()
+{
+	std::atomic<bool> done(false);
+	std::thread::id ran_on;
+	int value = 0;
+
+	std::thread worker([&]() {
+		QtExecSync([&]() {
+			ran_on = std::this_thread::get_id();
+			value = 42;
+		});
+
+		/* The task ran before QtExecSync returned */
+		CHECK_EQ(value, 42);
+		done = true;
+	});
+
+	drain_until([&]() { return done.load(); });
+	worker.join();
+
+	CHECK(ran_on == std::this_thread::get_id());
+
+	/* Inline on the main thread */
+	QtExecSync([&]() { value = 7; });
+	CHECK_EQ(value, 7);
+}
+
+static void test_exec_async()
+{
+	/* Inline on the main thread */
+	auto result = QtExecAsync([]() { return 5; });
+	CHECK(result.wait_for(std::chrono::seconds(0)) ==
+	      std::future_status::ready);
+	CHECK_EQ(result.get(), 5);
+
+	std::atomic<bool> done(false);
+	std::thread::id callback_on;
+	int callback_value = 0;
+
+	std::thread worker([&]() {
+		QtExecAsync([]() { return 9; },
+			    [&](int value) {
+				    callback_on = std::this_thread::get_id();
+				    callback_value = value;
+				    done = true;
+			    });
+	});
+	worker.join();
+
+	/* Nothing ran yet: the worker did not wait for the main thread */
+	CHECK(!done);
+
+	drain_until([&]() { return done.load(); });
+
+	CHECK_EQ(callback_value, 9);
+	CHECK(callback_on == std::this_thread::get_id());
+}
+
+/* A CEF thread hands a slow GUI task (a download dialog) to the main
+ * thread. QtExecSync holds the CEF thread for the whole task, the
+ * continuation form returns at once and resumes from the callback. */
+static void test_slow_gui_task_blocking()
+{
+	const auto slow_task = []() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		return true;
+	};
+
+	std::atomic<bool> done(false);
+	double sync_blocked_ms = 0;
+
+	std::thread sync_caller([&]() {
+		auto start = std::chrono::steady_clock::now();
+		QtExecSync([&]() { slow_task(); });
+		sync_blocked_ms = bench_elapsed_ms(start);
+		done = true;
+	});
+
+	drain_until([&]() { return done.load(); });
+	sync_caller.join();
+
+	done = false;
+	double async_blocked_ms = 0;
+	bool callback_result = false;
+
+	std::thread async_caller([&]() {
+		auto start = std::chrono::steady_clock::now();
+		QtExecAsync(slow_task, [&](bool result) {
+			callback_result = result;
+			done = true;
+		});
+		async_blocked_ms = bench_elapsed_ms(start);
+	});
+
+	drain_until([&]() { return done.load(); });
+	async_caller.join();
+
+	printf("slow gui task: caller blocked %.1f ms with QtExecSync, "
+	       "%.3f ms with QtExecAsync\n",
+	       sync_blocked_ms, async_blocked_ms);
+
+	CHECK(sync_blocked_ms >= 200);
+	CHECK(async_blocked_ms < 50);
+	CHECK(callback_result);
+}
+
+int main()
+{
+	stub::qt_set_main_thread();
+
+	test_order();
+	test_nested_event_loop();
+	test_batching();
+	test_exec_sync_from_worker();
+	test_exec_async();
+	test_slow_gui_task_blocking();
+
+	return test_result();
+}
@@ -0,0 +1,235 @@
+#include "test-common.hpp"
+
+#include "StreamElementsReportIssuePackage.hpp"
+
+#include "deps/zip/zip.h"
+
+#include <map>
+
+static std::string make_text(size_t size, unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	std::string text;
+
+	while (text.size() < size) {
+		text += "12:00:00.000: [obs-browser] line " +
+			std::to_string(rng() % 100000) + "\n";
+	}
+
+	text.resize(size);
+	return text;
+}
+
+static std::map<std::string, std::string> read_zip(const std::string &path)
+{
+	std::map<std::string, std::string> entries;
+
+	struct zip_t *zip = zip_open(path.c_str(), 0, 'r');
+	CHECK(zip != nullptr);
+	if (!zip)
+		return entries;
+
+	int total = zip_total_entries(zip);
+	for (int i = 0; i < total; ++i) {
+		CHECK_EQ(zip_entry_openbyindex(zip, i), 0);
+
+		void *buf = nullptr;
+		size_t size = 0;
+		std::string name = zip_entry_name(zip);
+
+		if (zip_entry_read(zip, &buf, &size) == 0) {
+			entries[name] = std::string((char *)buf, size);
+			free(buf);
+		} else {
+			entries[name] = "<unreadable>";
+		}
+
+		zip_entry_close(zip);
+	}
+
+	zip_close(zip);
+	return entries;
+}
+
+static void test_deflated_entries(const TempDir &dir)
+{
+	std::string zip_path = (dir.path() / "deflate.zip").string();
+	std::string text = make_text(300000, 1);
+	std::string binary(70000, '\0');
+	std::mt19937 rng(2);
+	for (auto &c : binary)
+		c = (char)rng();
+
+	struct zip_t *zip =
+		zip_open(zip_path.c_str(), ZIP_DEFAULT_COMPRESSION_LEVEL, 'w');
+	CHECK(zip != nullptr);
+
+	for (auto &item : {std::make_pair("logs\\text.log", &text),
+			   std::make_pair("bin/random.bin", &binary)}) {
+		size_t size = 0;
+		unsigned int crc = 0;
+		void *data = zip_deflate(item.second->data(),
+					 item.second->size(),
+					 ZIP_DEFAULT_COMPRESSION_LEVEL, &size,
+					 &crc);
+		CHECK(data != nullptr);
+
+		CHECK_EQ(zip_entry_write_deflated(zip, item.first, data, size,
+						  item.second->size(), crc),
+			 0);
+		free(data);
+	}
+
+	/* Text compresses, random data is stored deflated as well */
+	size_t size = 0;
+	unsigned int crc = 0;
+	void *data = zip_deflate(text.data(), text.size(),
+				 ZIP_DEFAULT_COMPRESSION_LEVEL, &size, &crc);
+	CHECK(size < text.size() / 2);
+	free(data);
+
+	CHECK(zip_deflate(text.data(), text.size(), 0, &size, &crc) ==
+	      nullptr);
+	CHECK(zip_entry_write_deflated(zip, "", text.data(), 1, 1, 0) != 0);
+
+	zip_close(zip);
+
+	auto entries = read_zip(zip_path);
+	CHECK_EQ(entries.size(), (size_t)2);
+	/* Backslashes become zip path separators */
+	CHECK(entries["logs/text.log"] == text);
+	CHECK(entries["bin/random.bin"] == binary);
+}
+
+static report_file make_report_file(const TempDir &dir,
+				    const std::string &name,
+				    const std::string &content, bool is_log)
+{
+	report_file file;
+	file.local_path = dir.Write("src/" + name, content);
+	file.zip_path = "obs-studio\\" + name;
+	file.size = content.size();
+	file.is_log = is_log;
+	return file;
+}
+
+static void test_read_report_file(const TempDir &dir)
+{
+	std::string output;
+
+	std::string small = make_text(1000, 3);
+	CHECK(read_report_file(make_report_file(dir, "small.log", small, true),
+			       output));
+	CHECK(output == small);
+
+	/* Logs keep their tail, with a note on what was dropped */
+	std::string big = make_text(REPORT_ISSUE_MAX_LOG_SIZE + 12345, 4);
+	output.clear();
+	CHECK(read_report_file(make_report_file(dir, "big.log", big, true),
+			       output));
+	std::string note = "[report issue: first 12345 bytes omitted]\r\n";
+	CHECK_EQ(output.size(), note.size() + REPORT_ISSUE_MAX_LOG_SIZE);
+	CHECK_EQ(output.compare(0, note.size(), note), 0);
+	CHECK_EQ(output.compare(note.size(), std::string::npos, big, 12345,
+				std::string::npos),
+		 0);
+
+	/* Other files are read in full */
+	output.clear();
+	CHECK(read_report_file(make_report_file(dir, "big.ini", big, false),
+			       output));
+	CHECK(output == big);
+
+	report_file missing = make_report_file(dir, "gone.log", "x", true);
+	std::filesystem::remove(missing.local_path);
+	CHECK(!read_report_file(missing, output));
+}
+
+static void test_add_report_files(const TempDir &dir)
+{
+	std::vector<report_file> files;
+	std::map<std::string, std::string> expected;
+
+	for (int i = 0; i < 40; ++i) {
+		std::string name = "logs\\" + std::to_string(i) + ".txt";
+		std::string content = make_text(1000 + i * 5000, 100 + i);
+
+		files.push_back(make_report_file(dir, name, content, true));
+		expected["obs-studio/logs/" + std::to_string(i) + ".txt"] =
+			content;
+	}
+
+	files.push_back(make_report_file(dir, "empty.ini", "", false));
+	expected["obs-studio/empty.ini"] = "";
+
+	/* Unreadable files are skipped, the rest are still packaged */
+	report_file missing = make_report_file(dir, "gone.log", "x", true);
+	std::filesystem::remove(missing.local_path);
+	files.push_back(missing);
+
+	uint64_t total = 0;
+	for (auto &file : files)
+		total += file.size;
+
+	std::string zip_path = (dir.path() / "report.zip").string();
+	struct zip_t *zip =
+		zip_open(zip_path.c_str(), ZIP_DEFAULT_COMPRESSION_LEVEL, 'w');
+
+	uint64_t last_progress = 0;
+	bool monotonic = true;
+	bool completed = add_report_files_to_zip(zip, files,
+						 [&](uint64_t bytes) {
+							 monotonic &= bytes >=
+								      last_progress;
+							 last_progress = bytes;
+							 return true;
+						 });
+	zip_close(zip);
+
+	CHECK(completed);
+	CHECK(monotonic);
+	CHECK_EQ(last_progress, total);
+
+	auto entries = read_zip(zip_path);
+	CHECK_EQ(entries.size(), expected.size());
+	for (auto &item : expected)
+		CHECK(entries[item.first] == item.second);
+}
+
+static void test_cancel(const TempDir &dir)
+{
+	std::vector<report_file> files;
+	for (int i = 0; i < 64; ++i)
+		files.push_back(make_report_file(
+			dir, "cancel/" + std::to_string(i) + ".log",
+			make_text(20000, 200 + i), true));
+
+	std::string zip_path = (dir.path() / "cancel.zip").string();
+	struct zip_t *zip =
+		zip_open(zip_path.c_str(), ZIP_DEFAULT_COMPRESSION_LEVEL, 'w');
+
+	int calls = 0;
+	bool completed = add_report_files_to_zip(
+		zip, files, [&](uint64_t) { return ++calls < 3; });
+	zip_close(zip);
+
+	CHECK(!completed);
+	CHECK_EQ(calls, 3);
+	CHECK_EQ(read_zip(zip_path).size(), (size_t)3);
+
+	/* Nothing to do */
+	CHECK(add_report_files_to_zip(nullptr, {},
+				      [](uint64_t) { return false; }));
+}
+
+int main()
+{
+	TempDir dir;
+
+	test_deflated_entries(dir);
+	test_read_report_file(dir);
+	test_add_report_files(dir);
+	test_cancel(dir);
+
+	return test_result();
+}
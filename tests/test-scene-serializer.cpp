@@ -0,0 +1,317 @@
+#include "test-common.hpp"
+#include "stub-control.hpp"
+
+#include "StreamElementsSceneSerializer.hpp"
+
+#include <vector>
+
+static std::string to_json(CefRefPtr<CefValue> value)
+{
+	return CefWriteJSON(value, JSON_WRITER_DEFAULT).ToString();
+}
+
+static std::string to_json(CefRefPtr<CefDictionaryValue> d)
+{
+	CefRefPtr<CefValue> value = CefValue::Create();
+	value->SetDictionary(d);
+
+	return to_json(value);
+}
+
+/* Settings shaped like a text source with a filter chain */
+static obs_data_t *make_settings(bool with_defaults = true)
+{
+	obs_data_t *data = obs_data_create();
+	obs_data_set_string(data, "text", "Hello \"world\"\n\u00e9");
+	obs_data_set_int(data, "color", 4294967295LL);
+	obs_data_set_double(data, "opacity", 0.75);
+	obs_data_set_bool(data, "outline", false);
+	if (with_defaults)
+		obs_data_set_default_string(data, "align", "left");
+
+	obs_data_t *font = obs_data_create();
+	obs_data_set_string(font, "face", "Arial");
+	obs_data_set_int(font, "size", 256);
+	obs_data_set_obj(data, "font", font);
+	obs_data_release(font);
+
+	obs_data_array_t *filters = obs_data_array_create();
+	for (int i = 0; i < 3; ++i) {
+		obs_data_t *filter = obs_data_create();
+		obs_data_set_string(filter, "id", "color_filter");
+		obs_data_set_double(filter, "gamma", 0.25 * (i + 1));
+
+		obs_data_array_t *empty = obs_data_array_create();
+		obs_data_set_array(filter, "empty", empty);
+		obs_data_array_release(empty);
+
+		obs_data_array_push_back(filters, filter);
+		obs_data_release(filter);
+	}
+	obs_data_set_array(data, "filters", filters);
+	obs_data_array_release(filters);
+
+	return data;
+}
+
+static void test_data_round_trip()
+{
+	obs_data_t *data = make_settings();
+
+	CefRefPtr<CefValue> value = SerializeData(data);
+	CefRefPtr<CefDictionaryValue> d = value->GetDictionary();
+
+	CHECK_EQ(d->GetType("color"), VTYPE_DOUBLE);
+	CHECK_EQ(d->GetDouble("color"), 4294967295.0);
+	CHECK_EQ(d->GetType("opacity"), VTYPE_DOUBLE);
+	CHECK_EQ(d->GetString("align").ToString(), "left");
+	CHECK_EQ(d->GetDictionary("font")->GetInt("size"), 256);
+	CHECK_EQ(d->GetList("filters")->GetSize(), 3u);
+	CHECK_EQ(d->GetList("filters")->GetDictionary(2)->GetDouble("gamma"),
+		 0.75);
+	CHECK_EQ(d->GetList("filters")
+			 ->GetDictionary(0)
+			 ->GetList("empty")
+			 ->GetSize(),
+		 0u);
+
+	obs_data_t *copy = obs_data_create();
+	CHECK(DeserializeData(value, copy));
+	CHECK_EQ(to_json(SerializeData(copy)), to_json(value));
+
+	CHECK_EQ(obs_data_get_int(copy, "color"), 4294967295LL);
+
+	obs_data_release(copy);
+	obs_data_release(data);
+}
+
+/* The direct conversion gives what going through JSON text did, except
+ * for default values, which obs_data_get_json() leaves out */
+static void test_data_matches_json_path()
+{
+	obs_data_t *data = make_settings(false);
+
+	CefRefPtr<CefValue> parsed =
+		CefParseJSON(obs_data_get_json(data), JSON_PARSER_RFC);
+	CHECK(parsed.get() != nullptr);
+	if (parsed)
+		CHECK_EQ(to_json(SerializeData(data)), to_json(parsed));
+
+	obs_data_t *from_json = obs_data_create_from_json(
+		CefWriteJSON(SerializeData(data), JSON_WRITER_DEFAULT)
+			.ToString()
+			.c_str());
+	obs_data_t *direct = obs_data_create();
+	CHECK(DeserializeData(SerializeData(data), direct));
+	CHECK_EQ(to_json(SerializeData(direct)),
+		 to_json(SerializeData(from_json)));
+
+	obs_data_release(direct);
+	obs_data_release(from_json);
+	obs_data_release(data);
+}
+
+static void test_deserialize_skips_unsupported()
+{
+	/* Nulls and non-object array items have no obs_data form */
+	CefRefPtr<CefValue> input = CefParseJSON(
+		"{\"a\":null,\"list\":[1,\"two\",{\"x\":1},[3],{\"y\":null}],"
+		"\"obj\":{\"n\":null,\"s\":\"v\"}}",
+		JSON_PARSER_RFC);
+
+	obs_data_t *data = obs_data_create();
+	CHECK(DeserializeData(input, data));
+
+	CHECK(!obs_data_has_user_value(data, "a"));
+
+	obs_data_array_t *list = obs_data_get_array(data, "list");
+	CHECK_EQ(obs_data_array_count(list), 2u);
+	obs_data_t *first = obs_data_array_item(list, 0);
+	CHECK_EQ(obs_data_get_int(first, "x"), 1);
+	obs_data_release(first);
+	obs_data_array_release(list);
+
+	obs_data_t *obj = obs_data_get_obj(data, "obj");
+	CHECK_EQ(std::string(obs_data_get_string(obj, "s")), "v");
+	CHECK(!obs_data_has_user_value(obj, "n"));
+	obs_data_release(obj);
+
+	obs_data_release(data);
+
+	/* Only dictionaries deserialize */
+	data = obs_data_create();
+	CHECK(!DeserializeData(CefParseJSON("[]", JSON_PARSER_RFC), data));
+	CHECK(!DeserializeData(nullptr, data));
+	obs_data_release(data);
+}
+
+static void test_source_settings()
+{
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_string(settings, "url", "https://example.com/overlay");
+	obs_data_set_int(settings, "width", 1920);
+	obs_data_set_double(settings, "fps", 29.97);
+	obs_data_set_bool(settings, "shutdown", true);
+
+	obs_source_t *source = obs_source_create_private("browser_source",
+							 "Overlay", settings);
+	obs_data_release(settings);
+
+	CefRefPtr<CefValue> value = SerializeObsSourceSettings(source);
+	CHECK_EQ(value->GetType(), VTYPE_DICTIONARY);
+
+	CefRefPtr<CefDictionaryValue> d = value->GetDictionary();
+	CHECK_EQ(d->GetSize(), 4u);
+	CHECK_EQ(d->GetString("url").ToString(), "https://example.com/overlay");
+	CHECK_EQ(d->GetType("width"), VTYPE_INT);
+	CHECK_EQ(d->GetInt("width"), 1920);
+	CHECK_EQ(d->GetType("fps"), VTYPE_DOUBLE);
+	CHECK_EQ(d->GetDouble("fps"), 29.97);
+	CHECK(d->GetBool("shutdown"));
+
+	CHECK_EQ(SerializeObsSourceSettings(nullptr)->GetType(), VTYPE_NULL);
+
+	obs_source_release(source);
+}
+
+static obs_transform_info make_transform()
+{
+	obs_transform_info info = {};
+
+	info.pos = {100.0f, 50.0f};
+	info.rot = 45.0f;
+	info.scale = {0.5f, 2.0f};
+	info.alignment = OBS_ALIGN_RIGHT | OBS_ALIGN_BOTTOM;
+	info.bounds_type = OBS_BOUNDS_SCALE_INNER;
+	info.bounds_alignment = OBS_ALIGN_TOP;
+	info.bounds = {1280.0f, 720.0f};
+
+	return info;
+}
+
+static bool collect_item(obs_scene_t *, obs_sceneitem_t *item, void *param)
+{
+	((std::vector<obs_sceneitem_t *> *)param)->push_back(item);
+
+	return true;
+}
+
+static void test_composition_round_trip()
+{
+	obs_scene_t *scene = obs_scene_create("Scene");
+	obs_source_t *logo =
+		obs_source_create_private("image_source", "Logo", nullptr);
+	stub::set_source_size(logo, 640, 360);
+
+	obs_sceneitem_t *item = obs_scene_add(scene, logo);
+
+	obs_transform_info info = make_transform();
+	obs_sceneitem_crop crop = {10, 20, 30, 40};
+	obs_sceneitem_set_info(item, &info);
+	obs_sceneitem_set_crop(item, &crop);
+
+	CefRefPtr<CefDictionaryValue> composition =
+		SerializeObsSceneItemCompositionSettings(logo, item);
+
+	CHECK_EQ(composition->GetInt("srcWidth"), 640);
+	CHECK_EQ(composition->GetInt("srcHeight"), 360);
+	CHECK_EQ(composition->GetDouble("rotationDegrees"), 45.0);
+	CHECK_EQ(composition->GetString("alignment").ToString(),
+		 "bottom_right");
+	CHECK_EQ(composition->GetString("boundsType").ToString(),
+		 "scale_to_inner_rect");
+	CHECK_EQ(composition->GetString("boundsAlignment").ToString(),
+		 "top_center");
+	CHECK_EQ(composition->GetDictionary("crop")->GetInt("bottom"), 40);
+	CHECK_EQ(composition->GetDictionary("position")->GetDouble("x"),
+		 100.0);
+
+	/* The scene API receives compositions wrapped in a scene item */
+	CefRefPtr<CefDictionaryValue> root = CefDictionaryValue::Create();
+	root->SetDictionary("composition", composition);
+	CefRefPtr<CefValue> input = CefValue::Create();
+	input->SetDictionary(root);
+
+	obs_transform_info parsed_info;
+	obs_sceneitem_crop parsed_crop;
+	CHECK(DeserializeSceneItemComposition(input, parsed_info,
+					      parsed_crop));
+
+	CHECK_EQ(parsed_info.pos.x, info.pos.x);
+	CHECK_EQ(parsed_info.pos.y, info.pos.y);
+	CHECK_EQ(parsed_info.rot, info.rot);
+	CHECK_EQ(parsed_info.scale.x, info.scale.x);
+	CHECK_EQ(parsed_info.scale.y, info.scale.y);
+	CHECK_EQ(parsed_info.alignment, info.alignment);
+	CHECK_EQ(parsed_info.bounds_type, info.bounds_type);
+	CHECK_EQ(parsed_info.bounds_alignment, info.bounds_alignment);
+	CHECK_EQ(parsed_info.bounds.x, info.bounds.x);
+	CHECK_EQ(parsed_crop.left, crop.left);
+	CHECK_EQ(parsed_crop.top, crop.top);
+	CHECK_EQ(parsed_crop.right, crop.right);
+	CHECK_EQ(parsed_crop.bottom, crop.bottom);
+
+	/* A second item given the parsed composition serializes the same */
+	obs_sceneitem_t *copy = obs_scene_add(scene, logo);
+	obs_sceneitem_set_info(copy, &parsed_info);
+	obs_sceneitem_set_crop(copy, &parsed_crop);
+
+	std::vector<obs_sceneitem_t *> items;
+	obs_scene_enum_items(scene, collect_item, &items);
+	CHECK_EQ(items.size(), 2u);
+
+	if (items.size() == 2) {
+		CHECK_EQ(to_json(SerializeObsSceneItemCompositionSettings(
+				 obs_sceneitem_get_source(items[0]),
+				 items[0])),
+			 to_json(SerializeObsSceneItemCompositionSettings(
+				 obs_sceneitem_get_source(items[1]),
+				 items[1])));
+	}
+
+	obs_source_release(logo);
+	obs_scene_release(scene);
+}
+
+static void test_composition_defaults_and_errors()
+{
+	obs_transform_info info;
+	obs_sceneitem_crop crop;
+
+	CefRefPtr<CefValue> input =
+		CefParseJSON("{\"composition\":{\"position\":{\"x\":5,\"y\":6}}}",
+			     JSON_PARSER_RFC);
+	CHECK(DeserializeSceneItemComposition(input, info, crop));
+	CHECK_EQ(info.pos.x, 5.0f);
+	CHECK_EQ(info.scale.x, 1.0f);
+	CHECK_EQ(info.scale.y, 1.0f);
+	CHECK_EQ(info.alignment, (uint32_t)(OBS_ALIGN_LEFT | OBS_ALIGN_TOP));
+	CHECK_EQ(info.bounds_type, OBS_BOUNDS_NONE);
+	CHECK_EQ(crop.left, 0);
+
+	input = CefParseJSON("{\"composition\":{\"boundsType\":\"bogus\"}}",
+			     JSON_PARSER_RFC);
+	CHECK(!DeserializeSceneItemComposition(input, info, crop));
+
+	input = CefParseJSON("{\"position\":{\"x\":5,\"y\":6}}",
+			     JSON_PARSER_RFC);
+	CHECK(!DeserializeSceneItemComposition(input, info, crop));
+
+	input = CefParseJSON("[]", JSON_PARSER_RFC);
+	CHECK(!DeserializeSceneItemComposition(input, info, crop));
+}
+
+int main()
+{
+	test_data_round_trip();
+	test_data_matches_json_path();
+	test_deserialize_skips_unsupported();
+	test_source_settings();
+	test_composition_round_trip();
+	test_composition_defaults_and_errors();
+
+	CHECK_EQ(stub::get_source_counters().created,
+		 stub::get_source_counters().destroyed);
+
+	return test_result();
+}
@@ -0,0 +1,199 @@
+#include "test-common.hpp"
+
+#include "StreamElementsStatePartitionWriter.hpp"
+
+#include <thread>
+
+/* Stands in for the partition files: counts writes and bytes, and can
+ * fail a partition or take a while to write */
+struct state_disk_t {
+	std::mutex mutex;
+	std::map<std::string, std::string> files;
+	std::string failing;
+	int delay_ms = 0;
+	size_t writes = 0;
+	size_t bytes = 0;
+
+	StreamElementsStatePartitionWriter::write_func_t Writer()
+	{
+		return [this](const std::string &name,
+			      const std::string &content) {
+			if (delay_ms)
+				std::this_thread::sleep_for(
+					std::chrono::milliseconds(delay_ms));
+
+			std::lock_guard<std::mutex> guard(mutex);
+
+			if (name == failing)
+				return false;
+
+			files[name] = content;
+			++writes;
+			bytes += content.size();
+			return true;
+		};
+	}
+};
+
+static std::string blob(char c, size_t size)
+{
+	return "\"" + std::string(size, c) + "\"";
+}
+
+/* A power user's state: a large hotkey and dock setup */
+static std::map<std::string, std::string> power_user_state()
+{
+	return {{"dockingBrowserWidgets", blob('d', 200 * 1024)},
+		{"notificationBar", blob('n', 512)},
+		{"workers", blob('w', 50 * 1024)},
+		{"hotkeyBindings", blob('h', 1024 * 1024)},
+		{"userInterfaceState", blob('u', 1024)}};
+}
+
+static size_t total_size(const std::map<std::string, std::string> &state)
+{
+	/* The previous single document: each partition keyed by name */
+	size_t size = 2;
+	for (auto &kv : state)
+		size += kv.first.size() + kv.second.size() + 4;
+	return size;
+}
+
+/* 100 UI changes in bursts of 10: each burst is one snapshot, which
+ * writes just the UI state partition */
+static void test_debounced_partitions()
+{
+	state_disk_t disk;
+	StreamElementsStatePartitionWriter writer(disk.Writer());
+
+	auto state = power_user_state();
+
+	CHECK(writer.Request());
+	CHECK_EQ(writer.Update(state), state.size());
+	auto result = writer.WritePending();
+	CHECK_EQ(result.partitions, state.size());
+	CHECK_EQ(result.failed, 0u);
+	CHECK(disk.files == state);
+
+	size_t initial_bytes = disk.bytes;
+	size_t snapshots = 0;
+	size_t requests = 0;
+
+	for (int burst = 0; burst < 10; ++burst) {
+		bool scheduled = false;
+
+		for (int change = 0; change < 10; ++change) {
+			++requests;
+			if (writer.Request()) {
+				CHECK(!scheduled);
+				scheduled = true;
+			}
+		}
+		CHECK(scheduled);
+
+		/* The debounce timer fires */
+		++snapshots;
+		state["userInterfaceState"] =
+			blob('0' + (char)burst, 1024);
+		CHECK_EQ(writer.Update(state), 1u);
+
+		/* On the persist queue's thread */
+		std::thread([&]() { result = writer.WritePending(); }).join();
+		CHECK_EQ(result.partitions, 1u);
+	}
+
+	CHECK(disk.files == state);
+	CHECK_EQ(disk.writes, state.size() + 10);
+
+	auto stats = writer.GetStats();
+	CHECK_EQ(stats.writeCount, 11u);
+	CHECK_EQ(stats.partitionsWritten, state.size() + 10);
+	CHECK_EQ(stats.bytesWritten, disk.bytes);
+
+	size_t changes_bytes = disk.bytes - initial_bytes;
+	CHECK_EQ(changes_bytes, 10 * (1024u + 2));
+
+	/* The previous persist: the base64 of the whole document, on every
+	 * request */
+	size_t previous_bytes = requests * 4 * ((total_size(state) + 2) / 3);
+
+	printf("state persistence: %zu changes in %zu bursts, %.1f MB of "
+	       "state: %zu bytes written, against %.1f MB rewriting the "
+	       "whole blob per change\n",
+	       requests, snapshots, total_size(state) / (1024.0 * 1024.0),
+	       changes_bytes, previous_bytes / (1024.0 * 1024.0));
+}
+
+/* Latency counts from the first request to the write reaching disk */
+static void test_latency()
+{
+	state_disk_t disk;
+	disk.delay_ms = 5;
+	StreamElementsStatePartitionWriter writer(disk.Writer());
+
+	CHECK(writer.Request());
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	CHECK(!writer.Request());
+
+	CHECK_EQ(writer.Update({{"workers", "[]"}}), 1u);
+	auto result = writer.WritePending();
+
+	CHECK(result.latencyNs >= 25000000u);
+	CHECK(result.latencyNs < 1000000000u);
+
+	auto stats = writer.GetStats();
+	CHECK_EQ(stats.totalLatencyNs, result.latencyNs);
+	CHECK_EQ(stats.maxLatencyNs, result.latencyNs);
+	CHECK_EQ(stats.bytesWritten, 2u);
+
+	/* An unchanged snapshot writes nothing, and is not counted */
+	CHECK(writer.Request());
+	CHECK_EQ(writer.Update({{"workers", "[]"}}), 0u);
+	result = writer.WritePending();
+	CHECK_EQ(result.partitions, 0u);
+	CHECK_EQ(writer.GetStats().writeCount, 1u);
+
+	printf("state persistence: request to disk latency %.1f ms with a "
+	       "20 ms debounce and a 5 ms write\n",
+	       stats.maxLatencyNs / 1e6);
+}
+
+/* A failed write is retried, unless newer content supersedes it */
+static void test_retry()
+{
+	state_disk_t disk;
+	disk.failing = "hotkeyBindings";
+	StreamElementsStatePartitionWriter writer(disk.Writer());
+
+	writer.Update({{"hotkeyBindings", "1"}, {"workers", "1"}});
+	auto result = writer.WritePending();
+	CHECK_EQ(result.partitions, 1u);
+	CHECK_EQ(result.failed, 1u);
+	CHECK(!disk.files.count("hotkeyBindings"));
+
+	disk.failing.clear();
+	result = writer.WritePending();
+	CHECK_EQ(result.partitions, 1u);
+	CHECK_EQ(result.failed, 0u);
+	CHECK_EQ(disk.files["hotkeyBindings"], "1");
+
+	disk.failing = "hotkeyBindings";
+	writer.Update({{"hotkeyBindings", "2"}, {"workers", "1"}});
+	CHECK_EQ(writer.WritePending().failed, 1u);
+
+	disk.failing.clear();
+	writer.Update({{"hotkeyBindings", "3"}, {"workers", "1"}});
+	result = writer.WritePending();
+	CHECK_EQ(result.partitions, 1u);
+	CHECK_EQ(disk.files["hotkeyBindings"], "3");
+	CHECK_EQ(disk.files["workers"], "1");
+}
+
+int main()
+{
+	test_debounced_partitions();
+	test_latency();
+	test_retry();
+
+	return test_result();
+}
@@ -0,0 +1,149 @@
+#include "test-common.hpp"
+
+#include "StreamElementsTracer.hpp"
+
+#include "json11/json11.hpp"
+
+#include <set>
+#include <thread>
+
+static json11::Json::array trace_events()
+{
+	std::string err;
+	json11::Json trace = json11::Json::parse(
+		StreamElementsTracer::SerializeChromeTrace(), err);
+
+	CHECK(err.empty());
+	CHECK_EQ(trace["displayTimeUnit"].string_value(), "ms");
+
+	return trace["traceEvents"].array_items();
+}
+
+static void test_disabled()
+{
+	StreamElementsTracer::SetEnabled(false);
+	StreamElementsTracer::Clear();
+
+	{
+		SE_TRACE_SCOPE("test", "disabled");
+	}
+	StreamElementsTracer::RecordAsyncBegin("test", "disabled", 1);
+
+	CHECK(trace_events().empty());
+}
+
+static void test_spans()
+{
+	StreamElementsTracer::Clear();
+	StreamElementsTracer::SetEnabled(true);
+
+	{
+		SE_TRACE_SCOPE("test", "outer");
+		SE_TRACE_SCOPE("test", std::string("inner"));
+	}
+
+	std::thread([]() { SE_TRACE_SCOPE("test", "worker"); }).join();
+
+	auto events = trace_events();
+	CHECK_EQ(events.size(), 6u);
+	if (events.size() != 6)
+		return;
+
+	/* Per thread, in recording order */
+	std::set<int> tids;
+	for (auto &event : events) {
+		CHECK_EQ(event["cat"].string_value(), "test");
+		CHECK_EQ(event["pid"].int_value(), 1);
+		tids.insert(event["tid"].int_value());
+	}
+	CHECK_EQ(tids.size(), 2u);
+
+	CHECK_EQ(events[0]["ph"].string_value(), "B");
+	CHECK_EQ(events[0]["name"].string_value(), "outer");
+	CHECK_EQ(events[1]["name"].string_value(), "inner");
+	CHECK_EQ(events[2]["ph"].string_value(), "E");
+	CHECK_EQ(events[3]["ph"].string_value(), "E");
+	CHECK(events[0]["ts"].number_value() <= events[3]["ts"].number_value());
+	CHECK_EQ(events[4]["name"].string_value(), "worker");
+
+	/* Names are copied, and truncated */
+	StreamElementsTracer::Clear();
+	{
+		SE_TRACE_SCOPE("test", std::string(100, 'x'));
+	}
+	events = trace_events();
+	CHECK_EQ(events.size(), 2u);
+	if (events.size() == 2)
+		CHECK_EQ(events[0]["name"].string_value(), std::string(62, 'x'));
+}
+
+static void test_async_and_disable()
+{
+	StreamElementsTracer::Clear();
+	StreamElementsTracer::SetEnabled(true);
+
+	uint64_t id = StreamElementsTracer::NewAsyncId();
+	CHECK(StreamElementsTracer::NewAsyncId() != id);
+
+	StreamElementsTracer::RecordAsyncBegin("api", "call", id);
+
+	{
+		SE_TRACE_SCOPE("test", "open");
+
+		/* Spans open when tracing stops are still closed */
+		StreamElementsTracer::SetEnabled(false);
+	}
+
+	StreamElementsTracer::RecordAsyncEnd("api", "call", id);
+
+	/* Threads which never recorded do not get a buffer for them */
+	std::thread([id]() {
+		StreamElementsTracer::RecordAsyncEnd("api", "late", id);
+	}).join();
+
+	auto events = trace_events();
+	CHECK_EQ(events.size(), 4u);
+	if (events.size() != 4)
+		return;
+
+	CHECK_EQ(events[0]["ph"].string_value(), "b");
+	CHECK_EQ(events[0]["id"].string_value(), std::to_string(id));
+	CHECK_EQ(events[1]["ph"].string_value(), "B");
+	CHECK_EQ(events[2]["ph"].string_value(), "E");
+	CHECK_EQ(events[3]["ph"].string_value(), "e");
+	CHECK_EQ(events[3]["id"].string_value(), std::to_string(id));
+}
+
+static void test_ring_buffer()
+{
+	StreamElementsTracer::Clear();
+	StreamElementsTracer::SetEnabled(true);
+
+	const int spans = 10000;
+	std::thread([]() {
+		for (int i = 0; i < spans; ++i) {
+			SE_TRACE_SCOPE("test", std::to_string(i));
+		}
+	}).join();
+
+	StreamElementsTracer::SetEnabled(false);
+
+	/* The oldest events were overwritten */
+	auto events = trace_events();
+	CHECK_EQ(events.size(), 8192u);
+	if (!events.empty()) {
+		CHECK_EQ(events.back()["ph"].string_value(), "E");
+		CHECK_EQ(events[events.size() - 2]["name"].string_value(),
+			 std::to_string(spans - 1));
+	}
+}
+
+int main()
+{
+	test_disabled();
+	test_spans();
+	test_async_and_disable();
+	test_ring_buffer();
+
+	return test_result();
+}
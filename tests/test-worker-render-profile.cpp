@@ -0,0 +1,103 @@
+#include "test-common.hpp"
+
+#include "StreamElementsWorkerRenderProfile.hpp"
+
+#include <vector>
+
+/* Stats of count workers, as getAllBackgroundWorkersStats reports them */
+static std::vector<CefRefPtr<CefDictionaryValue>>
+start_workers(size_t count, bool lightweight)
+{
+	std::vector<CefRefPtr<CefDictionaryValue>> stats;
+
+	for (size_t i = 0; i < count; ++i) {
+		StreamElementsWorkerRenderProfile profile =
+			StreamElementsWorkerRenderProfile::Get(lightweight);
+
+		CefRefPtr<CefValue> value = CefValue::Create();
+		SerializeWorkerRenderStats(value, lightweight, &profile, 0);
+
+		stats.push_back(value->GetDictionary());
+	}
+
+	return stats;
+}
+
+static double backing_store_total(
+	const std::vector<CefRefPtr<CefDictionaryValue>> &stats)
+{
+	double total = 0;
+
+	for (auto d : stats)
+		total += d->GetDouble("backingStoreBytes");
+
+	return total;
+}
+
+static void test_ten_workers()
+{
+	auto lightweight = start_workers(10, true);
+	auto full = start_workers(10, false);
+
+	for (auto d : lightweight) {
+		CHECK(d->GetBool("lightweight"));
+		CHECK(d->GetBool("loaded"));
+		CHECK_EQ(d->GetInt("viewportWidth"), 1);
+		CHECK_EQ(d->GetInt("viewportHeight"), 1);
+		CHECK_EQ(d->GetDouble("paintCount"), 0.0);
+	}
+
+	for (auto d : full) {
+		CHECK(!d->GetBool("lightweight"));
+		CHECK_EQ(d->GetInt("viewportWidth"), 1920);
+		CHECK_EQ(d->GetInt("viewportHeight"), 1080);
+	}
+
+	CHECK_EQ(backing_store_total(lightweight), 40.0);
+	CHECK_EQ(backing_store_total(full), 10.0 * 1920 * 1080 * 4);
+
+	printf("10 background workers: backing stores %.0f bytes "
+	       "lightweight, %.1f MB full size\n",
+	       backing_store_total(lightweight),
+	       backing_store_total(full) / (1024.0 * 1024.0));
+}
+
+static void test_profiles()
+{
+	auto lightweight = StreamElementsWorkerRenderProfile::Get(true);
+	CHECK(!lightweight.webgl);
+	CHECK(lightweight.hidden);
+	CHECK_EQ(lightweight.frameRate, 1);
+
+	/* Full size workers keep the previous setup */
+	auto full = StreamElementsWorkerRenderProfile::Get(false);
+	CHECK(full.webgl);
+	CHECK(!full.hidden);
+	CHECK_EQ(full.frameRate, 0);
+}
+
+/* Workers whose browser is not created yet report no viewport */
+static void test_not_loaded()
+{
+	CefRefPtr<CefValue> value = CefValue::Create();
+	SerializeWorkerRenderStats(value, true, nullptr, 0);
+
+	CefRefPtr<CefDictionaryValue> d = value->GetDictionary();
+	CHECK(d->GetBool("lightweight"));
+	CHECK(!d->GetBool("loaded"));
+	CHECK(!d->HasKey("viewportWidth"));
+	CHECK(!d->HasKey("backingStoreBytes"));
+
+	auto profile = StreamElementsWorkerRenderProfile::Get(false);
+	SerializeWorkerRenderStats(value, false, &profile, 1234);
+	CHECK_EQ(value->GetDictionary()->GetDouble("paintCount"), 1234.0);
+}
+
+int main()
+{
+	test_profiles();
+	test_ten_workers();
+	test_not_loaded();
+
+	return test_result();
+}